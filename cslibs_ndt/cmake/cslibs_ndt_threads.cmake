@@ -0,0 +1,2 @@
+find_package(Threads REQUIRED)
+list(APPEND cslibs_ndt_LIBRARIES Threads::Threads)
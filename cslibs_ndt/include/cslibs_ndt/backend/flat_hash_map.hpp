@@ -0,0 +1,330 @@
+#ifndef CSLIBS_NDT_BACKEND_FLAT_HASH_MAP_HPP
+#define CSLIBS_NDT_BACKEND_FLAT_HASH_MAP_HPP
+
+#include <cslibs_ndt/backend/traits.hpp>
+#include <cslibs_ndt/utility/morton.hpp>
+#include <cslibs_ndt/utility/memory.hpp>
+
+#include <Eigen/Core>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Dynamic storage backend based on an open addressing hash table with
+ *        linear probing. Indices are stored as their Morton code, probing thus
+ *        compares a single integer and the table itself is one flat array.
+ *        The data lives in fixed size blocks next to the table and never moves,
+ *        since the bundles of a map point into the layer storages. Traversal
+ *        follows the insertion order.
+ *        Indices have to be representable by utility::Morton, i.e. within
+ *        +-2^30 per component in 2D and +-2^20 in 3D.
+ */
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+class FlatHashMap
+{
+public:
+    using data_interface_t  = data_interface_t_;
+    using index_interface_t = index_interface_t_;
+    using data_t            = typename data_interface_t::type;
+    using index_t           = typename index_interface_t::type;
+    using morton_t          = utility::Morton<std::tuple_size<index_t>::value>;
+
+    static constexpr std::size_t block_bits    = 10;
+    static constexpr std::size_t block_size    = 1ul << block_bits;
+    static constexpr std::size_t initial_bits  = 4;
+    static constexpr std::uint32_t no_slot     = std::numeric_limits<std::uint32_t>::max();
+
+    inline FlatHashMap()
+    {
+        clear();
+    }
+
+    inline FlatHashMap(const FlatHashMap &other) :
+        table_(other.table_),
+        keys_(other.keys_),
+        free_(other.free_),
+        size_(other.size_),
+        tombstones_(other.tombstones_),
+        shift_(other.shift_),
+        mask_(other.mask_)
+    {
+        for (const auto &b : other.blocks_) {
+            blocks_.emplace_back(new block_t);
+            blocks_.back()->reserve(block_size);
+            blocks_.back()->insert(blocks_.back()->end(), b->begin(), b->end());
+        }
+    }
+
+    inline FlatHashMap& operator = (const FlatHashMap &other)
+    {
+        if (this != &other) {
+            FlatHashMap copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    template <typename... Args>
+    inline data_t& insert(const index_t &index, Args&&... args)
+    {
+        if (!morton_t::representable(index))
+            throw std::out_of_range("[FlatHashMap]: index exceeds the range of the Morton code");
+
+        const std::uint64_t key = morton_t::encode(index);
+        std::size_t pos = hash(key);
+        std::size_t target = no_slot;
+        for (; table_[pos].key != empty; pos = (pos + 1) & mask_) {
+            if (table_[pos].key == key) {
+                data_t &data = at(table_[pos].slot);
+                data_interface_t::merge(data, data_t(std::forward<Args>(args)...));
+                return data;
+            }
+            if (table_[pos].key == tombstone && target == no_slot)
+                target = pos;
+        }
+
+        /// keep the load factor including tombstones below 0.5
+        if (target == no_slot && 2 * (size_ + tombstones_ + 1) > table_.size()) {
+            rehash(2 * (size_ + 1) > table_.size() / 2 ? table_.size() * 2 : table_.size());
+            return insert(index, std::forward<Args>(args)...);
+        }
+        if (target == no_slot)
+            target = pos;
+        else
+            --tombstones_;
+
+        const std::uint32_t slot = allocate(key, std::forward<Args>(args)...);
+        table_[target].key  = key;
+        table_[target].slot = slot;
+        ++size_;
+        return at(slot);
+    }
+
+    inline data_t* get(const index_t &index)
+    {
+        const std::uint32_t s = slot(index);
+        return s == no_slot ? nullptr : &at(s);
+    }
+
+    inline const data_t* get(const index_t &index) const
+    {
+        const std::uint32_t s = slot(index);
+        return s == no_slot ? nullptr : &at(s);
+    }
+
+    /**
+     * @brief Get the slot of the data of an index, no_slot if there is none.
+     */
+    inline std::uint32_t slot(const index_t &index) const
+    {
+        if (!morton_t::representable(index))
+            return no_slot;
+
+        const std::uint64_t key = morton_t::encode(index);
+        for (std::size_t pos = hash(key); table_[pos].key != empty; pos = (pos + 1) & mask_)
+            if (table_[pos].key == key)
+                return table_[pos].slot;
+        return no_slot;
+    }
+
+    inline data_t& at(const std::uint32_t slot)
+    {
+        return (*blocks_[slot >> block_bits])[slot & (block_size - 1)];
+    }
+
+    inline const data_t& at(const std::uint32_t slot) const
+    {
+        return (*blocks_[slot >> block_bits])[slot & (block_size - 1)];
+    }
+
+    inline bool remove(const index_t &index)
+    {
+        if (!morton_t::representable(index))
+            return false;
+
+        const std::uint64_t key = morton_t::encode(index);
+        for (std::size_t pos = hash(key); table_[pos].key != empty; pos = (pos + 1) & mask_) {
+            if (table_[pos].key == key) {
+                const std::uint32_t slot = table_[pos].slot;
+                at(slot) = data_t();
+                keys_[slot] = empty;
+                free_.emplace_back(slot);
+                table_[pos].key = tombstone;
+                --size_;
+                ++tombstones_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function)
+    {
+        for (std::size_t slot=0; slot<keys_.size(); ++slot) {
+            if (keys_[slot] != empty) {
+                const index_t index = morton_t::decode(keys_[slot]);
+                function(index, at(slot));
+            }
+        }
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function) const
+    {
+        for (std::size_t slot=0; slot<keys_.size(); ++slot) {
+            if (keys_[slot] != empty) {
+                const index_t index = morton_t::decode(keys_[slot]);
+                function(index, at(slot));
+            }
+        }
+    }
+
+    inline void clear()
+    {
+        blocks_.clear();
+        keys_.clear();
+        free_.clear();
+        size_       = 0;
+        tombstones_ = 0;
+        resize(1ul << initial_bits);
+    }
+
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+    inline std::size_t capacity() const
+    {
+        return table_.size();
+    }
+
+    inline std::size_t byte_size() const
+    {
+        return sizeof(*this) +
+                table_.capacity() * sizeof(entry_t) +
+                keys_.capacity()  * sizeof(std::uint64_t) +
+                free_.capacity()  * sizeof(std::uint32_t) +
+                blocks_.size()    * block_size * sizeof(data_t);
+    }
+
+    /**
+     * @brief Heap bytes not covered by byte_size, i.e. the block list and malloc headers.
+     */
+    inline std::size_t allocation_overhead() const
+    {
+        return utility::heap_overhead(table_.capacity() * sizeof(entry_t)) +
+                utility::heap_overhead(keys_.capacity() * sizeof(std::uint64_t)) +
+                utility::heap_overhead(free_.capacity() * sizeof(std::uint32_t)) +
+                utility::heap_block_size(blocks_.capacity() * sizeof(std::unique_ptr<block_t>)) +
+                blocks_.size() * (utility::heap_block_size(sizeof(block_t)) +
+                                  utility::heap_overhead(block_size * sizeof(data_t)));
+    }
+
+private:
+    using block_t = std::vector<data_t, Eigen::aligned_allocator<data_t>>;
+
+    struct entry_t
+    {
+        std::uint64_t key;
+        std::uint32_t slot;
+    };
+
+    /// Morton codes never use the most significant bit
+    static constexpr std::uint64_t empty     = std::numeric_limits<std::uint64_t>::max();
+    static constexpr std::uint64_t tombstone = empty - 1;
+
+    std::vector<entry_t>                  table_;
+    std::vector<std::unique_ptr<block_t>> blocks_;
+    std::vector<std::uint64_t>            keys_;     /// key per data slot, empty if the slot is free
+    std::vector<std::uint32_t>            free_;
+    std::size_t                           size_;
+    std::size_t                           tombstones_;
+    std::size_t                           shift_;
+    std::size_t                           mask_;
+
+    inline std::size_t hash(const std::uint64_t key) const
+    {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    template <typename... Args>
+    inline std::uint32_t allocate(const std::uint64_t key, Args&&... args)
+    {
+        if (!free_.empty()) {
+            const std::uint32_t slot = free_.back();
+            free_.pop_back();
+            at(slot) = data_t(std::forward<Args>(args)...);
+            keys_[slot] = key;
+            return slot;
+        }
+
+        /// blocks are never reallocated, thus references stay valid
+        if (keys_.size() == blocks_.size() * block_size) {
+            blocks_.emplace_back(new block_t);
+            blocks_.back()->reserve(block_size);
+        }
+        blocks_.back()->emplace_back(std::forward<Args>(args)...);
+        keys_.emplace_back(key);
+        return static_cast<std::uint32_t>(keys_.size() - 1);
+    }
+
+    inline void resize(const std::size_t capacity)
+    {
+        std::size_t bits = initial_bits;
+        while ((1ul << bits) < capacity)
+            ++bits;
+        shift_ = 64 - bits;
+        mask_  = (1ul << bits) - 1;
+        table_.assign(1ul << bits, entry_t{empty, no_slot});
+    }
+
+    inline void rehash(const std::size_t capacity)
+    {
+        resize(capacity);
+        tombstones_ = 0;
+        for (std::size_t slot=0; slot<keys_.size(); ++slot) {
+            if (keys_[slot] == empty)
+                continue;
+            std::size_t pos = hash(keys_[slot]);
+            while (table_[pos].key != empty)
+                pos = (pos + 1) & mask_;
+            table_[pos].key  = keys_[slot];
+            table_[pos].slot = static_cast<std::uint32_t>(slot);
+        }
+    }
+
+    inline void swap(FlatHashMap &other)
+    {
+        std::swap(table_, other.table_);
+        std::swap(blocks_, other.blocks_);
+        std::swap(keys_, other.keys_);
+        std::swap(free_, other.free_);
+        std::swap(size_, other.size_);
+        std::swap(tombstones_, other.tombstones_);
+        std::swap(shift_, other.shift_);
+        std::swap(mask_, other.mask_);
+    }
+};
+
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::uint64_t FlatHashMap<data_interface_t_, index_interface_t_, options_ts_...>::empty;
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::uint64_t FlatHashMap<data_interface_t_, index_interface_t_, options_ts_...>::tombstone;
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::uint32_t FlatHashMap<data_interface_t_, index_interface_t_, options_ts_...>::no_slot;
+
+template <>
+struct has_slots<FlatHashMap> : std::true_type {};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_FLAT_HASH_MAP_HPP
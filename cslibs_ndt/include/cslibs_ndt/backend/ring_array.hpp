@@ -0,0 +1,297 @@
+#ifndef CSLIBS_NDT_BACKEND_RING_ARRAY_HPP
+#define CSLIBS_NDT_BACKEND_RING_ARRAY_HPP
+
+#include <cslibs_ndt/backend/traits.hpp>
+#include <cslibs_ndt/utility/memory.hpp>
+
+#include <cslibs_indexed_storage/storage.hpp>
+
+#include <Eigen/Core>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Static storage backend with toroidal addressing. Like the array backend
+ *        it covers a window of array_size cells starting at array_offset, but a
+ *        cell is addressed by its index modulo the size. Setting a new offset thus
+ *        moves the window without moving any data, only the cells which leave the
+ *        window are destroyed. Memory is reserved once when the size is set.
+ */
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+class RingArray
+{
+public:
+    using data_interface_t  = data_interface_t_;
+    using index_interface_t = index_interface_t_;
+    using data_t            = typename data_interface_t::type;
+    using index_t           = typename index_interface_t::type;
+
+    static constexpr std::size_t Dim = std::tuple_size<index_t>::value;
+
+    using size_t = std::array<std::size_t,Dim>;
+
+    inline RingArray() :
+        data_(nullptr),
+        capacity_(0),
+        size_(0)
+    {
+        extent_.fill(0);
+        offset_.fill(0);
+    }
+
+    inline RingArray(const RingArray &other) :
+        RingArray()
+    {
+        *this = other;
+    }
+
+    inline RingArray& operator = (const RingArray &other)
+    {
+        if (this != &other) {
+            resize(other.extent_);
+            offset_ = other.offset_;
+            other.traverseCells([this, &other](const std::size_t cell) {
+                construct(cell, other.data_[cell]);
+            });
+        }
+        return *this;
+    }
+
+    inline ~RingArray()
+    {
+        resize(size_t());
+    }
+
+    template <typename option_t, typename value_t>
+    inline void set(const value_t &value)
+    {
+        set(option_t(), value);
+    }
+
+    template <typename... Args>
+    inline data_t& insert(const index_t &index, Args&&... args)
+    {
+        if (!inWindow(index))
+            throw std::out_of_range("[RingArray]: index is outside of the window");
+
+        const std::size_t cell = cellIndex(index);
+        if (has(cell)) {
+            data_interface_t::merge(data_[cell], data_t(std::forward<Args>(args)...));
+            return data_[cell];
+        }
+        return construct(cell, std::forward<Args>(args)...);
+    }
+
+    inline data_t* get(const index_t &index)
+    {
+        if (!inWindow(index))
+            return nullptr;
+        const std::size_t cell = cellIndex(index);
+        return has(cell) ? data_ + cell : nullptr;
+    }
+
+    inline const data_t* get(const index_t &index) const
+    {
+        if (!inWindow(index))
+            return nullptr;
+        const std::size_t cell = cellIndex(index);
+        return has(cell) ? data_ + cell : nullptr;
+    }
+
+    inline bool remove(const index_t &index)
+    {
+        if (!inWindow(index))
+            return false;
+        const std::size_t cell = cellIndex(index);
+        if (!has(cell))
+            return false;
+        destroy(cell);
+        return true;
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function)
+    {
+        traverseCells([this, &function](const std::size_t cell) {
+            function(toIndex(cell), data_[cell]);
+        });
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function) const
+    {
+        traverseCells([this, &function](const std::size_t cell) {
+            function(toIndex(cell), static_cast<const data_t&>(data_[cell]));
+        });
+    }
+
+    inline void clear()
+    {
+        traverseCells([this](const std::size_t cell) {
+            destroy(cell);
+        });
+    }
+
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+    inline std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    inline std::size_t byte_size() const
+    {
+        return sizeof(*this) + capacity_ * sizeof(data_t) + used_.size() * sizeof(std::uint64_t);
+    }
+
+    /**
+     * @brief Heap bytes not covered by byte_size, i.e. malloc headers.
+     */
+    inline std::size_t allocation_overhead() const
+    {
+        return utility::heap_overhead(capacity_ * sizeof(data_t)) +
+                utility::heap_overhead(used_.capacity() * sizeof(std::uint64_t));
+    }
+
+private:
+    using allocator_t = Eigen::aligned_allocator<data_t>;
+
+    data_t                     *data_;
+    std::size_t                 capacity_;
+    std::size_t                 size_;
+    std::vector<std::uint64_t>  used_;
+    size_t                      extent_;
+    index_t                     offset_;
+
+    inline void set(cslibs_indexed_storage::option::tags::array_size, const size_t &extent)
+    {
+        resize(extent);
+    }
+
+    /**
+     * @brief Move the window, cells which leave it are destroyed slab by slab.
+     */
+    inline void set(cslibs_indexed_storage::option::tags::array_offset, const index_t &offset)
+    {
+        for (std::size_t i=0; i<Dim; ++i) {
+            const int extent = static_cast<int>(extent_[i]);
+            const int delta  = offset[i] - offset_[i];
+            if (delta >= extent || -delta >= extent) {
+                clear();
+                break;
+            }
+            const int begin = delta > 0 ? offset_[i]         : offset[i] + extent;
+            const int end   = delta > 0 ? offset[i]          : offset_[i] + extent;
+            for (int v = begin; v < end; ++v)
+                clearSlab(i, modulo(v, extent_[i]));
+        }
+        offset_ = offset;
+    }
+
+    inline void resize(const size_t &extent)
+    {
+        clear();
+        allocator_t().deallocate(data_, capacity_);
+
+        extent_   = extent;
+        capacity_ = 1;
+        for (const std::size_t e : extent_)
+            capacity_ *= e;
+        data_ = capacity_ > 0 ? allocator_t().allocate(capacity_) : nullptr;
+        used_.assign((capacity_ + 63) / 64, 0);
+    }
+
+    inline bool inWindow(const index_t &index) const
+    {
+        for (std::size_t i=0; i<Dim; ++i)
+            if (index[i] < offset_[i] || index[i] - offset_[i] >= static_cast<int>(extent_[i]))
+                return false;
+        return true;
+    }
+
+    static inline std::size_t modulo(const int v, const std::size_t extent)
+    {
+        const int e = static_cast<int>(extent);
+        return static_cast<std::size_t>(((v % e) + e) % e);
+    }
+
+    inline std::size_t cellIndex(const index_t &index) const
+    {
+        std::size_t cell = 0;
+        for (std::size_t i=Dim; i-- > 0;)
+            cell = cell * extent_[i] + modulo(index[i], extent_[i]);
+        return cell;
+    }
+
+    inline index_t toIndex(std::size_t cell) const
+    {
+        index_t index;
+        for (std::size_t i=0; i<Dim; ++i) {
+            const std::size_t m = cell % extent_[i];
+            cell /= extent_[i];
+            index[i] = offset_[i] + static_cast<int>(modulo(static_cast<int>(m) - offset_[i], extent_[i]));
+        }
+        return index;
+    }
+
+    /// destroy all cells with the ring coordinate m along dimension dim
+    inline void clearSlab(const std::size_t dim, const std::size_t m)
+    {
+        std::size_t stride = 1;
+        for (std::size_t i=0; i<dim; ++i)
+            stride *= extent_[i];
+        const std::size_t layer = stride * extent_[dim];
+        for (std::size_t outer = 0; outer < capacity_; outer += layer) {
+            const std::size_t begin = outer + m * stride;
+            for (std::size_t cell = begin; cell < begin + stride; ++cell)
+                if (has(cell))
+                    destroy(cell);
+        }
+    }
+
+    inline bool has(const std::size_t cell) const
+    {
+        return (used_[cell >> 6] >> (cell & 63ul)) & 1ul;
+    }
+
+    template <typename... Args>
+    inline data_t& construct(const std::size_t cell, Args&&... args)
+    {
+        new (data_ + cell) data_t(std::forward<Args>(args)...);
+        used_[cell >> 6] |= 1ull << (cell & 63ul);
+        ++size_;
+        return data_[cell];
+    }
+
+    inline void destroy(const std::size_t cell)
+    {
+        data_[cell].~data_t();
+        used_[cell >> 6] &= ~(1ull << (cell & 63ul));
+        --size_;
+    }
+
+    template <typename Fn>
+    inline void traverseCells(const Fn &function) const
+    {
+        for (std::size_t w=0; w<used_.size(); ++w) {
+            for (std::uint64_t u = used_[w]; u; u &= u - 1)
+                function(w * 64ul + static_cast<std::size_t>(__builtin_ctzll(u)));
+        }
+    }
+};
+
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::size_t RingArray<data_interface_t_, index_interface_t_, options_ts_...>::Dim;
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_RING_ARRAY_HPP
@@ -0,0 +1,185 @@
+#ifndef CSLIBS_NDT_BACKEND_SHARDED_UNORDERED_MAP_HPP
+#define CSLIBS_NDT_BACKEND_SHARDED_UNORDERED_MAP_HPP
+
+#include <cslibs_ndt/backend/traits.hpp>
+#include <cslibs_ndt/utility/memory.hpp>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Dynamic storage backend which can be written by several threads at once.
+ *        The indices are distributed over a fixed number of shards, each being an
+ *        unordered map guarded by its own mutex. References to the data stay valid
+ *        on insertion, thus only insert and get have to be synchronized.
+ *        insert, get and remove may be called concurrently, traverse, clear and the
+ *        size queries must not overlap with writers.
+ */
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+class ShardedUnorderedMap
+{
+public:
+    using data_interface_t  = data_interface_t_;
+    using index_interface_t = index_interface_t_;
+    using data_t            = typename data_interface_t::type;
+    using index_t           = typename index_interface_t::type;
+
+    static constexpr std::size_t shard_bits  = 6;
+    static constexpr std::size_t shard_count = 1ul << shard_bits;
+
+    inline ShardedUnorderedMap() = default;
+
+    inline ShardedUnorderedMap(const ShardedUnorderedMap &other)
+    {
+        for (std::size_t i=0; i<shard_count; ++i)
+            shards_[i].data = other.shards_[i].data;
+    }
+
+    inline ShardedUnorderedMap& operator = (const ShardedUnorderedMap &other)
+    {
+        for (std::size_t i=0; i<shard_count; ++i)
+            shards_[i].data = other.shards_[i].data;
+        return *this;
+    }
+
+    template <typename... Args>
+    inline data_t& insert(const index_t &index, Args&&... args)
+    {
+        shard_t &s = shard(index);
+        std::lock_guard<std::mutex> l(s.mutex);
+        auto it = s.data.find(index);
+        if (it == s.data.end())
+            return s.data.emplace(std::piecewise_construct,
+                                  std::forward_as_tuple(index),
+                                  std::forward_as_tuple(std::forward<Args>(args)...)).first->second;
+
+        data_interface_t::merge(it->second, data_t(std::forward<Args>(args)...));
+        return it->second;
+    }
+
+    inline data_t* get(const index_t &index)
+    {
+        shard_t &s = shard(index);
+        std::lock_guard<std::mutex> l(s.mutex);
+        auto it = s.data.find(index);
+        return it == s.data.end() ? nullptr : &(it->second);
+    }
+
+    inline const data_t* get(const index_t &index) const
+    {
+        const shard_t &s = shard(index);
+        std::lock_guard<std::mutex> l(s.mutex);
+        auto it = s.data.find(index);
+        return it == s.data.end() ? nullptr : &(it->second);
+    }
+
+    inline bool remove(const index_t &index)
+    {
+        shard_t &s = shard(index);
+        std::lock_guard<std::mutex> l(s.mutex);
+        return s.data.erase(index) > 0;
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function)
+    {
+        for (shard_t &s : shards_)
+            for (auto &entry : s.data)
+                function(entry.first, entry.second);
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function) const
+    {
+        for (const shard_t &s : shards_)
+            for (const auto &entry : s.data)
+                function(entry.first, entry.second);
+    }
+
+    inline void clear()
+    {
+        for (shard_t &s : shards_)
+            s.data.clear();
+    }
+
+    inline std::size_t size() const
+    {
+        std::size_t size = 0;
+        for (const shard_t &s : shards_)
+            size += s.data.size();
+        return size;
+    }
+
+    inline std::size_t capacity() const
+    {
+        std::size_t capacity = 0;
+        for (const shard_t &s : shards_)
+            capacity += s.data.bucket_count();
+        return capacity;
+    }
+
+    inline std::size_t byte_size() const
+    {
+        return sizeof(*this) + size() * (sizeof(index_t) + sizeof(data_t)) + capacity() * sizeof(void*);
+    }
+
+    /**
+     * @brief Heap bytes not covered by byte_size, i.e. the links and cached hashes
+     *        of the nodes and malloc headers.
+     */
+    inline std::size_t allocation_overhead() const
+    {
+        static constexpr std::size_t node_size = sizeof(void*) + sizeof(std::size_t) + sizeof(index_t) + sizeof(data_t);
+        std::size_t overhead = size() * (utility::heap_block_size(node_size) - sizeof(index_t) - sizeof(data_t));
+        for (const shard_t &s : shards_)
+            overhead += utility::heap_overhead(s.data.bucket_count() * sizeof(void*));
+        return overhead;
+    }
+
+private:
+    struct hash_t
+    {
+        inline std::size_t operator()(const index_t &index) const
+        {
+            std::uint64_t h = 0;
+            for (const auto &i : index)
+                h = (h ^ static_cast<std::uint32_t>(i)) * 0x100000001B3ull;
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+    struct shard_t
+    {
+        mutable std::mutex                          mutex;
+        std::unordered_map<index_t, data_t, hash_t> data;
+    };
+
+    std::array<shard_t, shard_count> shards_;
+
+    inline static std::size_t shardIndex(const index_t &index)
+    {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(hash_t()(index)) * 0x9E3779B97F4A7C15ull) >> (64 - shard_bits));
+    }
+
+    inline shard_t& shard(const index_t &index)
+    {
+        return shards_[shardIndex(index)];
+    }
+
+    inline const shard_t& shard(const index_t &index) const
+    {
+        return shards_[shardIndex(index)];
+    }
+};
+
+template <>
+struct is_concurrent<ShardedUnorderedMap> : std::true_type {};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_SHARDED_UNORDERED_MAP_HPP
@@ -0,0 +1,379 @@
+#ifndef CSLIBS_NDT_BACKEND_TILED_MAP_HPP
+#define CSLIBS_NDT_BACKEND_TILED_MAP_HPP
+
+#include <cslibs_ndt/backend/traits.hpp>
+#include <cslibs_ndt/utility/index_hash.hpp>
+#include <cslibs_ndt/utility/memory.hpp>
+
+#include <Eigen/Core>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Dynamic storage backend which grows in blocks of (2^block_bits)^Dim cells.
+ *        Every block is a dense array with a bitmask of the constructed cells, blocks
+ *        are found through a hash map of block indices. Neighbouring indices mostly
+ *        fall into the same block, which keeps lookups local. Cells never move once
+ *        constructed. Memory is reserved per block, so the backend is best suited for
+ *        maps which are dense on the scale of a block. Every block has a number in a
+ *        table, the slot of a cell is the block number followed by the cell bits.
+ */
+template <std::size_t block_bits, typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+class BasicTiledMap
+{
+public:
+    using data_interface_t  = data_interface_t_;
+    using index_interface_t = index_interface_t_;
+    using data_t            = typename data_interface_t::type;
+    using index_t           = typename index_interface_t::type;
+
+    static constexpr std::size_t   Dim         = std::tuple_size<index_t>::value;
+    static constexpr int           block_size  = 1 << block_bits;
+    static constexpr std::size_t   cell_bits   = block_bits * Dim;
+    static constexpr std::size_t   block_cells = 1ul << cell_bits;
+    static constexpr std::uint32_t no_slot     = std::numeric_limits<std::uint32_t>::max();
+
+    static_assert(cell_bits < 32, "BasicTiledMap: the cells of a block exceed a slot.");
+
+    inline BasicTiledMap() :
+        size_(0)
+    {
+    }
+
+    /// the copy keeps the block numbers, thus the slots
+    inline BasicTiledMap(const BasicTiledMap &other) :
+        blocks_(other.blocks_),
+        free_(other.free_),
+        size_(other.size_)
+    {
+        table_.resize(other.table_.size());
+        for (std::size_t b=0; b<table_.size(); ++b)
+            if (other.table_[b])
+                table_[b].reset(new block_t(*other.table_[b]));
+    }
+
+    inline BasicTiledMap& operator = (const BasicTiledMap &other)
+    {
+        if (this != &other) {
+            BasicTiledMap copy(other);
+            std::swap(blocks_, copy.blocks_);
+            std::swap(table_, copy.table_);
+            std::swap(free_, copy.free_);
+            std::swap(size_, copy.size_);
+        }
+        return *this;
+    }
+
+    template <typename... Args>
+    inline data_t& insert(const index_t &index, Args&&... args)
+    {
+        const index_t bi = blockIndex(index);
+        auto it = blocks_.find(bi);
+        if (it == blocks_.end())
+            it = blocks_.emplace(bi, createBlock()).first;
+
+        block_t &block = *table_[it->second];
+        const std::size_t cell = cellIndex(index);
+        if (block.has(cell)) {
+            data_interface_t::merge(block.at(cell), data_t(std::forward<Args>(args)...));
+            return block.at(cell);
+        }
+        ++size_;
+        return block.construct(cell, std::forward<Args>(args)...);
+    }
+
+    inline data_t* get(const index_t &index)
+    {
+        const std::uint32_t s = slot(index);
+        return s == no_slot ? nullptr : &at(s);
+    }
+
+    inline const data_t* get(const index_t &index) const
+    {
+        const std::uint32_t s = slot(index);
+        return s == no_slot ? nullptr : &at(s);
+    }
+
+    /**
+     * @brief Get the slot of the cell of an index, no_slot if it is not constructed.
+     */
+    inline std::uint32_t slot(const index_t &index) const
+    {
+        const auto it = blocks_.find(blockIndex(index));
+        if (it == blocks_.end())
+            return no_slot;
+        const std::size_t cell = cellIndex(index);
+        return table_[it->second]->has(cell) ?
+                    (it->second << cell_bits) | static_cast<std::uint32_t>(cell) : no_slot;
+    }
+
+    inline data_t& at(const std::uint32_t slot)
+    {
+        return table_[slot >> cell_bits]->at(slot & (block_cells - 1));
+    }
+
+    inline const data_t& at(const std::uint32_t slot) const
+    {
+        return table_[slot >> cell_bits]->at(slot & (block_cells - 1));
+    }
+
+    inline bool remove(const index_t &index)
+    {
+        const auto it = blocks_.find(blockIndex(index));
+        if (it == blocks_.end())
+            return false;
+        block_t &block = *table_[it->second];
+        const std::size_t cell = cellIndex(index);
+        if (!block.has(cell))
+            return false;
+
+        block.destroy(cell);
+        --size_;
+        if (block.empty()) {
+            table_[it->second].reset();
+            free_.emplace_back(it->second);
+            blocks_.erase(it);
+        }
+        return true;
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function)
+    {
+        for (auto &b : blocks_)
+            table_[b.second]->traverse(b.first, function);
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function) const
+    {
+        for (const auto &b : blocks_)
+            static_cast<const block_t&>(*table_[b.second]).traverse(b.first, function);
+    }
+
+    inline void clear()
+    {
+        blocks_.clear();
+        table_.clear();
+        free_.clear();
+        size_ = 0;
+    }
+
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+    inline std::size_t capacity() const
+    {
+        return blocks_.size() * block_cells;
+    }
+
+    inline std::size_t blockCount() const
+    {
+        return blocks_.size();
+    }
+
+    inline std::size_t byte_size() const
+    {
+        return sizeof(*this) +
+                blocks_.size()         * (sizeof(index_t) + sizeof(std::uint32_t) + sizeof(block_t) + block_cells * sizeof(data_t)) +
+                blocks_.bucket_count() * sizeof(void*) +
+                table_.capacity()      * sizeof(block_ptr_t) +
+                free_.capacity()       * sizeof(std::uint32_t);
+    }
+
+    /**
+     * @brief Heap bytes not covered by byte_size, i.e. the links of the block nodes
+     *        and malloc headers.
+     */
+    inline std::size_t allocation_overhead() const
+    {
+        static constexpr std::size_t node_size = sizeof(void*) + sizeof(std::pair<const index_t, std::uint32_t>);
+        return utility::heap_overhead(blocks_.bucket_count() * sizeof(void*)) +
+                utility::heap_overhead(table_.capacity() * sizeof(block_ptr_t)) +
+                utility::heap_overhead(free_.capacity() * sizeof(std::uint32_t)) +
+                blocks_.size() * (utility::heap_block_size(node_size) - sizeof(index_t) - sizeof(std::uint32_t) +
+                                  utility::heap_overhead(sizeof(block_t)) +
+                                  utility::heap_overhead(block_cells * sizeof(data_t)));
+    }
+
+private:
+    class block_t
+    {
+    public:
+        inline block_t() :
+            data_(allocator_t().allocate(block_cells))
+        {
+            used_.fill(0);
+        }
+
+        inline block_t(const block_t &other) :
+            block_t()
+        {
+            other.traverseCells([this, &other](const std::size_t cell) {
+                construct(cell, other.at(cell));
+            });
+        }
+
+        inline ~block_t()
+        {
+            traverseCells([this](const std::size_t cell) {
+                data_[cell].~data_t();
+            });
+            allocator_t().deallocate(data_, block_cells);
+        }
+
+        block_t& operator = (const block_t &other) = delete;
+
+        inline bool has(const std::size_t cell) const
+        {
+            return (used_[cell >> 6] >> (cell & 63ul)) & 1ul;
+        }
+
+        inline bool empty() const
+        {
+            for (const std::uint64_t u : used_)
+                if (u)
+                    return false;
+            return true;
+        }
+
+        inline data_t& at(const std::size_t cell)
+        {
+            return data_[cell];
+        }
+
+        inline const data_t& at(const std::size_t cell) const
+        {
+            return data_[cell];
+        }
+
+        template <typename... Args>
+        inline data_t& construct(const std::size_t cell, Args&&... args)
+        {
+            new (data_ + cell) data_t(std::forward<Args>(args)...);
+            used_[cell >> 6] |= 1ull << (cell & 63ul);
+            return data_[cell];
+        }
+
+        inline void destroy(const std::size_t cell)
+        {
+            data_[cell].~data_t();
+            used_[cell >> 6] &= ~(1ull << (cell & 63ul));
+        }
+
+        template <typename Fn>
+        inline void traverse(const index_t &bi, const Fn &function)
+        {
+            traverseCells([this, &bi, &function](const std::size_t cell) {
+                function(toIndex(bi, cell), data_[cell]);
+            });
+        }
+
+        template <typename Fn>
+        inline void traverse(const index_t &bi, const Fn &function) const
+        {
+            traverseCells([this, &bi, &function](const std::size_t cell) {
+                function(toIndex(bi, cell), static_cast<const data_t&>(data_[cell]));
+            });
+        }
+
+    private:
+        using allocator_t = Eigen::aligned_allocator<data_t>;
+
+        data_t                                              *data_;
+        std::array<std::uint64_t, (block_cells + 63) / 64>  used_;
+
+        template <typename Fn>
+        inline void traverseCells(const Fn &function) const
+        {
+            for (std::size_t w=0; w<used_.size(); ++w) {
+                for (std::uint64_t u = used_[w]; u; u &= u - 1)
+                    function(w * 64ul + static_cast<std::size_t>(__builtin_ctzll(u)));
+            }
+        }
+
+        static inline index_t toIndex(const index_t &bi, std::size_t cell)
+        {
+            index_t index;
+            for (std::size_t i=0; i<Dim; ++i) {
+                index[i] = bi[i] * block_size + static_cast<int>(cell & (block_size - 1));
+                cell >>= block_bits;
+            }
+            return index;
+        }
+    };
+
+    using block_ptr_t = std::unique_ptr<block_t>;
+
+    std::unordered_map<index_t, std::uint32_t, utility::IndexHash<Dim>> blocks_;   /// block number per block index
+    std::vector<block_ptr_t>                                            table_;
+    std::vector<std::uint32_t>                                          free_;     /// unused block numbers
+    std::size_t                                                         size_;
+
+    inline std::uint32_t createBlock()
+    {
+        if (!free_.empty()) {
+            const std::uint32_t b = free_.back();
+            free_.pop_back();
+            table_[b].reset(new block_t);
+            return b;
+        }
+        /// the last number is left out, its last cell would be no_slot
+        if ((table_.size() + 1) >> (32 - cell_bits))
+            throw std::length_error("[BasicTiledMap]: block numbers exceed a slot");
+        table_.emplace_back(new block_t);
+        return static_cast<std::uint32_t>(table_.size() - 1);
+    }
+
+    /// arithmetic shifts, floor division for negative indices as well
+    static inline index_t blockIndex(const index_t &index)
+    {
+        index_t bi;
+        for (std::size_t i=0; i<Dim; ++i)
+            bi[i] = index[i] >> block_bits;
+        return bi;
+    }
+
+    static inline std::size_t cellIndex(const index_t &index)
+    {
+        std::size_t cell = 0;
+        for (std::size_t i=Dim; i-- > 0;)
+            cell = (cell << block_bits) | static_cast<std::size_t>(index[i] & (block_size - 1));
+        return cell;
+    }
+};
+
+template <std::size_t block_bits, typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::size_t BasicTiledMap<block_bits, data_interface_t_, index_interface_t_, options_ts_...>::Dim;
+template <std::size_t block_bits, typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr int BasicTiledMap<block_bits, data_interface_t_, index_interface_t_, options_ts_...>::block_size;
+template <std::size_t block_bits, typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::size_t BasicTiledMap<block_bits, data_interface_t_, index_interface_t_, options_ts_...>::cell_bits;
+template <std::size_t block_bits, typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::size_t BasicTiledMap<block_bits, data_interface_t_, index_interface_t_, options_ts_...>::block_cells;
+template <std::size_t block_bits, typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+constexpr std::uint32_t BasicTiledMap<block_bits, data_interface_t_, index_interface_t_, options_ts_...>::no_slot;
+
+/**
+ * @brief Tiled backend with blocks of 16^Dim cells.
+ */
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+using TiledMap = BasicTiledMap<4, data_interface_t_, index_interface_t_, options_ts_...>;
+
+template <>
+struct has_slots<TiledMap> : std::true_type {};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_TILED_MAP_HPP
@@ -0,0 +1,27 @@
+#ifndef CSLIBS_NDT_BACKEND_TRAITS_HPP
+#define CSLIBS_NDT_BACKEND_TRAITS_HPP
+
+#include <type_traits>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Backends which allow concurrent insert and get calls specialize this
+ *        to true, maps using them then guard their distribution updates.
+ */
+template <template <typename, typename, typename...> class backend_t>
+struct is_concurrent : std::false_type {};
+
+/**
+ * @brief Backends which keep their data in arenas addressed by 32-bit slots
+ *        specialize this to true. They provide no_slot, slot(index), which
+ *        returns no_slot if the index is not stored, and at(slot). A slot stays
+ *        valid until its index is removed. Maps using them hold slots in their
+ *        bundles instead of pointers.
+ */
+template <template <typename, typename, typename...> class backend_t>
+struct has_slots : std::false_type {};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_TRAITS_HPP
@@ -2,8 +2,16 @@
 #define CSLIBS_NDT_COMMON_BUNDLE_HPP
 
 #include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 
 namespace cslibs_ndt {
+/**
+ * @brief The distributions of the 2^Dim layers overlapping a bundle. A bundle holds
+ *        nothing but the pointers, i.e. it has no virtual functions and no id of its
+ *        own. Ids are derived from the bundle index, see AbstractMap::getBundleId.
+ */
 template<typename T, std::size_t Size>
 class Bundle
 {
@@ -12,41 +20,15 @@ public:
     using data_t   = std::array<T, Size>;
 
     inline Bundle() :
-        id_(n_ ++)
+        data_()
     {
     }
 
-    inline virtual ~Bundle() = default;
-
     inline static std::size_t size()
     {
         return Size;
     }
 
-    inline Bundle(const Bundle &other) :
-        data_(other.data_),
-        id_(n_ ++)
-    {
-    }
-
-   inline  Bundle(Bundle &&other) :
-        data_(std::move(other.data_)),
-        id_(n_ ++)
-    {
-    }
-
-    inline Bundle& operator = (const Bundle &other)
-    {
-        data_ = other.data_;
-        return *this;
-    }
-
-    inline Bundle& operator = (Bundle &&other)
-    {
-        data_ = std::move(other.data_);
-        return *this;
-    }
-
     inline T& operator [] (const std::size_t i)
     {
         return data_[i];
@@ -77,8 +59,14 @@ public:
         return data_;
     }
 
-    inline void merge(const Bundle &)
+    /**
+     * @brief Take the entries of other where this bundle has none.
+     */
+    inline void merge(const Bundle &other)
     {
+        for (std::size_t i = 0 ; i < Size ; ++i)
+            if (!data_[i])
+                data_[i] = other.data_[i];
     }
 
     inline std::size_t byte_size() const
@@ -86,11 +74,6 @@ public:
         return sizeof(*this);
     }
 
-    inline const int& id() const
-    {
-        return id_;
-    }
-
     inline typename data_t::const_iterator begin() const
     {
         return data_.begin();
@@ -112,13 +95,163 @@ public:
     }
 
 private:
-    data_t     data_;
-    const int  id_;
-    static int n_;
+    data_t data_;
 };
 
-template<typename T, std::size_t Size>
-int Bundle<T, Size>::n_ = 0;
+/**
+ * @brief The distributions of the 2^Dim layers overlapping a bundle, as 32-bit slots
+ *        into the layer storages of a map which keep their distributions in slot
+ *        arenas (see backend::has_slots). Besides the slots, a bundle only holds
+ *        the layer table of its map, at() resolves a slot against it.
+ */
+template<typename T, typename storage_t, std::size_t Size>
+class SlotBundle
+{
+public:
+    using bundle_t = SlotBundle<T, storage_t, Size>;
+    using layers_t = std::array<storage_t*, Size>;
+    using slots_t  = std::array<std::uint32_t, Size>;
+    using data_t   = std::array<T*, Size>;
+
+    static constexpr std::uint32_t no_slot = std::numeric_limits<std::uint32_t>::max();
+
+    /**
+     * @brief Iterates the resolved distributions like the pointers of a Bundle.
+     */
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = T*;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T* const*;
+        using reference         = T*;
+
+        inline const_iterator(const bundle_t *bundle,
+                              const std::size_t i) :
+            bundle_(bundle),
+            i_(i)
+        {
+        }
+
+        inline T* operator * () const
+        {
+            return bundle_->at(i_);
+        }
+
+        inline const_iterator& operator ++ ()
+        {
+            ++i_;
+            return *this;
+        }
+
+        inline bool operator == (const const_iterator &other) const
+        {
+            return i_ == other.i_;
+        }
+
+        inline bool operator != (const const_iterator &other) const
+        {
+            return i_ != other.i_;
+        }
+
+    private:
+        const bundle_t *bundle_;
+        std::size_t     i_;
+    };
+
+    inline SlotBundle() :
+        layers_(nullptr)
+    {
+        slots_.fill(no_slot);
+    }
+
+    inline explicit SlotBundle(const layers_t *layers) :
+        layers_(layers)
+    {
+        slots_.fill(no_slot);
+    }
+
+    inline static std::size_t size()
+    {
+        return Size;
+    }
+
+    inline T* operator [] (const std::size_t i) const
+    {
+        return at(i);
+    }
+
+    inline T* at (const std::size_t i) const
+    {
+        return slots_[i] == no_slot ? nullptr : &((*layers_)[i]->at(slots_[i]));
+    }
+
+    inline std::uint32_t slot(const std::size_t i) const
+    {
+        return slots_[i];
+    }
+
+    inline void setSlot(const std::size_t i,
+                        const std::uint32_t slot)
+    {
+        slots_[i] = slot;
+    }
+
+    inline const slots_t& slots() const
+    {
+        return slots_;
+    }
+
+    inline const layers_t* layers() const
+    {
+        return layers_;
+    }
+
+    /**
+     * @brief The resolved distributions, nullptr where a layer has none.
+     */
+    inline data_t data() const
+    {
+        data_t d;
+        for (std::size_t i = 0 ; i < Size ; ++i)
+            d[i] = at(i);
+        return d;
+    }
+
+    /**
+     * @brief Take the entries of other where this bundle has none, both have to
+     *        belong to the same map.
+     */
+    inline void merge(const SlotBundle &other)
+    {
+        for (std::size_t i = 0 ; i < Size ; ++i)
+            if (slots_[i] == no_slot)
+                slots_[i] = other.slots_[i];
+    }
+
+    inline std::size_t byte_size() const
+    {
+        return sizeof(*this);
+    }
+
+    inline const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    inline const_iterator end() const
+    {
+        return const_iterator(this, Size);
+    }
+
+private:
+    const layers_t *layers_;
+    slots_t         slots_;
+};
+
+template<typename T, typename storage_t, std::size_t Size>
+constexpr std::uint32_t SlotBundle<T, storage_t, Size>::no_slot;
 }
 
 #endif // CSLIBS_NDT_COMMON_BUNDLE_HPP
@@ -9,6 +9,8 @@
 #include <cslibs_indexed_storage/storage.hpp>
 #include <cslibs_indexed_storage/backend/kdtree/kdtree.hpp>
 
+#include <cslibs_ndt/common/distribution_cache.hpp>
+
 namespace cslibs_ndt {
 template<typename T, std::size_t Dim>
 class EIGEN_ALIGN16 Distribution
@@ -19,6 +21,8 @@ public:
 
     using distribution_container_t = Distribution<T,Dim>;
     using distribution_t           = cslibs_math::statistics::StableDistribution<T,Dim,3>;
+    using point_t                  = typename distribution_t::sample_t;
+    using cache_t                  = DistributionCache<T,Dim>;
 
     inline Distribution()
     {
@@ -39,15 +43,35 @@ public:
     inline Distribution& operator = (const Distribution &other)
     {
         data_ = other.data_;
+        cache_.invalidate();
         return *this;
     }
 
     inline Distribution& operator = (Distribution &&other)
     {
         data_ = std::move(other.data_);
+        cache_.invalidate();
+        return *this;
+    }
+
+    inline void add(const point_t &p)
+    {
+        data_.add(p);
+        cache_.invalidate();
+    }
+
+    inline Distribution& operator += (const distribution_t &other)
+    {
+        data_ += other;
+        cache_.invalidate();
         return *this;
     }
 
+    inline Distribution& operator += (const Distribution &other)
+    {
+        return *this += other.data_;
+    }
+
     inline operator const distribution_t& () const
     {
         return data_;
@@ -73,22 +97,58 @@ public:
         return data_;
     }
 
+    /**
+     * @brief Direct access, changes made through it are not seen by the cache.
+     *        Use add and += to update the distribution.
+     */
     inline distribution_t& data()
     {
         return data_;
     }
 
-    inline void merge(const Distribution &)
+    /**
+     * @brief The cached information matrix, computed once per change.
+     */
+    inline const typename cache_t::matrix_t& getInformationMatrix() const
+    {
+        return cache_.get(data_).information;
+    }
+
+    /**
+     * @brief The cached normalizer, i.e. the density at the mean.
+     */
+    inline T getNormalizer() const
+    {
+        return cache_.get(data_).normalizer;
+    }
+
+    inline const typename cache_t::eigen_values_t& getEigenValues() const
+    {
+        return cache_.get(data_).eigen_values;
+    }
+
+    inline const typename cache_t::eigen_vectors_t& getEigenVectors() const
+    {
+        return cache_.get(data_).eigen_vectors;
+    }
+
+    /**
+     * @brief Combine the moments of both distributions, as if all samples had been
+     *        added to this one.
+     */
+    inline void merge(const Distribution &other)
     {
+        *this += other;
     }
 
     inline std::size_t byte_size() const
     {
-        return sizeof(*this);
+        return sizeof(*this) + cache_.byte_size();
     }
 
 private:
     distribution_t  data_;
+    cache_t         cache_;
 };
 }
 #endif // CSLIBS_NDT_COMMON_DISTRIBUTION_HPP
@@ -0,0 +1,132 @@
+#ifndef CSLIBS_NDT_COMMON_DISTRIBUTION_CACHE_HPP
+#define CSLIBS_NDT_COMMON_DISTRIBUTION_CACHE_HPP
+
+#include <atomic>
+#include <cmath>
+
+#include <cslibs_math/statistics/stable_distribution.hpp>
+
+#include <cslibs_ndt/utility/memory.hpp>
+
+namespace cslibs_ndt {
+/**
+ * @brief Values derived from a distribution which are needed for every point
+ *        while matching: the information matrix, the normalizer and the eigen
+ *        decomposition. They are computed lazily, once per change of the
+ *        distribution. Writers call invalidate() after each change.
+ *        All state lives in the entry, which is allocated on first use, thus a
+ *        distribution which is never matched only carries one pointer.
+ *        The first reader of a change computes the values under the spin lock of
+ *        the entry, all other readers only check its flag. Concurrent reads of an
+ *        unchanged map are thus safe, reads concurrent to writes are not.
+ */
+template<typename T, std::size_t Dim>
+class DistributionCache
+{
+public:
+    using distribution_t  = cslibs_math::statistics::StableDistribution<T,Dim,3>;
+    using matrix_t        = Eigen::Matrix<T,Dim,Dim>;
+    using eigen_values_t  = Eigen::Matrix<T,Dim,1>;
+    using eigen_vectors_t = Eigen::Matrix<T,Dim,Dim>;
+
+    struct EIGEN_ALIGN16 Entry
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        inline Entry() :
+            valid(false),
+            lock(false)
+        {
+        }
+
+        matrix_t          information;
+        T                 normalizer;
+        eigen_values_t    eigen_values;
+        eigen_vectors_t   eigen_vectors;
+        std::atomic<bool> valid;
+        std::atomic<bool> lock;
+    };
+
+    inline DistributionCache() :
+        entry_(nullptr)
+    {
+    }
+
+    /// copies compute their own values on first use
+    inline DistributionCache(const DistributionCache &) :
+        DistributionCache()
+    {
+    }
+
+    inline DistributionCache& operator = (const DistributionCache &)
+    {
+        invalidate();
+        return *this;
+    }
+
+    inline ~DistributionCache()
+    {
+        delete entry_.load(std::memory_order_relaxed);
+    }
+
+    inline void invalidate()
+    {
+        Entry *entry = entry_.load(std::memory_order_relaxed);
+        if (entry)
+            entry->valid.store(false, std::memory_order_relaxed);
+    }
+
+    inline const Entry& get(const distribution_t &d) const
+    {
+        Entry *entry = entry_.load(std::memory_order_acquire);
+        if (!entry)
+            entry = allocate(d);
+        if (!entry->valid.load(std::memory_order_acquire))
+            update(d, *entry);
+        return *entry;
+    }
+
+    inline std::size_t byte_size() const
+    {
+        return entry_.load(std::memory_order_relaxed) ? utility::heap_block_size(sizeof(Entry)) : 0ul;
+    }
+
+private:
+    mutable std::atomic<Entry*> entry_;
+
+    inline static void compute(const distribution_t &d, Entry &entry)
+    {
+        const matrix_t &covariance = d.getCovariance();
+        entry.information   = d.getInformationMatrix();
+        entry.normalizer    = 1.0 / std::sqrt(std::pow(2.0 * M_PI, static_cast<T>(Dim)) * covariance.determinant());
+        entry.eigen_values  = d.getEigenValues();
+        entry.eigen_vectors = d.getEigenVectors();
+    }
+
+    /// the entry is published with its values, a reader losing the race takes the other one
+    inline Entry* allocate(const distribution_t &d) const
+    {
+        Entry *entry = new Entry;
+        compute(d, *entry);
+        entry->valid.store(true, std::memory_order_relaxed);
+
+        Entry *expected = nullptr;
+        if (entry_.compare_exchange_strong(expected, entry, std::memory_order_acq_rel, std::memory_order_acquire))
+            return entry;
+        delete entry;
+        return expected;
+    }
+
+    inline static void update(const distribution_t &d, Entry &entry)
+    {
+        while (entry.lock.exchange(true, std::memory_order_acquire));
+        if (!entry.valid.load(std::memory_order_relaxed)) {
+            compute(d, entry);
+            entry.valid.store(true, std::memory_order_release);
+        }
+        entry.lock.store(false, std::memory_order_release);
+    }
+};
+}
+
+#endif // CSLIBS_NDT_COMMON_DISTRIBUTION_CACHE_HPP
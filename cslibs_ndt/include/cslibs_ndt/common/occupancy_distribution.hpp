@@ -9,6 +9,9 @@
 
 #include <cslibs_indexed_storage/storage.hpp>
 
+#include <cslibs_ndt/common/distribution_cache.hpp>
+#include <cslibs_ndt/utility/pool.hpp>
+
 namespace cslibs_ndt {
 template<typename T, std::size_t Dim>
 class EIGEN_ALIGN16 OccupancyDistribution
@@ -20,9 +23,10 @@ public:
     using Ptr                       = std::shared_ptr<OccupancyDistribution<T,Dim>>;
     using distribution_container_t  = OccupancyDistribution<T, Dim>;
     using distribution_t            = cslibs_math::statistics::StableDistribution<T,Dim,3>;
-    using distribution_ptr_t        = typename distribution_t::Ptr;
+    using distribution_ptr_t        = utility::PoolPtr<distribution_t>;
     using point_t                   = typename distribution_t::sample_t;
     using ivm_t                     = cslibs_gridmaps::utility::InverseModel<T>;
+    using cache_t                   = DistributionCache<T,Dim>;
 
     inline OccupancyDistribution() :
         num_free_(0)
@@ -37,8 +41,9 @@ public:
     inline OccupancyDistribution(const std::size_t    num_free,
                                  const distribution_t data) :
         num_free_(num_free),
-        distribution_(new distribution_t(data))
+        distribution_()
     {
+        distribution_.emplace(data);
     }
 
     inline OccupancyDistribution(const OccupancyDistribution &other) :
@@ -55,6 +60,25 @@ public:
         distribution_  = other.distribution_;
         occupancy_     = other.occupancy_;
         inverse_model_ = other.inverse_model_;
+        cache_.invalidate();
+        return *this;
+    }
+
+    inline OccupancyDistribution(OccupancyDistribution &&other) :
+        num_free_(other.num_free_),
+        distribution_(std::move(other.distribution_)),
+        occupancy_(other.occupancy_),
+        inverse_model_(other.inverse_model_)
+    {
+    }
+
+    inline OccupancyDistribution& operator = (OccupancyDistribution &&other)
+    {
+        num_free_      = other.num_free_;
+        distribution_  = std::move(other.distribution_);
+        occupancy_     = other.occupancy_;
+        inverse_model_ = other.inverse_model_;
+        cache_.invalidate();
         return *this;
     }
 
@@ -73,22 +97,27 @@ public:
     inline void updateOccupied(const point_t & p)
     {
         if (!distribution_)
-            distribution_.reset(new distribution_t());
+            distribution_.emplace();
 
         distribution_->add(p);
         inverse_model_ = nullptr;
+        cache_.invalidate();
     }
 
     inline void updateOccupied(const distribution_ptr_t &d)
     {
-        if (!d)
-            return;
+        if (d)
+            updateOccupied(*d);
+    }
 
+    inline void updateOccupied(const distribution_t &d)
+    {
         if (!distribution_)
-            distribution_.reset(new distribution_t());
+            distribution_.emplace();
 
-        *distribution_ += *d;
+        *distribution_ += d;
         inverse_model_ = nullptr;
+        cache_.invalidate();
     }
 
     inline std::size_t numFree() const
@@ -115,15 +144,23 @@ public:
             return occupancy_;
 
         inverse_model_ = &inverse_model;
-        occupancy_ = distribution_ ?
+        occupancy_ = computeOccupancy(inverse_model);
+        return occupancy_;
+    }
+
+    /**
+     * @brief Occupancy without touching the cache, safe for concurrent readers.
+     */
+    inline T computeOccupancy(const ivm_t &inverse_model) const
+    {
+        return distribution_ ?
                     cslibs_math::common::LogOdds<T>::from(
-                        static_cast<T>(num_free_) * inverse_model_->getLogOddsFree() +
-                        distribution_->getN() * inverse_model_->getLogOddsOccupied() -
-                        static_cast<T>(num_free_ + distribution_->getN()) * inverse_model_->getLogOddsPrior()) :
+                        static_cast<T>(num_free_) * inverse_model.getLogOddsFree() +
+                        distribution_->getN() * inverse_model.getLogOddsOccupied() -
+                        static_cast<T>(num_free_ + distribution_->getN()) * inverse_model.getLogOddsPrior()) :
                     cslibs_math::common::LogOdds<T>::from(
-                        static_cast<T>(num_free_) * inverse_model_->getLogOddsFree() -
-                        static_cast<T>(num_free_) * inverse_model_->getLogOddsPrior());
-        return occupancy_;
+                        static_cast<T>(num_free_) * inverse_model.getLogOddsFree() -
+                        static_cast<T>(num_free_) * inverse_model.getLogOddsPrior());
     }
 
     inline const distribution_ptr_t &getDistribution() const
@@ -131,18 +168,55 @@ public:
         return distribution_;
     }
 
+    /**
+     * @brief Direct access, changes made through it are not seen by the cache.
+     *        Use updateOccupied to update the distribution.
+     */
     inline distribution_ptr_t &getDistribution()
     {
         return distribution_;
     }
 
-    inline void merge(const OccupancyDistribution&)
+    /**
+     * @brief The cached information matrix, computed once per change.
+     *        Only available if getDistribution() is set.
+     */
+    inline const typename cache_t::matrix_t& getInformationMatrix() const
     {
+        return cache_.get(*distribution_).information;
+    }
+
+    /**
+     * @brief The cached normalizer, i.e. the density at the mean.
+     *        Only available if getDistribution() is set.
+     */
+    inline T getNormalizer() const
+    {
+        return cache_.get(*distribution_).normalizer;
+    }
+
+    inline const typename cache_t::eigen_values_t& getEigenValues() const
+    {
+        return cache_.get(*distribution_).eigen_values;
+    }
+
+    inline const typename cache_t::eigen_vectors_t& getEigenVectors() const
+    {
+        return cache_.get(*distribution_).eigen_vectors;
+    }
+
+    /**
+     * @brief Add the free and occupied observations of other.
+     */
+    inline void merge(const OccupancyDistribution &other)
+    {
+        updateFree(other.num_free_);
+        updateOccupied(other.distribution_);
     }
 
     inline std::size_t byte_size() const
     {
-        return distribution_ ? (sizeof(*this) + sizeof(distribution_t)) : sizeof(*this);
+        return (distribution_ ? (sizeof(*this) + sizeof(distribution_t)) : sizeof(*this)) + cache_.byte_size();
     }
 
 private:
@@ -151,6 +225,8 @@ private:
 
     mutable T            occupancy_     = 0;
     mutable const ivm_t* inverse_model_ = nullptr; // may point to invalid memory!
+
+    cache_t              cache_;
 };
 }
 
@@ -9,6 +9,8 @@
 
 #include <cslibs_indexed_storage/storage.hpp>
 
+#include <cslibs_ndt/utility/pool.hpp>
+
 namespace cslibs_ndt {
 template<typename T, std::size_t Dim>
 class EIGEN_ALIGN16 WeightedOccupancyDistribution
@@ -20,7 +22,7 @@ public:
     using Ptr                       = std::shared_ptr<WeightedOccupancyDistribution<T,Dim>>;
     using distribution_container_t  = WeightedOccupancyDistribution<T,Dim>;
     using distribution_t            = cslibs_math::statistics::StableWeightedDistribution<T,Dim,3>;
-    using distribution_ptr_t        = typename distribution_t::Ptr;
+    using distribution_ptr_t        = utility::PoolPtr<distribution_t>;
     using point_t                   = typename distribution_t::sample_t;
     using ivm_t                     = cslibs_gridmaps::utility::InverseModel<T>;
 
@@ -42,8 +44,9 @@ public:
                                          const distribution_t data) :
         num_free_(num_free),
         weight_free_(weight_free),
-        distribution_(new distribution_t(data))
+        distribution_()
     {
+        distribution_.emplace(data);
     }
 
     inline WeightedOccupancyDistribution(const WeightedOccupancyDistribution &other) :
@@ -65,6 +68,25 @@ public:
         return *this;
     }
 
+    inline WeightedOccupancyDistribution(WeightedOccupancyDistribution &&other) :
+        num_free_(other.num_free_),
+        weight_free_(other.weight_free_),
+        distribution_(std::move(other.distribution_)),
+        occupancy_(other.occupancy_),
+        inverse_model_(other.inverse_model_)
+    {
+    }
+
+    inline WeightedOccupancyDistribution& operator = (WeightedOccupancyDistribution &&other)
+    {
+        num_free_      = other.num_free_;
+        weight_free_   = other.weight_free_;
+        distribution_  = std::move(other.distribution_);
+        occupancy_     = other.occupancy_;
+        inverse_model_ = other.inverse_model_;
+        return *this;
+    }
+
     inline void updateFree(const std::size_t& num_free = 1, const T& weight_free = 1.0)
     {
         num_free_     += num_free;
@@ -75,7 +97,7 @@ public:
     inline void updateOccupied(const point_t& p, const T& w = 1.0)
     {
         if (!distribution_)
-            distribution_.reset(new distribution_t());
+            distribution_.emplace();
 
         distribution_->add(p, w);
         inverse_model_ = nullptr;
@@ -87,7 +109,7 @@ public:
             return;
 
         if (!distribution_)
-            distribution_.reset(new distribution_t());
+            distribution_.emplace();
 
         *distribution_ += *d;
         inverse_model_ = nullptr;
@@ -143,8 +165,13 @@ public:
         return distribution_;
     }
 
-    inline void merge(const WeightedOccupancyDistribution&)
+    /**
+     * @brief Add the free and occupied observations of other.
+     */
+    inline void merge(const WeightedOccupancyDistribution &other)
     {
+        updateFree(other.num_free_, other.weight_free_);
+        updateOccupied(other.distribution_);
     }
 
     inline std::size_t byte_size() const
@@ -16,7 +16,7 @@ template <typename T, std::size_t Dim>
 struct convert<Distribution,T,Dim> {
     static inline void from(const Distribution<T,Dim>* const& f, Distribution<T,Dim>* const& t)
     {
-        t->data() = f->data();
+        *t = *f;
     }
 };
 
@@ -64,7 +64,7 @@ struct convert<map::tags::dynamic_map,option_from_t,Dim,data_t,T,backend_to_t,dy
         static constexpr std::size_t bin_count  = utility::two_pow(Dim);
         using index_t = typename src_map_t::index_t;
         using bundle_t = cslibs_ndt::Bundle<data_t<T,Dim>*, bin_count>;
-        src->traverse([&dst](const index_t &bi, const bundle_t &b) {
+        src->traverseOrdered([&dst](const index_t &bi, const bundle_t &b) {
             if (const bundle_t* b_dst = dst->getDistributionBundle(bi)) {
                 for (std::size_t i = 0 ; i < bin_count ; ++i)
                     impl::convert<data_t,T,Dim>::from(b.at(i), b_dst->at(i));
@@ -108,7 +108,7 @@ struct convert<map::tags::static_map,option_from_t,Dim,data_t,T,backend_to_t,dyn
 
         static constexpr std::size_t bin_count  = utility::two_pow(Dim);
         using bundle_t = cslibs_ndt::Bundle<data_t<T,Dim>*, bin_count>;
-        src->traverse([&dst](const index_t &bi, const bundle_t &b) {
+        src->traverseOrdered([&dst](const index_t &bi, const bundle_t &b) {
             if (const bundle_t* b_dst = dst->getDistributionBundle(bi)) {
                 for (std::size_t i = 0 ; i < bin_count ; ++i)
                     impl::convert<data_t,T,Dim>::from(b.at(i), b_dst->at(i));
@@ -0,0 +1,347 @@
+#ifndef CSLIBS_NDT_CONVERSION_MERGE_HPP
+#define CSLIBS_NDT_CONVERSION_MERGE_HPP
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/common/distribution.hpp>
+#include <cslibs_ndt/common/occupancy_distribution.hpp>
+#include <cslibs_ndt/utility/parallel.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace conversion {
+
+namespace impl {
+/**
+ * @brief Build a distribution with the moments of d moved by a rigid transform. The
+ *        first rank + 1 samples deviate from the mean along the eigenvectors of the
+ *        scatter, weighted by Helmert vectors which are orthonormal and sum to zero,
+ *        all other samples lie on the mean. Sample count, mean and scatter are kept.
+ */
+template <typename distribution_t, typename point_t, typename transform_t>
+inline distribution_t transformed(const distribution_t &d,
+                                  const transform_t    &t)
+{
+    using vector_t     = typename point_t::type_t;
+    using scalar_t     = typename vector_t::Scalar;
+    using covariance_t = typename distribution_t::covariance_t;
+    static constexpr std::size_t Dim = point_t::Dimension;
+
+    distribution_t result;
+    const std::size_t n = d.getN();
+    if (n == 0)
+        return result;
+
+    const vector_t     mean    = d.getMean();
+    const covariance_t scatter = n > 1 ? covariance_t(d.getCovariance() * static_cast<scalar_t>(n - 1)) :
+                                         covariance_t(covariance_t::Zero());
+    const Eigen::SelfAdjointEigenSolver<covariance_t> solver(scatter);
+
+    const std::size_t rank = n - 1 < Dim ? n - 1 : Dim;
+    std::array<vector_t, Dim + 1> deviations;
+    for (vector_t &v : deviations)
+        v.setZero();
+    for (std::size_t i = 1 ; i <= rank ; ++i) {
+        /// largest eigenvalues first, the scatter of n samples has rank n - 1 at most
+        const std::size_t k      = Dim - i;
+        const scalar_t    lambda = std::max(solver.eigenvalues()(k), static_cast<scalar_t>(0));
+        const vector_t    v      = solver.eigenvectors().col(k) * std::sqrt(lambda);
+        const scalar_t    h      = 1 / std::sqrt(static_cast<scalar_t>(i * (i + 1)));
+        for (std::size_t j = 0 ; j < i ; ++j)
+            deviations[j] += v * h;
+        deviations[i] -= v * (static_cast<scalar_t>(i) * h);
+    }
+
+    point_t p;
+    for (std::size_t j = 0 ; j <= rank ; ++j) {
+        p.data() = mean + deviations[j];
+        result.add(t * p);
+    }
+
+    /// the remaining samples on the mean are added by doubling
+    p.data() = mean;
+    distribution_t block;
+    block.add(t * p);
+    for (std::size_t m = n - rank - 1 ; m > 0 ; m >>= 1) {
+        if (m & 1ul)
+            result += block;
+        if (m > 1) {
+            const distribution_t copy = block;
+            block += copy;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Resampling of distributions into a map with a different origin. The free
+ *        part of a cell goes to the cell of its center, the occupied part to the cell
+ *        of its mean.
+ */
+template <template <typename,std::size_t> class data_t, typename T, std::size_t Dim>
+struct resample {
+    static inline bool available()
+    {
+        return false;
+    }
+
+    static inline bool hasFree(const data_t<T,Dim> &)
+    {
+        return false;
+    }
+
+    template <typename point_t>
+    static inline bool hasOccupied(const data_t<T,Dim> &, point_t &)
+    {
+        return false;
+    }
+
+    static inline void free(data_t<T,Dim> &, const data_t<T,Dim> &)
+    {
+    }
+
+    template <typename point_t, typename transform_t>
+    static inline void occupied(data_t<T,Dim> &, const data_t<T,Dim> &, const transform_t &)
+    {
+    }
+};
+
+template <typename T, std::size_t Dim>
+struct resample<Distribution,T,Dim> {
+    static inline bool available()
+    {
+        return true;
+    }
+
+    static inline bool hasFree(const Distribution<T,Dim> &)
+    {
+        return false;
+    }
+
+    template <typename point_t>
+    static inline bool hasOccupied(const Distribution<T,Dim> &d, point_t &mean)
+    {
+        if (d.data().getN() == 0)
+            return false;
+        mean.data() = d.data().getMean();
+        return true;
+    }
+
+    static inline void free(Distribution<T,Dim> &, const Distribution<T,Dim> &)
+    {
+    }
+
+    template <typename point_t, typename transform_t>
+    static inline void occupied(Distribution<T,Dim> &dst, const Distribution<T,Dim> &src, const transform_t &t)
+    {
+        dst += transformed<typename Distribution<T,Dim>::distribution_t,point_t>(src.data(), t);
+    }
+};
+
+template <typename T, std::size_t Dim>
+struct resample<OccupancyDistribution,T,Dim> {
+    static inline bool available()
+    {
+        return true;
+    }
+
+    static inline bool hasFree(const OccupancyDistribution<T,Dim> &d)
+    {
+        return d.numFree() > 0;
+    }
+
+    template <typename point_t>
+    static inline bool hasOccupied(const OccupancyDistribution<T,Dim> &d, point_t &mean)
+    {
+        if (!d.getDistribution() || d.getDistribution()->getN() == 0)
+            return false;
+        mean.data() = d.getDistribution()->getMean();
+        return true;
+    }
+
+    static inline void free(OccupancyDistribution<T,Dim> &dst, const OccupancyDistribution<T,Dim> &src)
+    {
+        dst.updateFree(src.numFree());
+    }
+
+    template <typename point_t, typename transform_t>
+    static inline void occupied(OccupancyDistribution<T,Dim> &dst, const OccupancyDistribution<T,Dim> &src, const transform_t &t)
+    {
+        dst.updateOccupied(transformed<typename OccupancyDistribution<T,Dim>::distribution_t,point_t>(*src.getDistribution(), t));
+    }
+};
+}
+
+/**
+ * @brief Merge src into dst, as if everything inserted into src had been inserted
+ *        into dst as well. Both maps need the same resolution. For equal origins the
+ *        distributions are merged as they are. Otherwise every distribution is moved
+ *        into dst keeping sample count, mean and scatter. If the origins differ by
+ *        whole bundles, it goes to the cell covering the same area, else to the cell
+ *        containing its moved mean and free observations to the cell containing the
+ *        moved cell center. Contributions outside of a static dst are dropped.
+ *        Bundles of dst are allocated in the calling thread, the distributions are
+ *        then merged in parallel with one thread per tile of dst at a time.
+ *        Evicted tiles of src are not merged, see AbstractMap::restoreEvictedTiles.
+ *        A memory budget of dst is enforced with the next insertion.
+ * @param dst           the map to merge into
+ * @param src           the map to merge
+ * @param num_threads   maximum number of threads to use
+ * @param tile_size     edge length of a tile in bundles
+ */
+template <map::tags::option option_dst_t,
+          map::tags::option option_src_t,
+          std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T,
+          template <typename, typename, typename...> class backend_dst_t,
+          template <typename, typename, typename...> class dynamic_backend_dst_t,
+          template <typename, typename, typename...> class backend_src_t,
+          template <typename, typename, typename...> class dynamic_backend_src_t>
+inline void merge(map::Map<option_dst_t,Dim,data_t,T,backend_dst_t,dynamic_backend_dst_t> &dst,
+                  const map::Map<option_src_t,Dim,data_t,T,backend_src_t,dynamic_backend_src_t> &src,
+                  const std::size_t num_threads = utility::hardware_threads(),
+                  const std::size_t tile_size = 8)
+{
+    using dst_map_t      = map::Map<option_dst_t,Dim,data_t,T,backend_dst_t,dynamic_backend_dst_t>;
+    using src_map_t      = map::Map<option_src_t,Dim,data_t,T,backend_src_t,dynamic_backend_src_t>;
+    using index_t        = typename dst_map_t::index_t;
+    using point_t        = typename dst_map_t::point_t;
+    using pose_t         = typename dst_map_t::pose_t;
+    using distribution_t = typename dst_map_t::distribution_t;
+    using resample_t     = impl::resample<data_t,T,Dim>;
+
+    if (std::abs(dst.getResolution() - src.getResolution()) > 1e-6 * dst.getResolution())
+        throw std::runtime_error("cannot merge maps of different resolutions!");
+
+    if (static_cast<const void*>(&dst) == static_cast<const void*>(&src)) {
+        const src_map_t copy(src);
+        merge(dst, copy, num_threads, tile_size);
+        return;
+    }
+
+    /// src map coordinates to dst map coordinates
+    const pose_t  dst_T_src = dst.getInitialOrigin().inverse() * src.getInitialOrigin();
+    const T       bundle_resolution = dst.getBundleResolution();
+
+    /// the cells line up if the origins differ by whole bundles
+    const point_t offset = dst_T_src * point_t();
+    bool    aligned = true;
+    index_t shift;
+    for (std::size_t i = 0 ; i < Dim ; ++i) {
+        point_t unit;
+        unit(i) = 1.0;
+        const point_t moved = dst_T_src * unit;
+        for (std::size_t j = 0 ; j < Dim ; ++j)
+            aligned &= std::abs(moved(j) - offset(j) - unit(j)) < 1e-9;
+
+        const T bundles = offset(i) / bundle_resolution;
+        shift[i] = static_cast<int>(std::round(bundles));
+        aligned &= std::abs(bundles - static_cast<T>(shift[i])) < 1e-6;
+    }
+    /// distributions are kept in map coordinates, they are only merged as they are for equal origins
+    const bool identical = aligned && std::all_of(shift.begin(), shift.end(), [](const int s) { return s == 0; });
+    if (!identical && !resample_t::available())
+        throw std::runtime_error("cannot resample the distributions of this map type!");
+
+    enum class Part { ALL, FREE, OCCUPIED };
+    struct Item {
+        index_t               tile;
+        distribution_t       *dst;
+        const distribution_t *src;
+        Part                  part;
+    };
+
+    /// the smallest bundle covered by the distribution of a layer containing p
+    auto locate = [bundle_resolution](const std::size_t layer, const point_t &p) {
+        index_t bi;
+        for (std::size_t i = 0 ; i < Dim ; ++i) {
+            const int b = static_cast<int>(std::floor(p(i) / bundle_resolution));
+            bi[i] = b - cslibs_math::common::mod(b + static_cast<int>((layer >> i) & 1ul), 2);
+        }
+        return bi;
+    };
+
+    /// allocate the bundles of dst, one per distribution, which fixes the tile
+    std::vector<Item> items;
+    auto add = [&dst, &items, tile_size](const index_t &bi, const std::size_t layer,
+                                         const distribution_t &d, const Part part) {
+        typename dst_map_t::distribution_bundle_t *bundle = dst.getDistributionBundle(bi);
+        if (!bundle)
+            return;
+
+        Item item;
+        for (std::size_t i = 0 ; i < Dim ; ++i)
+            item.tile[i] = cslibs_math::common::div(bi[i], static_cast<int>(tile_size));
+        item.dst  = bundle->at(layer);
+        item.src  = &d;
+        item.part = part;
+        items.emplace_back(item);
+    };
+
+    src.traverseDistributions([&](const std::size_t layer, const index_t &index, const distribution_t &d) {
+        const index_t bi = src_map_t::getBundleIndex(layer, index);
+        if (aligned) {
+            /// an odd shift moves the distribution to another layer
+            index_t     dst_bi;
+            std::size_t dst_layer = 0;
+            for (std::size_t i = 0 ; i < Dim ; ++i) {
+                dst_bi[i] = bi[i] + shift[i];
+                dst_layer |= static_cast<std::size_t>(cslibs_math::common::mod(dst_bi[i], 2)) << i;
+            }
+            point_t mean;
+            if (identical)
+                add(dst_bi, dst_layer, d, Part::ALL);
+            if (!identical && resample_t::hasFree(d))
+                add(dst_bi, dst_layer, d, Part::FREE);
+            if (!identical && resample_t::hasOccupied(d, mean))
+                add(dst_bi, dst_layer, d, Part::OCCUPIED);
+            return;
+        }
+
+        if (resample_t::hasFree(d)) {
+            point_t center;
+            for (std::size_t i = 0 ; i < Dim ; ++i)
+                center(i) = static_cast<T>(bi[i] + 1) * bundle_resolution;
+            add(locate(layer, dst_T_src * center), layer, d, Part::FREE);
+        }
+        point_t mean;
+        if (resample_t::hasOccupied(d, mean))
+            add(locate(layer, dst_T_src * mean), layer, d, Part::OCCUPIED);
+    });
+
+    /// every distribution of dst lies in exactly one tile, tiles are merged in parallel
+    std::stable_sort(items.begin(), items.end(), [](const Item &a, const Item &b) {
+        return a.tile < b.tile;
+    });
+    std::vector<std::size_t> tiles;
+    for (std::size_t i = 0 ; i < items.size() ; ++i)
+        if (i == 0 || items[i].tile != items[i - 1].tile)
+            tiles.emplace_back(i);
+    tiles.emplace_back(items.size());
+
+    utility::parallel_for(tiles.size() - 1, num_threads, [&items, &tiles, &dst_T_src](const std::size_t t) {
+        for (std::size_t i = tiles[t] ; i < tiles[t + 1] ; ++i) {
+            const Item &item = items[i];
+            switch (item.part) {
+            case Part::ALL:
+                item.dst->merge(*item.src);
+                break;
+            case Part::FREE:
+                resample_t::free(*item.dst, *item.src);
+                break;
+            case Part::OCCUPIED:
+                resample_t::template occupied<point_t>(*item.dst, *item.src, dst_T_src);
+                break;
+            }
+        }
+    });
+}
+
+}
+}
+
+#endif // CSLIBS_NDT_CONVERSION_MERGE_HPP
@@ -1,14 +1,22 @@
 #ifndef CSLIBS_NDT_MAP_ABSTRACT_MAP_HPP
 #define CSLIBS_NDT_MAP_ABSTRACT_MAP_HPP
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <cmath>
+#include <iterator>
 #include <memory>
+#include <iostream>
+#include <string>
 
 #include <cslibs_ndt/map/traits.hpp>
+#include <cslibs_ndt/map/memory_statistics.hpp>
+#include <cslibs_ndt/backend/traits.hpp>
 #include <cslibs_ndt/common/bundle.hpp>
 #include <cslibs_ndt/utility/utility.hpp>
+#include <cslibs_ndt/utility/tile_cache.hpp>
+#include <cslibs_ndt/utility/memory.hpp>
 
 #include <cslibs_math/common/array.hpp>
 
@@ -19,6 +27,107 @@ namespace cis = cslibs_indexed_storage;
 
 namespace cslibs_ndt {
 namespace map {
+namespace detail {
+/// bundle index bounds of static and dynamic maps, resolved at compile time
+template <tags::option option_t>
+struct bounds;
+
+template <>
+struct bounds<tags::static_map>
+{
+    template <typename bound_t, typename index_t>
+    static inline bool valid(const bound_t &min, const bound_t &max, const index_t &index)
+    {
+        for (std::size_t i=0; i<std::tuple_size<index_t>::value; ++i)
+            if (index[i] < min[i] || index[i] > max[i])
+                return false;
+        return true;
+    }
+
+    template <typename bound_t, typename index_t>
+    static inline void update(bound_t &, bound_t &, const index_t &)
+    {
+    }
+};
+
+template <>
+struct bounds<tags::dynamic_map>
+{
+    template <typename bound_t, typename index_t>
+    static inline bool valid(const bound_t &, const bound_t &, const index_t &)
+    {
+        return true;
+    }
+
+    template <typename bound_t, typename index_t>
+    static inline void update(bound_t &min, bound_t &max, const index_t &index)
+    {
+        min.min(index);
+        max.max(index);
+    }
+};
+
+/// whether a distribution holds enough data to allocate its neighbourhood,
+/// specialized next to the map implementation of each distribution type
+template <template <typename,std::size_t> class data_t>
+struct expand;
+
+/// whether a distribution holds any data, specialized like expand
+template <template <typename,std::size_t> class data_t>
+struct populated;
+
+/// binds the layers of a bundle, by pointer or by slot if the backend has slots
+template <bool slotted>
+struct bundle_layers;
+
+template <>
+struct bundle_layers<false>
+{
+    template <typename bundle_t, typename layers_t>
+    static inline bundle_t create(const layers_t *)
+    {
+        return bundle_t();
+    }
+
+    template <typename distribution_t, typename bundle_t, typename storage_t, typename index_t>
+    static inline void bind(bundle_t &b,
+                            const std::size_t layer,
+                            storage_t &storage,
+                            const index_t &index,
+                            const bool allocate)
+    {
+        distribution_t *d = storage.get(index);
+        b[layer] = (d || !allocate) ? d : &(storage.insert(index, distribution_t()));
+    }
+};
+
+template <>
+struct bundle_layers<true>
+{
+    template <typename bundle_t, typename layers_t>
+    static inline bundle_t create(const layers_t *layers)
+    {
+        return bundle_t(layers);
+    }
+
+    template <typename distribution_t, typename bundle_t, typename storage_t, typename index_t>
+    static inline void bind(bundle_t &b,
+                            const std::size_t layer,
+                            storage_t &storage,
+                            const index_t &index,
+                            const bool allocate)
+    {
+        static_assert(storage_t::no_slot == bundle_t::no_slot, "bundle_layers: bundle and backend disagree on no_slot.");
+        std::uint32_t slot = storage.slot(index);
+        if (slot == storage_t::no_slot && allocate) {
+            storage.insert(index, distribution_t());
+            slot = storage.slot(index);
+        }
+        b.setSlot(layer, slot);
+    }
+};
+}
+
 template <tags::option option_t,
           std::size_t Dim,
           template <typename,std::size_t> class data_t,
@@ -44,18 +153,33 @@ public:
     static constexpr std::size_t bin_count  = utility::two_pow(Dim);
     static constexpr T div_count = 1.0 / static_cast<T>(bin_count);
 
+    /// concurrent backends allow several threads to insert at once
+    static constexpr bool concurrent = backend::is_concurrent<backend_t>::value;
+    /// bundles of slot backends hold 32-bit slots instead of pointers
+    static constexpr bool slotted    = backend::has_slots<backend_t>::value;
+
     using index_list_t                      = std::array<index_t, bin_count>;
     using distribution_t                    = data_t<T,Dim>;
     using distribution_storage_t            = cis::Storage<distribution_t, index_t, backend_t>;
     using distribution_storage_ptr_t        = std::shared_ptr<distribution_storage_t>;
     using distribution_storage_array_t      = std::array<distribution_storage_ptr_t, bin_count>;
-    using distribution_bundle_t             = cslibs_ndt::Bundle<distribution_t*, bin_count>;
+    using distribution_layers_t             = std::array<distribution_storage_t*, bin_count>;
+    using distribution_bundle_t             = typename std::conditional<slotted,
+                                                  cslibs_ndt::SlotBundle<distribution_t, distribution_storage_t, bin_count>,
+                                                  cslibs_ndt::Bundle<distribution_t*, bin_count>>::type;
     using distribution_const_bundle_t       = cslibs_ndt::Bundle<const distribution_t*, bin_count>;
+    using distribution_const_list_t         = std::array<const distribution_t*, bin_count>;
     using distribution_bundle_storage_t     = cis::Storage<distribution_bundle_t, index_t, backend_t>;
     using distribution_bundle_storage_ptr_t = std::shared_ptr<distribution_bundle_storage_t>;
     using dynamic_distribution_storage_t    = cis::Storage<distribution_t, index_t, dynamic_backend_t>;
 
-    using neighborhood_t = cis::operations::clustering::GridNeighborhoodStatic<std::tuple_size<index_t>::value, 3>;
+    using bundle_gaussians_t                = utility::BundleGaussians<T, Dim, bin_count>;
+    using ordered_bundle_t                  = std::pair<index_t, distribution_bundle_t*>;
+
+    using neighborhood_t  = cis::operations::clustering::GridNeighborhoodStatic<std::tuple_size<index_t>::value, 3>;
+    using lock_stripes_t  = typename std::conditional<concurrent, utility::LockStripes<>, utility::NoLockStripes>::type;
+    using dirty_bundles_t = utility::DirtyBundles<Dim, concurrent>;
+    using tile_cache_t    = utility::TileCache<Dim, distribution_t, bin_count>;
 
     template <std::size_t DD>
     using vector_t = cslibs_math::linear::Vector<T,DD>;
@@ -72,7 +196,8 @@ public:
         min_bundle_index_(min_bundle_index),
         max_bundle_index_(max_bundle_index),
         storage_(utility::create<distribution_storage_t,bin_count>()),
-        bundle_storage_(new distribution_bundle_storage_t)
+        bundle_storage_(new distribution_bundle_storage_t),
+        layers_(createLayers(storage_))
     {
     }
 
@@ -90,8 +215,12 @@ public:
         min_bundle_index_(min_bundle_index),
         max_bundle_index_(max_bundle_index),
         storage_(storage),
-        bundle_storage_(bundles)
+        bundle_storage_(bundles),
+        layers_(createLayers(storage_))
     {
+        bundle_storage_->traverse([this](const index_t &bi, distribution_bundle_t &b) {
+            b = bindBundle(bi, false);
+        });
     }
 
     inline AbstractMap(const AbstractMap &other) :
@@ -103,8 +232,20 @@ public:
         min_bundle_index_(other.min_bundle_index_),
         max_bundle_index_(other.max_bundle_index_),
         storage_(utility::create<distribution_storage_t,bin_count>(other.storage_)),
-        bundle_storage_(new distribution_bundle_storage_t(*other.bundle_storage_))
+        bundle_storage_(new distribution_bundle_storage_t(*other.bundle_storage_)),
+        layers_(createLayers(storage_)),
+        changes_(other.changes_),
+        dirty_(other.dirty_),
+        tiles_(other.tiles_)
     {
+        /// the copied bundles still point into the storages of other
+        bundle_storage_->traverse([this](const index_t &bi, distribution_bundle_t &b) {
+            b = bindBundle(bi, false);
+        });
+        /// the copy holds everything, the evicted tiles of other included
+        other.tiles_.copyEvicted(storage_, [this](const index_t &bi) {
+            createBundle(bi);
+        });
     }
 
     inline AbstractMap(AbstractMap &&other) :
@@ -116,7 +257,11 @@ public:
         min_bundle_index_(other.min_bundle_index_),
         max_bundle_index_(other.max_bundle_index_),
         storage_(other.storage_),
-        bundle_storage_(other.bundle_storage_)
+        bundle_storage_(other.bundle_storage_),
+        layers_(other.layers_),
+        changes_(other.changes_),
+        dirty_(other.dirty_),
+        tiles_(std::move(other.tiles_))
     {
     }
 
@@ -174,6 +319,17 @@ public:
         return max_bundle_index_;
     }
 
+    /**
+     * @brief Get a stable id of a bundle, derived from its index. Ids are unique as long
+     *        as the index is within +-2^30 per component in 2D and +-2^20 in 3D.
+     * @param bi            the bundle index
+     * @return the id
+     */
+    static inline std::uint64_t getBundleId(const index_t &bi)
+    {
+        return utility::Morton<Dim>::encode(bi);
+    }
+
     inline T getBundleResolution() const
     {
         return bundle_resolution_;
@@ -200,17 +356,171 @@ public:
     inline const distribution_bundle_t* get(const point_t &p) const;
     inline const distribution_bundle_t* get(const index_t &bi) const;
 
+    /**
+     * @brief Look up the distributions of a bundle without allocating anything.
+     *        In contrast to getDistributionBundle, this does not modify the map
+     *        and can be called from several threads as long as nobody inserts.
+     * @param bi            the bundle index
+     * @param distributions the layer distributions, nullptr if not allocated
+     * @return false if the index is invalid or no layer distribution exists
+     */
+    inline bool getDistributions(const index_t &bi,
+                                 distribution_const_list_t &distributions) const
+    {
+        if (!valid(bi))
+            return false;
+
+        if (const distribution_bundle_t *bundle = bundle_storage_->get(bi)) {
+            for (std::size_t i=0; i<bin_count; ++i)
+                distributions[i] = bundle->at(i);
+            return true;
+        }
+
+        /// partially allocated bundle, the layers may still hold data
+        const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+        bool found = false;
+        for (std::size_t i=0; i<bin_count; ++i) {
+            distributions[i] = storage_[i]->get(indices[i]);
+            found |= distributions[i] != nullptr;
+        }
+        return found;
+    }
+
+    inline bool getDistributions(const point_t &p,
+                                 distribution_const_list_t &distributions) const
+    {
+        return getDistributions(toBundleIndex(p), distributions);
+    }
+
     inline distribution_storage_array_t const & getStorages() const
     {
         return storage_;
     }
 
+    /**
+     * @brief Visit every distribution exactly once, layer by layer. A bundle traversal
+     *        sees each distribution in up to 2^Dim bundles. Distributions of partially
+     *        allocated bundles are visited as well.
+     * @param function      called with the layer, the index within the layer and the distribution
+     */
+    template <typename Fn>
+    inline void traverseDistributions(const Fn& function) const
+    {
+        for (std::size_t layer=0; layer<bin_count; ++layer)
+            traverseLayer(layer, function);
+    }
+
+    /**
+     * @brief Visit every distribution exactly once, the layers are traversed concurrently.
+     * @param function      called with the layer, the index within the layer and the distribution
+     * @param num_threads   maximum number of threads to use, at most one per layer
+     */
+    template <typename Fn>
+    inline void traverseDistributionsParallel(const Fn& function,
+                                              const std::size_t num_threads = utility::hardware_threads()) const
+    {
+        utility::parallel_for(bin_count, num_threads, [this, &function](const std::size_t layer) {
+            traverseLayer(layer, function);
+        });
+    }
+
+    /**
+     * @brief Visit every distribution exactly once, the layers are traversed by
+     *        the threads of a pool which is kept over several traversals.
+     * @param function      called with the layer, the index within the layer and the distribution
+     * @param workers       the threads to use
+     */
+    template <typename Fn>
+    inline void traverseDistributionsParallel(const Fn& function,
+                                              utility::WorkerPool &workers) const
+    {
+        workers.parallel_for(bin_count, [this, &function](const std::size_t layer) {
+            traverseLayer(layer, function);
+        });
+    }
+
+    /**
+     * @brief Get the smallest bundle index covered by a distribution. The parity of
+     *        the result encodes the layer, the result is thus unique per distribution.
+     * @param layer         the layer
+     * @param index         the index within the layer
+     * @return the bundle index
+     */
+    static inline index_t getBundleIndex(const std::size_t layer,
+                                         const index_t &index)
+    {
+        index_t bi;
+        for (std::size_t i=0; i<Dim; ++i)
+            bi[i] = 2 * index[i] - static_cast<int>((layer >> i) & 1ul);
+        return bi;
+    }
+
+    /**
+     * @brief Get a stable id of a distribution, unique among all distributions and
+     *        within the same range as the bundle ids.
+     * @param layer         the layer
+     * @param index         the index within the layer
+     * @return the id
+     */
+    static inline std::uint64_t getDistributionId(const std::size_t layer,
+                                                  const index_t &index)
+    {
+        return getBundleId(getBundleIndex(layer, index));
+    }
+
     template <typename Fn>
     inline void traverse(const Fn& function) const
     {
         return bundle_storage_->traverse(function);
     }
 
+    /**
+     * @brief Visit the bundles in Morton (Z-) order, independent of the order of
+     *        the backend. Bundles which are close in space are visited close in time,
+     *        which keeps their neighbours and the written results in cache.
+     * @param function      called with the bundle index and the bundle
+     */
+    template <typename Fn>
+    inline void traverseOrdered(const Fn& function) const
+    {
+        std::vector<ordered_bundle_t> bundles;
+        getBundlesOrdered(bundles);
+        for (const ordered_bundle_t &b : bundles)
+            function(b.first, *b.second);
+    }
+
+    /**
+     * @brief Visit the bundles on several threads. The bundles are split into
+     *        contiguous ranges of the Morton order, every range thus covers a compact
+     *        region of the map. The function is called concurrently.
+     * @param function      called with the bundle index and the bundle
+     * @param num_threads   maximum number of threads to use
+     */
+    template <typename Fn>
+    inline void traverseParallel(const Fn& function,
+                                 const std::size_t num_threads = utility::hardware_threads()) const
+    {
+        std::vector<ordered_bundle_t> bundles;
+        getBundlesOrdered(bundles);
+
+        /// several ranges per thread balance bundles of different cost
+        const std::size_t ranges = std::min<std::size_t>(bundles.size(), 8 * std::max<std::size_t>(1, num_threads));
+        utility::parallel_for(ranges, num_threads, [&bundles, &function, ranges](const std::size_t r) {
+            const std::size_t end = (r + 1) * bundles.size() / ranges;
+            for (std::size_t i = r * bundles.size() / ranges ; i < end ; ++i)
+                function(bundles[i].first, *bundles[i].second);
+        });
+    }
+
+    /**
+     * @brief Get the index and address of every bundle in Morton order.
+     * @param bundles       the bundles
+     */
+    inline void getBundlesOrdered(std::vector<ordered_bundle_t> &bundles) const
+    {
+        utility::morton_entries<Dim>(*bundle_storage_, bundles);
+    }
+
     inline void getBundleIndices(std::vector<index_t> &indices) const
     {
         auto add_index = [&indices](const index_t &i, const distribution_bundle_t &) {
@@ -225,28 +535,88 @@ public:
         return valid(toBundleIndex(p_w));
     }
 
+    /**
+     * @brief Allocate the neighbourhood of every bundle holding enough data, such that
+     *        the distributions are covered by bundles everywhere. Only bundles which
+     *        share distributions with bundles allocated or modified since the last
+     *        call are expanded, the first call expands all bundles. With a memory
+     *        budget, evicted neighbours of modified bundles are faulted in.
+     */
     inline void allocatePartiallyAllocatedBundles() const
     {
-        std::vector<index_t> bis;
-        getBundleIndices(bis);
-
         static constexpr neighborhood_t grid{};
 
-        for (const index_t &bi : bis) {
-            const distribution_bundle_t *bundle = bundle_storage_->get(bi);
-            bool do_expand = expandBundle(bundle);
-            if (do_expand) {
-                grid.visit([this, &bi](typename neighborhood_t::offset_t o) {
+        std::vector<index_t> bis;
+        if (dirty_.take(bis)) {
+            /// a modified bundle changes the distributions of its direct neighbours
+            std::vector<index_t> dirty;
+            dirty.swap(bis);
+            for (const index_t &bi : dirty) {
+                grid.visit([this, &bi, &bis](typename neighborhood_t::offset_t o) {
                     index_t ii;
                     for (std::size_t i=0; i<Dim; ++i)
                         ii[i] = bi[i] + o[i];
-                    if (valid(ii))
-                        getAllocate(ii);
+                    touch(ii);
+                    if (bundle_storage_->get(ii))
+                        bis.emplace_back(ii);
                 });
             }
+            utility::morton_sort<Dim>(bis, [](const index_t &bi) -> const index_t& { return bi; });
+            bis.erase(std::unique(bis.begin(), bis.end()), bis.end());
+        } else {
+            getBundleIndices(bis);
+            utility::morton_sort<Dim>(bis, [](const index_t &bi) -> const index_t& { return bi; });
         }
+        expand(bis, 1);
+        enforceMemoryBudget();
+    }
+
+    /**
+     * @brief Allocate the neighbourhood of every bundle holding enough data, regardless
+     *        of modifications. The neighbourhoods are searched on several threads,
+     *        the missing bundles are allocated by the calling thread. With a memory
+     *        budget, only the resident bundles are expanded.
+     * @param num_threads   maximum number of threads to use
+     */
+    inline void allocateAllPartiallyAllocatedBundles(const std::size_t num_threads = utility::hardware_threads()) const
+    {
+        std::vector<index_t> bis;
+        dirty_.reset();
+        getBundleIndices(bis);
+        utility::morton_sort<Dim>(bis, [](const index_t &bi) -> const index_t& { return bi; });
+        expand(bis, num_threads);
+        enforceMemoryBudget();
+    }
+
+    /**
+     * @brief Record which tiles of tile_size^Dim bundles are modified, which allows
+     *        to publish snapshots incrementally. A tile size of zero disables tracking.
+     * @param tile_size     edge length of a tile in bundles
+     */
+    inline void trackChanges(const std::size_t tile_size)
+    {
+        changes_.setTileSize(tile_size);
+    }
+
+    inline std::size_t getChangeTileSize() const
+    {
+        return changes_.getTileSize();
     }
 
+    /**
+     * @brief Get the tiles modified since the last call and reset the record.
+     * @param tiles         the tile indices
+     */
+    inline void takeChangedTiles(std::vector<index_t> &tiles)
+    {
+        changes_.take(tiles);
+    }
+
+    /**
+     * @brief Get a quick estimate of the memory used by the storages. Memory owned by
+     *        the distributions and allocator overhead are not included, see
+     *        getMemoryStatistics.
+     */
     inline std::size_t getByteSize() const
     {
         std::size_t size = sizeof(*this) + bundle_storage_->byte_size();
@@ -255,6 +625,132 @@ public:
         return size;
     }
 
+    /**
+     * @brief Get the memory per layer and of the bundles, including the memory owned
+     *        by the distributions and an estimate of the allocator overhead. Visits
+     *        every distribution, evicted tiles are not included.
+     * @return the statistics
+     */
+    inline MemoryStatistics getMemoryStatistics() const
+    {
+        MemoryStatistics statistics;
+        statistics.map_bytes = sizeof(*this);
+        statistics.layers.resize(bin_count);
+        for (std::size_t i=0; i<bin_count; ++i) {
+            StorageStatistics &s = statistics.layers[i];
+            storage_[i]->traverse([&s](const index_t &, const distribution_t &d) {
+                ++s.cells;
+                s.populated     += detail::populated<data_t>::distribution(&d) ? 1ul : 0ul;
+                s.payload_bytes += d.byte_size() - sizeof(distribution_t);
+            });
+            s.capacity       = storage_[i]->capacity();
+            s.storage_bytes  = storage_[i]->byte_size();
+            s.overhead_bytes = utility::allocation_overhead<backend_t,index_t,distribution_t>(*storage_[i]);
+        }
+
+        StorageStatistics &s = statistics.bundles;
+        bundle_storage_->traverse([&s](const index_t &, const distribution_bundle_t &b) {
+            ++s.cells;
+            for (std::size_t i=0; i<bin_count; ++i) {
+                if (detail::populated<data_t>::distribution(b.at(i))) {
+                    ++s.populated;
+                    break;
+                }
+            }
+        });
+        s.capacity       = bundle_storage_->capacity();
+        s.storage_bytes  = bundle_storage_->byte_size();
+        s.overhead_bytes = utility::allocation_overhead<backend_t,index_t,distribution_bundle_t>(*bundle_storage_);
+        return statistics;
+    }
+
+    /**
+     * @brief Bound the memory of the map. Tiles of tile_size^Dim bundles which were
+     *        not used recently are written to a spill file and faulted back in as soon
+     *        as getAllocate or get touch them again, e.g. by inserting. The budget is
+     *        enforced after insertions and expansions. Sampling, getDistributions and
+     *        the traversals only see the resident tiles, call restoreEvictedTiles
+     *        before. Distributions shared by two tiles always stay resident. Not
+     *        available for concurrent backends. Once a budget is set, get marks
+     *        tiles as used and faults them in, i.e. even const reads must not run
+     *        concurrently.
+     * @param bytes         the budget for the resident distributions and bundles,
+     *                      zero restores all tiles and removes the budget
+     * @param path          the spill file, it is truncated and removed with the map,
+     *                      a unique file in the temporary directory if empty
+     * @param tile_size     edge length of a tile in bundles
+     * @return false if the spill file cannot be opened or the backend is concurrent
+     */
+    inline bool setMemoryBudget(const std::size_t  bytes,
+                                const std::string &path = "",
+                                const std::size_t  tile_size = 16)
+    {
+        if (concurrent) {
+            std::cerr << "[AbstractMap]: memory budgets are not supported by concurrent backends" << std::endl;
+            return false;
+        }
+
+        restoreEvictedTiles();
+        tiles_.disable();
+        if (bytes == 0)
+            return true;
+
+        std::vector<index_t> bis;
+        getBundleIndices(bis);
+        if (!tiles_.enable(bytes, tile_size, path, bis))
+            return false;
+        enforceMemoryBudget();
+        return true;
+    }
+
+    inline std::size_t getMemoryBudget() const
+    {
+        return tiles_.getBudget();
+    }
+
+    /**
+     * @brief Get the bytes accounted for by the memory budget, i.e. the resident
+     *        distributions and bundles.
+     */
+    inline std::size_t getResidentByteSize() const
+    {
+        std::size_t size = bundle_storage_->size() * sizeof(distribution_bundle_t);
+        for (auto &storage : storage_)
+            size += storage->size() * sizeof(distribution_t);
+        return size;
+    }
+
+    inline std::size_t getEvictionCount() const
+    {
+        return tiles_.getEvictionCount();
+    }
+
+    inline std::size_t getFaultCount() const
+    {
+        return tiles_.getFaultCount();
+    }
+
+    inline std::size_t getEvictedTileCount() const
+    {
+        return tiles_.getEvictedTileCount();
+    }
+
+    inline std::size_t getSpillFileSize() const
+    {
+        return tiles_.getSpillFileSize();
+    }
+
+    /**
+     * @brief Fault in every evicted tile, the map may exceed its budget until the
+     *        next insertion.
+     */
+    inline void restoreEvictedTiles() const
+    {
+        tiles_.faultInAll(storage_, [this](const index_t &bi) {
+            createBundle(bi);
+        });
+    }
+
 protected:
     const T                                    resolution_;
     const T                                    bundle_resolution_;
@@ -262,45 +758,159 @@ protected:
     const transform_t                          w_T_m_;
     const transform_t                          m_T_w_;
 
-    mutable index_t                            min_bundle_index_;
-    mutable index_t                            max_bundle_index_;
+    mutable utility::AtomicIndex<Dim>          min_bundle_index_;
+    mutable utility::AtomicIndex<Dim>          max_bundle_index_;
     mutable distribution_storage_array_t       storage_;
     mutable distribution_bundle_storage_ptr_t  bundle_storage_;
+    std::shared_ptr<const distribution_layers_t> layers_;    /// resolves the slots of the bundles
+    lock_stripes_t                             locks_;
+    mutable utility::ChangeTracker<Dim>        changes_;
+    mutable dirty_bundles_t                    dirty_;
+    mutable tile_cache_t                       tiles_;
+
+    /**
+     * @brief Guard the update of a distribution, only locks if the backend is concurrent.
+     */
+    inline typename lock_stripes_t::lock_t lock(const distribution_t *d) const
+    {
+        return locks_.lock(d);
+    }
 
-    inline static distribution_t* getAllocate(const distribution_storage_ptr_t &s,
-                                              const index_t &i)
+    template <typename Fn>
+    inline void traverseLayer(const std::size_t layer,
+                              const Fn& function) const
     {
-        distribution_t *d = s->get(i);
-        return d ? d : &(s->insert(i, distribution_t()));
+        storage_[layer]->traverse([layer, &function](const index_t &index, distribution_t &d) {
+            function(layer, index, d);
+        });
     }
 
     inline distribution_bundle_t *getAllocate(const index_t &bi) const
     {
-        auto get_allocate = [this](const index_t &bi) {
-            distribution_bundle_t *bundle = bundle_storage_->get(bi);
+        dirty_.mark(bi);
+        return allocate(bi);
+    }
 
-            auto allocate_bundle = [this, &bi]() {
-                const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+    /**
+     * @brief Get or allocate a bundle without marking it as dirty, i.e. the caller
+     *        does not modify the distributions.
+     */
+    inline distribution_bundle_t *allocate(const index_t &bi) const
+    {
+        changes_.mark(bi);
+        touch(bi);
 
-                distribution_bundle_t b;
-                std::size_t id = 0;
-                for (const auto& index : indices) {
-                    b[id] = getAllocate(storage_[id], index);
-                    ++id;
-                }
-                updateIndices(bi);
-                return &(bundle_storage_->insert(bi, b));
-            };
-            return bundle ? bundle : allocate_bundle();
-        };
+        distribution_bundle_t *bundle = bundle_storage_->get(bi);
+        if (bundle)
+            return bundle;
+
+        tiles_.add(bi);
+        return createBundle(bi);
+    }
+
+    inline distribution_bundle_t *createBundle(const index_t &bi) const
+    {
+        const distribution_bundle_t b = bindBundle(bi, true);
+        updateIndices(bi);
+        return &(bundle_storage_->insert(bi, b));
+    }
+
+    /**
+     * @brief Bind a bundle to the layer distributions overlapping it.
+     * @param allocate      whether missing layer distributions are inserted
+     */
+    inline distribution_bundle_t bindBundle(const index_t &bi,
+                                            const bool allocate) const
+    {
+        using bundle_layers_t = detail::bundle_layers<slotted>;
+
+        const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+        distribution_bundle_t b = bundle_layers_t::template create<distribution_bundle_t>(layers_.get());
+        for (std::size_t i=0; i<bin_count; ++i)
+            bundle_layers_t::template bind<distribution_t>(b, i, *storage_[i], indices[i], allocate);
+        return b;
+    }
+
+    static inline std::shared_ptr<const distribution_layers_t> createLayers(const distribution_storage_array_t &storage)
+    {
+        std::shared_ptr<distribution_layers_t> layers(new distribution_layers_t);
+        for (std::size_t i=0; i<bin_count; ++i)
+            (*layers)[i] = storage[i].get();
+        return layers;
+    }
+
+    /**
+     * @brief Mark the tile of a bundle as used and fault it in if it was evicted.
+     */
+    inline void touch(const index_t &bi) const
+    {
+        tiles_.touch(bi, storage_, [this](const index_t &b) {
+            createBundle(b);
+        });
+    }
 
-        return get_allocate(bi);
+    /**
+     * @brief Evict tiles if the map exceeds its memory budget. Bundle pointers
+     *        obtained before may be invalidated, only call between operations.
+     */
+    inline void enforceMemoryBudget() const
+    {
+        tiles_.enforce(storage_, *bundle_storage_, [this]() {
+            return getResidentByteSize();
+        });
     }
 
-    virtual void updateIndices(const index_t &chunk_index) const = 0;
-    virtual bool valid(const index_t &index) const = 0;
+    inline void updateIndices(const index_t &chunk_index) const
+    {
+        detail::bounds<option_t>::update(min_bundle_index_, max_bundle_index_, chunk_index);
+    }
 
-    virtual bool expandDistribution(const distribution_t* d) const = 0;
+    inline bool valid(const index_t &index) const
+    {
+        return detail::bounds<option_t>::valid(min_bundle_index_, max_bundle_index_, index);
+    }
+
+    inline bool expandDistribution(const distribution_t* d) const
+    {
+        return detail::expand<data_t>::distribution(d);
+    }
+
+    /**
+     * @brief Allocate the missing neighbours of the expandable bundles among bis.
+     *        The existing bundles are only read while searching, which is done on
+     *        up to num_threads threads in ranges of the Morton order.
+     */
+    inline void expand(const std::vector<index_t> &bis,
+                       const std::size_t num_threads) const
+    {
+        static constexpr neighborhood_t grid{};
+
+        const std::size_t ranges = std::min<std::size_t>(bis.size(), 8 * std::max<std::size_t>(1, num_threads));
+        std::vector<std::vector<index_t>> missing(ranges);
+        utility::parallel_for(ranges, num_threads, [this, &bis, &missing, ranges](const std::size_t r) {
+            const std::size_t end = (r + 1) * bis.size() / ranges;
+            for (std::size_t b = r * bis.size() / ranges ; b < end ; ++b) {
+                const index_t &bi = bis[b];
+                if (!expandBundle(bundle_storage_->get(bi)))
+                    continue;
+                grid.visit([this, &bi, &missing, r](typename neighborhood_t::offset_t o) {
+                    index_t ii;
+                    for (std::size_t i=0; i<Dim; ++i)
+                        ii[i] = bi[i] + o[i];
+                    if (valid(ii) && !bundle_storage_->get(ii))
+                        missing[r].emplace_back(ii);
+                });
+            }
+        });
+
+        std::vector<index_t> allocate_bis;
+        for (const std::vector<index_t> &m : missing)
+            allocate_bis.insert(allocate_bis.end(), m.begin(), m.end());
+        utility::morton_sort<Dim>(allocate_bis, [](const index_t &bi) -> const index_t& { return bi; });
+        allocate_bis.erase(std::unique(allocate_bis.begin(), allocate_bis.end()), allocate_bis.end());
+        for (const index_t &bi : allocate_bis)
+            allocate(bi);
+    }
 
     inline bool expandBundle(const distribution_bundle_t *bundle) const
     {
@@ -343,6 +953,84 @@ protected:
         return valid(index);
     }
 
+    /**
+     * @brief Evaluate many points at once. The points are transformed and quantized
+     *        in one pass and grouped by bundle, every bundle is thus looked up and
+     *        packed only once and all its points are evaluated in one loop.
+     * @param points_begin  the first point in world coordinates
+     * @param points_end    the end of the points
+     * @param values        the value per point, zero outside of the map
+     * @param gather        packs the Gaussians of a bundle into a bundle_gaussians_t
+     */
+    template <typename iterator_t, typename gather_t>
+    inline void sampleBatch(const iterator_t &points_begin,
+                            const iterator_t &points_end,
+                            std::vector<T> &values,
+                            const gather_t &gather) const
+    {
+        const std::size_t n = static_cast<std::size_t>(std::distance(points_begin, points_end));
+        values.assign(n, T());
+
+        /// transform and quantize, points are grouped by sorting their Morton codes
+        using morton_t = utility::Morton<Dim>;
+        std::vector<T> coordinates(n * Dim);
+        std::vector<index_t> indices(n);
+        std::vector<std::pair<std::uint64_t, std::size_t>> keys(n);
+        bool representable = true;
+        std::size_t j = 0;
+        for (auto p = points_begin; p != points_end; ++p, ++j) {
+            const point_t pm = m_T_w_ * *p;
+            for (std::size_t d=0; d<Dim; ++d) {
+                coordinates[j * Dim + d] = pm(d);
+                indices[j][d] = static_cast<int>(std::floor(pm(d) * bundle_resolution_inv_));
+            }
+            representable &= morton_t::representable(indices[j]);
+            keys[j].first  = representable ? morton_t::encode(indices[j]) : 0;
+            keys[j].second = j;
+        }
+        if (representable) {
+            utility::radix_sort(keys);
+        } else {
+            std::sort(keys.begin(), keys.end(), [&indices](const std::pair<std::uint64_t, std::size_t> &a,
+                                                           const std::pair<std::uint64_t, std::size_t> &b) {
+                return indices[a.second] < indices[b.second];
+            });
+        }
+
+        /// evaluate bundle by bundle
+        bundle_gaussians_t gaussians;
+        std::vector<T> group_coordinates;
+        std::vector<T> group_values;
+        for (std::size_t begin = 0, end = 0; begin < n; begin = end) {
+            const index_t &bi = indices[keys[begin].second];
+            end = begin + 1;
+            while (end < n && indices[keys[end].second] == bi)
+                ++end;
+
+            if (!valid(bi))
+                continue;
+            const distribution_bundle_t *bundle = bundle_storage_->get(bi);
+            if (!bundle)
+                continue;
+
+            gaussians.clear();
+            gather(*bundle, gaussians);
+            if (gaussians.size() == 0)
+                continue;
+
+            const std::size_t m = end - begin;
+            group_coordinates.resize(m * Dim);
+            group_values.assign(m, T());
+            for (std::size_t k=0; k<m; ++k)
+                for (std::size_t d=0; d<Dim; ++d)
+                    group_coordinates[d * m + k] = coordinates[keys[begin + k].second * Dim + d];
+
+            gaussians.evaluate(m, group_coordinates.data(), group_values.data());
+            for (std::size_t k=0; k<m; ++k)
+                values[keys[begin + k].second] = group_values[k];
+        }
+    }
+
     template <std::size_t DD, typename std::size_t... counter>
     static inline point_t toPoint(vector_t<DD> p, utility::integer_sequence<std::size_t,counter...>)
     {
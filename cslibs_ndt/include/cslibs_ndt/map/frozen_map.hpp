@@ -0,0 +1,639 @@
+#ifndef CSLIBS_NDT_MAP_FROZEN_MAP_HPP
+#define CSLIBS_NDT_MAP_FROZEN_MAP_HPP
+
+#include <cslibs_ndt/map/map.hpp>
+
+#include <cslibs_math/common/log_odds.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+namespace cslibs_ndt {
+namespace map {
+namespace detail {
+/// access to the payload of the different distribution types while freezing
+template <template <typename,std::size_t> class data_t>
+struct frozen_data;
+
+template <>
+struct frozen_data<cslibs_ndt::Distribution>
+{
+    static constexpr bool occupancy = false;
+
+    template <typename T, std::size_t Dim>
+    static inline const typename Distribution<T,Dim>::distribution_t* get(const Distribution<T,Dim> &d)
+    {
+        return &d.data();
+    }
+
+    template <typename T, std::size_t Dim>
+    static inline std::size_t sampleCount(const Distribution<T,Dim> &d)
+    {
+        return d.data().getN();
+    }
+
+    template <typename T, std::size_t Dim>
+    static inline void occupancyTerms(const Distribution<T,Dim> &,
+                                      T &weight_free, T &weight_occupied, T &observations)
+    {
+        weight_free = weight_occupied = observations = T();
+    }
+};
+
+template <>
+struct frozen_data<cslibs_ndt::OccupancyDistribution>
+{
+    static constexpr bool occupancy = true;
+
+    template <typename T, std::size_t Dim>
+    static inline const typename OccupancyDistribution<T,Dim>::distribution_t* get(const OccupancyDistribution<T,Dim> &d)
+    {
+        return d.getDistribution().get();
+    }
+
+    template <typename T, std::size_t Dim>
+    static inline std::size_t sampleCount(const OccupancyDistribution<T,Dim> &d)
+    {
+        return d.getDistribution() ? d.getDistribution()->getN() : 0ul;
+    }
+
+    template <typename T, std::size_t Dim>
+    static inline void occupancyTerms(const OccupancyDistribution<T,Dim> &d,
+                                      T &weight_free, T &weight_occupied, T &observations)
+    {
+        weight_free     = static_cast<T>(d.numFree());
+        weight_occupied = static_cast<T>(sampleCount(d));
+        observations    = weight_free + weight_occupied;
+    }
+};
+
+template <>
+struct frozen_data<cslibs_ndt::WeightedOccupancyDistribution>
+{
+    static constexpr bool occupancy = true;
+
+    template <typename T, std::size_t Dim>
+    static inline const typename WeightedOccupancyDistribution<T,Dim>::distribution_t* get(const WeightedOccupancyDistribution<T,Dim> &d)
+    {
+        return d.getDistribution().get();
+    }
+
+    template <typename T, std::size_t Dim>
+    static inline std::size_t sampleCount(const WeightedOccupancyDistribution<T,Dim> &d)
+    {
+        return d.getDistribution() ? d.getDistribution()->getSampleCount() : 0ul;
+    }
+
+    template <typename T, std::size_t Dim>
+    static inline void occupancyTerms(const WeightedOccupancyDistribution<T,Dim> &d,
+                                      T &weight_free, T &weight_occupied, T &observations)
+    {
+        weight_free     = d.weightFree();
+        weight_occupied = d.weightOccupied();
+        observations    = static_cast<T>(d.numFree() + sampleCount(d));
+    }
+};
+}
+
+/**
+ * @brief Read-only snapshot of a map, meant for matching against a fixed prior map.
+ *        Means, information matrices and normalizers are precomputed and stored as
+ *        contiguous arrays, bundles are found through an open addressing hash table.
+ *        Queries never allocate and never modify anything, thus the map can be read
+ *        from many threads at once.
+ *        Bundles which were only partially allocated in the source map are complete
+ *        here, the same way AbstractMap::getDistributions sees them.
+ */
+template <std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T>
+class EIGEN_ALIGN16 FrozenMap
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    using allocator_t   = Eigen::aligned_allocator<FrozenMap<Dim,data_t,T>>;
+
+    using ConstPtr      = std::shared_ptr<const FrozenMap<Dim,data_t,T>>;
+    using Ptr           = std::shared_ptr<FrozenMap<Dim,data_t,T>>;
+
+    using pose_t        = typename traits<Dim,T>::pose_t;
+    using transform_t   = typename traits<Dim,T>::transform_t;
+    using point_t       = typename traits<Dim,T>::point_t;
+    using index_t       = std::array<int,Dim>;
+
+    static constexpr std::size_t bin_count  = utility::two_pow(Dim);
+    static constexpr T div_count = 1.0 / static_cast<T>(bin_count);
+
+    using entry_t                   = std::uint32_t;
+    using bundle_t                  = std::array<entry_t, bin_count>;
+    using mean_t                    = Eigen::Matrix<T,Dim,1>;
+    using matrix_t                  = Eigen::Matrix<T,Dim,Dim>;
+    using inverse_sensor_model_t    = cslibs_gridmaps::utility::InverseModel<T>;
+
+    /// marks an empty slot in a bundle or in the hash table
+    static constexpr entry_t no_entry = std::numeric_limits<entry_t>::max();
+
+    template <tags::option option_t,
+              template <typename, typename, typename...> class backend_t,
+              template <typename, typename, typename...> class dynamic_backend_t>
+    explicit inline FrozenMap(const Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t> &map) :
+        resolution_(map.getResolution()),
+        bundle_resolution_(map.getBundleResolution()),
+        bundle_resolution_inv_(1.0 / bundle_resolution_),
+        w_T_m_(map.getInitialOrigin()),
+        m_T_w_(w_T_m_.inverse()),
+        min_bundle_index_(map.getMinBundleIndex()),
+        max_bundle_index_(map.getMaxBundleIndex())
+    {
+        using distribution_t = typename Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::distribution_t;
+
+        /// static maps do not serve bundles outside of their bounds
+        index_t lo = min_bundle_index_;
+        index_t hi = max_bundle_index_;
+        if (option_t != tags::static_map) {
+            lo.fill(std::numeric_limits<int>::min());
+            hi.fill(std::numeric_limits<int>::max());
+        }
+
+        std::vector<index_t> keys;
+        bundle_ids_t bundle_ids;
+        for (std::size_t layer=0; layer<bin_count; ++layer) {
+            map.getStorages()[layer]->traverse([this, layer, &lo, &hi, &keys, &bundle_ids](const index_t &li, const distribution_t &d) {
+                add(layer, li, d, lo, hi, keys, bundle_ids);
+            });
+        }
+        buildTable(keys);
+    }
+
+    /**
+     * @brief Freeze only the bundles within [min_bundle_index, max_bundle_index].
+     *        The layer storages are queried per index, which is cheap for small
+     *        regions and does not need to visit the rest of the map.
+     * @param map               the source map
+     * @param min_bundle_index  lower corner of the region
+     * @param max_bundle_index  upper corner of the region, inclusive
+     */
+    template <tags::option option_t,
+              template <typename, typename, typename...> class backend_t,
+              template <typename, typename, typename...> class dynamic_backend_t>
+    inline FrozenMap(const Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t> &map,
+                     const index_t &min_bundle_index,
+                     const index_t &max_bundle_index) :
+        resolution_(map.getResolution()),
+        bundle_resolution_(map.getBundleResolution()),
+        bundle_resolution_inv_(1.0 / bundle_resolution_),
+        w_T_m_(map.getInitialOrigin()),
+        m_T_w_(w_T_m_.inverse()),
+        min_bundle_index_(map.getMinBundleIndex()),
+        max_bundle_index_(map.getMaxBundleIndex())
+    {
+        index_t lo = min_bundle_index;
+        index_t hi = max_bundle_index;
+        if (option_t == tags::static_map) {
+            for (std::size_t j=0; j<Dim; ++j) {
+                lo[j] = std::max(lo[j], min_bundle_index_[j]);
+                hi[j] = std::min(hi[j], max_bundle_index_[j]);
+            }
+        }
+
+        std::vector<index_t> keys;
+        bundle_ids_t bundle_ids;
+        for (std::size_t layer=0; layer<bin_count; ++layer) {
+            /// range of layer indices referenced by the region, see generate_indices
+            index_t li_lo, li_hi;
+            for (std::size_t j=0; j<Dim; ++j) {
+                const int bit = static_cast<int>((layer >> j) & 1ul);
+                li_lo[j] = cslibs_math::common::div(lo[j] + bit, 2);
+                li_hi[j] = cslibs_math::common::div(hi[j] + bit, 2);
+                if (li_lo[j] > li_hi[j]) {
+                    buildTable(keys);
+                    return;
+                }
+            }
+
+            index_t li = li_lo;
+            std::size_t j = 0;
+            while (j < Dim) {
+                if (const auto *d = map.getStorages()[layer]->get(li))
+                    add(layer, li, *d, lo, hi, keys, bundle_ids);
+                for (j = 0; j < Dim; ++j) {
+                    if (li[j] < li_hi[j]) {
+                        ++li[j];
+                        break;
+                    }
+                    li[j] = li_lo[j];
+                }
+            }
+        }
+        buildTable(keys);
+    }
+
+    inline pose_t getInitialOrigin() const
+    {
+        return w_T_m_;
+    }
+
+    inline index_t getMinBundleIndex() const
+    {
+        return min_bundle_index_;
+    }
+
+    inline index_t getMaxBundleIndex() const
+    {
+        return max_bundle_index_;
+    }
+
+    inline T getBundleResolution() const
+    {
+        return bundle_resolution_;
+    }
+
+    inline T getResolution() const
+    {
+        return resolution_;
+    }
+
+    /**
+     * @brief Find a bundle.
+     * @param bi    the bundle index
+     * @return the entries of the bundle per layer, nullptr if there is no data
+     */
+    inline const bundle_t* getBundle(const index_t &bi) const
+    {
+        std::size_t pos = hash(bi);
+        for (entry_t slot = table_slots_[pos]; slot != no_entry; slot = table_slots_[pos]) {
+            if (table_keys_[pos] == bi)
+                return &bundles_[slot];
+            pos = (pos + 1) & mask_;
+        }
+        return nullptr;
+    }
+
+    inline const bundle_t* getBundle(const point_t &p) const
+    {
+        return getBundle(toBundleIndex(p));
+    }
+
+    inline const mean_t& getMean(const entry_t e) const
+    {
+        return means_[e];
+    }
+
+    inline const matrix_t& getInformationMatrix(const entry_t e) const
+    {
+        return information_[e];
+    }
+
+    inline T getNormalizer(const entry_t e) const
+    {
+        return normalizers_[e];
+    }
+
+    inline std::size_t getSampleCount(const entry_t e) const
+    {
+        return sample_counts_[e];
+    }
+
+    /**
+     * @brief Check if the entry holds a valid distribution, occupancy maps
+     *        also keep entries which only observed free space.
+     */
+    inline bool valid(const entry_t e) const
+    {
+        return valid_[e] != 0;
+    }
+
+    inline T getOccupancy(const entry_t e,
+                          const inverse_sensor_model_t &ivm) const
+    {
+        static_assert(frozen_data_t::occupancy, "Only occupancy maps provide occupancy.");
+        return cslibs_math::common::LogOdds<T>::from(
+                    weight_free_[e]     * ivm.getLogOddsFree() +
+                    weight_occupied_[e] * ivm.getLogOddsOccupied() -
+                    observations_[e]    * ivm.getLogOddsPrior());
+    }
+
+    inline T sample(const point_t &p) const
+    {
+        point_t pm;
+        const index_t &bi = toBundleIndex(p, pm);
+        return sample(pm, getBundle(bi));
+    }
+
+    inline T sample(const point_t &p,
+                    const index_t &bi) const
+    {
+        return sample(p, getBundle(bi));
+    }
+
+    inline T sample(const point_t &p,
+                    const bundle_t *bundle) const
+    {
+        static_assert(!frozen_data_t::occupancy, "Occupancy maps require an inverse model for sampling.");
+        if (!bundle)
+            return T();
+
+        T retval = T();
+        for (const entry_t e : *bundle)
+            if (e != no_entry)
+                retval += div_count * normalizers_[e] * evaluate(p, e);
+        return retval;
+    }
+
+    inline T sampleNonNormalized(const point_t &p) const
+    {
+        point_t pm;
+        const index_t &bi = toBundleIndex(p, pm);
+        return sampleNonNormalized(pm, getBundle(bi));
+    }
+
+    inline T sampleNonNormalized(const point_t &p,
+                                 const index_t &bi) const
+    {
+        return sampleNonNormalized(p, getBundle(bi));
+    }
+
+    inline T sampleNonNormalized(const point_t &p,
+                                 const bundle_t *bundle) const
+    {
+        static_assert(!frozen_data_t::occupancy, "Occupancy maps require an inverse model for sampling.");
+        if (!bundle)
+            return T();
+
+        T retval = T();
+        for (const entry_t e : *bundle)
+            if (e != no_entry)
+                retval += div_count * evaluate(p, e);
+        return retval;
+    }
+
+    inline T sample(const point_t &p,
+                    const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        point_t pm;
+        const index_t &bi = toBundleIndex(p, pm);
+        return sample(pm, getBundle(bi), ivm);
+    }
+
+    inline T sample(const point_t &p,
+                    const index_t &bi,
+                    const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        return sample(p, getBundle(bi), ivm);
+    }
+
+    inline T sample(const point_t &p,
+                    const bundle_t *bundle,
+                    const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        if (!ivm)
+            throw std::runtime_error("[FrozenMap]: inverse model not set");
+        if (!bundle)
+            return T();
+
+        T retval = T();
+        for (const entry_t e : *bundle)
+            if (e != no_entry && valid_[e])
+                retval += div_count * normalizers_[e] * evaluate(p, e) * getOccupancy(e, *ivm);
+        return retval;
+    }
+
+    inline T sampleNonNormalized(const point_t &p,
+                                 const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        point_t pm;
+        const index_t &bi = toBundleIndex(p, pm);
+        return sampleNonNormalized(pm, getBundle(bi), ivm);
+    }
+
+    inline T sampleNonNormalized(const point_t &p,
+                                 const index_t &bi,
+                                 const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        return sampleNonNormalized(p, getBundle(bi), ivm);
+    }
+
+    inline T sampleNonNormalized(const point_t &p,
+                                 const bundle_t *bundle,
+                                 const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        if (!ivm)
+            throw std::runtime_error("[FrozenMap]: inverse model not set");
+        if (!bundle)
+            return T();
+
+        T retval = T();
+        for (const entry_t e : *bundle)
+            if (e != no_entry && valid_[e])
+                retval += div_count * evaluate(p, e) * getOccupancy(e, *ivm);
+        return retval;
+    }
+
+    /**
+     * @brief Number of stored layer distributions.
+     */
+    inline std::size_t size() const
+    {
+        return means_.size();
+    }
+
+    inline std::size_t bundleCount() const
+    {
+        return bundles_.size();
+    }
+
+    inline std::size_t getByteSize() const
+    {
+        return sizeof(*this) +
+                means_.capacity()           * sizeof(mean_t) +
+                information_.capacity()     * sizeof(matrix_t) +
+                normalizers_.capacity()     * sizeof(T) +
+                sample_counts_.capacity()   * sizeof(std::size_t) +
+                valid_.capacity()           * sizeof(std::uint8_t) +
+                weight_free_.capacity()     * sizeof(T) +
+                weight_occupied_.capacity() * sizeof(T) +
+                observations_.capacity()    * sizeof(T) +
+                bundles_.capacity()         * sizeof(bundle_t) +
+                table_keys_.capacity()      * sizeof(index_t) +
+                table_slots_.capacity()     * sizeof(entry_t);
+    }
+
+protected:
+    using frozen_data_t = detail::frozen_data<data_t>;
+
+    template <typename U>
+    using aligned_vector_t = std::vector<U, Eigen::aligned_allocator<U>>;
+
+    struct hash_t
+    {
+        inline std::size_t operator()(const index_t &bi) const
+        {
+            std::size_t h = 0;
+            for (std::size_t i=0; i<Dim; ++i)
+                h = h * 31ul + static_cast<std::size_t>(static_cast<std::uint32_t>(bi[i]));
+            return h;
+        }
+    };
+
+    using bundle_ids_t = std::unordered_map<index_t, entry_t, hash_t>;
+
+    const T                         resolution_;
+    const T                         bundle_resolution_;
+    const T                         bundle_resolution_inv_;
+    const transform_t               w_T_m_;
+    const transform_t               m_T_w_;
+    const index_t                   min_bundle_index_;
+    const index_t                   max_bundle_index_;
+
+    /// one element per layer distribution
+    aligned_vector_t<mean_t>        means_;
+    aligned_vector_t<matrix_t>      information_;
+    std::vector<T>                  normalizers_;
+    std::vector<std::size_t>        sample_counts_;
+    std::vector<std::uint8_t>       valid_;
+    std::vector<T>                  weight_free_;
+    std::vector<T>                  weight_occupied_;
+    std::vector<T>                  observations_;
+
+    /// one element per bundle
+    std::vector<bundle_t>           bundles_;
+
+    /// open addressing hash table, bundle index to bundle
+    std::vector<index_t>            table_keys_;
+    std::vector<entry_t>            table_slots_;
+    std::size_t                     shift_;
+    std::size_t                     mask_;
+
+    /**
+     * @brief Store a layer distribution and register it with every bundle in [lo, hi] it belongs to.
+     */
+    template <typename distribution_t>
+    inline void add(const std::size_t layer,
+                    const index_t &li,
+                    const distribution_t &d,
+                    const index_t &lo,
+                    const index_t &hi,
+                    std::vector<index_t> &keys,
+                    bundle_ids_t &bundle_ids)
+    {
+        const auto *g = frozen_data_t::get(d);
+        const bool valid = g && g->valid();
+        if (!valid && !frozen_data_t::occupancy)
+            return;
+
+        const entry_t e = static_cast<entry_t>(means_.size());
+        means_.emplace_back(valid ? mean_t(g->getMean()) : mean_t::Zero());
+        information_.emplace_back(valid ? matrix_t(g->getInformationMatrix()) : matrix_t::Zero());
+        normalizers_.emplace_back(valid ? normalizer(g->getCovariance()) : T());
+        sample_counts_.emplace_back(frozen_data_t::sampleCount(d));
+        valid_.emplace_back(valid ? 1 : 0);
+
+        T weight_free, weight_occupied, observations;
+        frozen_data_t::occupancyTerms(d, weight_free, weight_occupied, observations);
+        weight_free_.emplace_back(weight_free);
+        weight_occupied_.emplace_back(weight_occupied);
+        observations_.emplace_back(observations);
+
+        /// every layer distribution is shared by 2^Dim bundles, inverse of generate_indices
+        bool referenced = false;
+        for (std::size_t c=0; c<bin_count; ++c) {
+            index_t bi;
+            bool inside = true;
+            for (std::size_t j=0; j<Dim; ++j) {
+                const int offset = static_cast<int>((c >> j) & 1ul);
+                bi[j] = ((layer >> j) & 1ul) ? (2 * li[j] - offset) : (2 * li[j] + offset);
+                inside &= bi[j] >= lo[j] && bi[j] <= hi[j];
+            }
+            if (!inside)
+                continue;
+
+            auto it = bundle_ids.find(bi);
+            if (it == bundle_ids.end()) {
+                it = bundle_ids.emplace(bi, static_cast<entry_t>(bundles_.size())).first;
+                bundle_t b;
+                b.fill(no_entry);
+                bundles_.emplace_back(b);
+                keys.emplace_back(bi);
+            }
+            bundles_[it->second][layer] = e;
+            referenced = true;
+        }
+
+        /// drop entries which only belong to bundles outside of the region
+        if (!referenced) {
+            means_.pop_back();
+            information_.pop_back();
+            normalizers_.pop_back();
+            sample_counts_.pop_back();
+            valid_.pop_back();
+            weight_free_.pop_back();
+            weight_occupied_.pop_back();
+            observations_.pop_back();
+        }
+    }
+
+    inline void buildTable(const std::vector<index_t> &keys)
+    {
+        /// load factor of at most 0.5, there is always an empty slot to terminate a probe
+        std::size_t bits = 1;
+        while ((1ul << bits) < 2 * keys.size())
+            ++bits;
+        shift_ = 64 - bits;
+        mask_  = (1ul << bits) - 1;
+        table_keys_.resize(1ul << bits);
+        table_slots_.assign(1ul << bits, no_entry);
+
+        for (std::size_t i=0; i<keys.size(); ++i) {
+            std::size_t pos = hash(keys[i]);
+            while (table_slots_[pos] != no_entry)
+                pos = (pos + 1) & mask_;
+            table_keys_[pos]  = keys[i];
+            table_slots_[pos] = static_cast<entry_t>(i);
+        }
+    }
+
+    inline std::size_t hash(const index_t &bi) const
+    {
+        std::uint64_t h = 0;
+        for (std::size_t i=0; i<Dim; ++i)
+            h = (h ^ static_cast<std::uint32_t>(bi[i])) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h >> shift_);
+    }
+
+    inline T evaluate(const point_t &p,
+                      const entry_t e) const
+    {
+        const mean_t q = p.data() - means_[e];
+        return std::exp(-0.5 * static_cast<T>(q.transpose() * information_[e] * q));
+    }
+
+    static inline T normalizer(const matrix_t &covariance)
+    {
+        return 1.0 / std::sqrt(std::pow(2.0 * M_PI, static_cast<T>(Dim)) * covariance.determinant());
+    }
+
+    inline index_t toBundleIndex(const point_t &p_w,
+                                 point_t &p_m) const
+    {
+        p_m = m_T_w_ * p_w;
+        index_t retval;
+        for (std::size_t i=0; i<Dim; ++i)
+            retval[i] = static_cast<int>(std::floor(p_m(i) * bundle_resolution_inv_));
+        return retval;
+    }
+
+    inline index_t toBundleIndex(const point_t &p_w) const
+    {
+        point_t p_m;
+        return toBundleIndex(p_w, p_m);
+    }
+};
+
+template <std::size_t Dim, template <typename,std::size_t> class data_t, typename T>
+constexpr typename FrozenMap<Dim,data_t,T>::entry_t FrozenMap<Dim,data_t,T>::no_entry;
+}
+}
+
+#endif // CSLIBS_NDT_MAP_FROZEN_MAP_HPP
@@ -44,6 +44,7 @@ public:
     using typename base_t::distribution_storage_array_t;
     using typename base_t::distribution_bundle_t;
     using typename base_t::distribution_const_bundle_t;
+    using typename base_t::distribution_const_list_t;
     using typename base_t::distribution_bundle_storage_t;
     using typename base_t::distribution_bundle_storage_ptr_t;
     using typename base_t::dynamic_distribution_storage_t;
@@ -107,12 +108,12 @@ public:
 
     inline const distribution_bundle_t* getDistributionBundle(const index_t &bi) const
     {
-        return valid(bi) ? this->getAllocate(bi) : nullptr;
+        return this->valid(bi) ? this->getAllocate(bi) : nullptr;
     }
 
     inline distribution_bundle_t* getDistributionBundle(const index_t &bi)
     {
-        return valid(bi) ? this->getAllocate(bi) : nullptr;
+        return this->valid(bi) ? this->getAllocate(bi) : nullptr;
     }
 
     inline const distribution_bundle_t* getDistributionBundle(const point_t &p) const
@@ -130,12 +131,20 @@ public:
         if (!this->toBundleIndex(p, bi))
             return nullptr;
 
-        return this->bundle_storage_->get(bi);
+        return get(bi);
     }
 
+    /**
+     * @brief Get a bundle without allocating it. With a memory budget, an evicted
+     *        bundle is faulted in, which is not thread safe.
+     */
     inline const distribution_bundle_t* get(const index_t &bi) const
     {
-        return valid(bi) ? this->bundle_storage_->get(bi) : nullptr;
+        if (!this->valid(bi))
+            return nullptr;
+
+        this->touch(bi);
+        return this->bundle_storage_->get(bi);
     }
 
     inline size_m_t getSizeM() const
@@ -156,23 +165,6 @@ public:
 protected:
     const size_t    size_;
     const size_m_t  size_m_;
-
-    virtual inline void updateIndices(const index_t &chunk_index) const override
-    {
-    }
-
-    virtual inline bool valid(const index_t &index) const override
-    {
-        auto is_valid = [this,&index](const std::size_t &c) {
-            return index[c] >= this->min_bundle_index_[c] && index[c] <= this->max_bundle_index_[c];
-        };
-        for (std::size_t i=0; i<Dim; ++i)
-            if (!is_valid(i))
-                return false;
-        return true;
-    }
-
-    virtual inline bool expandDistribution(const distribution_t* d) const = 0;
 };
 
 template <std::size_t Dim,
@@ -203,6 +195,7 @@ public:
     using typename base_t::distribution_storage_array_t;
     using typename base_t::distribution_bundle_t;
     using typename base_t::distribution_const_bundle_t;
+    using typename base_t::distribution_const_list_t;
     using typename base_t::distribution_bundle_storage_t;
     using typename base_t::distribution_bundle_storage_ptr_t;
     using typename base_t::dynamic_distribution_storage_t;
@@ -259,13 +252,18 @@ public:
     inline const distribution_bundle_t* get(const point_t &p) const
     {
         const index_t bi = this->toBundleIndex(p);
-        return this->bundle_storage_->get(bi);
+        return get(bi);
     }
 
+    /**
+     * @brief Get a bundle without allocating it. With a memory budget, an evicted
+     *        bundle is faulted in, which is not thread safe.
+     */
     inline const distribution_bundle_t* get(const index_t &bi) const
     {
+        this->touch(bi);
         return this->bundle_storage_->get(bi);
-    }    
+    }
 
     inline size_m_t getSizeM() const
     {
@@ -275,19 +273,6 @@ public:
         return result;
     }
 
-protected:
-    virtual inline void updateIndices(const index_t &chunk_index) const override
-    {
-        this->min_bundle_index_ = std::min(this->min_bundle_index_, chunk_index);
-        this->max_bundle_index_ = std::max(this->max_bundle_index_, chunk_index);
-    }
-
-    virtual inline bool valid(const index_t &index) const override
-    {
-        return true;
-    }
-
-    virtual inline bool expandDistribution(const distribution_t* d) const = 0;
 };
 }
 }
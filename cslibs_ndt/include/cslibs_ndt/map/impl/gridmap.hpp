@@ -4,8 +4,33 @@
 #include <cslibs_ndt/map/generic_map.hpp>
 #include <cslibs_ndt/common/distribution.hpp>
 
+#include <algorithm>
+#include <iterator>
+
 namespace cslibs_ndt {
 namespace map {
+namespace detail {
+template <>
+struct expand<Distribution>
+{
+    template <typename distribution_t>
+    static inline bool distribution(const distribution_t* d)
+    {
+        return d && d->data().getN() >= 3;
+    }
+};
+
+template <>
+struct populated<Distribution>
+{
+    template <typename distribution_t>
+    static inline bool distribution(const distribution_t* d)
+    {
+        return d && d->data().getN() > 0;
+    }
+};
+}
+
 template <tags::option option_t,
           std::size_t Dim,
           typename T,
@@ -34,9 +59,11 @@ public:
     using typename base_t::distribution_storage_array_t;
     using typename base_t::distribution_bundle_t;
     using typename base_t::distribution_const_bundle_t;
+    using typename base_t::distribution_const_list_t;
     using typename base_t::distribution_bundle_storage_t;
     using typename base_t::distribution_bundle_storage_ptr_t;
     using typename base_t::dynamic_distribution_storage_t;
+    using typename base_t::bundle_gaussians_t;
 
     using base_t::GenericMap;
     inline Map(const base_t &other) : base_t(other) { }
@@ -50,8 +77,11 @@ public:
             return;
 
         distribution_bundle_t *bundle = this->getAllocate(bi);
-        for (std::size_t i=0; i<this->bin_count; ++i)
-            bundle->at(i)->data().add(pm);
+        for (std::size_t i=0; i<this->bin_count; ++i) {
+            const auto l = this->lock(bundle->at(i));
+            bundle->at(i)->add(pm);
+        }
+        this->enforceMemoryBudget();
     }
 
     inline void insert(const typename pointcloud_t::ConstPtr &points,
@@ -72,16 +102,106 @@ public:
                 point_t pm;
                 const index_t &bi = this->toBundleIndex(pw,pm);
                 distribution_t *d = storage.get(bi);
-                (d ? d : &storage.insert(bi, distribution_t()))->data().add(pm);
+                (d ? d : &storage.insert(bi, distribution_t()))->add(pm);
             }
         }
 
         storage.traverse([this](const index_t& bi, const distribution_t &d) {
+            if (!this->valid(bi))
+                return;
+
             distribution_bundle_t *bundle = this->getAllocate(bi);
             const typename distribution_t::distribution_t &dist = d.data();
-            for (std::size_t i=0; i<this->bin_count; ++i)
-                bundle->at(i)->data() += dist;
+            for (std::size_t i=0; i<this->bin_count; ++i) {
+                const auto l = this->lock(bundle->at(i));
+                *bundle->at(i) += dist;
+            }
+        });
+        this->enforceMemoryBudget();
+    }
+
+    /**
+     * @brief Insert a scan using several threads. Every thread aggregates a part of
+     *        the scan on its own, the partial aggregates are merged into the layers
+     *        afterwards. Each layer distribution is updated by exactly one thread, so
+     *        the result does not depend on the thread count up to rounding.
+     * @param points_begin  begin of the scan
+     * @param points_end    end of the scan
+     * @param points_origin transformation applied to every point
+     * @param num_threads   maximum number of threads to use
+     */
+    template<typename iterator_t>
+    inline void insertParallel(const iterator_t &points_begin,
+                               const iterator_t &points_end,
+                               const pose_t &points_origin = pose_t(),
+                               const std::size_t num_threads = utility::hardware_threads())
+    {
+        static constexpr std::size_t min_points_per_thread = 1024;
+
+        const std::size_t count   = static_cast<std::size_t>(std::distance(points_begin, points_end));
+        const std::size_t threads = std::min(num_threads, count / min_points_per_thread);
+        if (threads <= 1)
+            return insert(points_begin, points_end, points_origin);
+
+        /// aggregate disjoint parts of the scan
+        std::vector<dynamic_distribution_storage_t> storages(threads);
+        utility::parallel_for(threads, threads, [&](const std::size_t t) {
+            dynamic_distribution_storage_t &storage = storages[t];
+            const iterator_t begin = std::next(points_begin, static_cast<std::ptrdiff_t>(t * count / threads));
+            const iterator_t end   = std::next(points_begin, static_cast<std::ptrdiff_t>((t + 1) * count / threads));
+            for (auto p = begin; p != end; ++p) {
+                const point_t pw = points_origin * *p;
+                if (pw.isNormal()) {
+                    point_t pm;
+                    const index_t &bi = this->toBundleIndex(pw,pm);
+                    distribution_t *d = storage.get(bi);
+                    (d ? d : &storage.insert(bi, distribution_t()))->add(pm);
+                }
+            }
+        });
+
+        /// allocation modifies the storages and stays in the calling thread
+        using update_t = std::pair<distribution_t*, const distribution_t*>;
+        std::array<std::vector<update_t>, Map::bin_count> updates;
+        for (const dynamic_distribution_storage_t &storage : storages) {
+            storage.traverse([this, &updates](const index_t& bi, const distribution_t &d) {
+                if (!this->valid(bi))
+                    return;
+
+                distribution_bundle_t *bundle = this->getAllocate(bi);
+                for (std::size_t i=0; i<this->bin_count; ++i)
+                    updates[i].emplace_back(bundle->at(i), &d);
+            });
+        }
+
+        /// neighbouring bundles share layer distributions, group the updates by target
+        utility::parallel_for(this->bin_count, num_threads, [&updates](const std::size_t i) {
+            std::stable_sort(updates[i].begin(), updates[i].end(),
+                             [](const update_t &a, const update_t &b) { return a.first < b.first; });
         });
+
+        /// split every layer into ranges that never share a target
+        std::vector<std::pair<const update_t*, const update_t*>> ranges;
+        for (const std::vector<update_t> &layer : updates) {
+            const update_t *begin = layer.data();
+            const update_t *end   = layer.data() + layer.size();
+            for (std::size_t t = 1; t <= threads && begin != end; ++t) {
+                const update_t *split = t == threads ? end : std::max(begin, layer.data() + t * layer.size() / threads);
+                while (split != end && split != begin && split->first == (split - 1)->first)
+                    ++split;
+                if (split != begin)
+                    ranges.emplace_back(begin, split);
+                begin = split;
+            }
+        }
+
+        utility::parallel_for(ranges.size(), num_threads, [this, &ranges](const std::size_t r) {
+            for (const update_t *u = ranges[r].first; u != ranges[r].second; ++u) {
+                const auto l = this->lock(u->first);
+                *u->first += *u->second;
+            }
+        });
+        this->enforceMemoryBudget();
     }
 
     inline T sample(const point_t &p) const
@@ -104,13 +224,12 @@ public:
     inline T sample(const point_t &p,
                     const distribution_bundle_t *bundle) const
     {
-        auto evaluate = [this, &p, &bundle]() {
-            T retval = T();
-            for (std::size_t i=0; i<this->bin_count; ++i)
-                retval += this->div_count * bundle->at(i)->data().sample(p);
-            return retval;
-        };
-        return bundle ? evaluate() : T();
+        if (!bundle)
+            return T();
+
+        bundle_gaussians_t gaussians;
+        gather(*bundle, gaussians, true);
+        return gaussians.evaluate(p.data().data());
     }
 
     inline T sampleNonNormalized(const point_t &p) const
@@ -133,19 +252,56 @@ public:
     inline T sampleNonNormalized(const point_t &p,
                                  const distribution_bundle_t *bundle) const
     {
-        auto evaluate = [this, &p, &bundle]() {
-            T retval = T();
-            for (std::size_t i=0; i<this->bin_count; ++i)
-                retval += this->div_count * bundle->at(i)->data().sampleNonNormalized(p);
-            return retval;
-        };
-        return bundle ? evaluate() : T();
+        if (!bundle)
+            return T();
+
+        bundle_gaussians_t gaussians;
+        gather(*bundle, gaussians, false);
+        return gaussians.evaluate(p.data().data());
+    }
+
+    /**
+     * @brief Sample many points at once, see AbstractMap::sampleBatch.
+     * @param points_begin  the first point in world coordinates
+     * @param points_end    the end of the points
+     * @param values        the value per point
+     */
+    template <typename iterator_t>
+    inline void sample(const iterator_t &points_begin,
+                       const iterator_t &points_end,
+                       std::vector<T> &values) const
+    {
+        this->sampleBatch(points_begin, points_end, values,
+                          [this](const distribution_bundle_t &bundle, bundle_gaussians_t &gaussians) {
+            gather(bundle, gaussians, true);
+        });
+    }
+
+    template <typename iterator_t>
+    inline void sampleNonNormalized(const iterator_t &points_begin,
+                                    const iterator_t &points_end,
+                                    std::vector<T> &values) const
+    {
+        this->sampleBatch(points_begin, points_end, values,
+                          [this](const distribution_bundle_t &bundle, bundle_gaussians_t &gaussians) {
+            gather(bundle, gaussians, false);
+        });
     }
 
 protected:
-    virtual inline bool expandDistribution(const distribution_t* d) const override
+    /**
+     * @brief Pack the valid layers of a bundle.
+     */
+    inline void gather(const distribution_bundle_t &bundle,
+                       bundle_gaussians_t &gaussians,
+                       const bool normalized) const
     {
-        return d && d->data().getN() >= 3;
+        for (std::size_t i=0; i<this->bin_count; ++i) {
+            const distribution_t *d = bundle.at(i);
+            if (d->data().valid())
+                gaussians.add(d->data().getMean(), d->getInformationMatrix(),
+                              this->div_count * (normalized ? d->getNormalizer() : T(1)));
+        }
     }
 };
 }
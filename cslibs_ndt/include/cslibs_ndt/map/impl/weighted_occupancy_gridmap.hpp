@@ -6,6 +6,28 @@
 
 namespace cslibs_ndt {
 namespace map {
+namespace detail {
+template <>
+struct expand<WeightedOccupancyDistribution>
+{
+    template <typename distribution_t>
+    static inline bool distribution(const distribution_t* d)
+    {
+        return d && d->getDistribution() && d->getDistribution()->getSampleCount() > 0;
+    }
+};
+
+template <>
+struct populated<WeightedOccupancyDistribution>
+{
+    template <typename distribution_t>
+    static inline bool distribution(const distribution_t* d)
+    {
+        return d && (d->weightFree() > 0 || d->getDistribution());
+    }
+};
+}
+
 template <tags::option option_t,
           std::size_t Dim,
           typename T,
@@ -34,9 +56,11 @@ public:
     using typename base_t::distribution_storage_array_t;
     using typename base_t::distribution_bundle_t;
     using typename base_t::distribution_const_bundle_t;
+    using typename base_t::distribution_const_list_t;
     using typename base_t::distribution_bundle_storage_t;
     using typename base_t::distribution_bundle_storage_ptr_t;
     using typename base_t::dynamic_distribution_storage_t;
+    using typename base_t::bundle_gaussians_t;
 
     using inverse_sensor_model_t = cslibs_gridmaps::utility::InverseModel<T>;
     using default_iterator_t     = typename map::traits<Dim,T>::default_iterator_t;
@@ -58,6 +82,7 @@ public:
             updateFree(it());
             ++ it;
         }
+        this->enforceMemoryBudget();
     }
 
     template <typename line_iterator_t = default_iterator_t>
@@ -96,6 +121,7 @@ public:
                 ++ it;
             }
         });
+        this->enforceMemoryBudget();
     }
 
     template <typename line_iterator_t = default_iterator_t>
@@ -124,8 +150,10 @@ public:
             const distribution_bundle_t *bundle = this->getAllocate(bi);
             T retval = T();
             if (bundle) {
-                for (std::size_t i=0; i<this->bin_count; ++i)
+                for (std::size_t i=0; i<this->bin_count; ++i) {
+                    const auto l = this->lock(bundle->at(i));
                     retval += this->div_count * bundle->at(i)->getOccupancy(ivm);
+                }
             }
             return retval;
         };
@@ -179,6 +207,7 @@ public:
             if ((visibility *= current_visibility(bi)) >= ivm_visibility->getProbPrior())
                 updateOccupied(bi, d.getDistribution());
         });
+        this->enforceMemoryBudget();
     }
 
     inline T sample(const point_t &p,
@@ -210,21 +239,12 @@ public:
         if (!ivm)
             throw std::runtime_error("[WeightedOccupancyGridmap]: inverse model not set");
 
-        auto sample = [&p, &ivm] (const distribution_t *d) {
-            auto do_sample = [&p, &ivm, &d]() {
-                const auto &handle = d;
-                return handle->getDistribution() ?
-                            handle->getDistribution()->sample(p) * handle->getOccupancy(ivm) : T();
-            };
-            return d ? do_sample() : T();
-        };
-        auto evaluate = [this, &p, &bundle, &sample]() {
-            T retval = T();
-            for (std::size_t i=0; i<this->bin_count; ++i)
-                retval += this->div_count * sample(bundle->at(i));
-            return retval;
-        };
-        return bundle ? evaluate() : T();
+        if (!bundle)
+            return T();
+
+        bundle_gaussians_t gaussians;
+        gather(*bundle, gaussians, ivm, true);
+        return gaussians.evaluate(p.data().data());
     }
 
     inline T sampleNonNormalized(const point_t &p,
@@ -256,60 +276,124 @@ public:
         if (!ivm)
             throw std::runtime_error("[WeightedOccupancyGridmap]: inverse model not set");
 
-        auto sample = [&p, &ivm] (const distribution_t *d) {
-            auto do_sample = [&p, &ivm, &d]() {
-                const auto &handle = d;
-                return handle->getDistribution() ?
-                            handle->getDistribution()->sampleNonNormalized(p) * handle->getOccupancy(ivm) : T();
-            };
-            return d ? do_sample() : T();
-        };
-        auto evaluate = [this, &p, &bundle, &sample]() {
-            T retval = T();
-            for (std::size_t i=0; i<this->bin_count; ++i)
-                retval += this->div_count * sample(bundle->at(i));
-            return retval;
-        };
-        return bundle ? evaluate() : T();
+        if (!bundle)
+            return T();
+
+        bundle_gaussians_t gaussians;
+        gather(*bundle, gaussians, ivm, false);
+        return gaussians.evaluate(p.data().data());
+    }
+
+    /**
+     * @brief Sample many points at once, see AbstractMap::sampleBatch.
+     * @param points_begin  the first point in world coordinates
+     * @param points_end    the end of the points
+     * @param values        the value per point
+     * @param ivm           the inverse sensor model
+     */
+    template <typename iterator_t>
+    inline void sample(const iterator_t &points_begin,
+                       const iterator_t &points_end,
+                       std::vector<T> &values,
+                       const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        sampleBatch(points_begin, points_end, values, ivm, true);
+    }
+
+    template <typename iterator_t>
+    inline void sampleNonNormalized(const iterator_t &points_begin,
+                                    const iterator_t &points_end,
+                                    std::vector<T> &values,
+                                    const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        sampleBatch(points_begin, points_end, values, ivm, false);
     }
 
 protected:
-    virtual inline bool expandDistribution(const distribution_t* d) const override
+    template <typename iterator_t>
+    inline void sampleBatch(const iterator_t &points_begin,
+                            const iterator_t &points_end,
+                            std::vector<T> &values,
+                            const typename inverse_sensor_model_t::Ptr &ivm,
+                            const bool normalized) const
     {
-        return d && d->getDistribution() && d->getDistribution()->getSampleCount() > 0;
+        if (!ivm)
+            throw std::runtime_error("[WeightedOccupancyGridmap]: inverse model not set");
+
+        base_t::sampleBatch(points_begin, points_end, values,
+                            [this, &ivm, normalized](const distribution_bundle_t &bundle, bundle_gaussians_t &gaussians) {
+            gather(bundle, gaussians, ivm, normalized);
+        });
+    }
+
+    /**
+     * @brief Pack the valid layers of a bundle weighted by their occupancy.
+     */
+    inline void gather(const distribution_bundle_t &bundle,
+                       bundle_gaussians_t &gaussians,
+                       const typename inverse_sensor_model_t::Ptr &ivm,
+                       const bool normalized) const
+    {
+        for (std::size_t i=0; i<this->bin_count; ++i) {
+            const distribution_t *d = bundle.at(i);
+            const auto *g = d ? d->getDistribution().get() : nullptr;
+            if (g && g->valid())
+                gaussians.add(g->getMean(), g->getInformationMatrix(),
+                              this->div_count * d->getOccupancy(ivm) * (normalized ? bundle_gaussians_t::normalizer(g->getCovariance()) : T(1)));
+        }
     }
 
     inline void updateFree(const index_t &bi) const
     {
+        if (!this->valid(bi))
+            return;
+
         distribution_bundle_t *bundle = this->getAllocate(bi);
-        for (std::size_t i=0; i<this->bin_count; ++i)
+        for (std::size_t i=0; i<this->bin_count; ++i) {
+            const auto l = this->lock(bundle->at(i));
             bundle->at(i)->updateFree();
+        }
     }
 
     inline void updateFree(const index_t     &bi,
                            const std::size_t &n,
                            const T           &w) const
     {
+        if (!this->valid(bi))
+            return;
+
         distribution_bundle_t *bundle = this->getAllocate(bi);
-        for (std::size_t i=0; i<this->bin_count; ++i)
+        for (std::size_t i=0; i<this->bin_count; ++i) {
+            const auto l = this->lock(bundle->at(i));
             bundle->at(i)->updateFree(n, w);
+        }
     }
 
     inline void updateOccupied(const index_t &bi,
                                const point_t &p,
                                const T       &w = 1.0) const
     {
+        if (!this->valid(bi))
+            return;
+
         distribution_bundle_t *bundle = this->getAllocate(bi);
-        for (std::size_t i=0; i<this->bin_count; ++i)
+        for (std::size_t i=0; i<this->bin_count; ++i) {
+            const auto l = this->lock(bundle->at(i));
             bundle->at(i)->updateOccupied(p, w);
+        }
     }
 
     inline void updateOccupied(const index_t &bi,
                                const typename distribution_t::distribution_ptr_t &d) const
     {
+        if (!this->valid(bi))
+            return;
+
         distribution_bundle_t *bundle = this->getAllocate(bi);
-        for (std::size_t i=0; i<this->bin_count; ++i)
+        for (std::size_t i=0; i<this->bin_count; ++i) {
+            const auto l = this->lock(bundle->at(i));
             bundle->at(i)->updateOccupied(d);
+        }
     }
 };
 }
@@ -0,0 +1,103 @@
+#ifndef CSLIBS_NDT_MAP_MEMORY_STATISTICS_HPP
+#define CSLIBS_NDT_MAP_MEMORY_STATISTICS_HPP
+
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Memory of one storage of a map, i.e. a layer or the bundles.
+ */
+struct StorageStatistics
+{
+    std::size_t cells          = 0;     /// allocated cells
+    std::size_t populated      = 0;     /// cells holding data
+    std::size_t capacity       = 0;     /// cells the backend has room for
+    std::size_t storage_bytes  = 0;     /// bytes reported by the backend, cells included
+    std::size_t payload_bytes  = 0;     /// heap bytes owned by the cells
+    std::size_t overhead_bytes = 0;     /// allocator headers, padding and bookkeeping
+
+    inline std::size_t empty() const
+    {
+        return cells - populated;
+    }
+
+    inline std::size_t total() const
+    {
+        return storage_bytes + payload_bytes + overhead_bytes;
+    }
+
+    inline StorageStatistics& operator += (const StorageStatistics &other)
+    {
+        cells          += other.cells;
+        populated      += other.populated;
+        capacity       += other.capacity;
+        storage_bytes  += other.storage_bytes;
+        payload_bytes  += other.payload_bytes;
+        overhead_bytes += other.overhead_bytes;
+        return *this;
+    }
+};
+
+/**
+ * @brief Memory of a map per layer and for the bundles. Heap block sizes are
+ *        estimated for glibc malloc, see utility::heap_block_size.
+ */
+struct MemoryStatistics
+{
+    std::size_t                    map_bytes = 0;   /// the map object itself
+    std::vector<StorageStatistics> layers;
+    StorageStatistics              bundles;
+
+    inline StorageStatistics getLayerTotal() const
+    {
+        StorageStatistics total;
+        for (const StorageStatistics &l : layers)
+            total += l;
+        return total;
+    }
+
+    inline std::size_t total() const
+    {
+        return map_bytes + getLayerTotal().total() + bundles.total();
+    }
+};
+
+inline std::ostream& operator << (std::ostream &out, const MemoryStatistics &statistics)
+{
+    auto row = [&out](const std::string &name, const StorageStatistics &s) {
+        out << std::setw(8)  << name
+            << std::setw(10) << s.cells
+            << std::setw(10) << s.populated
+            << std::setw(10) << s.empty()
+            << std::setw(10) << s.capacity
+            << std::setw(12) << s.storage_bytes
+            << std::setw(12) << s.payload_bytes
+            << std::setw(12) << s.overhead_bytes
+            << std::setw(12) << s.total() << "\n";
+    };
+
+    out << std::setw(8)  << "storage"
+        << std::setw(10) << "cells"
+        << std::setw(10) << "populated"
+        << std::setw(10) << "empty"
+        << std::setw(10) << "capacity"
+        << std::setw(12) << "storage"
+        << std::setw(12) << "payload"
+        << std::setw(12) << "overhead"
+        << std::setw(12) << "total" << "\n";
+    for (std::size_t i=0; i<statistics.layers.size(); ++i)
+        row("layer " + std::to_string(i), statistics.layers[i]);
+    row("layers", statistics.getLayerTotal());
+    row("bundles", statistics.bundles);
+    out << "map object: " << statistics.map_bytes << " | total bytes: " << statistics.total() << "\n";
+    return out;
+}
+}
+}
+
+#endif // CSLIBS_NDT_MAP_MEMORY_STATISTICS_HPP
@@ -0,0 +1,282 @@
+#ifndef CSLIBS_NDT_MAP_PYRAMID_HPP
+#define CSLIBS_NDT_MAP_PYRAMID_HPP
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/utility/index_hash.hpp>
+#include <cslibs_ndt/utility/parallel.hpp>
+
+#include <stdexcept>
+#include <unordered_set>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Maps of the same data at resolutions growing by a factor of two. Level 0
+ *        is the map the data is inserted into, every coarser level is derived from
+ *        the next finer one: a distribution of level k covers exactly 2^Dim cells
+ *        of layer 0 of level k - 1, whose moments are merged. Coarser levels are
+ *        dynamic maps with the backends of level 0 if it is dynamic, the default
+ *        ones otherwise.
+ *        Updates follow the tiles the map reported as modified (see
+ *        AbstractMap::trackChanges), the changes recorded by the map are consumed
+ *        as for a Snapshot. Evicted tiles of level 0 are not taken into account.
+ */
+template <tags::option option_t,
+          std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T,
+          template <typename, typename, typename...> class backend_t = tags::default_types<option_t>::template default_backend_t,
+          template <typename, typename, typename...> class dynamic_backend_t = tags::default_types<option_t>::template default_dynamic_backend_t>
+class EIGEN_ALIGN16 Pyramid
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    using allocator_t   = Eigen::aligned_allocator<Pyramid<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>>;
+
+    using ConstPtr      = std::shared_ptr<const Pyramid<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>>;
+    using Ptr           = std::shared_ptr<Pyramid<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>>;
+
+    using map_t         = Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>;
+    using level_t       = typename std::conditional<option_t == tags::dynamic_map, map_t,
+                                                    Map<tags::dynamic_map,Dim,data_t,T>>::type;
+    using pose_t                = typename map_t::pose_t;
+    using point_t               = typename map_t::point_t;
+    using index_t               = typename map_t::index_t;
+    using distribution_t        = typename map_t::distribution_t;
+    using distribution_bundle_t = typename map_t::distribution_bundle_t;
+
+    static constexpr std::size_t bin_count = map_t::bin_count;
+
+    /**
+     * @brief Build the coarser levels of a map. Change tracking of the map is
+     *        enabled with tile_size if it is disabled.
+     * @param map           level 0
+     * @param levels        number of levels, level 0 included
+     * @param tile_size     edge length of a tile in bundles used to track changes
+     * @param num_threads   maximum number of threads to use
+     */
+    inline Pyramid(const typename map_t::Ptr &map,
+                   const std::size_t          levels,
+                   const std::size_t          tile_size   = 8,
+                   const std::size_t          num_threads = utility::hardware_threads()) :
+        map_(map)
+    {
+        if (!map_)
+            throw std::runtime_error("[Pyramid]: map is not set");
+        if (levels == 0)
+            throw std::runtime_error("[Pyramid]: at least one level is required");
+
+        if (map_->getChangeTileSize() == 0)
+            map_->trackChanges(tile_size);
+
+        T resolution = map_->getResolution();
+        for (std::size_t k = 1 ; k < levels ; ++k) {
+            resolution *= 2;
+            levels_.emplace_back(new level_t(map_->getInitialOrigin(), resolution));
+        }
+
+        /// everything is derived, what the map recorded so far is covered
+        std::vector<index_t> changed;
+        map_->takeChangedTiles(changed);
+
+        std::vector<index_t> cells;
+        map_->getStorages()[0]->traverse([&cells](const index_t &index, const distribution_t &) {
+            cells.emplace_back(index);
+        });
+        derive(cells, num_threads);
+    }
+
+    /**
+     * @brief Derive the coarser levels where level 0 changed since the last update.
+     *        Has to be called by the thread which modifies the map.
+     * @param num_threads   maximum number of threads to use
+     */
+    inline void update(const std::size_t num_threads = utility::hardware_threads())
+    {
+        const int tile_size = static_cast<int>(map_->getChangeTileSize());
+        if (tile_size == 0)
+            throw std::runtime_error("[Pyramid]: change tracking of the map is disabled");
+
+        std::vector<index_t> changed;
+        map_->takeChangedTiles(changed);
+
+        /// layer 0 cells of level 0 are the bundles of level 1
+        std::unordered_set<index_t, utility::IndexHash<Dim>> candidates;
+        for (const index_t &ti : changed) {
+            index_t lo, hi;
+            for (std::size_t i = 0 ; i < Dim ; ++i) {
+                lo[i] = cslibs_math::common::div(ti[i] * tile_size, 2);
+                hi[i] = cslibs_math::common::div(ti[i] * tile_size + tile_size - 1, 2);
+            }
+            forEach(lo, hi, [&candidates](const index_t &index) {
+                candidates.insert(index);
+            });
+        }
+
+        std::vector<index_t> cells;
+        const typename map_t::distribution_storage_ptr_t &storage = map_->getStorages()[0];
+        for (const index_t &index : candidates)
+            if (storage->get(index))
+                cells.emplace_back(index);
+        derive(cells, num_threads);
+    }
+
+    inline std::size_t getLevelCount() const
+    {
+        return levels_.size() + 1;
+    }
+
+    inline T getResolution(const std::size_t level) const
+    {
+        return level == 0 ? map_->getResolution() : levels_.at(level - 1)->getResolution();
+    }
+
+    inline const typename map_t::Ptr& getMap() const
+    {
+        return map_;
+    }
+
+    /**
+     * @brief Get a coarser level.
+     * @param level     the level, starting at 1
+     */
+    inline const level_t& getLevel(const std::size_t level) const
+    {
+        return *levels_.at(level - 1);
+    }
+
+    inline const distribution_bundle_t* get(const point_t &p,
+                                            const std::size_t level) const
+    {
+        return level == 0 ? map_->get(p) : levels_.at(level - 1)->get(p);
+    }
+
+    /**
+     * @brief Evaluate a level, further arguments are passed to the sample function
+     *        of the map, e.g. the inverse sensor model of occupancy maps.
+     */
+    template <typename... Args>
+    inline T sample(const point_t &p,
+                    const std::size_t level,
+                    const Args&... args) const
+    {
+        return level == 0 ? map_->sample(p, args...) : levels_.at(level - 1)->sample(p, args...);
+    }
+
+    template <typename... Args>
+    inline T sampleNonNormalized(const point_t &p,
+                                 const std::size_t level,
+                                 const Args&... args) const
+    {
+        return level == 0 ? map_->sampleNonNormalized(p, args...) : levels_.at(level - 1)->sampleNonNormalized(p, args...);
+    }
+
+    inline std::size_t getByteSize() const
+    {
+        std::size_t size = sizeof(*this) + map_->getByteSize();
+        for (const auto &l : levels_)
+            size += l->getByteSize();
+        return size;
+    }
+
+private:
+    typename map_t::Ptr                       map_;
+    std::vector<typename level_t::Ptr>        levels_;
+
+    template <typename Fn>
+    static inline void forEach(const index_t &lo,
+                               const index_t &hi,
+                               const Fn &function)
+    {
+        index_t index = lo;
+        while (true) {
+            function(index);
+            std::size_t i = 0;
+            for (; i < Dim ; ++i) {
+                if (index[i] < hi[i]) {
+                    ++index[i];
+                    break;
+                }
+                index[i] = lo[i];
+            }
+            if (i == Dim)
+                return;
+        }
+    }
+
+    /**
+     * @brief Recompute the distributions of each coarser level covering the given
+     *        bundles, which are the modified layer 0 cells of the finer level.
+     */
+    inline void derive(std::vector<index_t> bundles,
+                       const std::size_t num_threads)
+    {
+        for (std::size_t k = 0 ; k < levels_.size() ; ++k) {
+            if (k == 0)
+                derive(map_->getStorages()[0], *levels_[k], bundles, num_threads);
+            else
+                derive(levels_[k - 1]->getStorages()[0], *levels_[k], bundles, num_threads);
+
+            /// the modified layer 0 cells of this level are the bundles of the next one
+            std::unordered_set<index_t, utility::IndexHash<Dim>> next;
+            for (const index_t &bi : bundles) {
+                index_t n;
+                for (std::size_t i = 0 ; i < Dim ; ++i)
+                    n[i] = cslibs_math::common::div(bi[i], 2);
+                next.insert(n);
+            }
+            bundles.assign(next.begin(), next.end());
+        }
+    }
+
+    template <typename storage_ptr_t>
+    inline void derive(const storage_ptr_t        &children,
+                       level_t                    &level,
+                       const std::vector<index_t> &bundles,
+                       const std::size_t           num_threads)
+    {
+        /// the smallest bundle covered identifies a distribution and its layer
+        std::unordered_set<index_t, utility::IndexHash<Dim>> smallest;
+        for (const index_t &bi : bundles) {
+            for (std::size_t l = 0 ; l < bin_count ; ++l) {
+                index_t b;
+                for (std::size_t i = 0 ; i < Dim ; ++i)
+                    b[i] = bi[i] - cslibs_math::common::mod(bi[i] + static_cast<int>((l >> i) & 1ul), 2);
+                smallest.insert(b);
+            }
+        }
+
+        /// distributions are allocated in this thread, their children are merged in parallel
+        std::vector<std::pair<index_t, distribution_t*>> cells;
+        cells.reserve(smallest.size());
+        for (const index_t &b : smallest) {
+            std::size_t layer = 0;
+            for (std::size_t i = 0 ; i < Dim ; ++i)
+                layer |= static_cast<std::size_t>(cslibs_math::common::mod(b[i], 2)) << i;
+            cells.emplace_back(b, level.getDistributionBundle(b)->at(layer));
+        }
+
+        utility::parallel_for(cells.size(), num_threads, [&cells, &children](const std::size_t c) {
+            const index_t &b = cells[c].first;
+            distribution_t &d = *cells[c].second;
+            d = distribution_t();
+            forEach(b, offset(b, 1), [&children, &d](const index_t &child) {
+                if (const distribution_t *cd = children->get(child))
+                    d.merge(*cd);
+            });
+        });
+    }
+
+    static inline index_t offset(const index_t &index,
+                                 const int o)
+    {
+        index_t result;
+        for (std::size_t i = 0 ; i < Dim ; ++i)
+            result[i] = index[i] + o;
+        return result;
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_MAP_PYRAMID_HPP
@@ -0,0 +1,120 @@
+#ifndef CSLIBS_NDT_MAP_ROLLING_MAP_HPP
+#define CSLIBS_NDT_MAP_ROLLING_MAP_HPP
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/ring_array.hpp>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Static map of constant size which follows a moving center, e.g. a local
+ *        map around a robot. The storages use toroidal addressing, moving the window
+ *        only destroys the distributions and bundles which leave it. Nothing is
+ *        reallocated and the data within the window stays untouched. The window
+ *        moves in steps of the resolution, i.e. by whole layer distributions.
+ */
+template <std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T,
+          template <typename, typename, typename...> class dynamic_backend_t = tags::default_types<tags::static_map>::template default_dynamic_backend_t>
+class EIGEN_ALIGN16 RollingMap :
+        public Map<tags::static_map,Dim,data_t,T,backend::RingArray,dynamic_backend_t>
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    using allocator_t = Eigen::aligned_allocator<RollingMap<Dim,data_t,T,dynamic_backend_t>>;
+
+    using ConstPtr = std::shared_ptr<const RollingMap<Dim,data_t,T,dynamic_backend_t>>;
+    using Ptr      = std::shared_ptr<RollingMap<Dim,data_t,T,dynamic_backend_t>>;
+
+    using base_t = Map<tags::static_map,Dim,data_t,T,backend::RingArray,dynamic_backend_t>;
+    using typename base_t::pose_t;
+    using typename base_t::point_t;
+    using typename base_t::index_t;
+    using typename base_t::size_t;
+
+    /**
+     * @brief Create a map of size distributions per dimension around center.
+     * @param origin        the map origin in world coordinates
+     * @param resolution    the distribution resolution
+     * @param size          the number of distributions per dimension
+     * @param center        the initial center in world coordinates
+     */
+    inline RollingMap(const pose_t  &origin,
+                      const T       &resolution,
+                      const size_t  &size,
+                      const point_t &center = point_t()) :
+        base_t(origin, resolution, size, minBundleIndex(windowOffset(origin.inverse() * center, resolution, size)))
+    {
+    }
+
+    inline RollingMap(const RollingMap &other) : base_t(other) { }
+    inline RollingMap(RollingMap &&other) : base_t(other) { }
+
+    /**
+     * @brief Center the window at a point, the window only moves if the point lies
+     *        in another distribution than the current center.
+     * @param center        the new center in world coordinates
+     * @return true if the window moved
+     */
+    inline bool moveTo(const point_t &center)
+    {
+        return moveWindow(windowOffset(this->m_T_w_ * center, this->resolution_, this->size_));
+    }
+
+    /**
+     * @brief Move the window to start at the given layer index.
+     * @param offset        the first distribution index of the window per dimension
+     * @return true if the window moved
+     */
+    inline bool moveWindow(const index_t &offset)
+    {
+        const index_t min_bundle_index = minBundleIndex(offset);
+        if (min_bundle_index == this->getMinBundleIndex())
+            return false;
+
+        /// bundles reference the layers, a bundle leaves before its distributions do
+        this->bundle_storage_->template set<cis::option::tags::array_offset>(min_bundle_index);
+        for (std::size_t i=0; i<this->bin_count; ++i)
+            this->storage_[i]->template set<cis::option::tags::array_offset>(offset);
+
+        this->min_bundle_index_ = min_bundle_index;
+        this->max_bundle_index_ = min_bundle_index + cslibs_math::common::cast<int>(this->size_ * 2ul) - 1;
+        return true;
+    }
+
+    /**
+     * @brief Get the first distribution index of the window.
+     */
+    inline index_t getWindowOffset() const
+    {
+        index_t offset;
+        const index_t min_bundle_index = this->getMinBundleIndex();
+        for (std::size_t i=0; i<Dim; ++i)
+            offset[i] = min_bundle_index[i] / 2;
+        return offset;
+    }
+
+private:
+    static inline index_t minBundleIndex(const index_t &offset)
+    {
+        index_t min_bundle_index;
+        for (std::size_t i=0; i<Dim; ++i)
+            min_bundle_index[i] = 2 * offset[i];
+        return min_bundle_index;
+    }
+
+    static inline index_t windowOffset(const point_t &center_m,
+                                       const T       &resolution,
+                                       const size_t  &size)
+    {
+        index_t offset;
+        for (std::size_t i=0; i<Dim; ++i)
+            offset[i] = static_cast<int>(std::floor(center_m(i) / resolution)) - static_cast<int>(size[i] / 2);
+        return offset;
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_MAP_ROLLING_MAP_HPP
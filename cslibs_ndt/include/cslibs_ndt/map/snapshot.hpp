@@ -0,0 +1,345 @@
+#ifndef CSLIBS_NDT_MAP_SNAPSHOT_HPP
+#define CSLIBS_NDT_MAP_SNAPSHOT_HPP
+
+#include <cslibs_ndt/map/frozen_map.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Versioned read-only view of a map. The map is split into tiles of
+ *        tile_size^Dim bundles, every tile is frozen on its own and shared with
+ *        the previous version if it did not change. Publishing a new version only
+ *        freezes the tiles the map reported as modified (see AbstractMap::trackChanges),
+ *        the cost therefore depends on the changed data instead of the map size.
+ *        The tiles are held in chunks of 64 tiles, a new version copies the
+ *        chunks with changed tiles and shares all others with the previous one.
+ *        A reader keeps its version alive through the shared pointer while the
+ *        writer continues inserting, e.g. exchanged via std::atomic_load / std::atomic_store.
+ */
+template <std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T>
+class EIGEN_ALIGN16 Snapshot
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    using allocator_t   = Eigen::aligned_allocator<Snapshot<Dim,data_t,T>>;
+
+    using ConstPtr      = std::shared_ptr<const Snapshot<Dim,data_t,T>>;
+    using Ptr           = std::shared_ptr<Snapshot<Dim,data_t,T>>;
+
+    using tile_t        = FrozenMap<Dim,data_t,T>;
+    using tile_ptr_t    = typename tile_t::ConstPtr;
+    using pose_t        = typename tile_t::pose_t;
+    using transform_t   = typename tile_t::transform_t;
+    using point_t       = typename tile_t::point_t;
+    using index_t       = typename tile_t::index_t;
+    using entry_t       = typename tile_t::entry_t;
+    using bundle_t      = typename tile_t::bundle_t;
+    using inverse_sensor_model_t = typename tile_t::inverse_sensor_model_t;
+
+    static constexpr std::size_t bin_count   = tile_t::bin_count;
+    /// 8^2 tiles per chunk in 2D, 4^3 in 3D
+    static constexpr int         chunk_bits  = 6 / static_cast<int>(Dim);
+    static constexpr int         chunk_size  = 1 << chunk_bits;
+    static constexpr std::size_t chunk_tiles = 1ul << (chunk_bits * Dim);
+
+    /// a chunk is immutable once published, versions share it by pointer
+    struct chunk_t
+    {
+        std::array<tile_ptr_t, chunk_tiles> tiles;
+        std::size_t                         count = 0;
+    };
+    using chunk_ptr_t = std::shared_ptr<const chunk_t>;
+
+    /**
+     * @brief Publish a version of the map. Has to be called by the thread which
+     *        modifies the map, since the changes recorded by the map are consumed.
+     * @param map       the map, change tracking has to be enabled
+     * @param previous  the last published version, everything is frozen if not set
+     */
+    template <tags::option option_t,
+              template <typename, typename, typename...> class backend_t,
+              template <typename, typename, typename...> class dynamic_backend_t>
+    explicit inline Snapshot(Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t> &map,
+                             const ConstPtr &previous = ConstPtr()) :
+        resolution_(map.getResolution()),
+        bundle_resolution_(map.getBundleResolution()),
+        bundle_resolution_inv_(1.0 / bundle_resolution_),
+        w_T_m_(map.getInitialOrigin()),
+        m_T_w_(w_T_m_.inverse()),
+        min_bundle_index_(map.getMinBundleIndex()),
+        max_bundle_index_(map.getMaxBundleIndex()),
+        tile_size_(static_cast<int>(map.getChangeTileSize())),
+        version_(previous ? previous->version_ + 1 : 0ul),
+        tile_count_(0)
+    {
+        if (tile_size_ == 0)
+            throw std::runtime_error("[Snapshot]: change tracking of the map is disabled");
+        if (previous && previous->tile_size_ != tile_size_)
+            throw std::runtime_error("[Snapshot]: tile size differs from the previous version");
+
+        std::vector<index_t> changed;
+        map.takeChangedTiles(changed);
+
+        if (previous) {
+            chunks_     = previous->chunks_;
+            tile_count_ = previous->tile_count_;
+        } else {
+            /// every layer distribution belongs to an allocated bundle
+            std::unordered_map<index_t, bool, utility::IndexHash<Dim>> all;
+            map.traverse([this, &all](const index_t &bi, const typename Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::distribution_bundle_t &) {
+                utility::ChangeTracker<Dim>::forEachTile(bi, tile_size_, [&all](const index_t &ti) {
+                    all[ti] = true;
+                });
+            });
+            changed.clear();
+            for (const auto &t : all)
+                changed.emplace_back(t.first);
+        }
+
+        /// the chunks with changed tiles are copied once, the others stay shared
+        std::unordered_map<index_t, std::shared_ptr<chunk_t>, utility::IndexHash<Dim>> modified;
+        for (const index_t &ti : changed) {
+            index_t lo, hi;
+            for (std::size_t i=0; i<Dim; ++i) {
+                lo[i] = ti[i] * tile_size_;
+                hi[i] = lo[i] + tile_size_ - 1;
+            }
+
+            tile_ptr_t tile(new tile_t(map, lo, hi));
+            if (tile->bundleCount() == 0)
+                tile.reset();
+
+            const index_t ci = toChunkIndex(ti);
+            std::shared_ptr<chunk_t> &chunk = modified[ci];
+            if (!chunk) {
+                const auto it = chunks_.find(ci);
+                chunk.reset(it == chunks_.end() ? new chunk_t : new chunk_t(*it->second));
+            }
+
+            tile_ptr_t &entry = chunk->tiles[toChunkOffset(ti)];
+            if (entry) {
+                --chunk->count;
+                --tile_count_;
+            }
+            if (tile) {
+                ++chunk->count;
+                ++tile_count_;
+            }
+            entry = tile;
+        }
+
+        for (const auto &c : modified) {
+            if (c.second->count > 0)
+                chunks_[c.first] = c.second;
+            else
+                chunks_.erase(c.first);
+        }
+    }
+
+    inline std::size_t version() const
+    {
+        return version_;
+    }
+
+    inline pose_t getInitialOrigin() const
+    {
+        return w_T_m_;
+    }
+
+    inline index_t getMinBundleIndex() const
+    {
+        return min_bundle_index_;
+    }
+
+    inline index_t getMaxBundleIndex() const
+    {
+        return max_bundle_index_;
+    }
+
+    inline T getBundleResolution() const
+    {
+        return bundle_resolution_;
+    }
+
+    inline T getResolution() const
+    {
+        return resolution_;
+    }
+
+    inline std::size_t getTileSize() const
+    {
+        return static_cast<std::size_t>(tile_size_);
+    }
+
+    /**
+     * @brief Get the frozen tile containing a bundle.
+     * @param bi    the bundle index
+     * @return the tile, nullptr if there is no data
+     */
+    inline const tile_t* getTile(const index_t &bi) const
+    {
+        const index_t ti = utility::ChangeTracker<Dim>::toTileIndex(bi, tile_size_);
+        const auto it = chunks_.find(toChunkIndex(ti));
+        return it == chunks_.end() ? nullptr : it->second->tiles[toChunkOffset(ti)].get();
+    }
+
+    /**
+     * @brief Find a bundle, entries have to be resolved through the returned tile.
+     * @param bi    the bundle index
+     * @param tile  the tile holding the bundle
+     * @return the bundle, nullptr if there is no data
+     */
+    inline const bundle_t* getBundle(const index_t &bi,
+                                     const tile_t *&tile) const
+    {
+        tile = getTile(bi);
+        return tile ? tile->getBundle(bi) : nullptr;
+    }
+
+    inline const bundle_t* getBundle(const point_t &p,
+                                     const tile_t *&tile) const
+    {
+        return getBundle(toBundleIndex(p), tile);
+    }
+
+    inline T sample(const point_t &p) const
+    {
+        const tile_t *tile = getTile(toBundleIndex(p));
+        return tile ? tile->sample(p) : T();
+    }
+
+    inline T sampleNonNormalized(const point_t &p) const
+    {
+        const tile_t *tile = getTile(toBundleIndex(p));
+        return tile ? tile->sampleNonNormalized(p) : T();
+    }
+
+    inline T sample(const point_t &p,
+                    const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        const tile_t *tile = getTile(toBundleIndex(p));
+        return tile ? tile->sample(p, ivm) : T();
+    }
+
+    inline T sampleNonNormalized(const point_t &p,
+                                 const typename inverse_sensor_model_t::Ptr &ivm) const
+    {
+        const tile_t *tile = getTile(toBundleIndex(p));
+        return tile ? tile->sampleNonNormalized(p, ivm) : T();
+    }
+
+    inline std::size_t tileCount() const
+    {
+        return tile_count_;
+    }
+
+    inline std::size_t chunkCount() const
+    {
+        return chunks_.size();
+    }
+
+    /**
+     * @brief Number of tiles this version shares with another one.
+     */
+    inline std::size_t sharedTileCount(const Snapshot &other) const
+    {
+        std::size_t shared = 0;
+        for (const auto &c : chunks_) {
+            const auto it = other.chunks_.find(c.first);
+            if (it == other.chunks_.end())
+                continue;
+            if (it->second == c.second) {
+                shared += c.second->count;
+                continue;
+            }
+            for (std::size_t i=0; i<chunk_tiles; ++i)
+                shared += c.second->tiles[i] && c.second->tiles[i] == it->second->tiles[i];
+        }
+        return shared;
+    }
+
+    /**
+     * @brief Number of chunks this version shares with another one by pointer.
+     */
+    inline std::size_t sharedChunkCount(const Snapshot &other) const
+    {
+        std::size_t shared = 0;
+        for (const auto &c : chunks_) {
+            const auto it = other.chunks_.find(c.first);
+            shared += it != other.chunks_.end() && it->second == c.second;
+        }
+        return shared;
+    }
+
+    /**
+     * @brief Memory held by this version, shared chunks and tiles are counted fully.
+     */
+    inline std::size_t getByteSize() const
+    {
+        std::size_t size = sizeof(*this);
+        for (const auto &c : chunks_) {
+            size += sizeof(c) + sizeof(chunk_t);
+            for (const tile_ptr_t &t : c.second->tiles)
+                if (t)
+                    size += t->getByteSize();
+        }
+        return size;
+    }
+
+protected:
+    const T                         resolution_;
+    const T                         bundle_resolution_;
+    const T                         bundle_resolution_inv_;
+    const transform_t               w_T_m_;
+    const transform_t               m_T_w_;
+    const index_t                   min_bundle_index_;
+    const index_t                   max_bundle_index_;
+    const int                       tile_size_;
+    const std::size_t               version_;
+    std::size_t                     tile_count_;
+
+    std::unordered_map<index_t, chunk_ptr_t, utility::IndexHash<Dim>> chunks_;
+
+    static inline index_t toChunkIndex(const index_t &ti)
+    {
+        index_t ci;
+        for (std::size_t i=0; i<Dim; ++i)
+            ci[i] = cslibs_math::common::div(ti[i], chunk_size);
+        return ci;
+    }
+
+    /// position of a tile within its chunk
+    static inline std::size_t toChunkOffset(const index_t &ti)
+    {
+        std::size_t offset = 0;
+        for (std::size_t i=0; i<Dim; ++i)
+            offset |= static_cast<std::size_t>(ti[i] & (chunk_size - 1)) << (chunk_bits * i);
+        return offset;
+    }
+
+    inline index_t toBundleIndex(const point_t &p_w) const
+    {
+        const point_t p_m = m_T_w_ * p_w;
+        index_t retval;
+        for (std::size_t i=0; i<Dim; ++i)
+            retval[i] = static_cast<int>(std::floor(p_m(i) * bundle_resolution_inv_));
+        return retval;
+    }
+};
+
+template <std::size_t Dim, template <typename,std::size_t> class data_t, typename T>
+constexpr int Snapshot<Dim,data_t,T>::chunk_bits;
+template <std::size_t Dim, template <typename,std::size_t> class data_t, typename T>
+constexpr int Snapshot<Dim,data_t,T>::chunk_size;
+template <std::size_t Dim, template <typename,std::size_t> class data_t, typename T>
+constexpr std::size_t Snapshot<Dim,data_t,T>::chunk_tiles;
+}
+}
+
+#endif // CSLIBS_NDT_MAP_SNAPSHOT_HPP
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <cslibs_ndt/matching/line_search.hpp>
+#include <cslibs_ndt/matching/match_traits.hpp>
+#include <cslibs_ndt/matching/parameter.hpp>
+#include <cslibs_ndt/matching/result.hpp>
+#include <cslibs_ndt/utility/parallel.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace matching {
+namespace detail {
+template<int DIMS>
+struct EIGEN_ALIGN16 Accumulator
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    using allocator_t = Eigen::aligned_allocator<Accumulator<DIMS>>;
+
+    inline void reset()
+    {
+        score = 0.0;
+        g.setZero();
+        h.setZero();
+    }
+
+    double                               score;
+    Eigen::Matrix<double, DIMS, 1>       g;
+    Eigen::Matrix<double, DIMS, DIMS>    h;
+};
+
+/// points are evaluated in blocks of fixed size, independent of the thread count
+static constexpr std::size_t BLOCK_SIZE = 512;
+}
+
+template<typename iterator_t, typename ndt_t, typename traits_t = MatchTraits<ndt_t>>
+auto match(const iterator_t& points_begin,
+           const iterator_t& points_end,
+           const ndt_t& map,
+           const typename traits_t::parameter_t& param,
+           const typename ndt_t::transform_t& initial_transform)
+-> Result<typename ndt_t::transform_t>
+{
+    static constexpr int DIMS = traits_t::LINEAR_DIMS + traits_t::ANGULAR_DIMS;
+    using point_t             = typename ndt_t::point_t;
+    using transform_t         = typename ndt_t::transform_t;
+    using result_t            = Result<transform_t>;
+
+    using JacobianCompute = typename traits_t::Jacobian;
+    using HessianCompute  = typename traits_t::Hessian;
+
+    using linear_t      = Eigen::Matrix<double, traits_t::LINEAR_DIMS, 1>;
+    using angular_t     = Eigen::Matrix<double, traits_t::ANGULAR_DIMS, 1>;
+    using gradient_t    = Eigen::Matrix<double, DIMS, 1>;
+    using hessian_t     = Eigen::Matrix<double, DIMS, DIMS>;
+    using accumulator_t = detail::Accumulator<DIMS>;
+
+    // todo: pre transform points, should be externalized or made completely optional...
+    std::vector<point_t> points_prime;
+    points_prime.reserve(std::distance(points_begin, points_end));
+    std::transform(points_begin, points_end, std::back_inserter(points_prime),
+                   [&](const point_t& point) { return initial_transform * point; });
+
+    // every block accumulates on its own, the blocks are reduced in order afterwards,
+    // thus the result is the same for any number of threads
+    const std::size_t blocks = (points_prime.size() + detail::BLOCK_SIZE - 1) / detail::BLOCK_SIZE;
+    std::vector<accumulator_t, typename accumulator_t::allocator_t> partial(blocks);
+
+    // the threads are kept for all evaluations of this call
+    utility::WorkerPool workers(std::min(param.numThreads(), blocks));
+
+    // initialize result
+    double max_score        = std::numeric_limits<double>::lowest();
+    std::size_t iteration   = 0;
+
+    linear_t  linear    = linear_t::Zero();
+    angular_t angular   = angular_t::Zero();
+
+    // initialize state
+    linear_t  linear_old    = linear_t::Zero();
+    angular_t angular_old   = angular_t::Zero();
+    linear_t  linear_delta  = linear_t::Constant(std::numeric_limits<double>::max());
+    angular_t angular_delta = angular_t::Constant(std::numeric_limits<double>::max());
+
+    double lambda = 1.0;
+    std::size_t step_adjustments = 0;
+
+    // termination criteria
+    const auto test_eps = [&]()
+    {
+        return (linear_delta.array().abs() < param.translationEpsilon()).all()
+                && (angular_delta.array().abs() < param.rotationEpsilon()).all();
+    };
+
+    const auto test_readjustments = [&]()
+    {
+        return step_adjustments > 0 && step_adjustments > param.maxStepReadjustments();
+    };
+
+    // termination
+    const auto terminate = [&](Termination reason)
+    {
+        return result_t{
+            max_score,
+                    iteration,
+                    traits_t::makeTransform(linear, angular) * initial_transform,
+                    reason };
+    };
+
+    // score, gradient and Hessian of the state, one pass over all points
+    const auto evaluate = [&](const linear_t& state_linear, const angular_t& state_angular, double& score, gradient_t& g, hessian_t& h)
+    {
+        const auto t = traits_t::makeTransform(state_linear, state_angular);
+
+        JacobianCompute J;
+        JacobianCompute::get(state_angular, J);
+        HessianCompute H;
+        HessianCompute::get(state_angular, H);
+
+        auto process_block = [&](const std::size_t block)
+        {
+            accumulator_t& a = partial[block];
+            a.reset();
+
+            const std::size_t end = std::min(points_prime.size(), (block + 1) * detail::BLOCK_SIZE);
+            for (std::size_t i = block * detail::BLOCK_SIZE; i < end; ++i)
+            {
+                const point_t point = t * points_prime[i];
+                traits_t::computeGradient(map, point, points_prime[i], J, H, param, a.score, a.g, a.h);
+            }
+        };
+        workers.parallel_for(blocks, process_block);
+
+        score = 0.0;
+        g.setZero();
+        h.setZero();
+        for (const accumulator_t& a : partial)
+        {
+            score += a.score;
+            g += a.g;
+            h += a.h;
+        }
+        // the point terms only fill the upper triangle
+        h.template triangularView<Eigen::StrictlyLower>() = h.transpose();
+    };
+
+    double score = 0.0;
+    gradient_t g;
+    hessian_t  h;
+
+    if (param.lineSearch())
+    {
+        evaluate(linear, angular, score, g, h);
+        max_score = score;
+
+        for (iteration = 0; iteration < param.maxIterations(); ++iteration)
+        {
+            // g is the negative score gradient, phi(a) = -score(x + a dp) has the slope g(x + a dp) dp
+            gradient_t dp = h.fullPivLu().solve(g);
+            double dphi_0 = g.dot(dp);
+            if (dphi_0 > 0.0)
+            {
+                dp = -dp;
+                dphi_0 = -dphi_0;
+            }
+            if (!(dphi_0 < 0.0))
+                return terminate(Termination::DELTA_EPSILON);
+
+            // every trial leaves its terms in score, g and h, the accepted one is evaluated last
+            const auto phi = [&](const double a, double& value, double& derivative)
+            {
+                evaluate(linear + a * dp.template head<traits_t::LINEAR_DIMS>(),
+                         angular + a * dp.template tail<traits_t::ANGULAR_DIMS>(),
+                         score, g, h);
+                value = -score;
+                derivative = g.dot(dp);
+            };
+            const double a = moreThuente(phi, -max_score, dphi_0, 1.0, param.maxStepLength(),
+                                         param.sufficientDecrease(), param.curvature(),
+                                         param.maxLineSearchSteps());
+            if (a == 0.0)
+                return terminate(Termination::DELTA_EPSILON);
+
+            max_score = score;
+
+            linear_delta = a * dp.template head<traits_t::LINEAR_DIMS>();
+            linear += linear_delta;
+
+            angular_delta = a * dp.template tail<traits_t::ANGULAR_DIMS>();
+            angular += angular_delta;
+
+            if (test_eps())
+                return terminate(Termination::DELTA_EPSILON);
+        }
+
+        return terminate(Termination::MAX_ITERATIONS);
+    }
+
+    // iterations
+    for (iteration = 0; iteration < param.maxIterations(); ++iteration)
+    {
+        if (test_readjustments())
+            return terminate(Termination::MAX_STEP_READJUSTMENTS);
+
+        evaluate(linear, angular, score, g, h);
+
+        if (score < max_score)
+        {
+            lambda = -lambda;//std::max(1.0, lambda * param.alpha());
+            linear = linear_old;
+            angular = angular_old;
+            ++step_adjustments;
+            continue;
+        }
+
+        if (score > max_score)
+        {
+            max_score = score;
+            lambda = std::min(1.0, lambda / param.alpha());
+            step_adjustments = 0;
+        }
+
+        /// limit H
+        // cslibs_math::statistics::LimitEigenValuesByZero<DIMS>::apply(h);
+        gradient_t dp = h.fullPivLu().solve(g);
+        dp *= lambda;
+
+        linear_old = linear;
+        angular_old = angular;
+
+        linear_delta = dp.template head<traits_t::LINEAR_DIMS>();
+        linear += linear_delta;
+
+        // todo: verify if we have to normalize here
+        angular_delta = dp.template tail<traits_t::ANGULAR_DIMS>();
+        angular += angular_delta;
+
+        if (test_eps())
+            return terminate(Termination::DELTA_EPSILON);
+    }
+
+    return terminate(Termination::MAX_ITERATIONS);
+}
+
+template<typename ndt_t, typename traits_t = MatchTraits<ndt_t>>
+auto match(const ndt_t& src,
+           const ndt_t& dst,
+           const Parameter& param,
+           const typename ndt_t::transform_t& initial_transform)
+-> Result<typename ndt_t::transform_t>
+{
+    static constexpr int DIMS = traits_t::LINEAR_DIMS + traits_t::ANGULAR_DIMS;
+    using transform_t         = typename ndt_t::transform_t;
+    using result_t            = Result<transform_t>;
+
+    using JacobianCompute = typename traits_t::Jacobian;
+    using HessianCompute  = typename traits_t::Hessian;
+
+    using linear_t      = Eigen::Matrix<double, traits_t::LINEAR_DIMS, 1>;
+    using angular_t     = Eigen::Matrix<double, traits_t::ANGULAR_DIMS, 1>;
+    using gradient_t    = Eigen::Matrix<double, DIMS, 1>;
+    using hessian_t     = Eigen::Matrix<double, DIMS, DIMS>;
+    using accumulator_t = detail::Accumulator<DIMS>;
+
+    // every layer accumulates on its own, the layers are reduced in order afterwards,
+    // thus the result is the same for any number of threads
+    std::vector<accumulator_t, typename accumulator_t::allocator_t> partial(ndt_t::bin_count);
+
+    // the threads are kept for all iterations of this call
+    utility::WorkerPool workers(std::min<std::size_t>(param.numThreads(), ndt_t::bin_count));
+
+    // initialize result
+    double max_score        = std::numeric_limits<double>::lowest();
+    std::size_t iteration   = 0;
+
+    // the state is the transform of src itself, it starts at the initial transform
+    linear_t  linear    = initial_transform.translation().data();
+    angular_t angular   = initial_transform.euler();
+
+    // initialize state
+    linear_t  linear_old    = linear;
+    angular_t angular_old   = angular;
+    linear_t  linear_delta  = linear_t::Constant(std::numeric_limits<double>::max());
+    angular_t angular_delta = angular_t::Constant(std::numeric_limits<double>::max());
+
+    double lambda = 1.0;
+    std::size_t step_adjustments = 0;
+
+    // termination criteria
+    const auto test_eps = [&]()
+    {
+        return (linear_delta.array().abs() < param.translationEpsilon()).all()
+                && (angular_delta.array().abs() < param.rotationEpsilon()).all();
+    };
+
+    const auto test_readjustments = [&]()
+    {
+        return step_adjustments > 0 && step_adjustments > param.maxStepReadjustments();
+    };
+
+    // termination
+    const auto terminate = [&](Termination reason)
+    {
+        return result_t{
+                    max_score,
+                    iteration,
+                    traits_t::makeTransform(linear, angular),
+                    reason };
+    };
+
+    // iterations
+    for (iteration = 0; iteration < param.maxIterations(); ++iteration)
+    {
+        if (test_readjustments())
+            return terminate(Termination::MAX_STEP_READJUSTMENTS);
+
+        const auto t = traits_t::makeTransform(linear, angular);
+
+        JacobianCompute J;
+        JacobianCompute::get(angular, J);
+        HessianCompute H;
+        HessianCompute::get(angular, H);
+
+        gradient_t  g = gradient_t::Zero();
+        hessian_t   h = hessian_t::Zero();
+
+        // every distribution of src is matched once, layer by layer
+        auto process_distribution = [&](const std::size_t layer, const typename ndt_t::index_t &, const typename ndt_t::distribution_t &d)
+        {
+            accumulator_t& a = partial[layer];
+            traits_t::computeGradient(dst, layer, d, J, H, t, a.score, a.g, a.h);
+        };
+        for (accumulator_t& a : partial)
+            a.reset();
+        src.traverseDistributionsParallel(process_distribution, workers);
+
+        double score = 0.0;
+        for (const accumulator_t& a : partial)
+        {
+            score += a.score;
+            g += a.g;
+            h += a.h;
+        }
+
+        if (score < max_score)
+        {
+            lambda /= param.alpha();
+            linear = linear_old;
+            angular = angular_old;
+            ++step_adjustments;
+            continue;
+        }
+
+        if (score > max_score)
+        {
+            max_score = score;
+            lambda = std::min(1.0, lambda * param.alpha());
+            step_adjustments = 0;
+        }
+
+        /// limit H
+        // cslibs_math::statistics::LimitEigenValuesByZero<DIMS>::apply(h);
+        gradient_t dp = h.fullPivLu().solve(g);
+        dp *= lambda;
+
+        linear_old = linear;
+        angular_old = angular;
+
+        linear_delta = dp.template head<traits_t::LINEAR_DIMS>();
+        linear += linear_delta;
+
+        // todo: verify if we have to normalize here
+        angular_delta = dp.template tail<traits_t::ANGULAR_DIMS>();
+        angular += angular_delta;
+
+        if (test_eps())
+            return terminate(Termination::DELTA_EPSILON);
+    }
+
+    return terminate(Termination::MAX_ITERATIONS);
+}
+
+
+}
+}
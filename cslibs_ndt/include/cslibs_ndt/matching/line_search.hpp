@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace cslibs_ndt {
+namespace matching {
+namespace detail {
+/// relative width of the bracketing interval below which the search stops
+static constexpr double LINE_SEARCH_INTERVAL_TOLERANCE = 1e-10;
+
+/**
+ * @brief Safeguarded step of More and Thuente (1994). The interval between x and
+ *        y is updated with the trial step t, where x is the best step so far,
+ *        and the next trial step is returned. f are the function values, d the
+ *        derivatives along the search direction.
+ */
+inline double updateInterval(double& x, double& f_x, double& d_x,
+                             double& y, double& f_y, double& d_y,
+                             const double t, const double f_t, const double d_t,
+                             bool& bracketed,
+                             const double min,
+                             const double max)
+{
+    const bool opposite = d_t * std::copysign(1.0, d_x) < 0.0;
+
+    auto cubic_gamma = [](const double theta, const double d_a, const double d_b, const bool clamp)
+    {
+        const double s = std::max(std::abs(theta), std::max(std::abs(d_a), std::abs(d_b)));
+        const double r = (theta / s) * (theta / s) - (d_a / s) * (d_b / s);
+        return s * std::sqrt(clamp ? std::max(0.0, r) : r);
+    };
+
+    double next;
+    if (f_t > f_x) {
+        /// higher value, the minimum is bracketed, prefer the cubic step closer to x
+        const double theta = 3.0 * (f_x - f_t) / (t - x) + d_x + d_t;
+        double gamma = cubic_gamma(theta, d_x, d_t, false);
+        if (t < x)
+            gamma = -gamma;
+        const double r = ((gamma - d_x) + theta) / (((gamma - d_x) + gamma) + d_t);
+        const double cubic = x + r * (t - x);
+        const double quadratic = x + ((d_x / ((f_x - f_t) / (t - x) + d_x)) / 2.0) * (t - x);
+        next = std::abs(cubic - x) < std::abs(quadratic - x) ?
+                    cubic : cubic + (quadratic - cubic) / 2.0;
+        bracketed = true;
+    } else if (opposite) {
+        /// the derivative changes sign, the minimum is bracketed
+        const double theta = 3.0 * (f_x - f_t) / (t - x) + d_x + d_t;
+        double gamma = cubic_gamma(theta, d_x, d_t, false);
+        if (t > x)
+            gamma = -gamma;
+        const double r = ((gamma - d_t) + theta) / (((gamma - d_t) + gamma) + d_x);
+        const double cubic = t + r * (x - t);
+        const double secant = t + (d_t / (d_t - d_x)) * (x - t);
+        next = std::abs(cubic - t) > std::abs(secant - t) ? cubic : secant;
+        bracketed = true;
+    } else if (std::abs(d_t) < std::abs(d_x)) {
+        /// lower value and the derivative decreases in magnitude
+        const double theta = 3.0 * (f_x - f_t) / (t - x) + d_x + d_t;
+        double gamma = cubic_gamma(theta, d_x, d_t, true);
+        if (t > x)
+            gamma = -gamma;
+        const double r = ((gamma - d_t) + theta) / ((gamma + (d_x - d_t)) + gamma);
+        double cubic;
+        if (r < 0.0 && gamma != 0.0)
+            cubic = t + r * (x - t);
+        else
+            cubic = t > x ? max : min;
+        const double secant = t + (d_t / (d_t - d_x)) * (x - t);
+        if (bracketed) {
+            next = std::abs(cubic - t) < std::abs(secant - t) ? cubic : secant;
+            next = t > x ? std::min(t + 0.66 * (y - t), next) : std::max(t + 0.66 * (y - t), next);
+        } else {
+            next = std::abs(cubic - t) > std::abs(secant - t) ? cubic : secant;
+            next = std::max(min, std::min(max, next));
+        }
+    } else {
+        /// lower value and the derivative does not decrease in magnitude
+        if (bracketed) {
+            const double theta = 3.0 * (f_t - f_y) / (y - t) + d_y + d_t;
+            double gamma = cubic_gamma(theta, d_y, d_t, false);
+            if (t > y)
+                gamma = -gamma;
+            const double r = ((gamma - d_t) + theta) / (((gamma - d_t) + gamma) + d_y);
+            next = t + r * (y - t);
+        } else {
+            next = t > x ? max : min;
+        }
+    }
+
+    if (f_t > f_x) {
+        y = t; f_y = f_t; d_y = d_t;
+    } else {
+        if (opposite) {
+            y = x; f_y = f_x; d_y = d_x;
+        }
+        x = t; f_x = f_t; d_x = d_t;
+    }
+    return next;
+}
+}
+
+/**
+ * @brief Line search of More and Thuente (1994) for a step a > 0 satisfying the
+ *        strong Wolfe conditions
+ *            phi(a) <= phi(0) + mu a phi'(0) and |phi'(a)| <= nu |phi'(0)|.
+ *        If they are not met within max_evaluations, the best step so far is taken.
+ * @param phi             evaluates phi(a) and phi'(a), called as phi(a, value, derivative)
+ * @param phi_0           phi(0)
+ * @param dphi_0          phi'(0), has to be negative
+ * @param step            the first trial step
+ * @param max_step        upper bound of the step
+ * @return the step, phi was evaluated at it last, or 0 if no step decreases phi
+ */
+template<typename phi_t>
+inline double moreThuente(const phi_t& phi,
+                          const double phi_0,
+                          const double dphi_0,
+                          const double step,
+                          const double max_step,
+                          const double mu,
+                          const double nu,
+                          const std::size_t max_evaluations)
+{
+    const double slope = mu * dphi_0;
+
+    /// best step and the other end of the interval
+    double x = 0.0, f_x = phi_0, d_x = dphi_0;
+    double y = 0.0, f_y = phi_0, d_y = dphi_0;
+
+    bool bracketed = false;
+    bool modified  = true;
+    double min = 0.0;
+    double max = 5.0 * step;
+    double width     = max_step;
+    double width_old = 2.0 * max_step;
+
+    double t = std::min(step, max_step);
+    double last = 0.0;
+    for (std::size_t i = 0; i < max_evaluations; ++i)
+    {
+        double f_t, d_t;
+        phi(t, f_t, d_t);
+        last = t;
+
+        const double f_test = phi_0 + t * slope;
+        if (modified && f_t <= f_test && d_t >= 0.0)
+            modified = false;
+
+        if (f_t <= f_test && std::abs(d_t) <= -nu * dphi_0)
+            return t;
+        if (t == max_step && f_t <= f_test && d_t <= slope)
+            return t;
+        if (bracketed && (t <= min || t >= max || max - min <= detail::LINE_SEARCH_INTERVAL_TOLERANCE * max))
+            break;
+
+        /// as long as no step has a lower value and a positive derivative, the interval
+        /// is updated with the function shifted by the sufficient decrease line
+        if (modified && f_t <= f_x && f_t > f_test) {
+            double f_xm = f_x - x * slope, d_xm = d_x - slope;
+            double f_ym = f_y - y * slope, d_ym = d_y - slope;
+            t = detail::updateInterval(x, f_xm, d_xm, y, f_ym, d_ym,
+                                       t, f_t - t * slope, d_t - slope,
+                                       bracketed, min, max);
+            f_x = f_xm + x * slope; d_x = d_xm + slope;
+            f_y = f_ym + y * slope; d_y = d_ym + slope;
+        } else {
+            t = detail::updateInterval(x, f_x, d_x, y, f_y, d_y,
+                                       t, f_t, d_t,
+                                       bracketed, min, max);
+        }
+
+        /// bisect if the interval does not shrink fast enough
+        if (bracketed) {
+            if (std::abs(y - x) >= 0.66 * width_old)
+                t = x + 0.5 * (y - x);
+            width_old = width;
+            width = std::abs(y - x);
+            min = std::min(x, y);
+            max = std::max(x, y);
+        } else {
+            min = t + 1.1 * (t - x);
+            max = t + 4.0 * (t - x);
+        }
+        t = std::max(0.0, std::min(max_step, t));
+
+        if (bracketed && (t <= min || t >= max || max - min <= detail::LINE_SEARCH_INTERVAL_TOLERANCE * max))
+            break;
+    }
+
+    if (x > 0.0 && x != last) {
+        double f, d;
+        phi(x, f, d);
+    }
+    return x;
+}
+
+}
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cslibs_ndt/matching/generic_match.hpp>
+#include <cslibs_ndt/matching/pyramid_parameter.hpp>
+#include <cslibs_ndt/map/pyramid.hpp>
+#include <cslibs_ndt/utility/index_hash.hpp>
+
+#include <unordered_map>
+
+namespace cslibs_ndt {
+namespace matching {
+namespace detail {
+/**
+ * @brief Replace the points of every voxel by their centroid, voxels keep the
+ *        order in which they are first hit.
+ */
+template<typename iterator_t, typename point_t>
+inline void downsample(const iterator_t& points_begin,
+                       const iterator_t& points_end,
+                       const double size,
+                       std::vector<point_t>& points)
+{
+    static constexpr std::size_t Dim = point_t::Dimension;
+    using index_t  = std::array<int, Dim>;
+    using vector_t = Eigen::Matrix<double, Dim, 1>;
+
+    points.clear();
+    if (size <= 0.0) {
+        points.assign(points_begin, points_end);
+        return;
+    }
+
+    std::unordered_map<index_t, std::size_t, utility::IndexHash<Dim>> voxels;
+    std::vector<vector_t, Eigen::aligned_allocator<vector_t>> sums;
+    std::vector<std::size_t> counts;
+    for (iterator_t it = points_begin; it != points_end; ++it)
+    {
+        index_t index;
+        for (std::size_t i = 0; i < Dim; ++i)
+            index[i] = static_cast<int>(std::floor(it->data()(i) / size));
+
+        const auto inserted = voxels.emplace(index, sums.size());
+        if (inserted.second)
+        {
+            sums.emplace_back(vector_t::Zero());
+            counts.emplace_back(0);
+        }
+        sums[inserted.first->second] += it->data();
+        ++counts[inserted.first->second];
+    }
+
+    points.reserve(sums.size());
+    for (std::size_t i = 0; i < sums.size(); ++i)
+        points.emplace_back(vector_t(sums[i] / static_cast<double>(counts[i])));
+}
+
+/**
+ * @brief Translation and rotation angle taking one transform to the other.
+ */
+template<typename point_t, typename transform_t>
+inline void difference(const transform_t& a,
+                       const transform_t& b,
+                       double& translation,
+                       double& rotation)
+{
+    static constexpr std::size_t Dim = point_t::Dimension;
+    using vector_t = Eigen::Matrix<double, Dim, 1>;
+
+    const transform_t delta = a.inverse() * b;
+    translation = delta.translation().data().norm();
+
+    /// the trace of a rotation by an angle a is Dim - 2 + 2 cos(a)
+    double trace = 0.0;
+    for (std::size_t i = 0; i < Dim; ++i)
+        trace += (delta * point_t(vector_t(vector_t::Unit(i)))).data()(i) - delta.translation().data()(i);
+    const double c = 0.5 * (trace - static_cast<double>(Dim) + 2.0);
+    rotation = std::acos(std::max(-1.0, std::min(1.0, c)));
+}
+}
+
+/**
+ * @brief Match a scan against the levels of a pyramid from the coarsest to level 0.
+ *        Each level matches the scan downsampled to its resolution, starting at the
+ *        result of the level above. Once a level does not move its initial guess
+ *        beyond the agreement thresholds, the intermediate levels are skipped,
+ *        level 0 is always matched so that the accuracy is that of the full map. The
+ *        MatchTraits of the maps have to be included, e.g. by the match header of
+ *        the 2d or 3d package.
+ */
+template<typename iterator_t, typename pyramid_t, typename parameter_t>
+auto match(const iterator_t& points_begin,
+           const iterator_t& points_end,
+           const pyramid_t& pyramid,
+           const PyramidParameter<parameter_t>& param,
+           const typename pyramid_t::map_t::transform_t& initial_transform)
+-> PyramidResult<typename pyramid_t::map_t::transform_t>
+{
+    using point_t     = typename pyramid_t::point_t;
+    using transform_t = typename pyramid_t::map_t::transform_t;
+    using result_t    = PyramidResult<transform_t>;
+
+    const parameter_t& level_param = param;
+    const std::size_t levels = pyramid.getLevelCount();
+
+    result_t result(levels);
+    result.transform() = initial_transform;
+
+    std::vector<point_t> points;
+    for (std::size_t level = levels; level-- > 0;)
+    {
+        detail::downsample(points_begin, points_end, param.voxelRatio() * pyramid.getResolution(level), points);
+
+        const Result<transform_t> r = level == 0 ?
+                    match(points.begin(), points.end(), *pyramid.getMap(), level_param, result.transform()) :
+                    match(points.begin(), points.end(), pyramid.getLevel(level), level_param, result.transform());
+
+        double translation, rotation;
+        detail::difference<point_t>(result.transform(), r.transform(), translation, rotation);
+
+        result.score()       = r.score();
+        result.iterations() += r.iterations();
+        result.transform()   = r.transform();
+        result.termination() = r.termination();
+        result.levelIterations()[level] = r.iterations();
+
+        /// continue at level 0, the next iteration decrements the level
+        if (level > 1 && level + 1 < levels &&
+                translation < param.agreementTranslation() &&
+                rotation < param.agreementRotation()) {
+            result.level() = level;
+            level = 1;
+        }
+    }
+
+    return result;
+}
+
+}
+}
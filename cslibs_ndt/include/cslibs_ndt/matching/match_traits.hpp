@@ -21,14 +21,20 @@ Required Interface:
 
     using point_t       = void;
     using transform_t   = void;
+    using parameter_t   = void;
 
     static transform_t makeTransform(const Eigen::Matrix<double, LINEAR_DIMS, 1>& linear,
                                      const Eigen::Matrix<double, ANGULAR_DIMS, 1>& angular);
 
+    // may be called concurrently for different points, the map must not be modified,
+    // only the upper triangle of h has to be filled, point is source transformed by
+    // the current state, the partials in the angular parameters are taken at source
     static void computeGradient(const MapT& map,
                                 const point_t& point,
+                                const point_t& source,
                                 const Jacobian& J,
                                 const Hessian& H,
+                                const parameter_t& param,
                                 double& score,
                                 gradient_t& g,
                                 hessian_t& h);
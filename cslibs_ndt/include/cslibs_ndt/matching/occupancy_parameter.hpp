@@ -14,7 +14,8 @@ public:
                                 const InverseModel& inverse_model,
                                 double occupancy_threshold = 0.0) :
             Parameter(parameter),
-            inverse_model_(inverse_model)
+            inverse_model_(inverse_model),
+            occupancy_threshold_(occupancy_threshold)
     {}
 
     InverseModel& inverseModel() { return inverse_model_; }
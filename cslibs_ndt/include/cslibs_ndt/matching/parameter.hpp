@@ -13,7 +13,13 @@ public:
         translation_epsilon_(1e-3),
         rotation_epsilon_(1e-3),
         max_step_readjustments_(5),
-        alpha_(1.1)
+        alpha_(1.1),
+        num_threads_(1),
+        line_search_(false),
+        max_line_search_steps_(10),
+        sufficient_decrease_(1e-4),
+        curvature_(0.9),
+        max_step_length_(16.0)
     {
     }
 
@@ -21,12 +27,19 @@ public:
                        double translation_epsilon,
                        double rotation_epsilon,
                        std::size_t max_step_readjustments,
-                       double alpha) :
+                       double alpha,
+                       std::size_t num_threads = 1) :
             max_iterations_(max_iterations),
             translation_epsilon_(translation_epsilon),
             rotation_epsilon_(rotation_epsilon),
             max_step_readjustments_(max_step_readjustments),
-            alpha_(alpha)
+            alpha_(alpha),
+            num_threads_(num_threads),
+            line_search_(false),
+            max_line_search_steps_(10),
+            sufficient_decrease_(1e-4),
+            curvature_(0.9),
+            max_step_length_(16.0)
     {}
 
     std::size_t maxIterations() const { return max_iterations_; }
@@ -34,12 +47,30 @@ public:
     double rotationEpsilon() const { return rotation_epsilon_; }
     std::size_t maxStepReadjustments() const { return max_step_readjustments_; }
     double alpha() const { return alpha_; }
+    std::size_t numThreads() const { return num_threads_; }
+
+    /// scan matching replaces the step control by a More-Thuente line search along the Newton step,
+    /// alpha() and maxStepReadjustments() are not used then
+    bool lineSearch() const { return line_search_; }
+    /// score evaluations per line search
+    std::size_t maxLineSearchSteps() const { return max_line_search_steps_; }
+    /// strong Wolfe conditions on the negated score, mu for the sufficient decrease, nu for the curvature
+    double sufficientDecrease() const { return sufficient_decrease_; }
+    double curvature() const { return curvature_; }
+    /// longest step in multiples of the Newton step
+    double maxStepLength() const { return max_step_length_; }
 
     std::size_t& maxIterations() { return max_iterations_; }
     double& translationEpsilon() { return translation_epsilon_; }
     double& rotationEpsilon() { return rotation_epsilon_; }
     std::size_t& maxStepReadjustments() { return max_step_readjustments_; }
     double& alpha() { return alpha_; }
+    std::size_t& numThreads() { return num_threads_; }
+    bool& lineSearch() { return line_search_; }
+    std::size_t& maxLineSearchSteps() { return max_line_search_steps_; }
+    double& sufficientDecrease() { return sufficient_decrease_; }
+    double& curvature() { return curvature_; }
+    double& maxStepLength() { return max_step_length_; }
 
 
 private:
@@ -48,6 +79,12 @@ private:
     double rotation_epsilon_;
     std::size_t max_step_readjustments_;
     double alpha_;
+    std::size_t num_threads_;
+    bool line_search_;
+    std::size_t max_line_search_steps_;
+    double sufficient_decrease_;
+    double curvature_;
+    double max_step_length_;
 };
 
 }
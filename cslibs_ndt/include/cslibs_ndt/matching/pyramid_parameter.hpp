@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cslibs_ndt/matching/parameter.hpp>
+
+namespace cslibs_ndt {
+namespace matching {
+
+/**
+ * @brief Parameters of coarse to fine matching, the base parameters are used on
+ *        every level of the pyramid.
+ */
+template<typename parameter_t>
+class PyramidParameter : public parameter_t
+{
+public:
+    /**
+     * @param parameter             parameters of a single level
+     * @param voxel_ratio           edge length of the voxels the scan is downsampled
+     *                              to relative to the resolution of a level, zero
+     *                              keeps all points
+     * @param agreement_translation levels agree if a level moves its initial
+     *                              guess by less than this translation ...
+     * @param agreement_rotation    ... and by less than this angle
+     */
+    explicit PyramidParameter(const parameter_t& parameter,
+                              double voxel_ratio = 0.25,
+                              double agreement_translation = 1e-2,
+                              double agreement_rotation = 1e-3) :
+            parameter_t(parameter),
+            voxel_ratio_(voxel_ratio),
+            agreement_translation_(agreement_translation),
+            agreement_rotation_(agreement_rotation)
+    {}
+
+    double voxelRatio() const { return voxel_ratio_; }
+    double agreementTranslation() const { return agreement_translation_; }
+    double agreementRotation() const { return agreement_rotation_; }
+
+    double& voxelRatio() { return voxel_ratio_; }
+    double& agreementTranslation() { return agreement_translation_; }
+    double& agreementRotation() { return agreement_rotation_; }
+
+private:
+    double voxel_ratio_;
+    double agreement_translation_;
+    double agreement_rotation_;
+};
+
+}
+}
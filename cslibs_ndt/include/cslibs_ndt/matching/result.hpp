@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 #include <eigen3/Eigen/Eigen>
 
 namespace cslibs_ndt {
@@ -45,6 +46,33 @@ protected:
     Termination termination_;
 };
 
+/**
+ * @brief Result of coarse to fine matching, iterations() is the sum over all levels.
+ */
+template<typename transform_t>
+class EIGEN_ALIGN16 PyramidResult : public Result<transform_t>
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    explicit PyramidResult(std::size_t levels = 0) :
+            level_(0),
+            level_iterations_(levels, 0)
+    {}
+
+    /// the level at which the levels agreed, the ones between it and level 0 were
+    /// skipped, zero if every level was matched
+    std::size_t                     level()             const { return level_; }
+    const std::vector<std::size_t>& levelIterations()   const { return level_iterations_; }
+
+    std::size_t&                    level()             { return level_; }
+    std::vector<std::size_t>&       levelIterations()   { return level_iterations_; }
+
+protected:
+    std::size_t              level_;
+    std::vector<std::size_t> level_iterations_;
+};
+
 }
 }
 
@@ -72,4 +100,15 @@ inline std::string to_string(const cslibs_ndt::matching::Result<transform_t>& re
     s += "termination: " + std::to_string(result.termination());
     return s;
 }
+
+template<typename transform_t>
+inline std::string to_string(const cslibs_ndt::matching::PyramidResult<transform_t>& result)
+{
+    std::string s = to_string(static_cast<const cslibs_ndt::matching::Result<transform_t>&>(result)) + "\n";
+    s += "level      : " + std::to_string(result.level()) + "\n";
+    s += "per level  :";
+    for (std::size_t iterations : result.levelIterations())
+        s += " " + std::to_string(iterations);
+    return s;
+}
 }
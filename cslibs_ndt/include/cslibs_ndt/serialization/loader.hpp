@@ -56,21 +56,14 @@ struct loader<cslibs_ndt::map::tags::static_map,Dim,data_t,T,backend_t,dynamic_b
     }
 
     inline void allocateBundles(const std::shared_ptr<bundle_storage_t>& bundles,
-                                const storages_t& storages) const
+                                const storages_t&) const
     {
         bundles->template set<cslibs_indexed_storage::option::tags::array_size>(size_ * 2ul);
         bundles->template set<cslibs_indexed_storage::option::tags::array_offset>(min_index_);
 
-        auto allocate_bundle = [&storages, &bundles](const index_t &bi) {
-            typename map_t::distribution_bundle_t b;
-            const typename map_t::index_list_t indices =
-                    utility::generate_indices<typename map_t::index_list_t,Dim>(bi);
-            for (std::size_t i = 0 ; i < map_t::bin_count ; ++i)
-                b[i] = storages[i]->get(indices[i]);
-            bundles->insert(bi, b);
-        };
+        /// the map binds the bundles to the layers on construction
         for (const index_t &index : indices_)
-            allocate_bundle(index);
+            bundles->insert(index, typename map_t::distribution_bundle_t());
     }
 
     inline void setMap(typename map_t::Ptr &map,
@@ -122,18 +115,11 @@ struct loader<cslibs_ndt::map::tags::dynamic_map,Dim,data_t,T,backend_t,dynamic_
     }
 
     inline void allocateBundles(const std::shared_ptr<bundle_storage_t>& bundles,
-                                const storages_t& storages) const
+                                const storages_t&) const
     {
-        auto allocate_bundle = [&storages, &bundles](const index_t &bi) {
-            typename map_t::distribution_bundle_t b;
-            const typename map_t::index_list_t indices =
-                    utility::generate_indices<typename map_t::index_list_t,Dim>(bi);
-            for (std::size_t i = 0 ; i < map_t::bin_count ; ++i)
-                b[i] = storages[i]->get(indices[i]);
-            bundles->insert(bi, b);
-        };
+        /// the map binds the bundles to the layers on construction
         for (const index_t &index : indices_)
-            allocate_bundle(index);
+            bundles->insert(index, typename map_t::distribution_bundle_t());
     }
 
     inline void setMap(typename map_t::Ptr &map,
@@ -0,0 +1,291 @@
+#ifndef CSLIBS_NDT_SERIALIZATION_SPILL_FILE_HPP
+#define CSLIBS_NDT_SERIALIZATION_SPILL_FILE_HPP
+
+#include <cslibs_ndt/serialization/binary.hpp>
+#include <cslibs_ndt/utility/index_hash.hpp>
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+namespace cslibs_ndt {
+namespace serialization {
+/**
+ * @brief Temporary file holding the distributions of evicted map tiles. A record
+ *        consists of the bundle indices of a tile and the distributions per layer,
+ *        written with the binary serialization of the distributions. Records are
+ *        appended, the space of records which were read back is reclaimed once it
+ *        makes up half of the file. The file is removed when closed.
+ */
+template <typename distribution_t, std::size_t Dim, std::size_t bin_count>
+class SpillFile
+{
+public:
+    using index_t        = std::array<int,Dim>;
+    using index_vector_t = std::vector<index_t>;
+    using layers_t       = std::array<index_vector_t,bin_count>;
+
+    static constexpr std::size_t min_compact = 1ul << 20;
+
+    inline SpillFile() :
+        size_(0),
+        dead_(0)
+    {
+    }
+
+    inline SpillFile(SpillFile &&other) :
+        path_(std::move(other.path_)),
+        out_(std::move(other.out_)),
+        in_(std::move(other.in_)),
+        records_(std::move(other.records_)),
+        size_(other.size_),
+        dead_(other.dead_)
+    {
+        other.path_.clear();
+    }
+
+    SpillFile(const SpillFile &other) = delete;
+    SpillFile& operator = (const SpillFile &other) = delete;
+
+    inline ~SpillFile()
+    {
+        close();
+    }
+
+    /**
+     * @brief Create the file, an existing file is truncated.
+     * @param path          the file path, a unique file in the temporary directory if empty
+     * @return false if the file cannot be opened
+     */
+    inline bool open(const std::string &path)
+    {
+        close();
+        const std::string file = path.empty() ? createTemporary() : path;
+        if (file.empty()) {
+            std::cerr << "Could not create a temporary spill file" << std::endl;
+            return false;
+        }
+
+        std::ofstream create(file, std::ios::binary | std::ios::trunc);
+        if (!create.is_open()) {
+            std::cerr << "Could not open '" << file << "'" << std::endl;
+            return false;
+        }
+        create.close();
+
+        path_ = file;
+        return reopen();
+    }
+
+    inline const std::string& getPath() const
+    {
+        return path_;
+    }
+
+    inline void close()
+    {
+        if (path_.empty())
+            return;
+
+        out_.close();
+        in_.close();
+        std::remove(path_.c_str());
+        path_.clear();
+        records_.clear();
+        size_ = 0;
+        dead_ = 0;
+    }
+
+    inline bool isOpen() const
+    {
+        return !path_.empty();
+    }
+
+    inline bool contains(const index_t &tile) const
+    {
+        return records_.find(tile) != records_.end();
+    }
+
+    /**
+     * @brief Append the record of a tile.
+     * @param tile          the tile index
+     * @param bundles       the bundle indices of the tile
+     * @param layers        the distribution indices per layer
+     * @param storages      the layer storages holding the distributions
+     */
+    template <typename storage_array_t>
+    inline void write(const index_t         &tile,
+                      const index_vector_t  &bundles,
+                      const layers_t        &layers,
+                      const storage_array_t &storages)
+    {
+        const std::streamoff offset = out_.tellp();
+        cslibs_math::serialization::io<std::size_t>::write(bundles.size(), out_);
+        for (const index_t &bi : bundles)
+            cslibs_math::serialization::array::binary<int,Dim>::write(bi, out_);
+        for (std::size_t i=0; i<bin_count; ++i) {
+            cslibs_math::serialization::io<std::size_t>::write(layers[i].size(), out_);
+            for (const index_t &index : layers[i]) {
+                cslibs_math::serialization::array::binary<int,Dim>::write(index, out_);
+                cslibs_ndt::write(*storages[i]->get(index), out_);
+            }
+        }
+        out_.flush();
+        if (!out_)
+            throw std::runtime_error("[SpillFile]: cannot write to '" + path_ + "'");
+
+        const std::size_t bytes = static_cast<std::size_t>(out_.tellp() - offset);
+        records_[tile] = record_t{offset, bytes};
+        size_ += bytes;
+    }
+
+    /**
+     * @brief Read the record of a tile, the record is kept.
+     * @param tile          the tile index
+     * @param bundles       the bundle indices of the tile
+     * @param insert        called with the layer, the index and the distribution
+     * @return false if there is no record of the tile
+     */
+    template <typename insert_t>
+    inline bool read(const index_t   &tile,
+                     index_vector_t  &bundles,
+                     const insert_t  &insert) const
+    {
+        const auto it = records_.find(tile);
+        if (it == records_.end())
+            return false;
+
+        in_.clear();
+        in_.seekg(it->second.offset);
+        bundles.resize(cslibs_math::serialization::io<std::size_t>::read(in_));
+        for (index_t &bi : bundles)
+            cslibs_math::serialization::array::binary<int,Dim>::read(in_, bi);
+        for (std::size_t i=0; i<bin_count; ++i) {
+            const std::size_t count = cslibs_math::serialization::io<std::size_t>::read(in_);
+            for (std::size_t j=0; j<count; ++j) {
+                index_t index;
+                distribution_t d;
+                cslibs_math::serialization::array::binary<int,Dim>::read(in_, index);
+                cslibs_ndt::read(in_, d);
+                insert(i, index, d);
+            }
+        }
+        if (!in_)
+            throw std::runtime_error("[SpillFile]: cannot read from '" + path_ + "'");
+        return true;
+    }
+
+    /**
+     * @brief Drop the record of a tile.
+     */
+    inline void erase(const index_t &tile)
+    {
+        const auto it = records_.find(tile);
+        if (it == records_.end())
+            return;
+
+        dead_ += it->second.bytes;
+        records_.erase(it);
+        if (dead_ > min_compact && 2 * dead_ > size_)
+            compact();
+    }
+
+    /**
+     * @brief Get the number of records.
+     */
+    inline std::size_t records() const
+    {
+        return records_.size();
+    }
+
+    /**
+     * @brief Get the size of the file in bytes, including reclaimable space.
+     */
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    struct record_t
+    {
+        std::streamoff offset;
+        std::size_t    bytes;
+    };
+
+    std::string                                                   path_;
+    std::ofstream                                                 out_;
+    mutable std::ifstream                                         in_;
+    std::unordered_map<index_t, record_t, utility::IndexHash<Dim>> records_;
+    std::size_t                                                   size_;
+    std::size_t                                                   dead_;
+
+    /// a unique empty file in TMPDIR or /tmp, empty if it cannot be created
+    static inline std::string createTemporary()
+    {
+        const char *dir = std::getenv("TMPDIR");
+        const std::string pattern = std::string((dir && *dir) ? dir : "/tmp") + "/cslibs_ndt_spill_XXXXXX";
+        std::vector<char> name(pattern.begin(), pattern.end());
+        name.emplace_back('\0');
+        const int fd = ::mkstemp(name.data());
+        if (fd < 0)
+            return std::string();
+        ::close(fd);
+        return std::string(name.data());
+    }
+
+    inline bool reopen()
+    {
+        out_.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+        out_.seekp(0, std::ios::end);
+        in_.open(path_, std::ios::binary);
+        if (!out_.is_open() || !in_.is_open()) {
+            std::cerr << "Could not open '" << path_ << "'" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /// copy the live records into a new file
+    inline void compact()
+    {
+        const std::string tmp = path_ + ".tmp";
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        std::vector<char> buffer;
+        std::streamoff offset = 0;
+        for (auto &r : records_) {
+            buffer.resize(r.second.bytes);
+            in_.clear();
+            in_.seekg(r.second.offset);
+            in_.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            r.second.offset = offset;
+            offset += static_cast<std::streamoff>(r.second.bytes);
+        }
+        out.close();
+        if (!in_ || !out)
+            throw std::runtime_error("[SpillFile]: cannot compact '" + path_ + "'");
+
+        out_.close();
+        in_.close();
+        if (std::rename(tmp.c_str(), path_.c_str()) != 0 || !reopen())
+            throw std::runtime_error("[SpillFile]: cannot replace '" + path_ + "'");
+        size_ = static_cast<std::size_t>(offset);
+        dead_ = 0;
+    }
+};
+
+template <typename distribution_t, std::size_t Dim, std::size_t bin_count>
+constexpr std::size_t SpillFile<distribution_t,Dim,bin_count>::min_compact;
+}
+}
+
+#endif // CSLIBS_NDT_SERIALIZATION_SPILL_FILE_HPP
@@ -5,16 +5,9 @@
 #include <cslibs_indexed_storage/backend/kdtree/kdtree.hpp>
 #include <cslibs_indexed_storage/backend/array/array.hpp>
 
-#include <cslibs_ndt/common/distribution.hpp>
-#include <cslibs_ndt/common/occupancy_distribution.hpp>
-#include <cslibs_ndt/common/weighted_occupancy_distribution.hpp>
+#include <cslibs_ndt/serialization/binary.hpp>
 #include <cslibs_ndt/serialization/filesystem.hpp>
-
-#include <cslibs_math/serialization/array.hpp>
-#include <cslibs_math/serialization/distribution.hpp>
-#include <cslibs_math/serialization/weighted_distribution.hpp>
-#include <cslibs_math/serialization/stable_distribution.hpp>
-#include <cslibs_math/serialization/stable_weighted_distribution.hpp>
+#include <cslibs_ndt/utility/morton_order.hpp>
 
 #include <fstream>
 #include <yaml-cpp/yaml.h>
@@ -22,65 +15,6 @@
 namespace cis = cslibs_indexed_storage;
 
 namespace cslibs_ndt {
-template <typename Tp, std::size_t Size>
-void write(const Distribution<Tp,Size> &d, std::ofstream &out)
-{
-    cslibs_math::serialization::binary<cslibs_math::statistics::StableDistribution,Tp,Size,3>::write(d.data(), out);
-}
-
-template <typename Tp, template <typename,std::size_t> class T, std::size_t Size>
-std::size_t read(std::ifstream &in, T<Tp,Size> &d)
-{
-    return cslibs_math::serialization::binary<cslibs_math::statistics::StableDistribution,Tp,Size,3>::read(in, d.data());
-}
-
-template<typename Tp, std::size_t Size>
-void write(const OccupancyDistribution<Tp,Size> &d, std::ofstream &out)
-{
-    cslibs_math::serialization::io<std::size_t>::write(d.numFree(), out);
-    if (!d.getDistribution())
-        cslibs_math::serialization::binary<cslibs_math::statistics::StableDistribution,Tp,Size,3>::write(out);
-    else
-        cslibs_math::serialization::binary<cslibs_math::statistics::StableDistribution,Tp,Size,3>::write(*(d.getDistribution()), out);
-}
-
-template<typename Tp, std::size_t Size>
-std::size_t read(std::ifstream &in, OccupancyDistribution<Tp,Size> &d)
-{
-    std::size_t f = cslibs_math::serialization::io<std::size_t>::read(in);
-    d = OccupancyDistribution<Tp,Size>(f);
-    typename OccupancyDistribution<Tp,Size>::distribution_t tmp;
-    std::size_t r = cslibs_math::serialization::binary<cslibs_math::statistics::StableDistribution,Tp,Size,3>::read(in,tmp);
-    if (tmp.getN() != 0)
-        d.getDistribution().reset(new typename OccupancyDistribution<Tp,Size>::distribution_t(tmp));
-    return sizeof(std::size_t) + r;
-}
-
-template<typename Tp, std::size_t Size>
-void write(const WeightedOccupancyDistribution<Tp,Size> &d, std::ofstream &out)
-{
-    cslibs_math::serialization::io<std::size_t>::write(d.numFree(), out);
-    cslibs_math::serialization::io<Tp>::write(d.weightFree(), out);
-    if (!d.getDistribution())
-        cslibs_math::serialization::binary<cslibs_math::statistics::StableWeightedDistribution,Tp,Size,3>::write(out);
-    else
-        cslibs_math::serialization::binary<cslibs_math::statistics::StableWeightedDistribution,Tp,Size,3>::write(*(d.getDistribution()), out);
-}
-
-template<typename Tp, std::size_t Size>
-std::size_t read(std::ifstream &in, WeightedOccupancyDistribution<Tp,Size> &d)
-{
-    std::size_t n = cslibs_math::serialization::io<std::size_t>::read(in);
-    Tp f = cslibs_math::serialization::io<Tp>::read(in);
-    using distr_t = typename WeightedOccupancyDistribution<Tp,Size>::distribution_t;
-    distr_t tmp;
-    std::size_t r = cslibs_math::serialization::binary<cslibs_math::statistics::StableWeightedDistribution,Tp,Size,3>::read(in,tmp);
-    d = WeightedOccupancyDistribution<Tp,Size>(n, f);
-    if (tmp.getSampleCount() > 0)
-        d.getDistribution().reset(new distr_t(tmp));
-    return sizeof(std::size_t) + sizeof(Tp) + r;
-}
-
 template <template <typename,std::size_t> class T, typename Tp, std::size_t Size, std::size_t Dim,
           template <typename, typename, typename...> class backend_t>
 struct binary {
@@ -98,11 +32,13 @@ struct binary {
             return false;
         }
 
-        auto write = [&out] (const index_t &index, const data_t &data) {
-            cslibs_math::serialization::array::binary<int, Dim>::write(index, out);
-            cslibs_ndt::write(data, out);
-        };
-        storage->traverse(write);
+        /// Morton order writes neighbours next to each other, independent of the backend
+        std::vector<std::pair<index_t, data_t*>> entries;
+        utility::morton_entries<Dim>(*storage, entries);
+        for (const auto &e : entries) {
+            cslibs_math::serialization::array::binary<int, Dim>::write(e.first, out);
+            cslibs_ndt::write(*e.second, out);
+        }
         out.close();
         return true;
     }
@@ -0,0 +1,91 @@
+#ifndef CSLIBS_NDT_UTILITY_ATOMIC_INDEX_HPP
+#define CSLIBS_NDT_UTILITY_ATOMIC_INDEX_HPP
+
+#include <array>
+#include <atomic>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Index with atomic components, used for the map bounds which
+ *        may be extended by several inserting threads at once.
+ *        Reads behave like a plain std::array<int,Dim>.
+ */
+template <std::size_t Dim>
+class AtomicIndex
+{
+public:
+    using index_t = std::array<int,Dim>;
+
+    inline AtomicIndex(const index_t &index)
+    {
+        store(index);
+    }
+
+    inline AtomicIndex(const AtomicIndex &other)
+    {
+        store(other);
+    }
+
+    inline AtomicIndex& operator = (const index_t &index)
+    {
+        store(index);
+        return *this;
+    }
+
+    inline AtomicIndex& operator = (const AtomicIndex &other)
+    {
+        store(other);
+        return *this;
+    }
+
+    inline int operator [] (const std::size_t i) const
+    {
+        return data_[i].load(std::memory_order_relaxed);
+    }
+
+    inline operator index_t () const
+    {
+        index_t index;
+        for (std::size_t i=0; i<Dim; ++i)
+            index[i] = (*this)[i];
+        return index;
+    }
+
+    /**
+     * @brief Component-wise minimum with another index.
+     */
+    inline void min(const index_t &index)
+    {
+        for (std::size_t i=0; i<Dim; ++i) {
+            int current = data_[i].load(std::memory_order_relaxed);
+            while (index[i] < current &&
+                   !data_[i].compare_exchange_weak(current, index[i], std::memory_order_relaxed));
+        }
+    }
+
+    /**
+     * @brief Component-wise maximum with another index.
+     */
+    inline void max(const index_t &index)
+    {
+        for (std::size_t i=0; i<Dim; ++i) {
+            int current = data_[i].load(std::memory_order_relaxed);
+            while (index[i] > current &&
+                   !data_[i].compare_exchange_weak(current, index[i], std::memory_order_relaxed));
+        }
+    }
+
+private:
+    std::array<std::atomic<int>,Dim> data_;
+
+    inline void store(const index_t &index)
+    {
+        for (std::size_t i=0; i<Dim; ++i)
+            data_[i].store(index[i], std::memory_order_relaxed);
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_ATOMIC_INDEX_HPP
@@ -0,0 +1,186 @@
+#ifndef CSLIBS_NDT_UTILITY_BUNDLE_GAUSSIANS_HPP
+#define CSLIBS_NDT_UTILITY_BUNDLE_GAUSSIANS_HPP
+
+#include <Eigen/Core>
+
+#include <cslibs_ndt/utility/simd.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief The weighted Gaussians of the layers of one bundle, packed for evaluating
+ *        many points against them. A weight usually combines the bundle factor
+ *        1/2^Dim, the normalizer and the occupancy of a layer.
+ *        Means and information matrices are stored component wise, so a point can
+ *        be evaluated against all layers at once, or one layer against many points,
+ *        using the vector instructions of simd::Pack<T>.
+ */
+template <typename T, std::size_t Dim, std::size_t Size>
+class EIGEN_ALIGN16 BundleGaussians
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    using mean_t   = Eigen::Matrix<T,Dim,1>;
+    using matrix_t = Eigen::Matrix<T,Dim,Dim>;
+    using pack_t   = typename simd::Pack<T>::type;
+
+    /// the layers are padded with zero weights to whole packs
+    static constexpr std::size_t padded_size = (Size + pack_t::width - 1) / pack_t::width * pack_t::width;
+    /// entries of the upper triangle of an information matrix
+    static constexpr std::size_t entries     = Dim * (Dim + 1) / 2;
+
+    inline BundleGaussians() :
+        size_(0)
+    {
+    }
+
+    /**
+     * @brief The normalizer of a Gaussian, i.e. its density at the mean.
+     */
+    static inline T normalizer(const matrix_t &covariance)
+    {
+        return 1.0 / std::sqrt(std::pow(2.0 * M_PI, static_cast<T>(Dim)) * covariance.determinant());
+    }
+
+    inline void clear()
+    {
+        size_ = 0;
+    }
+
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+    inline void add(const mean_t   &mean,
+                    const matrix_t &information,
+                    const T         weight)
+    {
+        /// unused lanes of a pack have to be finite and weightless
+        if (size_ % pack_t::width == 0) {
+            for (std::size_t l=size_; l<size_+pack_t::width; ++l) {
+                for (std::size_t d=0; d<Dim; ++d)
+                    means_[d][l] = T();
+                for (std::size_t e=0; e<entries; ++e)
+                    information_[e][l] = T();
+                weights_[l] = T();
+            }
+        }
+
+        for (std::size_t d=0; d<Dim; ++d)
+            means_[d][size_] = mean(d);
+        std::size_t e = 0;
+        for (std::size_t r=0; r<Dim; ++r) {
+            information_[e++][size_] = information(r,r);
+            for (std::size_t c=r+1; c<Dim; ++c)
+                information_[e++][size_] = information(r,c) + information(c,r);
+        }
+        weights_[size_] = weight;
+        ++size_;
+    }
+
+    /**
+     * @brief The sum of the weighted densities of all Gaussians at one point.
+     */
+    inline T evaluate(const T *point) const
+    {
+        pack_t sum = pack_t::set1(T());
+        for (std::size_t k=0; k<size_; k+=pack_t::width)
+            sum = sum + density<pack_t>(point, k);
+        return sum.sum();
+    }
+
+    /**
+     * @brief The weighted density of every Gaussian at one point.
+     * @param point         the point
+     * @param values        size() values, in the order the Gaussians were added
+     */
+    inline void evaluate(const T *point,
+                         T *values) const
+    {
+        std::array<T,padded_size> all;
+        for (std::size_t k=0; k<size_; k+=pack_t::width)
+            density<pack_t>(point, k).store(all.data() + k);
+        std::copy(all.begin(), all.begin() + size_, values);
+    }
+
+    /**
+     * @brief Add the weighted densities of all Gaussians at n points to values.
+     * @param n             the number of points
+     * @param coordinates   the points, one row of n values per dimension
+     * @param values        the n values to accumulate into
+     */
+    inline void evaluate(const std::size_t n,
+                         const T *coordinates,
+                         T *values) const
+    {
+        const std::size_t packed = n / pack_t::width * pack_t::width;
+        for (std::size_t k=0; k<size_; ++k) {
+            for (std::size_t j=0; j<packed; j+=pack_t::width)
+                (pack_t::load(values + j) + density<pack_t>(coordinates + j, n, k)).store(values + j);
+            for (std::size_t j=packed; j<n; ++j)
+                values[j] += density<simd::Scalar<T>>(coordinates + j, n, k).v;
+        }
+    }
+
+private:
+    std::array<std::array<T,padded_size>,Dim>       means_;
+    std::array<std::array<T,padded_size>,entries>   information_;
+    std::array<T,padded_size>                       weights_;
+    std::size_t                                     size_;
+
+    /// Gaussians k, ... of one point, one per lane
+    template <typename p_t>
+    inline p_t density(const T *point,
+                       const std::size_t k) const
+    {
+        std::array<p_t,Dim> q;
+        for (std::size_t d=0; d<Dim; ++d)
+            q[d] = p_t::set1(point[d]) - p_t::load(means_[d].data() + k);
+        return kernel(q, [this, k](const std::size_t e) { return p_t::load(information_[e].data() + k); })
+                * p_t::load(weights_.data() + k);
+    }
+
+    /// Gaussian k of the points j, ... given component wise with a stride of n
+    template <typename p_t>
+    inline p_t density(const T *coordinates,
+                       const std::size_t n,
+                       const std::size_t k) const
+    {
+        std::array<p_t,Dim> q;
+        for (std::size_t d=0; d<Dim; ++d)
+            q[d] = p_t::load(coordinates + d * n) - p_t::set1(means_[d][k]);
+        return kernel(q, [this, k](const std::size_t e) { return p_t::set1(information_[e][k]); })
+                * p_t::set1(weights_[k]);
+    }
+
+    /// exp(-0.5 q^T A q) for the upper triangle of A with folded off diagonal entries
+    template <typename p_t, typename information_t>
+    static inline p_t kernel(const std::array<p_t,Dim> &q,
+                             const information_t &information)
+    {
+        p_t exponent = p_t::set1(T());
+        std::size_t e = 0;
+        for (std::size_t r=0; r<Dim; ++r) {
+            p_t row = information(e++) * q[r];
+            for (std::size_t c=r+1; c<Dim; ++c)
+                row = row + information(e++) * q[c];
+            exponent = exponent + row * q[r];
+        }
+        return (exponent * p_t::set1(-0.5)).exp();
+    }
+};
+
+template <typename T, std::size_t Dim, std::size_t Size>
+constexpr std::size_t BundleGaussians<T,Dim,Size>::padded_size;
+template <typename T, std::size_t Dim, std::size_t Size>
+constexpr std::size_t BundleGaussians<T,Dim,Size>::entries;
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_BUNDLE_GAUSSIANS_HPP
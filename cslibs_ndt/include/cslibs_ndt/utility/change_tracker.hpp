@@ -0,0 +1,168 @@
+#ifndef CSLIBS_NDT_UTILITY_CHANGE_TRACKER_HPP
+#define CSLIBS_NDT_UTILITY_CHANGE_TRACKER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <cslibs_ndt/utility/index_hash.hpp>
+
+#include <cslibs_math/common/div.hpp>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Records which tiles of a map were modified. A tile is a cube of
+ *        tile_size^Dim bundles. Since neighbouring bundles share their layer
+ *        distributions, a modified bundle also marks the tiles of its direct
+ *        neighbours. Tracking is disabled as long as the tile size is zero.
+ *        The tiles are spread over shards with a mutex each, so concurrent
+ *        writers only contend if they modify tiles of the same shard.
+ */
+template <std::size_t Dim>
+class ChangeTracker
+{
+public:
+    using index_t = std::array<int,Dim>;
+
+    static constexpr std::size_t shard_bits  = 5;
+    static constexpr std::size_t shard_count = 1ul << shard_bits;
+
+    inline ChangeTracker() :
+        tile_size_(0)
+    {
+    }
+
+    inline ChangeTracker(const ChangeTracker &other) :
+        tile_size_(other.tile_size_.load())
+    {
+        for (std::size_t i=0; i<shard_count; ++i) {
+            shards_[i].tiles = other.shards_[i].tiles;
+            shards_[i].last  = other.shards_[i].last;
+            shards_[i].valid = other.shards_[i].valid;
+        }
+    }
+
+    inline void setTileSize(const std::size_t tile_size)
+    {
+        for (shard_t &s : shards_) {
+            std::unique_lock<std::mutex> l(s.mutex);
+            s.tiles.clear();
+            s.valid = false;
+        }
+        tile_size_ = tile_size;
+    }
+
+    inline std::size_t getTileSize() const
+    {
+        return tile_size_;
+    }
+
+    inline bool enabled() const
+    {
+        return tile_size_ != 0;
+    }
+
+    /**
+     * @brief Mark the tiles affected by a modification of a bundle, thread safe.
+     */
+    inline void mark(const index_t &bi)
+    {
+        const int tile_size = static_cast<int>(tile_size_);
+        if (tile_size == 0)
+            return;
+
+        forEachTile(bi, tile_size, [this](const index_t &ti) {
+            shard_t &s = shards_[shardIndex(ti)];
+            std::unique_lock<std::mutex> l(s.mutex);
+            /// consecutive modifications mostly fall into the same tile
+            if (s.valid && s.last == ti)
+                return;
+            s.tiles.insert(ti);
+            s.last  = ti;
+            s.valid = true;
+        });
+    }
+
+    /**
+     * @brief Hand out the tiles marked so far and start over.
+     */
+    inline void take(std::vector<index_t> &tiles)
+    {
+        tiles.clear();
+        for (shard_t &s : shards_) {
+            std::unique_lock<std::mutex> l(s.mutex);
+            tiles.insert(tiles.end(), s.tiles.begin(), s.tiles.end());
+            s.tiles.clear();
+            s.valid = false;
+        }
+    }
+
+    /**
+     * @brief Call function for the tiles of a bundle and its direct neighbours.
+     */
+    template <typename Fn>
+    static inline void forEachTile(const index_t &bi,
+                                   const int tile_size,
+                                   const Fn &function)
+    {
+        index_t lo, hi;
+        for (std::size_t i=0; i<Dim; ++i) {
+            lo[i] = cslibs_math::common::div(bi[i] - 1, tile_size);
+            hi[i] = cslibs_math::common::div(bi[i] + 1, tile_size);
+        }
+
+        index_t ti = lo;
+        while (true) {
+            function(ti);
+            std::size_t i = 0;
+            for (; i<Dim; ++i) {
+                if (ti[i] < hi[i]) {
+                    ++ti[i];
+                    break;
+                }
+                ti[i] = lo[i];
+            }
+            if (i == Dim)
+                return;
+        }
+    }
+
+    static inline index_t toTileIndex(const index_t &bi,
+                                      const int tile_size)
+    {
+        index_t ti;
+        for (std::size_t i=0; i<Dim; ++i)
+            ti[i] = cslibs_math::common::div(bi[i], tile_size);
+        return ti;
+    }
+
+private:
+    struct shard_t
+    {
+        std::mutex                                    mutex;
+        std::unordered_set<index_t, IndexHash<Dim>>   tiles;
+        index_t                                       last;
+        bool                                          valid = false;
+    };
+
+    std::atomic<std::size_t>            tile_size_;
+    std::array<shard_t, shard_count>    shards_;
+
+    inline static std::size_t shardIndex(const index_t &ti)
+    {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(IndexHash<Dim>()(ti)) * 0x9E3779B97F4A7C15ull) >> (64 - shard_bits));
+    }
+};
+
+template <std::size_t Dim>
+constexpr std::size_t ChangeTracker<Dim>::shard_bits;
+template <std::size_t Dim>
+constexpr std::size_t ChangeTracker<Dim>::shard_count;
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_CHANGE_TRACKER_HPP
@@ -0,0 +1,146 @@
+#ifndef CSLIBS_NDT_UTILITY_DIRTY_BUNDLES_HPP
+#define CSLIBS_NDT_UTILITY_DIRTY_BUNDLES_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include <cslibs_ndt/utility/index_hash.hpp>
+#include <cslibs_ndt/utility/morton_order.hpp>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Records the bundles which were allocated or modified since they were last
+ *        handed out. Initially every bundle counts as dirty, recording starts with
+ *        the first take(). Marks are appended and deduplicated lazily, a mark thus
+ *        costs about a push_back. If the map is concurrent, the marks are spread
+ *        over shards with a mutex each like the sharded backend, so writers only
+ *        contend if they touch bundles of the same shard. take() merges the shards.
+ */
+template <std::size_t Dim, bool concurrent>
+class DirtyBundles
+{
+public:
+    using index_t = std::array<int,Dim>;
+
+    static constexpr std::size_t shard_bits  = concurrent ? 6 : 0;
+    static constexpr std::size_t shard_count = 1ul << shard_bits;
+
+    inline DirtyBundles() :
+        all_(true)
+    {
+    }
+
+    inline DirtyBundles(const DirtyBundles &other) :
+        all_(other.all_.load())
+    {
+        for (std::size_t i=0; i<shard_count; ++i) {
+            shards_[i].indices = other.shards_[i].indices;
+            shards_[i].unique  = other.shards_[i].unique;
+        }
+    }
+
+    inline void mark(const index_t &bi)
+    {
+        if (all_.load(std::memory_order_relaxed))
+            return;
+
+        shard_t &s = shards_[shardIndex(bi)];
+        std::lock_guard<mutex_t> l(s.mutex);
+        /// consecutive points mostly fall into the same bundle
+        if (!s.indices.empty() && s.indices.back() == bi)
+            return;
+        s.indices.emplace_back(bi);
+        if (s.indices.size() > 2 * s.unique + min_compact)
+            s.compact();
+    }
+
+    /**
+     * @brief Hand out the bundles marked so far and start recording anew.
+     * @param bis           the bundle indices in Morton order
+     * @return false if every bundle is dirty, bis stays empty then
+     */
+    inline bool take(std::vector<index_t> &bis)
+    {
+        bis.clear();
+        if (all_.exchange(false))
+            return false;
+
+        for (shard_t &s : shards_) {
+            std::lock_guard<mutex_t> l(s.mutex);
+            bis.insert(bis.end(), s.indices.begin(), s.indices.end());
+            s.indices.clear();
+            s.unique = 0;
+        }
+        morton_sort<Dim>(bis, [](const index_t &bi) -> const index_t& { return bi; });
+        bis.erase(std::unique(bis.begin(), bis.end()), bis.end());
+        return true;
+    }
+
+    /**
+     * @brief Forget all marks, e.g. after every bundle was processed.
+     */
+    inline void reset()
+    {
+        all_ = false;
+        for (shard_t &s : shards_) {
+            std::lock_guard<mutex_t> l(s.mutex);
+            s.indices.clear();
+            s.unique = 0;
+        }
+    }
+
+private:
+    struct NoMutex
+    {
+        inline void lock()
+        {
+        }
+
+        inline void unlock()
+        {
+        }
+    };
+    using mutex_t = typename std::conditional<concurrent, std::mutex, NoMutex>::type;
+
+    static constexpr std::size_t min_compact = 1024;
+
+    struct shard_t
+    {
+        mutex_t                 mutex;
+        std::vector<index_t>    indices;
+        std::size_t             unique = 0;
+
+        inline void compact()
+        {
+            morton_sort<Dim>(indices, [](const index_t &bi) -> const index_t& { return bi; });
+            indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+            unique = indices.size();
+        }
+    };
+
+    std::atomic<bool>                   all_;
+    std::array<shard_t, shard_count>    shards_;
+
+    inline static std::size_t shardIndex(const index_t &bi)
+    {
+        return shard_bits == 0 ? 0 :
+               static_cast<std::size_t>((static_cast<std::uint64_t>(IndexHash<Dim>()(bi)) * 0x9E3779B97F4A7C15ull) >> ((64 - shard_bits) % 64));
+    }
+};
+
+template <std::size_t Dim, bool concurrent>
+constexpr std::size_t DirtyBundles<Dim,concurrent>::shard_bits;
+template <std::size_t Dim, bool concurrent>
+constexpr std::size_t DirtyBundles<Dim,concurrent>::shard_count;
+template <std::size_t Dim, bool concurrent>
+constexpr std::size_t DirtyBundles<Dim,concurrent>::min_compact;
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_DIRTY_BUNDLES_HPP
@@ -0,0 +1,26 @@
+#ifndef CSLIBS_NDT_UTILITY_INDEX_HASH_HPP
+#define CSLIBS_NDT_UTILITY_INDEX_HASH_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Hash for bundle indices.
+ */
+template <std::size_t Dim>
+struct IndexHash
+{
+    inline std::size_t operator()(const std::array<int,Dim> &index) const
+    {
+        std::uint64_t h = 0;
+        for (std::size_t i=0; i<Dim; ++i)
+            h = (h ^ static_cast<std::uint32_t>(index[i])) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_INDEX_HASH_HPP
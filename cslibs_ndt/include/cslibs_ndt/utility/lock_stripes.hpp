@@ -0,0 +1,60 @@
+#ifndef CSLIBS_NDT_UTILITY_LOCK_STRIPES_HPP
+#define CSLIBS_NDT_UTILITY_LOCK_STRIPES_HPP
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Fixed set of mutexes, objects are mapped onto them by address.
+ *        Used to guard distribution updates of maps with concurrent backends.
+ */
+template <std::size_t Size = 1024>
+class LockStripes
+{
+public:
+    using lock_t = std::unique_lock<std::mutex>;
+
+    inline LockStripes() = default;
+
+    /// the mutexes are not part of the state
+    inline LockStripes(const LockStripes &)
+    {
+    }
+
+    inline lock_t lock(const void *address) const
+    {
+        std::uint64_t a = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(address));
+        a ^= a >> 17;
+        a *= 0x9E3779B97F4A7C15ull;
+        return lock_t(mutexes_[(a >> 32) % Size]);
+    }
+
+private:
+    mutable std::array<std::mutex,Size> mutexes_;
+};
+
+/**
+ * @brief Drop-in for LockStripes if no synchronization is required.
+ */
+class NoLockStripes
+{
+public:
+    struct lock_t
+    {
+        inline ~lock_t()
+        {
+        }
+    };
+
+    inline lock_t lock(const void *) const
+    {
+        return lock_t();
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_LOCK_STRIPES_HPP
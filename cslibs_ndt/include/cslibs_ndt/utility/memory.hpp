@@ -0,0 +1,113 @@
+#ifndef CSLIBS_NDT_UTILITY_MEMORY_HPP
+#define CSLIBS_NDT_UTILITY_MEMORY_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+#include <cslibs_indexed_storage/backends.hpp>
+
+namespace cis = cslibs_indexed_storage;
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Estimate the size of the heap block malloc hands out for a request, i.e.
+ *        the request plus the chunk header, rounded up to the malloc alignment.
+ *        Follows glibc on 64 bit platforms.
+ * @param bytes         the requested bytes
+ * @return the bytes taken from the heap, zero if nothing is requested
+ */
+inline std::size_t heap_block_size(const std::size_t bytes)
+{
+    static constexpr std::size_t header    = sizeof(std::size_t);
+    static constexpr std::size_t alignment = 2 * sizeof(std::size_t);
+    static constexpr std::size_t minimum   = 4 * sizeof(std::size_t);
+    return bytes == 0 ? 0 : std::max(minimum, (bytes + header + alignment - 1) & ~(alignment - 1));
+}
+
+/**
+ * @brief Bytes lost to the allocator when requesting bytes.
+ */
+inline std::size_t heap_overhead(const std::size_t bytes)
+{
+    return heap_block_size(bytes) - bytes;
+}
+
+namespace detail {
+/**
+ * @brief Heap layout of backends without own accounting. The overhead is the
+ *        modelled heap usage minus what byte_size already covers, it is unknown
+ *        and reported as zero for backends which are not modelled.
+ */
+template <template <typename, typename, typename...> class backend_t>
+struct allocation_layout
+{
+    template <typename index_t, typename data_t, typename storage_t>
+    static inline std::size_t overhead(const storage_t &)
+    {
+        return 0;
+    }
+};
+
+template <typename storage_t>
+inline std::size_t uncovered(const storage_t &storage, const std::size_t heap)
+{
+    const std::size_t covered = storage.byte_size() - sizeof(storage_t);
+    return heap > covered ? heap - covered : 0;
+}
+
+/// one contiguous allocation for all cells
+template <>
+struct allocation_layout<cis::backend::array::Array>
+{
+    template <typename index_t, typename data_t, typename storage_t>
+    static inline std::size_t overhead(const storage_t &storage)
+    {
+        return uncovered(storage, heap_block_size(storage.capacity() * sizeof(data_t)));
+    }
+};
+
+/// one node per entry with the link, the cached hash and the entry, plus the bucket array
+template <>
+struct allocation_layout<cis::backend::simple::UnorderedMap>
+{
+    template <typename index_t, typename data_t, typename storage_t>
+    static inline std::size_t overhead(const storage_t &storage)
+    {
+        static constexpr std::size_t node_size = sizeof(void*) + sizeof(std::size_t) + sizeof(index_t) + sizeof(data_t);
+        return uncovered(storage, storage.size() * heap_block_size(node_size) +
+                                  heap_block_size(storage.capacity() * sizeof(void*)));
+    }
+};
+
+template <template <typename, typename, typename...> class backend_t,
+          typename index_t, typename data_t, typename storage_t>
+inline auto allocation_overhead(const storage_t &storage, int) -> decltype(storage.allocation_overhead())
+{
+    return storage.allocation_overhead();
+}
+
+template <template <typename, typename, typename...> class backend_t,
+          typename index_t, typename data_t, typename storage_t>
+inline std::size_t allocation_overhead(const storage_t &storage, long)
+{
+    return allocation_layout<backend_t>::template overhead<index_t,data_t>(storage);
+}
+}
+
+/**
+ * @brief Heap bytes of a storage which its byte_size does not cover: malloc
+ *        headers, padding and bookkeeping. Backends provide allocation_overhead(),
+ *        the cis Array and UnorderedMap are modelled by detail::allocation_layout,
+ *        the overhead of other backends is unknown and reported as zero.
+ */
+template <template <typename, typename, typename...> class backend_t,
+          typename index_t, typename data_t, typename storage_t>
+inline std::size_t allocation_overhead(const storage_t &storage)
+{
+    return detail::allocation_overhead<backend_t,index_t,data_t>(storage, 0);
+}
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_MEMORY_HPP
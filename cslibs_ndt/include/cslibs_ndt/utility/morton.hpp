@@ -0,0 +1,123 @@
+#ifndef CSLIBS_NDT_UTILITY_MORTON_HPP
+#define CSLIBS_NDT_UTILITY_MORTON_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Morton (Z-order) codes of integer indices. Every component is shifted
+ *        to be non-negative and its bits are interleaved, indices which are
+ *        close in space thus get close codes. The most significant bit is
+ *        never used, which leaves room for sentinel values.
+ */
+template <std::size_t Dim>
+struct Morton;
+
+template <>
+struct Morton<2>
+{
+    using index_t = std::array<int,2>;
+
+    static constexpr std::size_t bits   = 31;
+    static constexpr std::int64_t bias  = 1ll << (bits - 1);
+
+    static inline bool representable(const index_t &index)
+    {
+        return index[0] >= -bias && index[0] < bias &&
+               index[1] >= -bias && index[1] < bias;
+    }
+
+    static inline std::uint64_t encode(const index_t &index)
+    {
+        return spread(static_cast<std::uint64_t>(index[0] + bias)) |
+              (spread(static_cast<std::uint64_t>(index[1] + bias)) << 1);
+    }
+
+    static inline index_t decode(const std::uint64_t code)
+    {
+        return {{static_cast<int>(static_cast<std::int64_t>(compact(code))      - bias),
+                 static_cast<int>(static_cast<std::int64_t>(compact(code >> 1)) - bias)}};
+    }
+
+private:
+    static inline std::uint64_t spread(std::uint64_t x)
+    {
+        x &= 0x00000000FFFFFFFFull;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x <<  8)) & 0x00FF00FF00FF00FFull;
+        x = (x | (x <<  4)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x <<  2)) & 0x3333333333333333ull;
+        x = (x | (x <<  1)) & 0x5555555555555555ull;
+        return x;
+    }
+
+    static inline std::uint64_t compact(std::uint64_t x)
+    {
+        x &= 0x5555555555555555ull;
+        x = (x ^ (x >>  1)) & 0x3333333333333333ull;
+        x = (x ^ (x >>  2)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x ^ (x >>  4)) & 0x00FF00FF00FF00FFull;
+        x = (x ^ (x >>  8)) & 0x0000FFFF0000FFFFull;
+        x = (x ^ (x >> 16)) & 0x00000000FFFFFFFFull;
+        return x;
+    }
+};
+
+template <>
+struct Morton<3>
+{
+    using index_t = std::array<int,3>;
+
+    static constexpr std::size_t bits   = 21;
+    static constexpr std::int64_t bias  = 1ll << (bits - 1);
+
+    static inline bool representable(const index_t &index)
+    {
+        return index[0] >= -bias && index[0] < bias &&
+               index[1] >= -bias && index[1] < bias &&
+               index[2] >= -bias && index[2] < bias;
+    }
+
+    static inline std::uint64_t encode(const index_t &index)
+    {
+        return spread(static_cast<std::uint64_t>(index[0] + bias)) |
+              (spread(static_cast<std::uint64_t>(index[1] + bias)) << 1) |
+              (spread(static_cast<std::uint64_t>(index[2] + bias)) << 2);
+    }
+
+    static inline index_t decode(const std::uint64_t code)
+    {
+        return {{static_cast<int>(static_cast<std::int64_t>(compact(code))      - bias),
+                 static_cast<int>(static_cast<std::int64_t>(compact(code >> 1)) - bias),
+                 static_cast<int>(static_cast<std::int64_t>(compact(code >> 2)) - bias)}};
+    }
+
+private:
+    static inline std::uint64_t spread(std::uint64_t x)
+    {
+        x &= 0x00000000001FFFFFull;
+        x = (x | (x << 32)) & 0x001F00000000FFFFull;
+        x = (x | (x << 16)) & 0x001F0000FF0000FFull;
+        x = (x | (x <<  8)) & 0x100F00F00F00F00Full;
+        x = (x | (x <<  4)) & 0x10C30C30C30C30C3ull;
+        x = (x | (x <<  2)) & 0x1249249249249249ull;
+        return x;
+    }
+
+    static inline std::uint64_t compact(std::uint64_t x)
+    {
+        x &= 0x1249249249249249ull;
+        x = (x ^ (x >>  2)) & 0x10C30C30C30C30C3ull;
+        x = (x ^ (x >>  4)) & 0x100F00F00F00F00Full;
+        x = (x ^ (x >>  8)) & 0x001F0000FF0000FFull;
+        x = (x ^ (x >> 16)) & 0x001F00000000FFFFull;
+        x = (x ^ (x >> 32)) & 0x00000000001FFFFFull;
+        return x;
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_MORTON_HPP
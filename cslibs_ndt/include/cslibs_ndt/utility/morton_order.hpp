@@ -0,0 +1,69 @@
+#ifndef CSLIBS_NDT_UTILITY_MORTON_ORDER_HPP
+#define CSLIBS_NDT_UTILITY_MORTON_ORDER_HPP
+
+#include <cslibs_ndt/utility/morton.hpp>
+#include <cslibs_ndt/utility/radix_sort.hpp>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Sort items by the Morton code of their index, items which are close in
+ *        space thus end up close in memory. Indices without a Morton code are
+ *        sorted lexicographically instead.
+ * @param items         the items
+ * @param index_of      returns the std::array<int,Dim> index of an item
+ */
+template <std::size_t Dim, typename value_t, typename index_of_t>
+inline void morton_sort(std::vector<value_t> &items,
+                        const index_of_t &index_of)
+{
+    using morton_t = Morton<Dim>;
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> keys(items.size());
+    for (std::size_t i=0; i<items.size(); ++i) {
+        const std::array<int,Dim> &index = index_of(items[i]);
+        if (!morton_t::representable(index)) {
+            std::sort(items.begin(), items.end(), [&index_of](const value_t &a, const value_t &b) {
+                return index_of(a) < index_of(b);
+            });
+            return;
+        }
+        keys[i].first  = morton_t::encode(index);
+        keys[i].second = i;
+    }
+    radix_sort(keys);
+
+    std::vector<value_t> sorted;
+    sorted.reserve(items.size());
+    for (const auto &key : keys)
+        sorted.emplace_back(std::move(items[key.second]));
+    items.swap(sorted);
+}
+
+/**
+ * @brief Collect the entries of an indexed storage in Morton order.
+ * @param storage       the storage
+ * @param entries       index and address of every entry
+ */
+template <std::size_t Dim, typename data_t, typename storage_t>
+inline void morton_entries(storage_t &storage,
+                           std::vector<std::pair<std::array<int,Dim>, data_t*>> &entries)
+{
+    using index_t = std::array<int,Dim>;
+    using entry_t = std::pair<index_t, data_t*>;
+
+    entries.clear();
+    storage.traverse([&entries](const index_t &index, data_t &data) {
+        entries.emplace_back(index, &data);
+    });
+    morton_sort<Dim>(entries, [](const entry_t &e) -> const index_t& { return e.first; });
+}
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_MORTON_ORDER_HPP
@@ -0,0 +1,189 @@
+#ifndef CSLIBS_NDT_UTILITY_PARALLEL_HPP
+#define CSLIBS_NDT_UTILITY_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace utility {
+
+/**
+ * @brief Call function(i) for every i in [0, count) using up to num_threads threads.
+ *        Work items are handed out dynamically, the calling thread takes part in the
+ *        work. With num_threads <= 1 everything runs in the calling thread.
+ * @param count         number of work items
+ * @param num_threads   maximum number of threads to use
+ * @param function      callable taking the work item index
+ */
+template <typename Fn>
+inline void parallel_for(const std::size_t count,
+                         const std::size_t num_threads,
+                         const Fn &function)
+{
+    const std::size_t threads = std::min(num_threads, count);
+    if (threads <= 1) {
+        for (std::size_t i = 0 ; i < count ; ++i)
+            function(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    auto work = [&next, count, &function]() {
+        for (std::size_t i = next++ ; i < count ; i = next++)
+            function(i);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t t = 1 ; t < threads ; ++t)
+        workers.emplace_back(work);
+    work();
+    for (std::thread &w : workers)
+        w.join();
+}
+
+/**
+ * @brief Threads which are started once and then run any number of parallel_for
+ *        calls, e.g. one per iteration of a registration. Spawning and joining the
+ *        threads on every call would cost more than a short call itself. Work items
+ *        are handed out like in parallel_for, the calling thread takes part in the
+ *        work. Calls must not overlap.
+ */
+class WorkerPool
+{
+public:
+    /**
+     * @param num_threads   number of threads including the calling one
+     */
+    inline explicit WorkerPool(const std::size_t num_threads) :
+        function_(nullptr),
+        call_(nullptr),
+        count_(0),
+        next_(0),
+        generation_(0),
+        active_(0),
+        stop_(false)
+    {
+        for (std::size_t t = 1 ; t < num_threads ; ++t)
+            workers_.emplace_back([this]() { run(); });
+    }
+
+    WorkerPool(const WorkerPool &other) = delete;
+    WorkerPool& operator = (const WorkerPool &other) = delete;
+
+    inline ~WorkerPool()
+    {
+        {
+            std::unique_lock<std::mutex> l(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for (std::thread &w : workers_)
+            w.join();
+    }
+
+    /**
+     * @brief Number of threads including the calling one.
+     */
+    inline std::size_t size() const
+    {
+        return workers_.size() + 1;
+    }
+
+    /**
+     * @brief Call function(i) for every i in [0, count) and return once all are done.
+     * @param count         number of work items
+     * @param function      callable taking the work item index
+     */
+    template <typename Fn>
+    inline void parallel_for(const std::size_t count,
+                             const Fn &function)
+    {
+        if (workers_.empty() || count <= 1) {
+            for (std::size_t i = 0 ; i < count ; ++i)
+                function(i);
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> l(mutex_);
+            function_ = &function;
+            call_     = &invoke<Fn>;
+            count_    = count;
+            next_     = 0;
+            active_   = workers_.size();
+            ++generation_;
+        }
+        start_.notify_all();
+        work();
+
+        std::unique_lock<std::mutex> l(mutex_);
+        done_.wait(l, [this]() { return active_ == 0; });
+        function_ = nullptr;
+    }
+
+private:
+    using call_t = void (*)(const void*, std::size_t);
+
+    std::vector<std::thread>    workers_;
+    std::mutex                  mutex_;
+    std::condition_variable     start_;
+    std::condition_variable     done_;
+
+    const void*                 function_;
+    call_t                      call_;
+    std::size_t                 count_;
+    std::atomic<std::size_t>    next_;
+    std::size_t                 generation_;
+    std::size_t                 active_;
+    bool                        stop_;
+
+    template <typename Fn>
+    static inline void invoke(const void *function, const std::size_t i)
+    {
+        (*static_cast<const Fn*>(function))(i);
+    }
+
+    inline void work()
+    {
+        for (std::size_t i = next_++ ; i < count_ ; i = next_++)
+            call_(function_, i);
+    }
+
+    inline void run()
+    {
+        std::size_t generation = 0;
+        std::unique_lock<std::mutex> l(mutex_);
+        while (true) {
+            start_.wait(l, [this, &generation]() { return stop_ || generation_ != generation; });
+            if (stop_)
+                return;
+            generation = generation_;
+
+            l.unlock();
+            work();
+            l.lock();
+
+            /// every worker checks in, even if the others took all items
+            if (--active_ == 0)
+                done_.notify_one();
+        }
+    }
+};
+
+/**
+ * @brief Number of threads to use if the user did not specify any.
+ */
+inline std::size_t hardware_threads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_PARALLEL_HPP
@@ -0,0 +1,324 @@
+#ifndef CSLIBS_NDT_UTILITY_POOL_HPP
+#define CSLIBS_NDT_UTILITY_POOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Slab allocator for objects of one type. Every thread allocates from a
+ *        pool of its own without any locking. An object released by another
+ *        thread is handed back to the pool it came from through a lock-free
+ *        list, which the owning thread takes over once its own free list is
+ *        empty. The blocks of a pool are returned when its thread has ended and
+ *        the last of its objects is released.
+ */
+template <typename T>
+class Pool
+{
+public:
+    static constexpr std::size_t block_bytes  = 1ul << 16;
+    static constexpr std::size_t header_bytes = 64;
+    static constexpr std::size_t block_size   = (block_bytes - header_bytes) / sizeof(T);
+
+    static_assert(alignof(T) <= header_bytes, "Pool: alignment of T exceeds the block header.");
+    static_assert(block_size >= 16, "Pool: T is too large for a block.");
+
+    /**
+     * @brief The pool of the calling thread.
+     */
+    static inline Pool& local()
+    {
+        static thread_local Owner owner;
+        return *owner.pool;
+    }
+
+    /**
+     * @brief Number of pools which are not yet destroyed, i.e. their thread is
+     *        running or some of their objects are still alive.
+     */
+    static inline std::size_t instances()
+    {
+        return counter();
+    }
+
+    template <typename... Args>
+    inline T* create(Args&&... args)
+    {
+        T *p = allocate();
+        try {
+            return new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(p);
+            throw;
+        }
+    }
+
+    /**
+     * @brief Destroy an object of any pool, may be called from any thread.
+     */
+    static inline void destroy(T *p)
+    {
+        if (!p)
+            return;
+        p->~T();
+        owner(p)->deallocate(p);
+    }
+
+    /**
+     * @brief Number of objects alive.
+     */
+    inline std::size_t size() const
+    {
+        return references_ - 1;
+    }
+
+    inline std::size_t byte_size() const
+    {
+        return sizeof(*this) +
+                blocks_.size()   * block_bytes +
+                free_.capacity() * sizeof(T*);
+    }
+
+private:
+    /// a released object is linked into the remote list in place
+    struct node_t
+    {
+        node_t *next;
+    };
+    static_assert(sizeof(T) >= sizeof(node_t), "Pool: T is smaller than a pointer.");
+
+    struct header_t
+    {
+        Pool *pool;
+    };
+
+    /// holds the reference of the thread, released when the thread ends
+    struct Owner
+    {
+        Pool *pool;
+
+        inline Owner() :
+            pool(new Pool)
+        {
+            current() = pool;
+        }
+
+        inline ~Owner()
+        {
+            current() = nullptr;
+            pool->release();
+        }
+    };
+
+    std::vector<void*>          blocks_;
+    std::vector<T*>             free_;
+    std::size_t                 used_ = block_size;   /// objects handed out of the last block
+    std::atomic<node_t*>        remote_;
+    std::atomic<std::size_t>    references_;          /// the thread and every object alive
+
+    inline Pool() :
+        remote_(nullptr),
+        references_(1)
+    {
+        ++counter();
+    }
+
+    inline ~Pool()
+    {
+        for (void *block : blocks_)
+            std::free(block);
+        --counter();
+    }
+
+    static inline Pool*& current()
+    {
+        static thread_local Pool *pool = nullptr;
+        return pool;
+    }
+
+    static inline std::atomic<std::size_t>& counter()
+    {
+        static std::atomic<std::size_t> count(0);
+        return count;
+    }
+
+    static inline Pool* owner(const T *p)
+    {
+        const std::uintptr_t block = reinterpret_cast<std::uintptr_t>(p) & ~static_cast<std::uintptr_t>(block_bytes - 1);
+        return reinterpret_cast<const header_t*>(block)->pool;
+    }
+
+    inline void release()
+    {
+        if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    inline T* allocate()
+    {
+        references_.fetch_add(1, std::memory_order_relaxed);
+        if (free_.empty()) {
+            /// take over the objects released by other threads
+            for (node_t *n = remote_.exchange(nullptr, std::memory_order_acquire) ; n ; n = n->next)
+                free_.emplace_back(reinterpret_cast<T*>(n));
+        }
+        if (!free_.empty()) {
+            T *p = free_.back();
+            free_.pop_back();
+            return p;
+        }
+        if (used_ == block_size) {
+            void *block = nullptr;
+            if (posix_memalign(&block, block_bytes, block_bytes) != 0)
+                throw std::bad_alloc();
+            reinterpret_cast<header_t*>(block)->pool = this;
+            blocks_.emplace_back(block);
+            used_ = 0;
+        }
+        return reinterpret_cast<T*>(static_cast<char*>(blocks_.back()) + header_bytes) + used_++;
+    }
+
+    inline void deallocate(T *p)
+    {
+        if (current() == this) {
+            free_.emplace_back(p);
+            references_.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        node_t *n = reinterpret_cast<node_t*>(p);
+        n->next = remote_.load(std::memory_order_relaxed);
+        while (!remote_.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed));
+        release();
+    }
+};
+
+template <typename T>
+constexpr std::size_t Pool<T>::block_bytes;
+template <typename T>
+constexpr std::size_t Pool<T>::header_bytes;
+template <typename T>
+constexpr std::size_t Pool<T>::block_size;
+
+/**
+ * @brief Owning pointer to an object living in Pool<T>. In contrast to a shared
+ *        pointer there is no reference count and copies are deep. New objects
+ *        are taken from the pool of the calling thread.
+ */
+template <typename T>
+class PoolPtr
+{
+public:
+    using element_type = T;
+
+    inline PoolPtr() :
+        p_(nullptr)
+    {
+    }
+
+    inline PoolPtr(std::nullptr_t) :
+        p_(nullptr)
+    {
+    }
+
+    inline PoolPtr(const PoolPtr &other) :
+        p_(other.p_ ? Pool<T>::local().create(*other.p_) : nullptr)
+    {
+    }
+
+    inline PoolPtr(PoolPtr &&other) :
+        p_(other.p_)
+    {
+        other.p_ = nullptr;
+    }
+
+    inline ~PoolPtr()
+    {
+        reset();
+    }
+
+    inline PoolPtr& operator = (const PoolPtr &other)
+    {
+        if (this != &other) {
+            if (!other.p_)
+                reset();
+            else if (p_)
+                *p_ = *other.p_;
+            else
+                p_ = Pool<T>::local().create(*other.p_);
+        }
+        return *this;
+    }
+
+    inline PoolPtr& operator = (PoolPtr &&other)
+    {
+        if (this != &other) {
+            reset();
+            p_ = other.p_;
+            other.p_ = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Construct a new object, an existing one is released.
+     */
+    template <typename... Args>
+    inline T& emplace(Args&&... args)
+    {
+        reset();
+        p_ = Pool<T>::local().create(std::forward<Args>(args)...);
+        return *p_;
+    }
+
+    inline void reset()
+    {
+        Pool<T>::destroy(p_);
+        p_ = nullptr;
+    }
+
+    inline T* get() const
+    {
+        return p_;
+    }
+
+    inline T& operator * () const
+    {
+        return *p_;
+    }
+
+    inline T* operator -> () const
+    {
+        return p_;
+    }
+
+    inline explicit operator bool () const
+    {
+        return p_ != nullptr;
+    }
+
+private:
+    T *p_;
+};
+
+template <typename T>
+inline bool operator == (const PoolPtr<T> &p, std::nullptr_t)
+{
+    return !p;
+}
+
+template <typename T>
+inline bool operator != (const PoolPtr<T> &p, std::nullptr_t)
+{
+    return static_cast<bool>(p);
+}
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_POOL_HPP
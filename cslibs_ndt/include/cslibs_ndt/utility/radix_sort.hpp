@@ -0,0 +1,47 @@
+#ifndef CSLIBS_NDT_UTILITY_RADIX_SORT_HPP
+#define CSLIBS_NDT_UTILITY_RADIX_SORT_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Stable LSD radix sort of items by an unsigned 64 bit key. Only the bits
+ *        in which the keys actually differ are sorted, which makes clustered keys
+ *        such as the Morton codes of nearby indices cheap to sort.
+ */
+template <typename value_t>
+inline void radix_sort(std::vector<std::pair<std::uint64_t, value_t>> &items)
+{
+    if (items.size() < 2)
+        return;
+
+    std::uint64_t min = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t max = 0;
+    for (const auto &item : items) {
+        min = std::min(min, item.first);
+        max = std::max(max, item.first);
+    }
+    const std::uint64_t range = max - min;
+
+    std::vector<std::pair<std::uint64_t, value_t>> buffer(items.size());
+    for (std::size_t shift = 0; shift < 64 && (range >> shift) != 0; shift += 8) {
+        std::array<std::size_t, 257> offsets;
+        offsets.fill(0);
+        for (const auto &item : items)
+            ++offsets[((item.first - min) >> shift & 0xff) + 1];
+        for (std::size_t i=1; i<offsets.size(); ++i)
+            offsets[i] += offsets[i - 1];
+        for (const auto &item : items)
+            buffer[offsets[(item.first - min) >> shift & 0xff]++] = item;
+        items.swap(buffer);
+    }
+}
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_RADIX_SORT_HPP
@@ -0,0 +1,201 @@
+#ifndef CSLIBS_NDT_UTILITY_SIMD_HPP
+#define CSLIBS_NDT_UTILITY_SIMD_HPP
+
+#include <cmath>
+#include <cstddef>
+
+/// the instruction set is chosen at build time, e.g. by -march=native (CS_USE_NATIVE),
+/// defining CSLIBS_NDT_DISABLE_SIMD forces the scalar fallback
+#if !defined(CSLIBS_NDT_DISABLE_SIMD) && defined(__AVX2__)
+#define CSLIBS_NDT_SIMD_AVX2
+#include <immintrin.h>
+#elif !defined(CSLIBS_NDT_DISABLE_SIMD) && defined(__SSE2__)
+#define CSLIBS_NDT_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace cslibs_ndt {
+namespace utility {
+namespace simd {
+/**
+ * @brief One value of type T, used where no vector type exists and for remainders.
+ */
+template <typename T>
+struct Scalar
+{
+    static constexpr std::size_t width = 1;
+
+    T v;
+
+    static inline Scalar set1(const T s)        { return {s}; }
+    static inline Scalar load(const T *p)       { return {*p}; }
+    inline void store(T *p) const               { *p = v; }
+    inline T sum() const                        { return v; }
+
+    inline Scalar operator + (const Scalar &o) const { return {v + o.v}; }
+    inline Scalar operator - (const Scalar &o) const { return {v - o.v}; }
+    inline Scalar operator * (const Scalar &o) const { return {v * o.v}; }
+
+    inline Scalar exp() const                   { return {std::exp(v)}; }
+};
+
+template <typename T>
+constexpr std::size_t Scalar<T>::width;
+
+#if defined(CSLIBS_NDT_SIMD_AVX2) || defined(CSLIBS_NDT_SIMD_SSE2)
+namespace detail {
+/**
+ * @brief exp(x) for packed doubles after Cephes: x = n ln2 + r with a rational
+ *        approximation for e^r, 2^n is built in the exponent bits. Results below
+ *        exp(-708) are flushed to zero, x is expected not to exceed 709.
+ */
+template <typename pack_t>
+inline pack_t exp(const pack_t &x)
+{
+    const pack_t xc = pack_t::max(x, pack_t::set1(-708.0));
+    const pack_t n  = pack_t::round(xc * pack_t::set1(1.4426950408889634073599));
+    pack_t r = xc - n * pack_t::set1(6.93145751953125e-1);
+    r = r - n * pack_t::set1(1.42860682030941723212e-6);
+
+    const pack_t rr = r * r;
+    pack_t p = pack_t::set1(1.26177193074810590878e-4);
+    p = p * rr + pack_t::set1(3.02994407707441961300e-2);
+    p = p * rr + pack_t::set1(9.99999999999999999910e-1);
+    p = p * r;
+    pack_t q = pack_t::set1(3.00198505138664455042e-6);
+    q = q * rr + pack_t::set1(2.52448340349684104192e-3);
+    q = q * rr + pack_t::set1(2.27265548208155028766e-1);
+    q = q * rr + pack_t::set1(2.00000000000000000009e0);
+
+    const pack_t e = pack_t::set1(1.0) + pack_t::set1(2.0) * (p / (q - p));
+    return pack_t::andGreater(e * pack_t::pow2(n), x, pack_t::set1(-708.0));
+}
+}
+#endif
+
+#if defined(CSLIBS_NDT_SIMD_AVX2)
+/**
+ * @brief Four doubles in an AVX register.
+ */
+struct Double
+{
+    static constexpr std::size_t width = 4;
+
+    __m256d v;
+
+    static inline Double set1(const double s)   { return {_mm256_set1_pd(s)}; }
+    static inline Double load(const double *p)  { return {_mm256_loadu_pd(p)}; }
+    inline void store(double *p) const          { _mm256_storeu_pd(p, v); }
+    inline double sum() const
+    {
+        const __m128d h = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+    }
+
+    inline Double operator + (const Double &o) const { return {_mm256_add_pd(v, o.v)}; }
+    inline Double operator - (const Double &o) const { return {_mm256_sub_pd(v, o.v)}; }
+    inline Double operator * (const Double &o) const { return {_mm256_mul_pd(v, o.v)}; }
+    inline Double operator / (const Double &o) const { return {_mm256_div_pd(v, o.v)}; }
+
+    static inline Double max(const Double &a, const Double &b) { return {_mm256_max_pd(a.v, b.v)}; }
+
+    /// a where x > limit, zero elsewhere
+    static inline Double andGreater(const Double &a, const Double &x, const Double &limit)
+    {
+        return {_mm256_and_pd(a.v, _mm256_cmp_pd(x.v, limit.v, _CMP_GT_OQ))};
+    }
+
+    static inline Double round(const Double &a)
+    {
+        return {_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+    }
+
+    /// 2^n for integral n in [-1022, 1023], written into the exponent bits
+    static inline Double pow2(const Double &n)
+    {
+        const __m128i e = _mm_add_epi32(_mm256_cvtpd_epi32(n.v), _mm_set1_epi32(1023));
+        return {_mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepi32_epi64(e), 52))};
+    }
+
+    inline Double exp() const                   { return detail::exp(*this); }
+};
+#elif defined(CSLIBS_NDT_SIMD_SSE2)
+/**
+ * @brief Two doubles in an SSE register.
+ */
+struct Double
+{
+    static constexpr std::size_t width = 2;
+
+    __m128d v;
+
+    static inline Double set1(const double s)   { return {_mm_set1_pd(s)}; }
+    static inline Double load(const double *p)  { return {_mm_loadu_pd(p)}; }
+    inline void store(double *p) const          { _mm_storeu_pd(p, v); }
+    inline double sum() const
+    {
+        return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+    }
+
+    inline Double operator + (const Double &o) const { return {_mm_add_pd(v, o.v)}; }
+    inline Double operator - (const Double &o) const { return {_mm_sub_pd(v, o.v)}; }
+    inline Double operator * (const Double &o) const { return {_mm_mul_pd(v, o.v)}; }
+    inline Double operator / (const Double &o) const { return {_mm_div_pd(v, o.v)}; }
+
+    static inline Double max(const Double &a, const Double &b) { return {_mm_max_pd(a.v, b.v)}; }
+
+    static inline Double andGreater(const Double &a, const Double &x, const Double &limit)
+    {
+        return {_mm_and_pd(a.v, _mm_cmpgt_pd(x.v, limit.v))};
+    }
+
+    static inline Double round(const Double &a)
+    {
+        return {_mm_cvtepi32_pd(_mm_cvtpd_epi32(a.v))};
+    }
+
+    static inline Double pow2(const Double &n)
+    {
+        const __m128i e = _mm_add_epi32(_mm_cvtpd_epi32(n.v), _mm_set1_epi32(1023));
+        return {_mm_castsi128_pd(_mm_slli_epi64(_mm_unpacklo_epi32(e, _mm_setzero_si128()), 52))};
+    }
+
+    inline Double exp() const                   { return detail::exp(*this); }
+};
+#else
+using Double = Scalar<double>;
+#endif
+
+/**
+ * @brief The widest pack available for T.
+ */
+template <typename T>
+struct Pack
+{
+    using type = Scalar<T>;
+};
+
+template <>
+struct Pack<double>
+{
+    using type = Double;
+};
+
+/**
+ * @brief The instruction set the kernels were compiled for.
+ */
+inline const char* name()
+{
+#if defined(CSLIBS_NDT_SIMD_AVX2)
+    return "avx2";
+#elif defined(CSLIBS_NDT_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+}
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_SIMD_HPP
@@ -0,0 +1,338 @@
+#ifndef CSLIBS_NDT_UTILITY_TILE_CACHE_HPP
+#define CSLIBS_NDT_UTILITY_TILE_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cslibs_ndt/utility/binary_indices.hpp>
+#include <cslibs_ndt/utility/index_hash.hpp>
+#include <cslibs_ndt/serialization/spill_file.hpp>
+
+#include <cslibs_math/common/div.hpp>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Keeps the memory of a map within a budget. The bundles are grouped into
+ *        tiles of tile_size^Dim bundles, the least recently used tiles are written
+ *        to a spill file and removed from the storages once the budget is exceeded.
+ *        A tile is faulted back in as soon as one of its bundles is touched again.
+ *        Only the distributions which lie completely within a tile are evicted,
+ *        distributions shared with neighbouring tiles stay resident. Not thread safe,
+ *        the budget is disabled as long as it is zero.
+ */
+template <std::size_t Dim, typename distribution_t, std::size_t bin_count>
+class TileCache
+{
+public:
+    using index_t      = std::array<int,Dim>;
+    using index_list_t = std::array<index_t,bin_count>;
+    using spill_file_t = serialization::SpillFile<distribution_t,Dim,bin_count>;
+
+    inline TileCache() :
+        budget_(0),
+        tile_size_(0),
+        clock_(0),
+        added_(0),
+        evictions_(0),
+        faults_(0)
+    {
+    }
+
+    /// a copy starts without budget, the map copies the evicted tiles
+    inline TileCache(const TileCache &) :
+        TileCache()
+    {
+    }
+
+    inline TileCache(TileCache &&other) :
+        budget_(other.budget_),
+        tile_size_(other.tile_size_),
+        clock_(other.clock_),
+        added_(other.added_),
+        evictions_(other.evictions_),
+        faults_(other.faults_),
+        tiles_(std::move(other.tiles_)),
+        spill_(std::move(other.spill_))
+    {
+        other.budget_ = 0;
+    }
+
+    inline bool enabled() const
+    {
+        return budget_ != 0;
+    }
+
+    /**
+     * @brief Start evicting tiles, every resident bundle is assigned to its tile.
+     * @param budget        the budget in bytes
+     * @param tile_size     edge length of a tile in bundles, at least 2
+     * @param path          the spill file
+     * @param bundles       the indices of the resident bundles
+     * @return false if the spill file cannot be opened
+     */
+    inline bool enable(const std::size_t budget,
+                       const std::size_t tile_size,
+                       const std::string &path,
+                       const std::vector<index_t> &bundles)
+    {
+        if (!spill_.open(path))
+            return false;
+
+        budget_    = budget;
+        tile_size_ = static_cast<int>(std::max<std::size_t>(2, tile_size));
+        tiles_.clear();
+        for (const index_t &bi : bundles)
+            tiles_[toTileIndex(bi)].bundles.emplace_back(bi);
+        added_ = 1;
+        return true;
+    }
+
+    /**
+     * @brief Stop evicting tiles, evicted tiles have to be faulted in before.
+     */
+    inline void disable()
+    {
+        budget_    = 0;
+        tile_size_ = 0;
+        tiles_.clear();
+        spill_.close();
+    }
+
+    /**
+     * @brief Mark the tile of a bundle as used, an evicted tile is faulted in.
+     *        Tiles without bundles are left alone, reads of empty space neither
+     *        create tiles nor advance the clock.
+     * @param bi            the bundle index
+     * @param storages      the layer storages
+     * @param create        creates a bundle from the resident distributions
+     */
+    template <typename storage_array_t, typename create_t>
+    inline void touch(const index_t &bi,
+                      const storage_array_t &storages,
+                      const create_t &create)
+    {
+        if (!enabled())
+            return;
+
+        const auto it = tiles_.find(toTileIndex(bi));
+        if (it == tiles_.end())
+            return;
+
+        tile_t &t = it->second;
+        t.stamp = ++clock_;
+        if (t.evicted)
+            faultIn(it->first, t, storages, create);
+    }
+
+    /**
+     * @brief Register a new bundle.
+     */
+    inline void add(const index_t &bi)
+    {
+        if (!enabled())
+            return;
+
+        tile_t &t = tiles_[toTileIndex(bi)];
+        t.bundles.emplace_back(bi);
+        t.stamp = ++clock_;
+        ++added_;
+    }
+
+    /**
+     * @brief Evict the least recently used tiles while the resident bytes exceed the
+     *        budget. Nothing happens unless bundles were added or faulted in since
+     *        the last call.
+     * @param storages      the layer storages
+     * @param bundles       the bundle storage
+     * @param resident      returns the resident bytes
+     */
+    template <typename storage_array_t, typename bundle_storage_t, typename resident_t>
+    inline void enforce(const storage_array_t &storages,
+                        bundle_storage_t &bundles,
+                        const resident_t &resident)
+    {
+        if (!enabled() || added_ == 0)
+            return;
+        added_ = 0;
+        if (resident() <= budget_)
+            return;
+
+        std::vector<std::pair<std::uint64_t, index_t>> order;
+        for (const auto &t : tiles_)
+            if (!t.second.evicted && !t.second.bundles.empty())
+                order.emplace_back(t.second.stamp, t.first);
+        std::sort(order.begin(), order.end());
+
+        /// evict some headroom, otherwise every new tile evicts another one
+        const std::size_t target = budget_ - budget_ / 8;
+        for (const auto &o : order) {
+            if (resident() <= target)
+                break;
+            evict(o.second, tiles_.at(o.second), storages, bundles);
+        }
+    }
+
+    /**
+     * @brief Fault in every evicted tile.
+     */
+    template <typename storage_array_t, typename create_t>
+    inline void faultInAll(const storage_array_t &storages,
+                           const create_t &create)
+    {
+        for (auto &t : tiles_)
+            if (t.second.evicted)
+                faultIn(t.first, t.second, storages, create);
+    }
+
+    /**
+     * @brief Read the evicted tiles into other storages, the tiles stay evicted.
+     */
+    template <typename storage_array_t, typename create_t>
+    inline void copyEvicted(const storage_array_t &storages,
+                            const create_t &create) const
+    {
+        std::vector<index_t> bundles;
+        for (const auto &t : tiles_) {
+            if (!t.second.evicted)
+                continue;
+            read(t.first, bundles, storages);
+            for (const index_t &bi : bundles)
+                create(bi);
+        }
+    }
+
+    inline std::size_t getBudget() const
+    {
+        return budget_;
+    }
+
+    inline std::size_t getTileSize() const
+    {
+        return static_cast<std::size_t>(tile_size_);
+    }
+
+    inline std::size_t getEvictionCount() const
+    {
+        return evictions_;
+    }
+
+    inline std::size_t getFaultCount() const
+    {
+        return faults_;
+    }
+
+    inline std::size_t getEvictedTileCount() const
+    {
+        return spill_.records();
+    }
+
+    inline std::size_t getSpillFileSize() const
+    {
+        return spill_.size();
+    }
+
+private:
+    struct tile_t
+    {
+        std::uint64_t        stamp   = 0;
+        bool                 evicted = false;
+        std::vector<index_t> bundles;
+    };
+
+    std::size_t                                          budget_;
+    int                                                  tile_size_;
+    std::uint64_t                                        clock_;
+    std::size_t                                          added_;
+    std::size_t                                          evictions_;
+    std::size_t                                          faults_;
+    std::unordered_map<index_t, tile_t, IndexHash<Dim>>  tiles_;
+    spill_file_t                                         spill_;
+
+    inline index_t toTileIndex(const index_t &bi) const
+    {
+        index_t ti;
+        for (std::size_t i=0; i<Dim; ++i)
+            ti[i] = cslibs_math::common::div(bi[i], tile_size_);
+        return ti;
+    }
+
+    /// all bundles sharing the distribution lie within the tile
+    inline bool interior(const std::size_t layer,
+                         const index_t &index,
+                         const index_t &ti) const
+    {
+        for (std::size_t i=0; i<Dim; ++i) {
+            const int first = 2 * index[i] - static_cast<int>((layer >> i) & 1ul);
+            if (cslibs_math::common::div(first, tile_size_) != ti[i] ||
+                    cslibs_math::common::div(first + 1, tile_size_) != ti[i])
+                return false;
+        }
+        return true;
+    }
+
+    template <typename storage_array_t, typename bundle_storage_t>
+    inline void evict(const index_t &ti,
+                      tile_t &t,
+                      const storage_array_t &storages,
+                      bundle_storage_t &bundles)
+    {
+        typename spill_file_t::layers_t layers;
+        for (const index_t &bi : t.bundles) {
+            const index_list_t indices = generate_indices<index_list_t,Dim>(bi);
+            for (std::size_t i=0; i<bin_count; ++i)
+                if (interior(i, indices[i], ti))
+                    layers[i].emplace_back(indices[i]);
+        }
+        for (auto &l : layers) {
+            std::sort(l.begin(), l.end());
+            l.erase(std::unique(l.begin(), l.end()), l.end());
+        }
+        spill_.write(ti, t.bundles, layers, storages);
+
+        /// bundles point into the layers, they are removed first
+        for (const index_t &bi : t.bundles)
+            bundles.remove(bi);
+        for (std::size_t i=0; i<bin_count; ++i)
+            for (const index_t &index : layers[i])
+                storages[i]->remove(index);
+
+        std::vector<index_t>().swap(t.bundles);
+        t.evicted = true;
+        ++evictions_;
+    }
+
+    template <typename storage_array_t, typename create_t>
+    inline void faultIn(const index_t &ti,
+                        tile_t &t,
+                        const storage_array_t &storages,
+                        const create_t &create)
+    {
+        read(ti, t.bundles, storages);
+        spill_.erase(ti);
+        t.evicted = false;
+        for (const index_t &bi : t.bundles)
+            create(bi);
+        added_ += t.bundles.size();
+        ++faults_;
+    }
+
+    template <typename storage_array_t>
+    inline void read(const index_t &ti,
+                     std::vector<index_t> &bundles,
+                     const storage_array_t &storages) const
+    {
+        spill_.read(ti, bundles, [&storages](const std::size_t layer, const index_t &index, const distribution_t &d) {
+            storages[layer]->insert(index, d);
+        });
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_TILE_CACHE_HPP
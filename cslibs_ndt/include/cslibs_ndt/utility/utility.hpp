@@ -6,5 +6,16 @@
 #include <cslibs_ndt/utility/merge.hpp>
 #include <cslibs_ndt/utility/create.hpp>
 #include <cslibs_ndt/utility/for_each.hpp>
+#include <cslibs_ndt/utility/parallel.hpp>
+#include <cslibs_ndt/utility/atomic_index.hpp>
+#include <cslibs_ndt/utility/lock_stripes.hpp>
+#include <cslibs_ndt/utility/index_hash.hpp>
+#include <cslibs_ndt/utility/morton.hpp>
+#include <cslibs_ndt/utility/radix_sort.hpp>
+#include <cslibs_ndt/utility/morton_order.hpp>
+#include <cslibs_ndt/utility/pool.hpp>
+#include <cslibs_ndt/utility/bundle_gaussians.hpp>
+#include <cslibs_ndt/utility/change_tracker.hpp>
+#include <cslibs_ndt/utility/dirty_bundles.hpp>
 
 #endif // CSLIBS_NDT_UTILITY_HPP
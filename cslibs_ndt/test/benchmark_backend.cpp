@@ -0,0 +1,108 @@
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/flat_hash_map.hpp>
+#include <cslibs_ndt/backend/tiled_map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace tags = cslibs_ndt::map::tags;
+
+template <std::size_t Dim>
+using map_t       = cslibs_ndt::map::Map<tags::dynamic_map,Dim,cslibs_ndt::Distribution,double>;
+template <std::size_t Dim>
+using flat_map_t  = cslibs_ndt::map::Map<tags::dynamic_map,Dim,cslibs_ndt::Distribution,double,
+                                         cslibs_ndt::backend::FlatHashMap,cslibs_ndt::backend::FlatHashMap>;
+template <std::size_t Dim>
+using tiled_map_t = cslibs_ndt::map::Map<tags::dynamic_map,Dim,cslibs_ndt::Distribution,double,
+                                         cslibs_ndt::backend::TiledMap>;
+
+/// 2d: a 200m x 200m floor plan with walls every 5m
+inline std::vector<cslibs_math_2d::Point2d> generatePoints2d(const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(-100.0, 100.0);
+    cslibs_math::random::Normal<double,1>  n(0.0, 0.02);
+    std::vector<cslibs_math_2d::Point2d> points;
+    points.reserve(count);
+    for (std::size_t i = 0 ; i < count ; ++i) {
+        const double wall = 5.0 * std::round(u.get() / 5.0) + n.get();
+        if (i % 2)
+            points.emplace_back(wall, u.get());
+        else
+            points.emplace_back(u.get(), wall);
+    }
+    return points;
+}
+
+/// 3d: a 100m x 100m area with ground and facades up to 10m
+inline std::vector<cslibs_math_3d::Point3d> generatePoints3d(const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(-50.0, 50.0);
+    cslibs_math::random::Uniform<double,1> h(0.0, 10.0);
+    cslibs_math::random::Normal<double,1>  n(0.0, 0.02);
+    std::vector<cslibs_math_3d::Point3d> points;
+    points.reserve(count);
+    for (std::size_t i = 0 ; i < count ; ++i) {
+        const double facade = 10.0 * std::round(u.get() / 10.0) + n.get();
+        switch (i % 3) {
+        case 0:  points.emplace_back(u.get(), u.get(), n.get()); break;
+        case 1:  points.emplace_back(facade, u.get(), h.get()); break;
+        default: points.emplace_back(u.get(), facade, h.get()); break;
+        }
+    }
+    return points;
+}
+
+template <typename map_t, typename points_t>
+void run(const std::string &name,
+         const points_t &points,
+         const points_t &queries,
+         const double resolution)
+{
+    using clock_t = std::chrono::steady_clock;
+
+    map_t map(resolution);
+    auto start = clock_t::now();
+    map.insert(points.begin(), points.end());
+    const double insert_ms = std::chrono::duration<double, std::milli>(clock_t::now() - start).count();
+
+    start = clock_t::now();
+    double sum = 0.0;
+    for (const auto &q : queries)
+        sum += map.sampleNonNormalized(q);
+    const double lookup_ms = std::chrono::duration<double, std::milli>(clock_t::now() - start).count();
+
+    std::vector<typename map_t::index_t> indices;
+    map.getBundleIndices(indices);
+
+    std::cout << name
+              << " | bundles: "          << indices.size()
+              << " | insert ms: "        << insert_ms
+              << " | lookup ns/query: "  << 1e6 * lookup_ms / static_cast<double>(queries.size())
+              << " | bytes: "            << map.getByteSize()
+              << " | checksum: "         << sum << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t count      = argc > 1 ? std::stoul(argv[1]) : 2000000ul;
+    const double      resolution = argc > 2 ? std::stod(argv[2]) : 0.5;
+
+    {
+        const auto points  = generatePoints2d(count);
+        const auto queries = generatePoints2d(count / 2);
+        run<map_t<2>>      ("2d unordered map", points, queries, resolution);
+        run<flat_map_t<2>> ("2d flat hash map", points, queries, resolution);
+        run<tiled_map_t<2>>("2d tiled map", points, queries, resolution);
+    }
+    {
+        const auto points  = generatePoints3d(count);
+        const auto queries = generatePoints3d(count / 2);
+        run<map_t<3>>      ("3d unordered map", points, queries, resolution);
+        run<flat_map_t<3>> ("3d flat hash map", points, queries, resolution);
+        run<tiled_map_t<3>>("3d tiled map", points, queries, resolution);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <cslibs_ndt/utility/bundle_gaussians.hpp>
+#include <cslibs_math/statistics/stable_distribution.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <iostream>
+#include <string>
+
+using rng_t    = cslibs_math::random::Uniform<double,1>;
+
+const std::size_t NUM_POINTS = 1000000;
+const std::size_t NUM_BATCH  = 64;
+
+template <std::size_t Dim>
+void benchmark()
+{
+    static constexpr std::size_t bin_count = 1ul << Dim;
+    using gaussians_t    = cslibs_ndt::utility::BundleGaussians<double,Dim,bin_count>;
+    using distribution_t = cslibs_math::statistics::StableDistribution<double,Dim,3>;
+    using sample_t       = typename distribution_t::sample_t;
+
+    rng_t rng(-1.0, +1.0);
+    auto random = [&rng]() {
+        sample_t s;
+        for (std::size_t d=0; d<Dim; ++d)
+            s(d) = rng.get();
+        return s;
+    };
+
+    std::vector<distribution_t, Eigen::aligned_allocator<distribution_t>> layers(bin_count);
+    for (distribution_t &l : layers)
+        for (std::size_t i=0; i<20; ++i)
+            l.add(random());
+
+    std::vector<sample_t, Eigen::aligned_allocator<sample_t>> points;
+    std::vector<double> coordinates(Dim * NUM_BATCH);
+    for (std::size_t i=0; i<NUM_POINTS; ++i)
+        points.emplace_back(random() * 1.5);
+    for (std::size_t j=0; j<NUM_BATCH; ++j)
+        for (std::size_t d=0; d<Dim; ++d)
+            coordinates[d * NUM_BATCH + j] = points[j](d);
+
+    auto gather = [&layers](gaussians_t &g) {
+        g.clear();
+        for (const distribution_t &l : layers)
+            if (l.valid())
+                g.add(l.getMean(), l.getInformationMatrix(), 1.0 / bin_count);
+    };
+    gaussians_t gaussians;
+    gather(gaussians);
+
+    /// all layers of a bundle at one point
+    double reference_sum = 0.0, kernel_sum = 0.0, gather_sum = 0.0;
+    const double reference = measure(NUM_POINTS, [&]() {
+        for (const sample_t &p : points)
+            for (const distribution_t &l : layers)
+                reference_sum += l.sampleNonNormalized(p) / bin_count;
+    });
+    const double kernel = measure(NUM_POINTS, [&]() {
+        for (const sample_t &p : points)
+            kernel_sum += gaussians.evaluate(p.data().data());
+    });
+    const double gathered = measure(NUM_POINTS, [&]() {
+        gaussians_t g;
+        for (const sample_t &p : points) {
+            gather(g);
+            gather_sum += g.evaluate(p.data().data());
+        }
+    });
+    std::cout << Dim << "d bundle, one point | reference ns: " << reference
+              << " | kernel ns: " << kernel << " | gather + kernel ns: " << gathered
+              << " | checksums: " << reference_sum << " / " << kernel_sum << " / " << gather_sum << "\n";
+
+    /// all layers of a bundle at many points
+    const std::size_t batches = NUM_POINTS / NUM_BATCH;
+    std::vector<double> values(NUM_BATCH);
+    reference_sum = 0.0;
+    kernel_sum    = 0.0;
+    const double batch_reference = measure(batches * NUM_BATCH, [&]() {
+        for (std::size_t b=0; b<batches; ++b)
+            for (std::size_t j=0; j<NUM_BATCH; ++j)
+                for (const distribution_t &l : layers)
+                    reference_sum += l.sampleNonNormalized(points[j]) / bin_count;
+    });
+    const double batch_kernel = measure(batches * NUM_BATCH, [&]() {
+        for (std::size_t b=0; b<batches; ++b) {
+            std::fill(values.begin(), values.end(), 0.0);
+            gaussians.evaluate(NUM_BATCH, coordinates.data(), values.data());
+            for (const double v : values)
+                kernel_sum += v;
+        }
+    });
+    std::cout << Dim << "d bundle, " << NUM_BATCH << " points | reference ns/point: " << batch_reference
+              << " | kernel ns/point: " << batch_kernel
+              << " | checksums: " << reference_sum << " / " << kernel_sum << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    std::cout << "instruction set: " << cslibs_ndt::utility::simd::name() << "\n";
+    benchmark<2>();
+    benchmark<3>();
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <cslibs_ndt/map/map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <iostream>
+#include <string>
+
+namespace tags = cslibs_ndt::map::tags;
+
+template <std::size_t Dim>
+using point_t  = typename cslibs_ndt::map::traits<Dim,double>::point_t;
+
+inline cslibs_math_2d::Point2d randomPoint(cslibs_math::random::Uniform<double,1> &u, const cslibs_math_2d::Point2d &)
+{
+    return cslibs_math_2d::Point2d(u.get(), u.get());
+}
+
+inline cslibs_math_3d::Point3d randomPoint(cslibs_math::random::Uniform<double,1> &u, const cslibs_math_3d::Point3d &)
+{
+    return cslibs_math_3d::Point3d(u.get(), u.get(), u.get());
+}
+
+template <std::size_t Dim>
+inline std::vector<point_t<Dim>> generatePoints(const std::size_t count, const double range)
+{
+    cslibs_math::random::Uniform<double,1> u(-range, range);
+    std::vector<point_t<Dim>> points;
+    points.reserve(count);
+    for (std::size_t i = 0 ; i < count ; ++i)
+        points.emplace_back(randomPoint(u, point_t<Dim>()));
+    return points;
+}
+
+/// insert, expand and query a map, reports ns per point
+template <typename map_t, std::size_t Dim>
+void run(const std::string &name, map_t &map, const std::size_t count)
+{
+    const auto points  = generatePoints<Dim>(count, 10.0);
+    const auto queries = generatePoints<Dim>(count, 12.0);
+
+    const double insert_ms = measure([&map, &points]() {
+        for (const auto &p : points)
+            map.insert(p);
+    });
+    const double expand_ms = measure([&map]() {
+        map.allocatePartiallyAllocatedBundles();
+    });
+    /// a small update afterwards, expanded incrementally and by a full pass
+    const auto update = generatePoints<Dim>(count / 100, 1.0);
+    for (const auto &p : update)
+        map.insert(p);
+    const double update_ms = measure([&map]() {
+        map.allocatePartiallyAllocatedBundles();
+    });
+    for (const auto &p : update)
+        map.insert(p);
+    const double full_ms = measure([&map]() {
+        map.allocateAllPartiallyAllocatedBundles();
+    });
+    double sum = 0.0;
+    const double sample_ms = measure([&map, &queries, &sum]() {
+        for (const auto &q : queries)
+            sum += map.sampleNonNormalized(q);
+    });
+
+    const double n = static_cast<double>(count);
+    std::cout << name
+              << " | insert ns/point: " << 1e6 * insert_ms / n
+              << " | expand ms: "       << expand_ms
+              << " | update expand ms: " << update_ms
+              << " | full expand ms: "  << full_ms
+              << " | sample ns/point: " << 1e6 * sample_ms / n
+              << " | checksum: "        << sum << "\n";
+}
+
+template <std::size_t Dim>
+void runStatic(const std::string &name, const std::size_t count, const double resolution)
+{
+    using map_t = cslibs_ndt::map::Map<tags::static_map,Dim,cslibs_ndt::Distribution,double>;
+
+    /// size counts distributions per layer, i.e. two bundles per dimension
+    std::array<std::size_t,Dim> size;
+    std::array<int,Dim> min_index;
+    size.fill(2ul * (static_cast<std::size_t>(10.0 / resolution) + 1ul));
+    min_index.fill(-static_cast<int>(size[0]));
+
+    map_t map(typename map_t::pose_t(), resolution, size, min_index);
+    run<map_t,Dim>(name, map, count);
+}
+
+template <std::size_t Dim>
+void runDynamic(const std::string &name, const std::size_t count, const double resolution)
+{
+    using map_t = cslibs_ndt::map::Map<tags::dynamic_map,Dim,cslibs_ndt::Distribution,double>;
+
+    map_t map(resolution);
+    run<map_t,Dim>(name, map, count);
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t count      = argc > 1 ? std::stoul(argv[1]) : 1000000ul;
+    const double      resolution = argc > 2 ? std::stod(argv[2]) : 1.0;
+
+    runStatic<2>("2d static ", count, resolution);
+    runDynamic<2>("2d dynamic", count, resolution);
+    runStatic<3>("3d static ", count, resolution);
+    runDynamic<3>("3d dynamic", count, resolution);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <cslibs_ndt/map/map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <iostream>
+#include <string>
+
+using map_t    = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using point_t  = map_t::point_t;
+using scan_t   = std::vector<point_t>;
+
+/// drive along a line and back, reports the insertion time with and without a budget
+int main(int argc, char *argv[])
+{
+    const std::size_t steps      = argc > 1 ? std::stoul(argv[1]) : 200ul;
+    const std::size_t scan_size  = argc > 2 ? std::stoul(argv[2]) : 20000ul;
+    const double      fraction   = argc > 3 ? std::stod(argv[3]) : 0.25;
+    const std::size_t tile_size  = argc > 4 ? std::stoul(argv[4]) : 16ul;
+    const std::string path       = argc > 5 ? argv[5] : "/tmp/cslibs_ndt_benchmark_memory_budget.spill";
+
+    cslibs_math::random::Uniform<double,1> u(-10.0, 10.0);
+    std::vector<scan_t> scans(2 * steps);
+    for (std::size_t s = 0 ; s < 2 * steps ; ++s) {
+        const double x = 2.0 * static_cast<double>(s < steps ? s : 2 * steps - s - 1);
+        for (std::size_t i = 0 ; i < scan_size ; ++i)
+            scans[s].emplace_back(x + u.get(), u.get(), 0.1 * u.get());
+    }
+
+    map_t unbounded(map_t::pose_t(), 0.5);
+    const double unbounded_ms = measure([&unbounded, &scans]() {
+        for (const scan_t &scan : scans)
+            unbounded.insert(scan.begin(), scan.end());
+    });
+
+    map_t bounded(map_t::pose_t(), 0.5);
+    const std::size_t budget = static_cast<std::size_t>(fraction * static_cast<double>(unbounded.getResidentByteSize()));
+    if (!bounded.setMemoryBudget(budget, path, tile_size))
+        return 1;
+    const double bounded_ms = measure([&bounded, &scans]() {
+        for (const scan_t &scan : scans)
+            bounded.insert(scan.begin(), scan.end());
+    });
+
+    const double n = static_cast<double>(scans.size());
+    std::cout << "unbounded ms/scan: "  << unbounded_ms / n
+              << " | bounded ms/scan: " << bounded_ms / n
+              << " | resident bytes: "  << unbounded.getResidentByteSize() << " / " << bounded.getResidentByteSize()
+              << " | budget: "          << budget
+              << " | evictions: "       << bounded.getEvictionCount()
+              << " | faults: "          << bounded.getFaultCount()
+              << " | spill bytes: "     << bounded.getSpillFileSize() << "\n";
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <cslibs_ndt/map/rolling_map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <deque>
+#include <iostream>
+#include <string>
+
+namespace tags = cslibs_ndt::map::tags;
+
+using rolling_map_t = cslibs_ndt::map::RollingMap<3,cslibs_ndt::Distribution,double>;
+using static_map_t  = cslibs_ndt::map::Map<tags::static_map,3,cslibs_ndt::Distribution,double>;
+using point_t       = rolling_map_t::point_t;
+using index_t       = rolling_map_t::index_t;
+using scan_t        = std::vector<point_t>;
+
+inline scan_t generateScan(cslibs_math::random::Uniform<double,1> &u, const point_t &robot, const std::size_t count)
+{
+    scan_t scan;
+    scan.reserve(count);
+    for (std::size_t i = 0 ; i < count ; ++i)
+        scan.emplace_back(robot(0) + u.get(), robot(1) + u.get(), 0.1 * u.get());
+    return scan;
+}
+
+/// drive along a line, the local map follows the robot; reports ms per step
+int main(int argc, char *argv[])
+{
+    const std::size_t steps      = argc > 1 ? std::stoul(argv[1]) : 100ul;
+    const std::size_t scan_size  = argc > 2 ? std::stoul(argv[2]) : 20000ul;
+    const double      resolution = argc > 3 ? std::stod(argv[3]) : 0.5;
+    const double      speed      = 0.8;
+
+    const rolling_map_t::size_t size = {{80ul, 80ul, 8ul}};
+    const double range = 0.5 * resolution * static_cast<double>(size[0]);
+    cslibs_math::random::Uniform<double,1> u(-range, range);
+
+    /// the scans which still overlap the window
+    const std::size_t history = static_cast<std::size_t>(2.0 * range / speed) + 1ul;
+
+    rolling_map_t rolling(rolling_map_t::pose_t(), resolution, size);
+    std::deque<scan_t> scans;
+    double roll_ms    = 0.0;
+    double rebuild_ms = 0.0;
+    double insert_ms  = 0.0;
+    for (std::size_t s = 0 ; s < steps ; ++s) {
+        const point_t robot(speed * static_cast<double>(s), 0.0, 0.0);
+        scans.emplace_back(generateScan(u, robot, scan_size));
+        if (scans.size() > history)
+            scans.pop_front();
+
+        roll_ms += measure([&rolling, &robot]() {
+            rolling.moveTo(robot);
+        });
+        insert_ms += measure([&rolling, &scans]() {
+            rolling.insert(scans.back().begin(), scans.back().end());
+        });
+
+        /// a static map has to be rebuilt from the scans which are still in range
+        rebuild_ms += measure([&scans, &robot, &size, resolution]() {
+            index_t min_bundle_index;
+            for (std::size_t i = 0 ; i < 3 ; ++i)
+                min_bundle_index[i] = 2 * (static_cast<int>(std::floor(robot(i) / resolution)) - static_cast<int>(size[i] / 2));
+            static_map_t map(static_map_t::pose_t(), resolution, size, min_bundle_index);
+            for (const scan_t &scan : scans)
+                map.insert(scan.begin(), scan.end());
+        });
+    }
+
+    const double n = static_cast<double>(steps);
+    std::cout << "rolling move ms/step: "    << roll_ms / n
+              << " | rolling insert ms/step: " << insert_ms / n
+              << " | static rebuild ms/step: " << rebuild_ms / n
+              << " | bytes: "                  << rolling.getByteSize() << "\n";
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <cslibs_ndt/map/map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace tags = cslibs_ndt::map::tags;
+
+using clock_t_ = std::chrono::steady_clock;
+using ivm_t    = cslibs_gridmaps::utility::InverseModel<double>;
+
+template <std::size_t Dim>
+using point_t  = typename cslibs_ndt::map::traits<Dim,double>::point_t;
+
+inline cslibs_math_2d::Point2d randomPoint(cslibs_math::random::Uniform<double,1> &u, const cslibs_math_2d::Point2d &)
+{
+    return cslibs_math_2d::Point2d(u.get(), u.get());
+}
+
+inline cslibs_math_3d::Point3d randomPoint(cslibs_math::random::Uniform<double,1> &u, const cslibs_math_3d::Point3d &)
+{
+    return cslibs_math_3d::Point3d(u.get(), u.get(), u.get());
+}
+
+template <std::size_t Dim>
+inline std::vector<point_t<Dim>> generatePoints(const std::size_t count, const double range)
+{
+    cslibs_math::random::Uniform<double,1> u(-range, range);
+    std::vector<point_t<Dim>> points;
+    points.reserve(count);
+    for (std::size_t i = 0 ; i < count ; ++i)
+        points.emplace_back(randomPoint(u, point_t<Dim>()));
+    return points;
+}
+
+template <typename single_t, typename batch_t>
+void report(const std::string &name,
+            const std::size_t queries,
+            const single_t &single,
+            const batch_t &batch)
+{
+    auto start = clock_t_::now();
+    const double sum_single = single();
+    const double single_ms = std::chrono::duration<double, std::milli>(clock_t_::now() - start).count();
+
+    start = clock_t_::now();
+    const double sum_batch = batch();
+    const double batch_ms = std::chrono::duration<double, std::milli>(clock_t_::now() - start).count();
+
+    std::cout << name
+              << " | single ns/point: " << 1e6 * single_ms / static_cast<double>(queries)
+              << " | batch ns/point: "  << 1e6 * batch_ms  / static_cast<double>(queries)
+              << " | speedup: "         << single_ms / batch_ms
+              << " | checksums: "       << sum_single << " / " << sum_batch << "\n";
+}
+
+template <std::size_t Dim, template <typename,std::size_t> class data_t>
+void runOccupancy(const std::string &name, const std::size_t count, const double resolution)
+{
+    using map_t = cslibs_ndt::map::Map<tags::dynamic_map,Dim,data_t,double>;
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+
+    map_t map(resolution);
+    const auto points = generatePoints<Dim>(count, 10.0);
+    map.insert(points.begin(), points.end());
+
+    /// particle filter like queries, clustered around the map content
+    const auto queries = generatePoints<Dim>(count, 10.0);
+    std::vector<double> values;
+    report(name, queries.size(),
+           [&map, &queries, &ivm]() {
+        double sum = 0.0;
+        for (const auto &q : queries)
+            sum += map.sampleNonNormalized(q, ivm);
+        return sum;
+    },
+           [&map, &queries, &values, &ivm]() {
+        map.sampleNonNormalized(queries.begin(), queries.end(), values, ivm);
+        double sum = 0.0;
+        for (const double v : values)
+            sum += v;
+        return sum;
+    });
+}
+
+template <std::size_t Dim>
+void runGridmap(const std::string &name, const std::size_t count, const double resolution)
+{
+    using map_t = cslibs_ndt::map::Map<tags::dynamic_map,Dim,cslibs_ndt::Distribution,double>;
+
+    map_t map(resolution);
+    const auto points = generatePoints<Dim>(count, 10.0);
+    map.insert(points.begin(), points.end());
+
+    const auto queries = generatePoints<Dim>(count, 10.0);
+    std::vector<double> values;
+    report(name, queries.size(),
+           [&map, &queries]() {
+        double sum = 0.0;
+        for (const auto &q : queries)
+            sum += map.sampleNonNormalized(q);
+        return sum;
+    },
+           [&map, &queries, &values]() {
+        map.sampleNonNormalized(queries.begin(), queries.end(), values);
+        double sum = 0.0;
+        for (const double v : values)
+            sum += v;
+        return sum;
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t count      = argc > 1 ? std::stoul(argv[1]) : 1000000ul;
+    const double      resolution = argc > 2 ? std::stod(argv[2]) : 1.0;
+
+    runGridmap<2>("2d gridmap", count, resolution);
+    runGridmap<3>("3d gridmap", count, resolution);
+    runOccupancy<2, cslibs_ndt::OccupancyDistribution>("2d occupancy gridmap", count, resolution);
+    runOccupancy<3, cslibs_ndt::OccupancyDistribution>("3d occupancy gridmap", count, resolution);
+    runOccupancy<2, cslibs_ndt::WeightedOccupancyDistribution>("2d weighted occupancy gridmap", count, resolution);
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <cslibs_ndt/map/map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace tags = cslibs_ndt::map::tags;
+
+using dynamic_map_t = cslibs_ndt::map::Map<tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using static_map_t  = cslibs_ndt::map::Map<tags::static_map,3,cslibs_ndt::Distribution,double>;
+using index_t       = dynamic_map_t::index_t;
+using bundle_t      = dynamic_map_t::distribution_bundle_t;
+
+/// a 100m x 100m area with ground and facades up to 10m
+inline std::vector<cslibs_math_3d::Point3d> generatePoints(const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(-50.0, 50.0);
+    cslibs_math::random::Uniform<double,1> h(0.0, 10.0);
+    cslibs_math::random::Normal<double,1>  n(0.0, 0.02);
+    std::vector<cslibs_math_3d::Point3d> points;
+    points.reserve(count);
+    for (std::size_t i = 0 ; i < count ; ++i) {
+        const double facade = 10.0 * std::round(u.get() / 10.0) + n.get();
+        switch (i % 3) {
+        case 0:  points.emplace_back(u.get(), u.get(), n.get()); break;
+        case 1:  points.emplace_back(facade, u.get(), h.get()); break;
+        default: points.emplace_back(u.get(), facade, h.get()); break;
+        }
+    }
+    return points;
+}
+
+/// the body of conversion::convert, copies every bundle into a static map
+inline std::unique_ptr<static_map_t> createStatic(const dynamic_map_t &src)
+{
+    static_map_t::size_t size;
+    index_t min_index;
+    for (std::size_t i = 0 ; i < 3 ; ++i) {
+        min_index[i] = (src.getMinBundleIndex()[i] / 2 - 1) * 2;
+        size[i]      = static_cast<std::size_t>(src.getMaxBundleIndex()[i] - min_index[i]) / 2 + 2;
+    }
+    return std::unique_ptr<static_map_t>(new static_map_t(src.getInitialOrigin(), src.getResolution(), size, min_index));
+}
+
+template <typename traverse_t>
+inline double convert(const dynamic_map_t &src, const traverse_t &traverse)
+{
+    std::unique_ptr<static_map_t> dst = createStatic(src);
+    return measure([&dst, &traverse]() {
+        traverse([&dst](const index_t &bi, const bundle_t &b) {
+            if (const static_map_t::distribution_bundle_t *b_dst = dst->getDistributionBundle(bi))
+                for (std::size_t i = 0 ; i < dynamic_map_t::bin_count ; ++i)
+                    *(b_dst->at(i)) = *(b.at(i));
+        });
+    });
+}
+
+/// the body of the distribution conversions, merges and evaluates every bundle
+inline bool evaluate(const bundle_t &b)
+{
+    dynamic_map_t::distribution_t::distribution_t d;
+    for (std::size_t i = 0 ; i < dynamic_map_t::bin_count ; ++i)
+        d += b.at(i)->data();
+    if (d.getN() < 3)
+        return false;
+
+    const cslibs_math_3d::Point3d mean(d.getMean());
+    double value = 0.0;
+    for (std::size_t i = 0 ; i < dynamic_map_t::bin_count ; ++i)
+        value += b.at(i)->data().sampleNonNormalized(mean);
+    return value > 0.5 * dynamic_map_t::bin_count;
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t count      = argc > 1 ? std::stoul(argv[1]) : 2000000ul;
+    const double      resolution = argc > 2 ? std::stod(argv[2]) : 0.5;
+    const std::size_t threads    = argc > 3 ? std::stoul(argv[3]) : cslibs_ndt::utility::hardware_threads();
+
+    dynamic_map_t map(resolution);
+    const auto points = generatePoints(count);
+    map.insert(points.begin(), points.end());
+    map.allocatePartiallyAllocatedBundles();
+
+    std::vector<index_t> indices;
+    map.getBundleIndices(indices);
+    std::cout << indices.size() << " bundles, " << threads << " threads\n";
+
+    /// the first conversion pays for fresh pages of the allocator
+    convert(map, [&map](const std::function<void(const index_t&, const bundle_t&)> &f) { map.traverse(f); });
+    const double convert_backend_ms = convert(map, [&map](const std::function<void(const index_t&, const bundle_t&)> &f) { map.traverse(f); });
+    const double convert_ordered_ms = convert(map, [&map](const std::function<void(const index_t&, const bundle_t&)> &f) { map.traverseOrdered(f); });
+    std::cout << "convert   | backend order ms: " << convert_backend_ms
+              << " | morton order ms: "           << convert_ordered_ms << "\n";
+
+    std::atomic<std::size_t> hits(0);
+    auto process = [&hits](const index_t &, const bundle_t &b) {
+        if (evaluate(b))
+            ++hits;
+    };
+    const double evaluate_backend_ms  = measure([&map, &process]() { map.traverse(process); });
+    const double evaluate_ordered_ms  = measure([&map, &process]() { map.traverseOrdered(process); });
+    const double evaluate_parallel_ms = measure([&map, &process, threads]() { map.traverseParallel(process, threads); });
+    std::cout << "evaluate  | backend order ms: " << evaluate_backend_ms
+              << " | morton order ms: "           << evaluate_ordered_ms
+              << " | parallel ms: "               << evaluate_parallel_ms
+              << " | hits: "                      << hits / 3 << "\n";
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/flat_hash_map.hpp>
+#include <cslibs_ndt/backend/tiled_map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <set>
+
+const std::size_t NUM_SAMPLES = 10000;
+using rng_t         = cslibs_math::random::Uniform<double,1>;
+using map_t         = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using flat_map_t    = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double,
+                                           cslibs_ndt::backend::FlatHashMap>;
+using tiled_map_t   = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double,
+                                           cslibs_ndt::backend::TiledMap>;
+using flat_map_2d_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,2,cslibs_ndt::Distribution,double,
+                                           cslibs_ndt::backend::FlatHashMap>;
+using point_t       = cslibs_math_3d::Point3d;
+
+/// the bundles of a slot map resolve to the distributions of its own layers
+template <typename slot_map_t>
+void testSlotMap()
+{
+    rng_t rng(-10.0, +10.0);
+    std::vector<point_t> points;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        points.emplace_back(rng.get(), rng.get(), rng.get());
+
+    map_t map(1.0);
+    map.insert(points.begin(), points.end());
+    typename slot_map_t::Ptr slot_map(new slot_map_t(1.0));
+    slot_map->insert(points.begin(), points.end());
+    expectEqual(map, *slot_map, 1e-9);
+
+    std::vector<map_t::index_t> indices;
+    slot_map->getBundleIndices(indices);
+    for (const auto &bi : indices) {
+        const typename slot_map_t::distribution_bundle_t *bundle = slot_map->get(bi);
+        ASSERT_NE(nullptr, bundle);
+        const typename slot_map_t::index_list_t layer_indices =
+                cslibs_ndt::utility::generate_indices<typename slot_map_t::index_list_t,3>(bi);
+        for (std::size_t i=0; i<slot_map_t::bin_count; ++i)
+            EXPECT_EQ(slot_map->getStorages()[i]->get(layer_indices[i]), bundle->at(i));
+    }
+
+    std::vector<double> expected;
+    std::vector<point_t> queries;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        queries.emplace_back(rng.get(), rng.get(), rng.get());
+        expected.emplace_back(map.sampleNonNormalized(queries.back()));
+        EXPECT_NEAR(expected.back(), slot_map->sampleNonNormalized(queries.back()), 1e-9);
+    }
+
+    /// the copy resolves its slots against its own layers
+    const slot_map_t copy(*slot_map);
+    for (const auto &bi : indices) {
+        const typename slot_map_t::distribution_bundle_t *bundle     = copy.get(bi);
+        const typename slot_map_t::distribution_bundle_t *src_bundle = slot_map->get(bi);
+        ASSERT_NE(nullptr, bundle);
+        EXPECT_NE(src_bundle->layers(), bundle->layers());
+        for (std::size_t i=0; i<slot_map_t::bin_count; ++i)
+            EXPECT_NE(src_bundle->at(i), bundle->at(i));
+    }
+    slot_map.reset();
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        EXPECT_NEAR(expected[i], copy.sampleNonNormalized(queries[i]), 1e-9);
+}
+
+TEST(Test_cslibs_ndt, testBundleSize)
+{
+    /// no virtual table and no id, just the layer pointers
+    EXPECT_EQ(8ul * sizeof(void*), sizeof(map_t::distribution_bundle_t));
+
+    const map_t::distribution_bundle_t b;
+    for (const auto *d : b)
+        EXPECT_EQ(nullptr, d);
+
+    /// slot backends, the layer table and one 32-bit slot per layer
+    EXPECT_FALSE(map_t::slotted);
+    EXPECT_TRUE(flat_map_t::slotted);
+    EXPECT_TRUE(tiled_map_t::slotted);
+    EXPECT_EQ(sizeof(void*) + 8ul * sizeof(std::uint32_t), sizeof(flat_map_t::distribution_bundle_t));
+    EXPECT_EQ(sizeof(void*) + 8ul * sizeof(std::uint32_t), sizeof(tiled_map_t::distribution_bundle_t));
+    EXPECT_EQ(sizeof(void*) + 4ul * sizeof(std::uint32_t), sizeof(flat_map_2d_t::distribution_bundle_t));
+
+    const flat_map_t::distribution_bundle_t s;
+    for (const auto *d : s)
+        EXPECT_EQ(nullptr, d);
+}
+
+TEST(Test_cslibs_ndt, testBundleId)
+{
+    rng_t rng(-10.0, +10.0);
+    std::vector<point_t> points;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        points.emplace_back(rng.get(), rng.get(), rng.get());
+
+    map_t map(1.0);
+    map.insert(points.begin(), points.end());
+
+    std::vector<map_t::index_t> indices;
+    map.getBundleIndices(indices);
+
+    std::set<std::uint64_t> ids;
+    for (const auto &bi : indices)
+        ids.insert(map_t::getBundleId(bi));
+    EXPECT_EQ(indices.size(), ids.size());
+
+    /// ids only depend on the index, copies keep them
+    const map_t copy(map);
+    std::vector<map_t::index_t> copy_indices;
+    copy.getBundleIndices(copy_indices);
+    std::set<std::uint64_t> copy_ids;
+    for (const auto &bi : copy_indices)
+        copy_ids.insert(map_t::getBundleId(bi));
+    EXPECT_EQ(ids, copy_ids);
+}
+
+TEST(Test_cslibs_ndt, testBundleCopy)
+{
+    rng_t rng(-10.0, +10.0);
+    std::vector<point_t> points;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        points.emplace_back(rng.get(), rng.get(), rng.get());
+
+    map_t::Ptr map(new map_t(1.0));
+    map->insert(points.begin(), points.end());
+    const map_t copy(*map);
+
+    /// the bundles of the copy have to point into its own storages
+    std::vector<map_t::index_t> indices;
+    copy.getBundleIndices(indices);
+    for (const auto &bi : indices) {
+        const map_t::distribution_bundle_t *bundle      = copy.get(bi);
+        const map_t::distribution_bundle_t *src_bundle  = map->get(bi);
+        ASSERT_NE(nullptr, bundle);
+        ASSERT_NE(nullptr, src_bundle);
+        for (std::size_t i=0; i<map_t::bin_count; ++i) {
+            EXPECT_NE(src_bundle->at(i), bundle->at(i));
+            EXPECT_EQ(src_bundle->at(i)->data().getN(), bundle->at(i)->data().getN());
+        }
+    }
+
+    std::vector<double> expected;
+    std::vector<point_t> queries;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        queries.emplace_back(rng.get(), rng.get(), rng.get());
+        expected.emplace_back(map->sampleNonNormalized(queries.back()));
+    }
+
+    map.reset();
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        EXPECT_NEAR(expected[i], copy.sampleNonNormalized(queries[i]), 1e-9);
+}
+
+TEST(Test_cslibs_ndt, testSlotBundleFlatHashMap)
+{
+    testSlotMap<flat_map_t>();
+}
+
+TEST(Test_cslibs_ndt, testSlotBundleTiledMap)
+{
+    testSlotMap<tiled_map_t>();
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/utility/bundle_gaussians.hpp>
+#include <cslibs_math/statistics/stable_distribution.hpp>
+#include <cslibs_math/random/random.hpp>
+
+const std::size_t NUM_SAMPLES = 10000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+template <std::size_t Dim, std::size_t Size>
+void testBundleGaussians()
+{
+    using gaussians_t    = cslibs_ndt::utility::BundleGaussians<double,Dim,Size>;
+    using distribution_t = cslibs_math::statistics::StableDistribution<double,Dim,3>;
+    using sample_t       = typename distribution_t::sample_t;
+
+    rng_t rng(-1.0, +1.0);
+    auto random = [&rng]() {
+        sample_t s;
+        for (std::size_t d=0; d<Dim; ++d)
+            s(d) = rng.get();
+        return s;
+    };
+
+    /// fewer Gaussians than layers leave unused lanes
+    for (std::size_t size=0; size<=Size; ++size) {
+        std::vector<distribution_t, Eigen::aligned_allocator<distribution_t>> distributions(size);
+        std::vector<double> weights(size);
+        gaussians_t gaussians;
+        for (std::size_t k=0; k<size; ++k) {
+            for (std::size_t i=0; i<20; ++i)
+                distributions[k].add(random());
+            weights[k] = 0.5 + rng.get();
+            gaussians.add(distributions[k].getMean(), distributions[k].getInformationMatrix(), weights[k]);
+        }
+        EXPECT_EQ(size, gaussians.size());
+
+        /// a count not divisible by the pack width leaves a remainder
+        const std::size_t n = NUM_SAMPLES - 1;
+        std::vector<double> coordinates(Dim * n);
+        std::vector<double> expected(n, 0.0);
+        std::vector<double> values(n + 1, 0.0);
+        for (std::size_t j=0; j<n; ++j) {
+            /// far points reach the flushed tail of exp
+            const sample_t p = random() * (j % 10 == 0 ? 100.0 : 2.0);
+            for (std::size_t d=0; d<Dim; ++d)
+                coordinates[d * n + j] = p(d);
+
+            std::array<double,Size> layers;
+            gaussians.evaluate(p.data().data(), layers.data());
+            for (std::size_t k=0; k<size; ++k) {
+                const double v = weights[k] * distributions[k].sampleNonNormalized(p);
+                EXPECT_NEAR(v, layers[k], 1e-12 * std::max(1.0, v));
+                expected[j] += v;
+            }
+            EXPECT_NEAR(expected[j], gaussians.evaluate(p.data().data()), 1e-12 * std::max(1.0, expected[j]));
+        }
+
+        gaussians.evaluate(n, coordinates.data(), values.data());
+        for (std::size_t j=0; j<n; ++j)
+            EXPECT_NEAR(expected[j], values[j], 1e-12 * std::max(1.0, expected[j]));
+        EXPECT_EQ(0.0, values[n]);
+    }
+}
+
+TEST(Test_cslibs_ndt, testBundleGaussians2d)
+{
+    testBundleGaussians<2,4>();
+}
+
+TEST(Test_cslibs_ndt, testBundleGaussians3d)
+{
+    testBundleGaussians<3,8>();
+}
+
+TEST(Test_cslibs_ndt, testBundleGaussiansExp)
+{
+    using pack_t = cslibs_ndt::utility::simd::Double;
+
+    for (double x = -800.0; x <= 700.0; x += 0.37) {
+        std::array<double,pack_t::width> in, out;
+        in.fill(x);
+        pack_t::load(in.data()).exp().store(out.data());
+        /// -ffast-math costs some digits of the range reduction
+        const double expected = std::exp(x);
+        for (const double v : out)
+            EXPECT_NEAR(expected, v, 1e-12 * expected + 1e-300) << x;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
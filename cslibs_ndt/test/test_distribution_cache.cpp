@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <thread>
+
+const std::size_t NUM_SAMPLES = 1000;
+using rng_t   = cslibs_math::random::Uniform<double,1>;
+using point_t = cslibs_math_3d::Point3d;
+
+template <typename distribution_t>
+void expectCached(const typename distribution_t::distribution_t &expected,
+                  const distribution_t &d)
+{
+    const double normalizer = 1.0 / std::sqrt(std::pow(2.0 * M_PI, 3.0) * expected.getCovariance().determinant());
+    EXPECT_TRUE(expected.getInformationMatrix().isApprox(d.getInformationMatrix(), 1e-12));
+    EXPECT_TRUE(expected.getEigenValues().isApprox(d.getEigenValues(), 1e-12));
+    EXPECT_TRUE(expected.getEigenVectors().isApprox(d.getEigenVectors(), 1e-12));
+    EXPECT_NEAR(normalizer, d.getNormalizer(), 1e-12 * normalizer);
+}
+
+TEST(Test_cslibs_ndt, testDistributionCache)
+{
+    using distribution_t = cslibs_ndt::Distribution<double,3>;
+
+    /// the cached values are allocated on first use, before only a pointer is kept
+    EXPECT_EQ(sizeof(void*), sizeof(distribution_t::cache_t));
+
+    rng_t rng(-10.0, +10.0);
+    distribution_t d;
+    for (std::size_t i=0; i<10; ++i)
+        d.add(point_t(rng.get(), rng.get(), 0.1 * rng.get()));
+    const std::size_t unused = d.byte_size();
+    expectCached(d.data(), d);
+    EXPECT_LT(unused, d.byte_size());
+
+    /// add and += invalidate
+    d.add(point_t(rng.get(), rng.get(), rng.get()));
+    expectCached(d.data(), d);
+
+    distribution_t other;
+    for (std::size_t i=0; i<10; ++i)
+        other.add(point_t(rng.get(), 5.0 + rng.get(), rng.get()));
+    d += other;
+    expectCached(d.data(), d);
+
+    /// copies and assignments see the values of their source
+    const distribution_t copy(d);
+    expectCached(d.data(), copy);
+    distribution_t assigned;
+    assigned = other;
+    expectCached(other.data(), assigned);
+    assigned = d;
+    expectCached(d.data(), assigned);
+}
+
+TEST(Test_cslibs_ndt, testOccupancyDistributionCache)
+{
+    using distribution_t = cslibs_ndt::OccupancyDistribution<double,3>;
+
+    rng_t rng(-10.0, +10.0);
+    distribution_t d;
+    for (std::size_t i=0; i<10; ++i)
+        d.updateOccupied(point_t(rng.get(), rng.get(), 0.1 * rng.get()));
+    expectCached(*d.getDistribution(), d);
+
+    d.updateOccupied(point_t(rng.get(), rng.get(), rng.get()));
+    expectCached(*d.getDistribution(), d);
+
+    distribution_t other;
+    for (std::size_t i=0; i<10; ++i)
+        other.updateOccupied(point_t(rng.get(), 5.0 + rng.get(), rng.get()));
+    d.updateOccupied(other.getDistribution());
+    expectCached(*d.getDistribution(), d);
+
+    distribution_t assigned;
+    assigned = other;
+    expectCached(*other.getDistribution(), assigned);
+    assigned = d;
+    expectCached(*d.getDistribution(), assigned);
+}
+
+TEST(Test_cslibs_ndt, testDistributionCacheConcurrentReaders)
+{
+    using distribution_t = cslibs_ndt::Distribution<double,3>;
+    using matrix_t       = distribution_t::cache_t::matrix_t;
+
+    rng_t rng(-10.0, +10.0);
+    std::vector<distribution_t, distribution_t::allocator_t> distributions(NUM_SAMPLES);
+    for (distribution_t &d : distributions)
+        for (std::size_t i=0; i<10; ++i)
+            d.add(point_t(rng.get(), rng.get(), rng.get()));
+
+    /// all threads race for the first computation of each entry
+    const std::size_t threads = 4;
+    std::vector<std::vector<matrix_t, Eigen::aligned_allocator<matrix_t>>> results(threads);
+    std::vector<std::thread> workers;
+    for (std::size_t t=0; t<threads; ++t) {
+        workers.emplace_back([&distributions, &results, t]() {
+            for (const distribution_t &d : distributions)
+                results[t].emplace_back(d.getInformationMatrix());
+        });
+    }
+    for (std::thread &w : workers)
+        w.join();
+
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        for (std::size_t t=0; t<threads; ++t)
+            EXPECT_EQ(distributions[i].data().getInformationMatrix(), results[t][i]);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/sharded_unordered_map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <set>
+#include <thread>
+
+const std::size_t NUM_SAMPLES = 5000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+using map_t            = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using concurrent_map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double,
+                                              cslibs_ndt::backend::ShardedUnorderedMap>;
+
+template <typename map_t>
+void fill(map_t &map, const double min, const double max, const std::size_t samples)
+{
+    rng_t rng(min, max);
+    for (std::size_t i=0; i<samples; ++i)
+        map.insert(typename map_t::point_t(rng.get(), rng.get(), rng.get()));
+}
+
+template <typename map_t>
+std::set<typename map_t::index_t> indices(const map_t &map)
+{
+    std::vector<typename map_t::index_t> bis;
+    map.getBundleIndices(bis);
+    return std::set<typename map_t::index_t>(bis.begin(), bis.end());
+}
+
+/// the former expansion: every bundle with enough data in any layer allocates its neighbours
+template <typename map_t>
+void expandReference(map_t &map)
+{
+    using index_t  = typename map_t::index_t;
+    using bundle_t = typename map_t::distribution_bundle_t;
+
+    std::vector<index_t> expandable;
+    map.traverse([&expandable](const index_t &bi, const bundle_t &b) {
+        for (std::size_t i=0; i<map_t::bin_count; ++i) {
+            if (b.at(i)->data().getN() >= 3) {
+                expandable.emplace_back(bi);
+                return;
+            }
+        }
+    });
+    for (const index_t &bi : expandable) {
+        for (int x=-1; x<=1; ++x)
+            for (int y=-1; y<=1; ++y)
+                for (int z=-1; z<=1; ++z)
+                    map.getDistributionBundle(index_t{{bi[0] + x, bi[1] + y, bi[2] + z}});
+    }
+}
+
+template <typename map_t>
+void testIncremental()
+{
+    map_t map(1.0);
+    fill(map, -5.0, 5.0, NUM_SAMPLES);
+    map_t expected(map);
+
+    /// the first call expands every bundle
+    map.allocatePartiallyAllocatedBundles();
+    expandReference(expected);
+    const auto expanded = indices(map);
+    EXPECT_EQ(indices(expected), expanded);
+
+    /// nothing was modified since
+    map.allocatePartiallyAllocatedBundles();
+    EXPECT_EQ(expanded, indices(map));
+
+    /// only the surroundings of the new data grow, a subset of the full pass
+    fill(map, 20.0, 22.0, NUM_SAMPLES / 10);
+    const auto before = indices(map);
+    map_t full(map);
+    expandReference(full);
+    map.allocatePartiallyAllocatedBundles();
+    const auto after  = indices(map);
+    const auto all    = indices(full);
+    EXPECT_LT(before.size(), after.size());
+    EXPECT_LT(after.size(), all.size());
+    for (const auto &bi : after) {
+        EXPECT_EQ(1ul, all.count(bi));
+        if (before.count(bi) == 0) {
+            EXPECT_GE(bi[0], 2 * 20 - 2);
+            EXPECT_LE(bi[0], 2 * 22 + 2);
+        }
+    }
+
+    /// a bundle with enough data allocates its neighbourhood
+    typename map_t::point_t p(30.1, 30.1, 30.1);
+    for (std::size_t i=0; i<3; ++i)
+        map.insert(p);
+    map.allocatePartiallyAllocatedBundles();
+    EXPECT_EQ(after.size() + 27ul, indices(map).size());
+}
+
+template <typename map_t>
+void testAll()
+{
+    map_t reference(1.0);
+    fill(reference, -5.0, 5.0, NUM_SAMPLES);
+
+    map_t serial(reference);
+    serial.allocateAllPartiallyAllocatedBundles(1);
+    expandReference(reference);
+    EXPECT_EQ(indices(reference), indices(serial));
+
+    /// the full pass grows by one ring every call
+    for (std::size_t threads : {1ul, 4ul}) {
+        map_t map(serial);
+        map.allocateAllPartiallyAllocatedBundles(threads);
+        map_t again(reference);
+        expandReference(again);
+        EXPECT_EQ(indices(again), indices(map));
+    }
+}
+
+TEST(Test_cslibs_ndt, testExpandIncremental)
+{
+    testIncremental<map_t>();
+    testIncremental<concurrent_map_t>();
+}
+
+TEST(Test_cslibs_ndt, testExpandAll)
+{
+    testAll<map_t>();
+    testAll<concurrent_map_t>();
+}
+
+TEST(Test_cslibs_ndt, testDirtyBundles)
+{
+    using dirty_t = cslibs_ndt::utility::DirtyBundles<3,false>;
+    using index_t = dirty_t::index_t;
+
+    dirty_t dirty;
+    std::vector<index_t> bis;
+
+    /// everything is dirty before the first take
+    dirty.mark(index_t{{1, 2, 3}});
+    EXPECT_FALSE(dirty.take(bis));
+    EXPECT_TRUE(bis.empty());
+
+    /// marks are deduplicated and handed out in Morton order
+    for (std::size_t r=0; r<5; ++r) {
+        for (int i=0; i<1000; ++i) {
+            dirty.mark(index_t{{i % 10, i % 7, 0}});
+            dirty.mark(index_t{{i % 10, i % 7, 0}});
+        }
+    }
+    EXPECT_TRUE(dirty.take(bis));
+    EXPECT_EQ(70ul, bis.size());
+    EXPECT_EQ(70ul, std::set<index_t>(bis.begin(), bis.end()).size());
+    for (std::size_t i=1; i<bis.size(); ++i)
+        EXPECT_LT(cslibs_ndt::utility::Morton<3>::encode(bis[i - 1]), cslibs_ndt::utility::Morton<3>::encode(bis[i]));
+
+    EXPECT_TRUE(dirty.take(bis));
+    EXPECT_TRUE(bis.empty());
+
+    dirty.mark(index_t{{1, 2, 3}});
+    dirty.reset();
+    EXPECT_TRUE(dirty.take(bis));
+    EXPECT_TRUE(bis.empty());
+}
+
+TEST(Test_cslibs_ndt, testConcurrentDirtyBundles)
+{
+    using dirty_t = cslibs_ndt::utility::DirtyBundles<3,true>;
+    using index_t = dirty_t::index_t;
+
+    dirty_t dirty;
+    std::vector<index_t> bis;
+    EXPECT_FALSE(dirty.take(bis));
+
+    /// the threads mark overlapping bundles, take merges the shards
+    std::vector<std::thread> threads;
+    for (int t=0; t<4; ++t) {
+        threads.emplace_back([&dirty, t]() {
+            for (int i=0; i<20000; ++i)
+                dirty.mark(index_t{{(i + t) % 20, i % 13, t % 2}});
+        });
+    }
+    for (std::thread &t : threads)
+        t.join();
+
+    std::set<index_t> expected;
+    for (int t=0; t<4; ++t)
+        for (int i=0; i<20000; ++i)
+            expected.insert(index_t{{(i + t) % 20, i % 13, t % 2}});
+
+    EXPECT_TRUE(dirty.take(bis));
+    EXPECT_EQ(expected.size(), bis.size());
+    EXPECT_TRUE(std::set<index_t>(bis.begin(), bis.end()) == expected);
+    for (std::size_t i=1; i<bis.size(); ++i)
+        EXPECT_LT(cslibs_ndt::utility::Morton<3>::encode(bis[i - 1]), cslibs_ndt::utility::Morton<3>::encode(bis[i]));
+
+    EXPECT_TRUE(dirty.take(bis));
+    EXPECT_TRUE(bis.empty());
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/flat_hash_map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <map>
+
+const std::size_t NUM_SAMPLES = 10000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+TEST(Test_cslibs_ndt, testMorton2d)
+{
+    using morton_t = cslibs_ndt::utility::Morton<2>;
+    using index_t  = morton_t::index_t;
+
+    rng_t rng(-1e9, +1e9);
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        const index_t index = {{static_cast<int>(rng.get()), static_cast<int>(rng.get())}};
+        ASSERT_TRUE(morton_t::representable(index));
+        EXPECT_EQ(index, morton_t::decode(morton_t::encode(index)));
+        EXPECT_EQ(0ull, morton_t::encode(index) >> 63);
+    }
+
+    /// neighbours in x and y differ in the lowest bits
+    EXPECT_EQ(morton_t::encode({{0, 0}}) + 1, morton_t::encode({{1, 0}}));
+    EXPECT_EQ(morton_t::encode({{0, 0}}) + 2, morton_t::encode({{0, 1}}));
+}
+
+TEST(Test_cslibs_ndt, testMorton3d)
+{
+    using morton_t = cslibs_ndt::utility::Morton<3>;
+    using index_t  = morton_t::index_t;
+
+    rng_t rng(-1e6, +1e6);
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        const index_t index = {{static_cast<int>(rng.get()), static_cast<int>(rng.get()), static_cast<int>(rng.get())}};
+        ASSERT_TRUE(morton_t::representable(index));
+        EXPECT_EQ(index, morton_t::decode(morton_t::encode(index)));
+        EXPECT_EQ(0ull, morton_t::encode(index) >> 63);
+    }
+
+    EXPECT_FALSE(morton_t::representable({{1 << 20, 0, 0}}));
+    EXPECT_TRUE(morton_t::representable({{-(1 << 20), 0, 0}}));
+    EXPECT_EQ(morton_t::encode({{0, 0, 0}}) + 4, morton_t::encode({{0, 0, 1}}));
+}
+
+TEST(Test_cslibs_ndt, testFlatHashMap)
+{
+    using index_t        = std::array<int,2>;
+    using distribution_t = cslibs_ndt::Distribution<double,2>;
+    using storage_t      = cis::Storage<distribution_t, index_t, cslibs_ndt::backend::FlatHashMap>;
+
+    storage_t storage;
+    std::map<index_t, std::size_t> reference;
+    std::map<index_t, const distribution_t*> addresses;
+
+    rng_t rng(-50.0, +50.0);
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        const index_t index = {{static_cast<int>(rng.get()), static_cast<int>(rng.get())}};
+        distribution_t *d = storage.get(index);
+        if (!d) {
+            d = &storage.insert(index, distribution_t());
+            addresses[index] = d;
+        }
+        d->data().add(cslibs_math_2d::Point2d(rng.get(), rng.get()));
+        ++reference[index];
+
+        /// every few steps remove an element
+        if (i % 7 == 0) {
+            const index_t other = {{static_cast<int>(rng.get()), static_cast<int>(rng.get())}};
+            EXPECT_EQ(reference.erase(other) > 0, storage.remove(other));
+            addresses.erase(other);
+        }
+    }
+
+    EXPECT_EQ(reference.size(), storage.size());
+    for (const auto &r : reference) {
+        const distribution_t *d = storage.get(r.first);
+        ASSERT_NE(nullptr, d);
+        EXPECT_EQ(r.second, d->data().getN());
+        /// growing the table must not move the data
+        EXPECT_EQ(addresses[r.first], d);
+    }
+
+    std::size_t visited = 0;
+    storage.traverse([&reference, &visited](const index_t &index, const distribution_t &d) {
+        ASSERT_EQ(1ul, reference.count(index));
+        EXPECT_EQ(reference[index], d.data().getN());
+        ++visited;
+    });
+    EXPECT_EQ(reference.size(), visited);
+
+    const storage_t copy(storage);
+    EXPECT_EQ(storage.size(), copy.size());
+    for (const auto &r : reference)
+        EXPECT_EQ(r.second, copy.get(r.first)->data().getN());
+
+    EXPECT_EQ(nullptr, storage.get({{1 << 30, 0}}));
+    EXPECT_THROW(storage.insert({{1 << 30, 0}}, distribution_t()), std::out_of_range);
+
+    storage.clear();
+    EXPECT_EQ(0ul, storage.size());
+    EXPECT_EQ(nullptr, storage.get(reference.begin()->first));
+}
+
+TEST(Test_cslibs_ndt, testFlatHashMapGridmap)
+{
+    using map_t      = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+    using flat_map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double,
+                                            cslibs_ndt::backend::FlatHashMap,cslibs_ndt::backend::FlatHashMap>;
+    using point_t    = cslibs_math_3d::Point3d;
+
+    rng_t rng(-10.0, +10.0);
+    std::vector<point_t> points;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        points.emplace_back(rng.get(), rng.get(), rng.get());
+
+    map_t map(1.0);
+    flat_map_t flat_map(1.0);
+    map.insert(points.begin(), points.end());
+    flat_map.insert(points.begin(), points.end());
+
+    std::vector<map_t::index_t> indices, flat_indices;
+    map.getBundleIndices(indices);
+    flat_map.getBundleIndices(flat_indices);
+    EXPECT_EQ(indices.size(), flat_indices.size());
+    for (std::size_t i=0; i<3; ++i) {
+        EXPECT_EQ(map.getMinBundleIndex()[i], flat_map.getMinBundleIndex()[i]);
+        EXPECT_EQ(map.getMaxBundleIndex()[i], flat_map.getMaxBundleIndex()[i]);
+    }
+
+    for (const auto &bi : indices) {
+        const map_t::distribution_bundle_t *bundle           = map.get(bi);
+        const flat_map_t::distribution_bundle_t *flat_bundle = flat_map.get(bi);
+        ASSERT_NE(nullptr, flat_bundle);
+        for (std::size_t i=0; i<map_t::bin_count; ++i)
+            EXPECT_EQ(bundle->at(i)->data().getN(), flat_bundle->at(i)->data().getN());
+    }
+
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        const point_t p(rng.get(), rng.get(), rng.get());
+        EXPECT_NEAR(map.sampleNonNormalized(p), flat_map.sampleNonNormalized(p), 1e-9);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
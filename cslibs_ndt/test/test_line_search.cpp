@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/matching/line_search.hpp>
+
+#include <functional>
+
+using function_t = std::function<void(double, double&, double&)>;
+
+/// the test functions of More and Thuente (1994), the search takes as many evaluations as in their table 1
+struct Problem
+{
+    function_t  phi;
+    double      mu;
+    double      nu;
+};
+
+std::vector<Problem> problems()
+{
+    std::vector<Problem> p;
+    p.push_back({[](double a, double& f, double& d) {
+        const double b = 2.0;
+        f = -a / (a * a + b);
+        d = (a * a - b) / ((a * a + b) * (a * a + b));
+    }, 1e-3, 0.1});
+    p.push_back({[](double a, double& f, double& d) {
+        const double b = 0.004;
+        f = std::pow(a + b, 5) - 2.0 * std::pow(a + b, 4);
+        d = 5.0 * std::pow(a + b, 4) - 8.0 * std::pow(a + b, 3);
+    }, 0.1, 0.1});
+    p.push_back({[](double a, double& f, double& d) {
+        const double b = 0.01;
+        const double l = 39.0;
+        if (a <= 1.0 - b) {
+            f = 1.0 - a;
+            d = -1.0;
+        } else if (a >= 1.0 + b) {
+            f = a - 1.0;
+            d = 1.0;
+        } else {
+            f = 0.5 * (a - 1.0) * (a - 1.0) / b + 0.5 * b;
+            d = (a - 1.0) / b;
+        }
+        f += 2.0 * (1.0 - b) / (l * M_PI) * std::sin(0.5 * l * M_PI * a);
+        d += (1.0 - b) * std::cos(0.5 * l * M_PI * a);
+    }, 0.1, 0.1});
+    return p;
+}
+
+TEST(Test_cslibs_ndt, testLineSearchWolfe)
+{
+    for (const Problem& problem : problems()) {
+        double f_0, d_0;
+        problem.phi(0.0, f_0, d_0);
+        ASSERT_LT(d_0, 0.0);
+
+        for (const double step : {1e-3, 1e-1, 1e1, 1e3}) {
+            std::size_t evaluations = 0;
+            double last = -1.0;
+            const function_t counted = [&](double a, double& f, double& d) {
+                ++evaluations;
+                last = a;
+                problem.phi(a, f, d);
+            };
+
+            const double a = cslibs_ndt::matching::moreThuente(counted, f_0, d_0, step, 1e4,
+                                                               problem.mu, problem.nu, 30);
+            double f, d;
+            problem.phi(a, f, d);
+
+            EXPECT_GT(a, 0.0);
+            EXPECT_EQ(a, last);
+            EXPECT_LE(f, f_0 + problem.mu * a * d_0);
+            EXPECT_LE(std::abs(d), problem.nu * std::abs(d_0));
+            EXPECT_LE(evaluations, 15ul);
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt, testLineSearchMaxStep)
+{
+    /// unbounded, the search stops at the longest step
+    const function_t linear = [](double a, double& f, double& d) {
+        f = -a;
+        d = -1.0;
+    };
+    EXPECT_EQ(4.0, cslibs_ndt::matching::moreThuente(linear, 0.0, -1.0, 1.0, 4.0, 1e-4, 0.9, 10));
+
+    /// a full step of a quadratic is accepted at once
+    std::size_t evaluations = 0;
+    const function_t quadratic = [&evaluations](double a, double& f, double& d) {
+        ++evaluations;
+        f = (a - 1.0) * (a - 1.0);
+        d = 2.0 * (a - 1.0);
+    };
+    EXPECT_EQ(1.0, cslibs_ndt::matching::moreThuente(quadratic, 1.0, -2.0, 1.0, 4.0, 1e-4, 0.9, 10));
+    EXPECT_EQ(1ul, evaluations);
+}
+
+TEST(Test_cslibs_ndt, testLineSearchNoDecrease)
+{
+    /// the derivative at 0 is wrong, no step decreases the function
+    std::size_t evaluations = 0;
+    const function_t increasing = [&evaluations](double a, double& f, double& d) {
+        ++evaluations;
+        f = a;
+        d = 1.0;
+    };
+    EXPECT_EQ(0.0, cslibs_ndt::matching::moreThuente(increasing, 0.0, -1.0, 1.0, 4.0, 1e-4, 0.9, 10));
+    EXPECT_LE(evaluations, 10ul);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/conversion/merge.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <map>
+#include <stdexcept>
+
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+using map_t           = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using static_map_t    = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double>;
+using occupancy_map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,double>;
+using point_t         = map_t::point_t;
+using pose_t          = map_t::pose_t;
+using index_t         = map_t::index_t;
+using distribution_t  = map_t::distribution_t;
+
+/// sample count, sum and second moment of every layer
+struct Moments
+{
+    std::size_t     n = 0;
+    Eigen::Vector3d sum          = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d second_order = Eigen::Matrix3d::Zero();
+};
+
+std::vector<Moments> layerMoments(const map_t &map)
+{
+    std::vector<Moments> moments(map_t::bin_count);
+    map.traverseDistributions([&moments](const std::size_t layer, const index_t &, const distribution_t &d) {
+        const std::size_t n = d.data().getN();
+        if (n == 0)
+            return;
+        const Eigen::Vector3d mean = d.data().getMean();
+        Moments &m = moments[layer];
+        m.n   += n;
+        m.sum += mean * static_cast<double>(n);
+        m.second_order += mean * mean.transpose() * static_cast<double>(n);
+        if (n > 1)
+            m.second_order += d.data().getCovariance() * static_cast<double>(n - 1);
+    });
+    return moments;
+}
+
+TEST(Test_cslibs_ndt, testTransformed)
+{
+    using stable_t = distribution_t::distribution_t;
+    const pose_t t(0.5, -1.0, 2.0, 0.1, -0.2, 0.7);
+
+    for (std::size_t n : {1ul, 2ul, 3ul, 4ul, 5ul, 100ul}) {
+        stable_t d, expected;
+        for (const point_t &p : generatePoints(n, -1.0, 1.0)) {
+            d.add(p);
+            expected.add(t * p);
+        }
+
+        const stable_t result = cslibs_ndt::conversion::impl::transformed<stable_t,point_t>(d, t);
+        EXPECT_EQ(n, result.getN());
+        EXPECT_TRUE(result.getMean().isApprox(expected.getMean(), 1e-9));
+        if (n > 1) {
+            EXPECT_TRUE(result.getCovariance().isApprox(expected.getCovariance(), 1e-9));
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt, testMergeAligned)
+{
+    const std::vector<point_t> a = generatePoints(20000, -10.0, 10.0);
+    const std::vector<point_t> b = generatePoints(20000, -5.0, 15.0);
+
+    map_t reference(pose_t(), 1.0);
+    reference.insert(a.begin(), a.end());
+    reference.insert(b.begin(), b.end());
+
+    /// origins differing by whole bundles, an odd shift swaps the layers
+    map_t dst(pose_t(), 1.0);
+    dst.insert(a.begin(), a.end());
+    map_t src(pose_t(1.5, -0.5, 2.0, 0.0, 0.0, 0.0), 1.0);
+    src.insert(b.begin(), b.end());
+
+    cslibs_ndt::conversion::merge(dst, src);
+    expectEqual(reference, dst, 1e-9);
+
+    /// merging a map into itself doubles the samples
+    map_t twice(pose_t(), 1.0);
+    twice.insert(a.begin(), a.end());
+    cslibs_ndt::conversion::merge(twice, twice);
+    map_t doubled(pose_t(), 1.0);
+    doubled.insert(a.begin(), a.end());
+    doubled.insert(a.begin(), a.end());
+    expectEqual(doubled, twice, 1e-9);
+}
+
+TEST(Test_cslibs_ndt, testMergeResampled)
+{
+    const std::vector<point_t> a = generatePoints(20000, -10.0, 10.0);
+    const std::vector<point_t> b = generatePoints(20000, -5.0, 15.0);
+
+    map_t reference(pose_t(), 1.0);
+    reference.insert(a.begin(), a.end());
+    reference.insert(b.begin(), b.end());
+
+    map_t dst(pose_t(), 1.0);
+    dst.insert(a.begin(), a.end());
+    map_t src(pose_t(0.37, -1.1, 0.2, 0.0, 0.0, 0.3), 1.0);
+    src.insert(b.begin(), b.end());
+    cslibs_ndt::conversion::merge(dst, src);
+
+    /// distributions move between cells, the moments of every layer are kept
+    const std::vector<Moments> expected = layerMoments(reference);
+    const std::vector<Moments> merged   = layerMoments(dst);
+    for (std::size_t i=0; i<map_t::bin_count; ++i) {
+        EXPECT_EQ(a.size() + b.size(), merged[i].n);
+        EXPECT_EQ(expected[i].n, merged[i].n);
+        EXPECT_TRUE(merged[i].sum.isApprox(expected[i].sum, 1e-9));
+        EXPECT_TRUE(merged[i].second_order.isApprox(expected[i].second_order, 1e-9));
+    }
+}
+
+TEST(Test_cslibs_ndt, testMergeParallel)
+{
+    const std::vector<point_t> a = generatePoints(20000, -10.0, 10.0);
+    const std::vector<point_t> b = generatePoints(20000, -5.0, 15.0);
+
+    map_t src(pose_t(0.37, -1.1, 0.2, 0.0, 0.0, 0.3), 1.0);
+    src.insert(b.begin(), b.end());
+
+    /// each distribution of dst is merged by one thread in a fixed order
+    map_t sequential(pose_t(), 1.0);
+    sequential.insert(a.begin(), a.end());
+    cslibs_ndt::conversion::merge(sequential, src, 1);
+    map_t parallel(pose_t(), 1.0);
+    parallel.insert(a.begin(), a.end());
+    cslibs_ndt::conversion::merge(parallel, src, 4, 2);
+    expectEqual(sequential, parallel, 0.0);
+
+    /// a static map keeps what lies within its bounds
+    static_map_t bounded(pose_t(), 1.0, {{20, 20, 20}}, {{-10, -10, -10}});
+    cslibs_ndt::conversion::merge(bounded, sequential);
+    std::size_t n = 0;
+    bounded.traverseDistributions([&n](const std::size_t layer, const index_t &, const distribution_t &d) {
+        n += layer == 0 ? d.data().getN() : 0;
+    });
+    EXPECT_GT(n, 0ul);
+    EXPECT_LT(n, a.size() + b.size());
+}
+
+TEST(Test_cslibs_ndt, testMergeOccupancy)
+{
+    using point_2d_t = occupancy_map_t::point_t;
+    using pose_2d_t  = occupancy_map_t::pose_t;
+
+    rng_t rng(-10.0, 10.0);
+    std::vector<point_2d_t> a, b;
+    for (std::size_t i=0; i<500; ++i) {
+        a.emplace_back(rng.get(), rng.get());
+        b.emplace_back(rng.get(), rng.get());
+    }
+
+    occupancy_map_t reference(pose_2d_t(), 1.0);
+    occupancy_map_t dst(pose_2d_t(), 1.0);
+    occupancy_map_t src(pose_2d_t(-2.5, 1.0, 0.0), 1.0);
+    for (const point_2d_t &p : a) {
+        reference.insert(point_2d_t(), p);
+        dst.insert(point_2d_t(), p);
+    }
+    for (const point_2d_t &p : b) {
+        reference.insert(point_2d_t(1.0, 1.0), p);
+        src.insert(point_2d_t(1.0, 1.0), p);
+    }
+    cslibs_ndt::conversion::merge(dst, src);
+
+    using key_t = std::pair<std::size_t, occupancy_map_t::index_t>;
+    std::map<key_t, const occupancy_map_t::distribution_t*> cells;
+    reference.traverseDistributions([&cells](const std::size_t layer, const occupancy_map_t::index_t &index,
+                                             const occupancy_map_t::distribution_t &d) {
+        cells[key_t(layer, index)] = &d;
+    });
+    std::size_t populated = 0;
+    dst.traverseDistributions([&cells, &populated](const std::size_t layer, const occupancy_map_t::index_t &index,
+                                                   const occupancy_map_t::distribution_t &d) {
+        if (d.numFree() == 0 && d.numOccupied() == 0)
+            return;
+        const auto it = cells.find(key_t(layer, index));
+        ASSERT_NE(cells.end(), it);
+        EXPECT_EQ(it->second->numFree(), d.numFree());
+        EXPECT_EQ(it->second->numOccupied(), d.numOccupied());
+        if (d.numOccupied() > 0) {
+            EXPECT_TRUE(it->second->getDistribution()->getMean().isApprox(d.getDistribution()->getMean(), 1e-9));
+        }
+        ++populated;
+    });
+    EXPECT_GT(populated, 0ul);
+
+    /// resampling keeps the number of observations
+    occupancy_map_t rotated(pose_2d_t(0.3, 0.2, 0.5), 1.0);
+    for (const point_2d_t &p : b)
+        rotated.insert(point_2d_t(1.0, 1.0), p);
+    occupancy_map_t resampled(pose_2d_t(), 1.0);
+    cslibs_ndt::conversion::merge(resampled, rotated);
+
+    auto count = [](const occupancy_map_t &map, std::size_t &free, std::size_t &occupied) {
+        free = occupied = 0;
+        map.traverseDistributions([&free, &occupied](const std::size_t, const occupancy_map_t::index_t &,
+                                                     const occupancy_map_t::distribution_t &d) {
+            free     += d.numFree();
+            occupied += d.numOccupied();
+        });
+    };
+    std::size_t free, occupied, expected_free, expected_occupied;
+    count(rotated, expected_free, expected_occupied);
+    count(resampled, free, occupied);
+    EXPECT_EQ(expected_free, free);
+    EXPECT_EQ(expected_occupied, occupied);
+}
+
+TEST(Test_cslibs_ndt, testMergeResolution)
+{
+    map_t dst(pose_t(), 1.0);
+    const map_t src(pose_t(), 0.5);
+    EXPECT_THROW(cslibs_ndt::conversion::merge(dst, src), std::runtime_error);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
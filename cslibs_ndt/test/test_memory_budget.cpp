@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/sharded_unordered_map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+using map_t            = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using concurrent_map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double,
+                                              cslibs_ndt::backend::ShardedUnorderedMap>;
+using point_t          = map_t::point_t;
+using index_t          = map_t::index_t;
+using distribution_t   = map_t::distribution_t;
+
+/// one spill file per test and process, so that concurrent runs of the suite do not share it
+std::string spillPath()
+{
+    return "/tmp/cslibs_ndt_test_memory_budget_" +
+           std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + "_" +
+           std::to_string(::getpid()) + ".spill";
+}
+
+/// scans along a line, the early parts of the map are not seen again
+std::vector<std::vector<point_t>> generateScans(const std::size_t scans)
+{
+    rng_t rng(-2.0, 2.0);
+    std::vector<std::vector<point_t>> result(scans);
+    for (std::size_t s=0; s<scans; ++s)
+        for (std::size_t i=0; i<2000; ++i)
+            result[s].emplace_back(2.0 * s + rng.get(), rng.get(), 0.5 * rng.get());
+    return result;
+}
+
+/// the map holds the same bundles and distributions as the reference, whether they were spilled or not
+void expectRestored(const map_t &expected, const map_t &map)
+{
+    expectEqual(expected, map, 1e-12);
+
+    std::size_t expected_count = 0, count = 0;
+    expected.traverseDistributions([&expected_count](const std::size_t, const index_t &, const distribution_t &) {
+        ++expected_count;
+    });
+    map.traverseDistributions([&count](const std::size_t, const index_t &, const distribution_t &) {
+        ++count;
+    });
+    EXPECT_EQ(expected_count, count);
+
+    std::vector<index_t> expected_bundles, bundles;
+    expected.getBundleIndices(expected_bundles);
+    map.getBundleIndices(bundles);
+    EXPECT_EQ(expected_bundles.size(), bundles.size());
+}
+
+TEST(Test_cslibs_ndt, testMemoryBudget)
+{
+    const std::vector<std::vector<point_t>> scans = generateScans(40);
+
+    map_t reference(map_t::pose_t(), 0.5);
+    for (const std::vector<point_t> &scan : scans)
+        reference.insert(scan.begin(), scan.end());
+
+    /// a third of the map stays resident
+    const std::size_t budget = reference.getResidentByteSize() / 3;
+    map_t map(map_t::pose_t(), 0.5);
+    ASSERT_TRUE(map.setMemoryBudget(budget, spillPath(), 8));
+    EXPECT_EQ(budget, map.getMemoryBudget());
+    for (const std::vector<point_t> &scan : scans) {
+        map.insert(scan.begin(), scan.end());
+        EXPECT_LE(map.getResidentByteSize(), budget);
+    }
+    EXPECT_GT(map.getEvictionCount(), 0ul);
+    EXPECT_GT(map.getEvictedTileCount(), 0ul);
+    EXPECT_GT(map.getSpillFileSize(), 0ul);
+
+    /// a copy holds the evicted tiles as well
+    const map_t copy(map);
+    EXPECT_EQ(0ul, copy.getMemoryBudget());
+    expectRestored(reference, copy);
+
+    /// revisiting the start faults its tiles in
+    const std::size_t evicted = map.getEvictedTileCount();
+    map.insert(scans.front().begin(), scans.front().end());
+    reference.insert(scans.front().begin(), scans.front().end());
+    EXPECT_GT(map.getFaultCount(), 0ul);
+    EXPECT_LE(map.getResidentByteSize(), budget);
+    EXPECT_NE(nullptr, map.get(point_t(60.0, 0.0, 0.0)));
+
+    /// everything which was evicted is restored unchanged
+    map.restoreEvictedTiles();
+    EXPECT_EQ(0ul, map.getEvictedTileCount());
+    EXPECT_GE(map.getFaultCount(), evicted);
+    expectRestored(reference, map);
+
+    EXPECT_TRUE(map.setMemoryBudget(0));
+    EXPECT_EQ(0ul, map.getMemoryBudget());
+    expectRestored(reference, map);
+}
+
+TEST(Test_cslibs_ndt, testMemoryBudgetExpand)
+{
+    const std::vector<std::vector<point_t>> scans = generateScans(20);
+
+    map_t full(map_t::pose_t(), 0.5);
+    for (const std::vector<point_t> &scan : scans)
+        full.insert(scan.begin(), scan.end());
+    const std::size_t budget = full.getResidentByteSize() / 2;
+
+    /// expansion allocates bundles in evicted tiles, which faults them in
+    map_t reference(map_t::pose_t(), 0.5);
+    map_t map(map_t::pose_t(), 0.5);
+    ASSERT_TRUE(map.setMemoryBudget(budget, spillPath(), 4));
+    for (const std::vector<point_t> &scan : scans) {
+        reference.insert(scan.begin(), scan.end());
+        reference.allocatePartiallyAllocatedBundles();
+        map.insert(scan.begin(), scan.end());
+        map.allocatePartiallyAllocatedBundles();
+    }
+    EXPECT_GT(map.getEvictionCount(), 0ul);
+
+    map.restoreEvictedTiles();
+    expectRestored(reference, map);
+}
+
+TEST(Test_cslibs_ndt, testMemoryBudgetTemporaryFile)
+{
+    using spill_file_t = cslibs_ndt::serialization::SpillFile<distribution_t,3,map_t::bin_count>;
+
+    /// without a path a unique temporary file is used and removed on close
+    spill_file_t file;
+    ASSERT_TRUE(file.open(""));
+    const std::string path = file.getPath();
+    EXPECT_FALSE(path.empty());
+    EXPECT_EQ(0, ::access(path.c_str(), F_OK));
+    file.close();
+    EXPECT_NE(0, ::access(path.c_str(), F_OK));
+
+    const std::vector<std::vector<point_t>> scans = generateScans(20);
+    map_t reference(map_t::pose_t(), 0.5);
+    for (const std::vector<point_t> &scan : scans)
+        reference.insert(scan.begin(), scan.end());
+
+    const std::size_t budget = reference.getResidentByteSize() / 2;
+    map_t map(map_t::pose_t(), 0.5);
+    ASSERT_TRUE(map.setMemoryBudget(budget));
+    for (const std::vector<point_t> &scan : scans)
+        map.insert(scan.begin(), scan.end());
+    EXPECT_GT(map.getEvictionCount(), 0ul);
+    EXPECT_GT(map.getSpillFileSize(), 0ul);
+
+    /// reading empty space neither faults in nor evicts
+    const std::size_t faults    = map.getFaultCount();
+    const std::size_t evictions = map.getEvictionCount();
+    const std::size_t resident  = map.getResidentByteSize();
+    for (int i=0; i<1000; ++i)
+        EXPECT_EQ(nullptr, map.get(point_t(-10.0 - i, 50.0, 0.0)));
+    EXPECT_EQ(faults, map.getFaultCount());
+    EXPECT_EQ(evictions, map.getEvictionCount());
+    EXPECT_EQ(resident, map.getResidentByteSize());
+
+    map.restoreEvictedTiles();
+    expectRestored(reference, map);
+}
+
+TEST(Test_cslibs_ndt, testMemoryBudgetConcurrent)
+{
+    concurrent_map_t map(concurrent_map_t::pose_t(), 0.5);
+    EXPECT_FALSE(map.setMemoryBudget(1ul << 20, spillPath()));
+    EXPECT_EQ(0ul, map.getMemoryBudget());
+}
+
+TEST(Test_cslibs_ndt, testSpillFile)
+{
+    using storage_t    = map_t::distribution_storage_t;
+    using spill_file_t = cslibs_ndt::serialization::SpillFile<distribution_t,3,1>;
+
+    std::array<std::shared_ptr<storage_t>,1> storages = {{std::make_shared<storage_t>()}};
+    spill_file_t::layers_t layers;
+    for (int i=0; i<16; ++i) {
+        const index_t index{{i, 0, 0}};
+        storages[0]->insert(index, distribution_t()).data().add(point_t(i, 1.0, 2.0));
+        layers[0].emplace_back(index);
+    }
+
+    spill_file_t spill;
+    EXPECT_FALSE(spill.open("/nonexistent/directory/spill"));
+    ASSERT_TRUE(spill.open(spillPath()));
+
+    /// enough records to trigger compaction
+    const std::size_t records = 4 * spill_file_t::min_compact / (16 * sizeof(distribution_t)) + 1;
+    for (std::size_t r=0; r<records; ++r)
+        spill.write(index_t{{static_cast<int>(r), 0, 0}}, std::vector<index_t>(1, index_t{{1, 2, 3}}), layers, storages);
+    EXPECT_EQ(records, spill.records());
+    const std::size_t size = spill.size();
+
+    for (std::size_t r=0; r+1<records; ++r)
+        spill.erase(index_t{{static_cast<int>(r), 0, 0}});
+    EXPECT_EQ(1ul, spill.records());
+    EXPECT_LT(spill.size(), size / 2);
+
+    std::vector<index_t> bundles;
+    std::size_t count = 0;
+    EXPECT_TRUE(spill.read(index_t{{static_cast<int>(records - 1), 0, 0}}, bundles,
+                           [&count](const std::size_t layer, const index_t &index, const distribution_t &d) {
+        EXPECT_EQ(0ul, layer);
+        EXPECT_EQ(1ul, d.data().getN());
+        EXPECT_DOUBLE_EQ(index[0], d.data().getMean()(0));
+        ++count;
+    }));
+    EXPECT_EQ(16ul, count);
+    ASSERT_EQ(1ul, bundles.size());
+    EXPECT_EQ((index_t{{1, 2, 3}}), bundles.front());
+    EXPECT_FALSE(spill.read(index_t{{0, 0, 0}}, bundles, [](const std::size_t, const index_t &, const distribution_t &) {}));
+
+    spill.close();
+    EXPECT_EQ(nullptr, std::fopen(spillPath().c_str(), "r"));
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/flat_hash_map.hpp>
+#include <cslibs_ndt/backend/sharded_unordered_map.hpp>
+#include <cslibs_ndt/backend/tiled_map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+namespace tags = cslibs_ndt::map::tags;
+
+template <template <typename, typename, typename...> class backend_t>
+using gridmap_t   = cslibs_ndt::map::Map<tags::dynamic_map,3,cslibs_ndt::Distribution,double,backend_t>;
+using occupancy_t = cslibs_ndt::map::Map<tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,double>;
+
+template <typename map_t>
+void fill(map_t &map)
+{
+    rng_t rng(-5.0, 5.0);
+    for (std::size_t i=0; i<5000; ++i)
+        map.insert(typename map_t::point_t(rng.get(), rng.get(), rng.get()));
+}
+
+template <typename map_t>
+void testConsistency(const map_t &map)
+{
+    const cslibs_ndt::map::MemoryStatistics statistics = map.getMemoryStatistics();
+    ASSERT_EQ(static_cast<std::size_t>(map_t::bin_count), statistics.layers.size());
+
+    /// the storage bytes are those of getByteSize
+    std::size_t storage_bytes = statistics.map_bytes + statistics.bundles.storage_bytes;
+    for (std::size_t i=0; i<map_t::bin_count; ++i) {
+        const cslibs_ndt::map::StorageStatistics &l = statistics.layers[i];
+        EXPECT_EQ(map.getStorages()[i]->size(), l.cells);
+        EXPECT_LE(l.populated, l.cells);
+        EXPECT_GE(l.capacity, l.cells);
+        storage_bytes += l.storage_bytes;
+    }
+    EXPECT_EQ(map.getByteSize(), storage_bytes);
+    EXPECT_GT(statistics.total(), map.getByteSize());
+
+    std::vector<typename map_t::index_t> bundles;
+    map.getBundleIndices(bundles);
+    EXPECT_EQ(bundles.size(), statistics.bundles.cells);
+    EXPECT_GT(statistics.bundles.populated, 0ul);
+}
+
+TEST(Test_cslibs_ndt, testHeapBlockSize)
+{
+    EXPECT_EQ(0ul,  cslibs_ndt::utility::heap_block_size(0));
+    EXPECT_EQ(32ul, cslibs_ndt::utility::heap_block_size(1));
+    EXPECT_EQ(32ul, cslibs_ndt::utility::heap_block_size(24));
+    EXPECT_EQ(48ul, cslibs_ndt::utility::heap_block_size(25));
+    EXPECT_EQ(8ul,  cslibs_ndt::utility::heap_overhead(24));
+}
+
+TEST(Test_cslibs_ndt, testMemoryStatistics)
+{
+    gridmap_t<cis::backend::simple::UnorderedMap> map(gridmap_t<cis::backend::simple::UnorderedMap>::pose_t(), 1.0);
+    fill(map);
+    testConsistency(map);
+
+    /// expansion allocates empty cells
+    const cslibs_ndt::map::MemoryStatistics before = map.getMemoryStatistics();
+    EXPECT_EQ(0ul, before.getLayerTotal().empty());
+    map.allocatePartiallyAllocatedBundles();
+    const cslibs_ndt::map::MemoryStatistics expanded = map.getMemoryStatistics();
+    EXPECT_GT(expanded.getLayerTotal().empty(), 0ul);
+    EXPECT_EQ(before.getLayerTotal().populated, expanded.getLayerTotal().populated);
+    /// new bundles share populated distributions with their neighbours
+    EXPECT_GT(expanded.bundles.cells, before.bundles.cells);
+    EXPECT_EQ(expanded.bundles.cells, expanded.bundles.populated);
+
+    /// sampling allocates the cached values of the distributions
+    EXPECT_EQ(0ul, expanded.getLayerTotal().payload_bytes);
+    map.sample(gridmap_t<cis::backend::simple::UnorderedMap>::point_t(0.0, 0.0, 0.0));
+    EXPECT_GT(map.getMemoryStatistics().getLayerTotal().payload_bytes, 0ul);
+}
+
+TEST(Test_cslibs_ndt, testMemoryStatisticsBackends)
+{
+    gridmap_t<cslibs_ndt::backend::FlatHashMap> flat(gridmap_t<cslibs_ndt::backend::FlatHashMap>::pose_t(), 1.0);
+    fill(flat);
+    testConsistency(flat);
+    EXPECT_GT(flat.getMemoryStatistics().getLayerTotal().overhead_bytes, 0ul);
+
+    gridmap_t<cslibs_ndt::backend::TiledMap> tiled(gridmap_t<cslibs_ndt::backend::TiledMap>::pose_t(), 1.0);
+    fill(tiled);
+    testConsistency(tiled);
+    EXPECT_GT(tiled.getMemoryStatistics().getLayerTotal().overhead_bytes, 0ul);
+
+    gridmap_t<cslibs_ndt::backend::ShardedUnorderedMap> sharded(gridmap_t<cslibs_ndt::backend::ShardedUnorderedMap>::pose_t(), 1.0);
+    fill(sharded);
+    testConsistency(sharded);
+    EXPECT_GT(sharded.getMemoryStatistics().getLayerTotal().overhead_bytes, 0ul);
+}
+
+TEST(Test_cslibs_ndt, testAllocationOverheadModels)
+{
+    using index_t        = std::array<int,3>;
+    using distribution_t = cslibs_ndt::Distribution<double,3>;
+    using array_t        = cis::Storage<distribution_t, index_t, cis::backend::array::Array>;
+    using unordered_t    = cis::Storage<distribution_t, index_t, cis::backend::simple::UnorderedMap>;
+
+    rng_t rng(0.0, 20.0);
+    std::vector<index_t> indices;
+    for (std::size_t i=0; i<2000; ++i)
+        indices.emplace_back(index_t{{static_cast<int>(rng.get()), static_cast<int>(rng.get()), static_cast<int>(rng.get())}});
+
+    /// the array is a single allocation, its overhead does not grow with the entries
+    array_t array;
+    array.set<cis::option::tags::array_size>(std::array<std::size_t,3>{{20, 20, 20}});
+    array.set<cis::option::tags::array_offset>(index_t{{0, 0, 0}});
+    const std::size_t empty = cslibs_ndt::utility::allocation_overhead<cis::backend::array::Array,index_t,distribution_t>(array);
+    for (const index_t &index : indices)
+        array.insert(index, distribution_t());
+    const std::size_t full = cslibs_ndt::utility::allocation_overhead<cis::backend::array::Array,index_t,distribution_t>(array);
+    EXPECT_LE(full, empty);
+    EXPECT_LE(full, cslibs_ndt::utility::heap_overhead(array.capacity() * sizeof(distribution_t)));
+
+    /// the unordered map pays a node per entry and the bucket array
+    unordered_t unordered;
+    for (const index_t &index : indices)
+        unordered.insert(index, distribution_t());
+    const std::size_t overhead = cslibs_ndt::utility::allocation_overhead<cis::backend::simple::UnorderedMap,index_t,distribution_t>(unordered);
+    EXPECT_GE(overhead, unordered.size() * sizeof(void*) + unordered.capacity() * sizeof(void*));
+    EXPECT_LE(overhead, unordered.size() * cslibs_ndt::utility::heap_block_size(2 * sizeof(void*) + sizeof(index_t) + sizeof(distribution_t)) +
+                        cslibs_ndt::utility::heap_block_size(unordered.capacity() * sizeof(void*)));
+}
+
+TEST(Test_cslibs_ndt, testMemoryStatisticsOccupancy)
+{
+    occupancy_t map(occupancy_t::pose_t(), 1.0);
+    rng_t rng(-5.0, 5.0);
+    for (std::size_t i=0; i<200; ++i)
+        map.insert(occupancy_t::point_t(), occupancy_t::point_t(rng.get(), rng.get()));
+
+    /// cells along the rays are only free, their Gaussians are not allocated
+    const cslibs_ndt::map::MemoryStatistics statistics = map.getMemoryStatistics();
+    std::size_t gaussians = 0;
+    map.traverseDistributions([&gaussians](const std::size_t, const occupancy_t::index_t &, const occupancy_t::distribution_t &d) {
+        gaussians += d.getDistribution() ? 1 : 0;
+    });
+    EXPECT_EQ(gaussians * sizeof(occupancy_t::distribution_t::distribution_t), statistics.getLayerTotal().payload_bytes);
+    EXPECT_EQ(statistics.getLayerTotal().cells, statistics.getLayerTotal().populated);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <set>
+#include <thread>
+
+const std::size_t NUM_SAMPLES = 1000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+TEST(Test_cslibs_ndt, testPool)
+{
+    using gaussian_t = cslibs_math::statistics::StableDistribution<double,3,3>;
+    using pool_t     = cslibs_ndt::utility::Pool<gaussian_t>;
+    using ptr_t      = cslibs_ndt::utility::PoolPtr<gaussian_t>;
+
+    const std::size_t alive = pool_t::local().size();
+    {
+        std::vector<ptr_t> ptrs(NUM_SAMPLES);
+        for (ptr_t &p : ptrs) {
+            EXPECT_FALSE(p);
+            EXPECT_TRUE(p == nullptr);
+            p.emplace().add(cslibs_math_3d::Point3d(1.0, 2.0, 3.0));
+        }
+        EXPECT_EQ(alive + NUM_SAMPLES, pool_t::local().size());
+
+        /// released objects are recycled
+        gaussian_t *released = ptrs.back().get();
+        ptrs.back().reset();
+        EXPECT_EQ(alive + NUM_SAMPLES - 1, pool_t::local().size());
+        ptrs.back().emplace();
+        EXPECT_EQ(released, ptrs.back().get());
+
+        /// copies are deep, moves are not
+        const ptr_t copy(ptrs.front());
+        EXPECT_NE(copy.get(), ptrs.front().get());
+        EXPECT_EQ(1ul, copy->getN());
+        ptrs.front()->add(cslibs_math_3d::Point3d(1.0, 2.0, 3.0));
+        EXPECT_EQ(1ul, copy->getN());
+
+        gaussian_t *moved = ptrs[1].get();
+        const ptr_t target(std::move(ptrs[1]));
+        EXPECT_EQ(moved, target.get());
+        EXPECT_FALSE(ptrs[1]);
+    }
+    EXPECT_EQ(alive, pool_t::local().size());
+}
+
+TEST(Test_cslibs_ndt, testPoolThreads)
+{
+    struct item_t
+    {
+        double data[4];
+    };
+    using pool_t = cslibs_ndt::utility::Pool<item_t>;
+    using ptr_t  = cslibs_ndt::utility::PoolPtr<item_t>;
+
+    /// objects released by another thread are recycled by their own pool
+    std::vector<ptr_t> ptrs(NUM_SAMPLES);
+    std::set<item_t*> addresses;
+    for (ptr_t &p : ptrs) {
+        p.emplace();
+        addresses.insert(p.get());
+    }
+    std::thread([&ptrs]() {
+        for (ptr_t &p : ptrs)
+            p.reset();
+    }).join();
+    EXPECT_EQ(0ul, pool_t::local().size());
+    for (ptr_t &p : ptrs) {
+        p.emplace();
+        EXPECT_EQ(1ul, addresses.count(p.get()));
+    }
+    ptrs.clear();
+
+    /// the pool of a thread lives as long as its objects
+    const std::size_t pools = pool_t::instances();
+    std::thread([&ptrs, pools]() {
+        ptrs.resize(NUM_SAMPLES);
+        for (ptr_t &p : ptrs)
+            p.emplace();
+        EXPECT_EQ(pools + 1, pool_t::instances());
+    }).join();
+    EXPECT_EQ(pools + 1, pool_t::instances());
+
+    const std::vector<ptr_t> copies(ptrs);
+    ptrs.clear();
+    EXPECT_EQ(pools, pool_t::instances());
+    EXPECT_EQ(NUM_SAMPLES, pool_t::local().size());
+}
+
+TEST(Test_cslibs_ndt, testOccupancyDistributionCopy)
+{
+    using distribution_t = cslibs_ndt::OccupancyDistribution<double,3>;
+
+    distribution_t d;
+    d.updateFree();
+    d.updateOccupied(cslibs_math_3d::Point3d(1.0, 2.0, 3.0));
+
+    distribution_t copy(d);
+    EXPECT_NE(d.getDistribution().get(), copy.getDistribution().get());
+    copy.updateOccupied(cslibs_math_3d::Point3d(1.0, 2.0, 3.0));
+    EXPECT_EQ(1ul, d.numOccupied());
+    EXPECT_EQ(2ul, copy.numOccupied());
+
+    copy = d;
+    EXPECT_EQ(1ul, copy.numOccupied());
+    EXPECT_NE(d.getDistribution().get(), copy.getDistribution().get());
+
+    using weighted_distribution_t = cslibs_ndt::WeightedOccupancyDistribution<double,3>;
+    weighted_distribution_t w;
+    w.updateOccupied(cslibs_math_3d::Point3d(1.0, 2.0, 3.0), 0.5);
+    weighted_distribution_t w_copy(w);
+    w_copy.updateOccupied(cslibs_math_3d::Point3d(1.0, 2.0, 3.0), 0.5);
+    EXPECT_NEAR(0.5, w.weightOccupied(), 1e-9);
+    EXPECT_NEAR(1.0, w_copy.weightOccupied(), 1e-9);
+}
+
+TEST(Test_cslibs_ndt, testOccupancyGridmapCopy)
+{
+    using map_t   = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::OccupancyDistribution,double>;
+    using point_t = cslibs_math_3d::Point3d;
+
+    rng_t rng(-10.0, +10.0);
+    std::vector<point_t> points;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        points.emplace_back(rng.get(), rng.get(), rng.get());
+
+    map_t map(1.0);
+    map.insert(points.begin(), points.end());
+
+    std::vector<map_t::index_t> indices;
+    map.getBundleIndices(indices);
+    std::vector<std::size_t> occupied;
+    for (const auto &bi : indices)
+        for (const auto *d : *map.get(bi))
+            occupied.emplace_back(d->numOccupied());
+
+    /// inserting into a copy must not change the original
+    map_t copy(map);
+    copy.insert(points.begin(), points.end());
+
+    std::size_t i = 0;
+    for (const auto &bi : indices) {
+        const map_t::distribution_bundle_t *bundle      = map.get(bi);
+        const map_t::distribution_bundle_t *copy_bundle = copy.get(bi);
+        for (std::size_t j=0; j<map_t::bin_count; ++j, ++i) {
+            EXPECT_EQ(occupied[i], bundle->at(j)->numOccupied());
+            EXPECT_EQ(2 * occupied[i], copy_bundle->at(j)->numOccupied());
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
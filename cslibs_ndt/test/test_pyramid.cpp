@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/pyramid.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <stdexcept>
+
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+namespace tags = cslibs_ndt::map::tags;
+
+using map_t           = cslibs_ndt::map::Map<tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using static_map_t    = cslibs_ndt::map::Map<tags::static_map,3,cslibs_ndt::Distribution,double>;
+using occupancy_map_t = cslibs_ndt::map::Map<tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,double>;
+using pyramid_t       = cslibs_ndt::map::Pyramid<tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+using point_t         = map_t::point_t;
+using pose_t          = map_t::pose_t;
+
+TEST(Test_cslibs_ndt, testPyramidLevels)
+{
+    const std::vector<point_t> points = generatePoints(20000, -10.0, 10.0);
+    const pose_t origin(0.3, -0.2, 0.1, 0.0, 0.0, 0.4);
+
+    map_t::Ptr map(new map_t(origin, 0.5));
+    map->insert(points.begin(), points.end());
+    const pyramid_t pyramid(map, 4);
+    ASSERT_EQ(4ul, pyramid.getLevelCount());
+
+    /// each level holds what a map of its resolution would
+    for (std::size_t k=1; k<pyramid.getLevelCount(); ++k) {
+        EXPECT_EQ(0.5 * static_cast<double>(1 << k), pyramid.getResolution(k));
+        map_t reference(origin, pyramid.getResolution(k));
+        reference.insert(points.begin(), points.end());
+        expectEqual(reference, pyramid.getLevel(k), 1e-9);
+
+        for (std::size_t i=0; i<100; ++i) {
+            EXPECT_NEAR(reference.sample(points[i]), pyramid.sample(points[i], k), 1e-6);
+            EXPECT_NEAR(reference.sampleNonNormalized(points[i]), pyramid.sampleNonNormalized(points[i], k), 1e-6);
+        }
+    }
+    EXPECT_EQ(map->sample(points[0]), pyramid.sample(points[0], 0));
+    EXPECT_EQ(map->get(points[0]), pyramid.get(points[0], 0));
+}
+
+TEST(Test_cslibs_ndt, testPyramidUpdate)
+{
+    const std::vector<point_t> a = generatePoints(20000, -10.0, 10.0);
+    const std::vector<point_t> b = generatePoints(2000, 5.0, 20.0);
+
+    map_t::Ptr map(new map_t(pose_t(), 0.5));
+    map->insert(a.begin(), a.end());
+    pyramid_t pyramid(map, 3, 4);
+
+    /// only what changed is derived again
+    map->insert(b.begin(), b.end());
+    pyramid.update(2);
+    for (std::size_t k=1; k<pyramid.getLevelCount(); ++k) {
+        map_t reference(pose_t(), pyramid.getResolution(k));
+        reference.insert(a.begin(), a.end());
+        reference.insert(b.begin(), b.end());
+        expectEqual(reference, pyramid.getLevel(k), 1e-9);
+    }
+
+    /// nothing changed since
+    pyramid.update();
+    map_t reference(pose_t(), pyramid.getResolution(2));
+    reference.insert(a.begin(), a.end());
+    reference.insert(b.begin(), b.end());
+    expectEqual(reference, pyramid.getLevel(2), 1e-9);
+}
+
+TEST(Test_cslibs_ndt, testPyramidStatic)
+{
+    const std::vector<point_t> points = generatePoints(5000, -4.0, 4.0);
+
+    using static_pyramid_t = cslibs_ndt::map::Pyramid<tags::static_map,3,cslibs_ndt::Distribution,double>;
+    static_map_t::Ptr map(new static_map_t(pose_t(), 1.0, {{10, 10, 10}}, {{-10, -10, -10}}));
+    map->insert(points.begin(), points.end());
+    const static_pyramid_t pyramid(map, 2);
+
+    map_t reference(pose_t(), 2.0);
+    reference.insert(points.begin(), points.end());
+    expectEqual(reference, pyramid.getLevel(1), 1e-9);
+}
+
+TEST(Test_cslibs_ndt, testPyramidOccupancy)
+{
+    using point_2d_t = occupancy_map_t::point_t;
+    using pose_2d_t  = occupancy_map_t::pose_t;
+    using index_2d_t = occupancy_map_t::index_t;
+    using occupancy_pyramid_t = cslibs_ndt::map::Pyramid<tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,double>;
+
+    rng_t rng(-10.0, 10.0);
+    std::vector<point_2d_t> points;
+    for (std::size_t i=0; i<500; ++i)
+        points.emplace_back(rng.get(), rng.get());
+
+    occupancy_map_t::Ptr map(new occupancy_map_t(pose_2d_t(), 0.5));
+    for (const point_2d_t &p : points)
+        map->insert(point_2d_t(), p);
+    const occupancy_pyramid_t pyramid(map, 3);
+
+    /// rays are discretized per resolution, the observations of the level below are kept
+    auto count = [](const std::size_t layer, const occupancy_map_t &level, std::size_t &free, std::size_t &occupied) {
+        free = occupied = 0;
+        level.traverseDistributions([layer, &free, &occupied](const std::size_t l, const index_2d_t &,
+                                                              const occupancy_map_t::distribution_t &d) {
+            if (l != layer)
+                return;
+            free     += d.numFree();
+            occupied += d.numOccupied();
+        });
+    };
+    for (std::size_t layer=0; layer<occupancy_map_t::bin_count; ++layer) {
+        std::size_t free, occupied, fine_free, fine_occupied;
+        count(0, *map, fine_free, fine_occupied);
+        count(layer, pyramid.getLevel(2), free, occupied);
+        EXPECT_EQ(fine_free, free);
+        EXPECT_EQ(points.size(), occupied);
+    }
+
+    /// occupied cells match a map of the coarser resolution
+    occupancy_map_t reference(pose_2d_t(), 1.0);
+    for (const point_2d_t &p : points)
+        reference.insert(point_2d_t(), p);
+    for (const point_2d_t &p : points) {
+        const occupancy_map_t::distribution_bundle_t *expected = reference.get(p);
+        const occupancy_map_t::distribution_bundle_t *bundle   = pyramid.get(p, 1);
+        ASSERT_NE(nullptr, bundle);
+        for (std::size_t i=0; i<occupancy_map_t::bin_count; ++i) {
+            EXPECT_EQ(expected->at(i)->numOccupied(), bundle->at(i)->numOccupied());
+            EXPECT_TRUE(expected->at(i)->getDistribution()->getMean().isApprox(bundle->at(i)->getDistribution()->getMean(), 1e-9));
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt, testPyramidErrors)
+{
+    EXPECT_THROW(pyramid_t(map_t::Ptr(), 2), std::runtime_error);
+    map_t::Ptr map(new map_t(pose_t(), 1.0));
+    EXPECT_THROW(pyramid_t(map, 0), std::runtime_error);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
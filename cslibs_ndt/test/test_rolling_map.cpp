@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/rolling_map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <map>
+
+const std::size_t NUM_SAMPLES = 5000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+TEST(Test_cslibs_ndt, testRingArray)
+{
+    using index_t        = std::array<int,2>;
+    using distribution_t = cslibs_ndt::Distribution<double,2>;
+    using storage_t      = cis::Storage<distribution_t, index_t, cslibs_ndt::backend::RingArray>;
+
+    storage_t storage;
+    storage.set<cis::option::tags::array_size>(std::array<std::size_t,2>{{5ul, 4ul}});
+    storage.set<cis::option::tags::array_offset>(index_t{{-2, -3}});
+    const std::size_t capacity = storage.capacity();
+    EXPECT_EQ(20ul, capacity);
+
+    for (int x=-2; x<3; ++x)
+        for (int y=-3; y<1; ++y)
+            storage.insert(index_t{{x, y}}, distribution_t()).data().add(cslibs_math_2d::Point2d(x, y));
+    EXPECT_THROW(storage.insert(index_t{{3, 0}}, distribution_t()), std::out_of_range);
+    EXPECT_EQ(nullptr, storage.get(index_t{{-3, 0}}));
+    const distribution_t *kept = storage.get(index_t{{1, -1}});
+
+    /// two columns leave the window, one row enters it
+    storage.set<cis::option::tags::array_offset>(index_t{{0, -4}});
+    EXPECT_EQ(capacity, storage.capacity());
+    EXPECT_EQ(9ul, storage.size());
+    EXPECT_EQ(kept, storage.get(index_t{{1, -1}}));
+
+    std::map<index_t, std::size_t> visited;
+    storage.traverse([&visited](const index_t &index, const distribution_t &d) {
+        ++visited[index];
+        EXPECT_EQ(1ul, d.data().getN());
+        EXPECT_DOUBLE_EQ(index[0], d.data().getMean()(0));
+        EXPECT_DOUBLE_EQ(index[1], d.data().getMean()(1));
+    });
+    EXPECT_EQ(9ul, visited.size());
+    for (const auto &v : visited) {
+        EXPECT_GE(v.first[0], 0);
+        EXPECT_LE(v.first[0], 2);
+        EXPECT_GE(v.first[1], -3);
+        EXPECT_LE(v.first[1], -1);
+    }
+
+    /// cells entering the window are empty, although their ring slots were used
+    EXPECT_EQ(nullptr, storage.get(index_t{{3, -2}}));
+    EXPECT_EQ(nullptr, storage.get(index_t{{1, -4}}));
+    storage.insert(index_t{{3, -2}}, distribution_t());
+    EXPECT_EQ(0ul, storage.get(index_t{{3, -2}})->data().getN());
+
+    const storage_t copy(storage);
+    EXPECT_EQ(storage.size(), copy.size());
+    EXPECT_EQ(1ul, copy.get(index_t{{1, -1}})->data().getN());
+
+    /// moving further than the window clears everything
+    storage.set<cis::option::tags::array_offset>(index_t{{10, 10}});
+    EXPECT_EQ(0ul, storage.size());
+}
+
+TEST(Test_cslibs_ndt, testRollingMap)
+{
+    using rolling_map_t = cslibs_ndt::map::RollingMap<3,cslibs_ndt::Distribution,double>;
+    using static_map_t  = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double>;
+    using point_t       = rolling_map_t::point_t;
+    using index_t       = rolling_map_t::index_t;
+
+    const rolling_map_t::size_t size = {{8ul, 8ul, 4ul}};
+    rolling_map_t map(rolling_map_t::pose_t(), 1.0, size, point_t(0.5, 0.5, 0.5));
+    EXPECT_EQ((index_t{{-4, -4, -2}}), map.getWindowOffset());
+
+    /// data around the robot and in the part of the window which is about to leave
+    rng_t rng(-1.5, 1.5);
+    std::vector<point_t> points;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        points.emplace_back(rng.get(), rng.get(), 0.5 * rng.get());
+    map.insert(points.begin(), points.end());
+    rng_t rng_leave(-3.8, -3.2);
+    for (std::size_t i=0; i<NUM_SAMPLES / 10; ++i)
+        map.insert(point_t(rng_leave.get(), rng_leave.get(), 0.0));
+    /// outside of the window
+    map.insert(point_t(100.0, 0.0, 0.0));
+
+    const std::size_t bytes = map.getByteSize();
+    EXPECT_FALSE(map.moveTo(point_t(0.9, 0.1, 0.5)));
+    EXPECT_TRUE(map.moveTo(point_t(2.5, 1.5, 0.5)));
+    EXPECT_EQ((index_t{{-2, -3, -2}}), map.getWindowOffset());
+    EXPECT_EQ(bytes, map.getByteSize());
+
+    /// a map created at the new window sees the same data
+    static_map_t reference(static_map_t::pose_t(), 1.0, size, index_t{{-4, -6, -4}});
+    reference.insert(points.begin(), points.end());
+    EXPECT_EQ(reference.getMinBundleIndex(), map.getMinBundleIndex());
+    EXPECT_EQ(reference.getMaxBundleIndex(), map.getMaxBundleIndex());
+
+    /// and keeps doing so while new data is added
+    rng_t rng_enter(2.0, 5.9);
+    std::vector<point_t> entering;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        entering.emplace_back(rng_enter.get(), rng.get(), 0.5 * rng.get());
+    map.insert(entering.begin(), entering.end());
+    reference.insert(entering.begin(), entering.end());
+
+    std::size_t bundles = 0;
+    map.traverse([&reference, &bundles](const index_t &bi, const rolling_map_t::distribution_bundle_t &b) {
+        const static_map_t::distribution_bundle_t *r = reference.get(bi);
+        ASSERT_NE(nullptr, r);
+        for (std::size_t i=0; i<rolling_map_t::bin_count; ++i) {
+            EXPECT_EQ(r->at(i)->data().getN(), b.at(i)->data().getN());
+            if (b.at(i)->data().getN() > 0) {
+                EXPECT_NEAR(r->at(i)->data().getMean()(0), b.at(i)->data().getMean()(0), 1e-9);
+            }
+        }
+        ++bundles;
+    });
+    std::vector<index_t> reference_bundles;
+    reference.getBundleIndices(reference_bundles);
+    EXPECT_EQ(reference_bundles.size(), bundles);
+
+    for (int i=0; i<10; ++i) {
+        const point_t p(rng_enter.get(), rng.get(), 0.5 * rng.get());
+        EXPECT_NEAR(reference.sampleNonNormalized(p), map.sampleNonNormalized(p), 1e-9);
+    }
+}
+
+TEST(Test_cslibs_ndt, testRollingMapDrive)
+{
+    using rolling_map_t = cslibs_ndt::map::RollingMap<2,cslibs_ndt::Distribution,double>;
+    using point_t       = rolling_map_t::point_t;
+
+    rolling_map_t map(rolling_map_t::pose_t(), 0.5, {{20ul, 20ul}});
+    const std::size_t bytes = map.getByteSize();
+
+    /// memory stays constant, only bundles within the window remain
+    rng_t rng(-2.0, 2.0);
+    for (int step=0; step<100; ++step) {
+        const point_t robot(0.3 * step, -0.1 * step);
+        map.moveTo(robot);
+        for (std::size_t i=0; i<100; ++i)
+            map.insert(point_t(robot(0) + rng.get(), robot(1) + rng.get()));
+
+        EXPECT_EQ(bytes, map.getByteSize());
+        const rolling_map_t::index_t min = map.getMinBundleIndex();
+        const rolling_map_t::index_t max = map.getMaxBundleIndex();
+        map.traverse([&min, &max](const rolling_map_t::index_t &bi, const rolling_map_t::distribution_bundle_t &) {
+            for (std::size_t i=0; i<2; ++i) {
+                EXPECT_GE(bi[i], min[i]);
+                EXPECT_LE(bi[i], max[i]);
+            }
+        });
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+const std::size_t NUM_SAMPLES = 20000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+template <std::size_t Dim>
+using point_t = typename cslibs_ndt::map::traits<Dim,double>::point_t;
+template <std::size_t Dim>
+using pose_t  = typename cslibs_ndt::map::traits<Dim,double>::pose_t;
+
+template <std::size_t Dim>
+inline point_t<Dim> randomPoint(rng_t &rng);
+
+template <>
+inline point_t<2> randomPoint<2>(rng_t &rng)
+{
+    return point_t<2>(rng.get(), rng.get());
+}
+
+template <>
+inline point_t<3> randomPoint<3>(rng_t &rng)
+{
+    return point_t<3>(rng.get(), rng.get(), rng.get());
+}
+
+template <std::size_t Dim>
+inline pose_t<Dim> origin();
+
+template <>
+inline pose_t<2> origin<2>()
+{
+    return pose_t<2>(1.0, -2.0, 0.3);
+}
+
+template <>
+inline pose_t<3> origin<3>()
+{
+    return pose_t<3>(1.0, -2.0, 0.5, 0.1, 0.2, 0.3);
+}
+
+template <std::size_t Dim>
+inline std::vector<point_t<Dim>> randomPoints(const std::size_t count, rng_t &rng)
+{
+    std::vector<point_t<Dim>> points;
+    for (std::size_t i=0; i<count; ++i)
+        points.emplace_back(randomPoint<Dim>(rng));
+    return points;
+}
+
+template <std::size_t Dim>
+void testGridmap()
+{
+    using map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,Dim,cslibs_ndt::Distribution,double>;
+
+    rng_t rng(-5.0, +5.0);
+    rng_t rng_queries(-8.0, +8.0);
+    const std::vector<point_t<Dim>> points = randomPoints<Dim>(NUM_SAMPLES, rng);
+    map_t map(origin<Dim>(), 1.0);
+    map.insert(points.begin(), points.end());
+
+    /// queries partly outside of the map
+    const std::vector<point_t<Dim>> queries = randomPoints<Dim>(NUM_SAMPLES, rng_queries);
+    std::vector<double> values, values_non_normalized;
+    map.sample(queries.begin(), queries.end(), values);
+    map.sampleNonNormalized(queries.begin(), queries.end(), values_non_normalized);
+
+    ASSERT_EQ(queries.size(), values.size());
+    ASSERT_EQ(queries.size(), values_non_normalized.size());
+    std::size_t non_zero = 0;
+    for (std::size_t i=0; i<queries.size(); ++i) {
+        EXPECT_NEAR(map.sample(queries[i]), values[i], 1e-9);
+        EXPECT_NEAR(map.sampleNonNormalized(queries[i]), values_non_normalized[i], 1e-9);
+        non_zero += values[i] > 0.0 ? 1 : 0;
+    }
+    EXPECT_GT(non_zero, 0ul);
+}
+
+template <std::size_t Dim, template <typename,std::size_t> class data_t>
+void testOccupancyGridmap()
+{
+    using map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,Dim,data_t,double>;
+
+    cslibs_gridmaps::utility::InverseModel<double>::Ptr ivm(
+                new cslibs_gridmaps::utility::InverseModel<double>(0.5, 0.45, 0.65));
+
+    rng_t rng(-5.0, +5.0);
+    rng_t rng_queries(-8.0, +8.0);
+    map_t map(origin<Dim>(), 1.0);
+    for (std::size_t i=0; i<4; ++i) {
+        const std::vector<point_t<Dim>> points = randomPoints<Dim>(NUM_SAMPLES / 4, rng);
+        map.insert(points.begin(), points.end());
+    }
+
+    const std::vector<point_t<Dim>> queries = randomPoints<Dim>(NUM_SAMPLES, rng_queries);
+    std::vector<double> values, values_non_normalized;
+    map.sample(queries.begin(), queries.end(), values, ivm);
+    map.sampleNonNormalized(queries.begin(), queries.end(), values_non_normalized, ivm);
+
+    ASSERT_EQ(queries.size(), values.size());
+    ASSERT_EQ(queries.size(), values_non_normalized.size());
+    std::size_t non_zero = 0;
+    for (std::size_t i=0; i<queries.size(); ++i) {
+        EXPECT_NEAR(map.sample(queries[i], ivm), values[i], 1e-9);
+        EXPECT_NEAR(map.sampleNonNormalized(queries[i], ivm), values_non_normalized[i], 1e-9);
+        non_zero += values[i] > 0.0 ? 1 : 0;
+    }
+    EXPECT_GT(non_zero, 0ul);
+
+    EXPECT_THROW(map.sample(queries.begin(), queries.end(), values, nullptr), std::runtime_error);
+}
+
+TEST(Test_cslibs_ndt, testSampleBatchGridmap2d)
+{
+    testGridmap<2>();
+}
+
+TEST(Test_cslibs_ndt, testSampleBatchGridmap3d)
+{
+    testGridmap<3>();
+}
+
+TEST(Test_cslibs_ndt, testSampleBatchOccupancyGridmap2d)
+{
+    testOccupancyGridmap<2, cslibs_ndt::OccupancyDistribution>();
+}
+
+TEST(Test_cslibs_ndt, testSampleBatchOccupancyGridmap3d)
+{
+    testOccupancyGridmap<3, cslibs_ndt::OccupancyDistribution>();
+}
+
+TEST(Test_cslibs_ndt, testSampleBatchWeightedOccupancyGridmap2d)
+{
+    testOccupancyGridmap<2, cslibs_ndt::WeightedOccupancyDistribution>();
+}
+
+TEST(Test_cslibs_ndt, testSampleBatchWeightedOccupancyGridmap3d)
+{
+    testOccupancyGridmap<3, cslibs_ndt::WeightedOccupancyDistribution>();
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
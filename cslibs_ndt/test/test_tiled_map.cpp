@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/tiled_map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <map>
+
+const std::size_t NUM_SAMPLES = 10000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+TEST(Test_cslibs_ndt, testTiledMap)
+{
+    using index_t        = std::array<int,2>;
+    using distribution_t = cslibs_ndt::Distribution<double,2>;
+    using storage_t      = cis::Storage<distribution_t, index_t, cslibs_ndt::backend::TiledMap>;
+
+    storage_t storage;
+    std::map<index_t, std::size_t> reference;
+    std::map<index_t, const distribution_t*> addresses;
+
+    /// covers negative indices and several blocks per dimension
+    rng_t rng(-50.0, +50.0);
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        const index_t index = {{static_cast<int>(std::floor(rng.get())), static_cast<int>(std::floor(rng.get()))}};
+        distribution_t *d = storage.get(index);
+        if (!d) {
+            d = &storage.insert(index, distribution_t());
+            addresses[index] = d;
+        }
+        d->data().add(cslibs_math_2d::Point2d(rng.get(), rng.get()));
+        ++reference[index];
+
+        /// every few steps remove an element
+        if (i % 7 == 0) {
+            const index_t other = {{static_cast<int>(std::floor(rng.get())), static_cast<int>(std::floor(rng.get()))}};
+            EXPECT_EQ(reference.erase(other) > 0, storage.remove(other));
+            addresses.erase(other);
+        }
+    }
+
+    EXPECT_EQ(reference.size(), storage.size());
+    for (const auto &r : reference) {
+        const distribution_t *d = storage.get(r.first);
+        ASSERT_NE(nullptr, d);
+        EXPECT_EQ(r.second, d->data().getN());
+        /// adding blocks must not move the data
+        EXPECT_EQ(addresses[r.first], d);
+    }
+
+    std::size_t visited = 0;
+    storage.traverse([&reference, &visited](const index_t &index, const distribution_t &d) {
+        ASSERT_EQ(1ul, reference.count(index));
+        EXPECT_EQ(reference[index], d.data().getN());
+        ++visited;
+    });
+    EXPECT_EQ(reference.size(), visited);
+
+    const storage_t copy(storage);
+    EXPECT_EQ(storage.size(), copy.size());
+    for (const auto &r : reference)
+        EXPECT_EQ(r.second, copy.get(r.first)->data().getN());
+
+    storage.clear();
+    EXPECT_EQ(0ul, storage.size());
+    EXPECT_EQ(nullptr, storage.get(reference.begin()->first));
+}
+
+TEST(Test_cslibs_ndt, testTiledMapBlocks)
+{
+    using index_t        = std::array<int,3>;
+    using distribution_t = cslibs_ndt::Distribution<double,3>;
+    using storage_t      = cis::Storage<distribution_t, index_t, cslibs_ndt::backend::TiledMap>;
+
+    storage_t storage;
+    EXPECT_EQ(4096ul, storage_t::block_cells);
+
+    /// a 16^3 cube aligned to the blocks fills exactly one block
+    for (int x=0; x<16; ++x)
+        for (int y=0; y<16; ++y)
+            for (int z=0; z<16; ++z)
+                storage.insert({{x, y, z}}, distribution_t());
+    EXPECT_EQ(1ul, storage.blockCount());
+    EXPECT_EQ(4096ul, storage.size());
+
+    /// -1 belongs to the block left of 0
+    storage.insert({{-1, 0, 0}}, distribution_t());
+    EXPECT_EQ(2ul, storage.blockCount());
+    storage.insert({{-16, 15, 0}}, distribution_t());
+    EXPECT_EQ(2ul, storage.blockCount());
+    storage.insert({{-17, 0, 0}}, distribution_t());
+    EXPECT_EQ(3ul, storage.blockCount());
+
+    /// empty blocks are released
+    EXPECT_TRUE(storage.remove({{-17, 0, 0}}));
+    EXPECT_FALSE(storage.remove({{-17, 0, 0}}));
+    EXPECT_EQ(2ul, storage.blockCount());
+    EXPECT_EQ(4098ul, storage.size());
+
+    std::size_t visited = 0;
+    storage.traverse([&storage, &visited](const index_t &index, const distribution_t &d) {
+        EXPECT_EQ(&d, storage.get(index));
+        ++visited;
+    });
+    EXPECT_EQ(storage.size(), visited);
+}
+
+TEST(Test_cslibs_ndt, testTiledMapGridmap)
+{
+    using map_t       = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+    using tiled_map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double,
+                                             cslibs_ndt::backend::TiledMap>;
+    using point_t     = cslibs_math_3d::Point3d;
+
+    rng_t rng(-10.0, +10.0);
+    std::vector<point_t> points;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        points.emplace_back(rng.get(), rng.get(), rng.get());
+
+    map_t map(1.0);
+    tiled_map_t tiled_map(1.0);
+    map.insert(points.begin(), points.end());
+    tiled_map.insert(points.begin(), points.end());
+
+    std::vector<map_t::index_t> indices, tiled_indices;
+    map.getBundleIndices(indices);
+    tiled_map.getBundleIndices(tiled_indices);
+    EXPECT_EQ(indices.size(), tiled_indices.size());
+    for (std::size_t i=0; i<3; ++i) {
+        EXPECT_EQ(map.getMinBundleIndex()[i], tiled_map.getMinBundleIndex()[i]);
+        EXPECT_EQ(map.getMaxBundleIndex()[i], tiled_map.getMaxBundleIndex()[i]);
+    }
+
+    for (const auto &bi : indices) {
+        const map_t::distribution_bundle_t *bundle             = map.get(bi);
+        const tiled_map_t::distribution_bundle_t *tiled_bundle = tiled_map.get(bi);
+        ASSERT_NE(nullptr, tiled_bundle);
+        for (std::size_t i=0; i<map_t::bin_count; ++i)
+            EXPECT_EQ(bundle->at(i)->data().getN(), tiled_bundle->at(i)->data().getN());
+    }
+
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        const point_t p(rng.get(), rng.get(), rng.get());
+        EXPECT_NEAR(map.sampleNonNormalized(p), tiled_map.sampleNonNormalized(p), 1e-9);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/map.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <atomic>
+#include <map>
+#include <set>
+
+const std::size_t NUM_SAMPLES = 10000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+template <typename map_t>
+void fill(map_t &map)
+{
+    rng_t rng(-20.0, +20.0);
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i)
+        map.insert(typename map_t::point_t(rng.get(), rng.get(), rng.get()));
+}
+
+template <typename map_t>
+std::map<typename map_t::index_t, const typename map_t::distribution_bundle_t*> reference(const map_t &map)
+{
+    using index_t  = typename map_t::index_t;
+    using bundle_t = typename map_t::distribution_bundle_t;
+
+    std::map<index_t, const bundle_t*> bundles;
+    map.traverse([&bundles](const index_t &bi, const bundle_t &b) {
+        bundles[bi] = &b;
+    });
+    return bundles;
+}
+
+template <typename map_t>
+void testOrdered(const map_t &map)
+{
+    using index_t  = typename map_t::index_t;
+    using bundle_t = typename map_t::distribution_bundle_t;
+    using morton_t = cslibs_ndt::utility::Morton<3>;
+
+    const auto expected = reference(map);
+    ASSERT_FALSE(expected.empty());
+
+    std::vector<index_t> visited;
+    map.traverseOrdered([&expected, &visited](const index_t &bi, const bundle_t &b) {
+        ASSERT_EQ(1ul, expected.count(bi));
+        EXPECT_EQ(expected.at(bi), &b);
+        visited.emplace_back(bi);
+    });
+    ASSERT_EQ(expected.size(), visited.size());
+    for (std::size_t i=1; i<visited.size(); ++i)
+        EXPECT_LT(morton_t::encode(visited[i - 1]), morton_t::encode(visited[i]));
+}
+
+template <typename map_t>
+void testParallel(const map_t &map)
+{
+    using index_t  = typename map_t::index_t;
+    using bundle_t = typename map_t::distribution_bundle_t;
+
+    const auto expected = reference(map);
+    std::map<index_t, std::size_t> slots;
+    for (const auto &e : expected)
+        slots.emplace(e.first, slots.size());
+
+    for (std::size_t threads : {1ul, 3ul, 8ul}) {
+        std::vector<std::atomic<std::size_t>> counts(slots.size());
+        for (auto &c : counts)
+            c = 0;
+        map.traverseParallel([&expected, &slots, &counts](const index_t &bi, const bundle_t &b) {
+            EXPECT_EQ(expected.at(bi), &b);
+            ++counts[slots.at(bi)];
+        }, threads);
+        for (const auto &c : counts)
+            EXPECT_EQ(1ul, c.load());
+    }
+}
+
+TEST(Test_cslibs_ndt, testTraverseOrdered)
+{
+    using static_map_t  = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double>;
+    using dynamic_map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+
+    dynamic_map_t dynamic_map(1.0);
+    fill(dynamic_map);
+    dynamic_map.allocatePartiallyAllocatedBundles();
+    testOrdered(dynamic_map);
+
+    static_map_t static_map(static_map_t::pose_t(), 1.0, {{42ul, 42ul, 42ul}}, {{-42, -42, -42}});
+    fill(static_map);
+    testOrdered(static_map);
+}
+
+TEST(Test_cslibs_ndt, testTraverseParallel)
+{
+    using map_t = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+
+    map_t map(1.0);
+    fill(map);
+    map.allocatePartiallyAllocatedBundles();
+    testParallel(map);
+
+    /// fewer bundles than ranges
+    map_t small(1.0);
+    small.insert(map_t::point_t(0.1, 0.2, 0.3));
+    testParallel(small);
+
+    map_t empty(1.0);
+    empty.traverseParallel([](const map_t::index_t &, const map_t::distribution_bundle_t &) {
+        ADD_FAILURE();
+    }, 4);
+}
+
+TEST(Test_cslibs_ndt, testTraverseDistributions)
+{
+    using map_t          = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,double>;
+    using index_t        = map_t::index_t;
+    using distribution_t = map_t::distribution_t;
+
+    map_t map(1.0);
+    fill(map);
+
+    /// the distributions of all bundles, each bundle shares them with its neighbours
+    std::set<const distribution_t*> expected;
+    map.traverse([&expected](const index_t &, const map_t::distribution_bundle_t &b) {
+        for (std::size_t i=0; i<map_t::bin_count; ++i)
+            expected.insert(b.at(i));
+    });
+
+    std::map<const distribution_t*, std::size_t> visited;
+    std::set<std::uint64_t> ids;
+    map.traverseDistributions([&map, &visited, &ids](const std::size_t layer, const index_t &index, const distribution_t &d) {
+        ++visited[&d];
+        ids.insert(map_t::getDistributionId(layer, index));
+        EXPECT_EQ(&d, map.getStorages()[layer]->get(index));
+
+        /// the bundle index lies within the distribution
+        const map_t::index_list_t indices =
+                cslibs_ndt::utility::generate_indices<map_t::index_list_t,3>(map_t::getBundleIndex(layer, index));
+        EXPECT_EQ(index, indices[layer]);
+    });
+    EXPECT_EQ(visited.size(), ids.size());
+    for (const auto &v : visited)
+        EXPECT_EQ(1ul, v.second);
+    for (const distribution_t *d : expected)
+        EXPECT_EQ(1ul, visited.count(d));
+
+    std::vector<std::map<const distribution_t*, std::size_t>> layers(map_t::bin_count);
+    map.traverseDistributionsParallel([&layers](const std::size_t layer, const index_t &, const distribution_t &d) {
+        ++layers[layer][&d];
+    }, 4);
+    std::size_t count = 0;
+    for (const auto &layer : layers) {
+        for (const auto &v : layer) {
+            EXPECT_EQ(1ul, v.second);
+            EXPECT_EQ(1ul, visited.count(v.first));
+        }
+        count += layer.size();
+    }
+    EXPECT_EQ(visited.size(), count);
+
+    /// a pool is reused over several traversals
+    cslibs_ndt::utility::WorkerPool workers(4);
+    for (std::size_t r=0; r<3; ++r) {
+        std::vector<std::size_t> counts(map_t::bin_count, 0);
+        map.traverseDistributionsParallel([&counts](const std::size_t layer, const index_t &, const distribution_t &) {
+            ++counts[layer];
+        }, workers);
+        for (std::size_t l=0; l<map_t::bin_count; ++l)
+            EXPECT_EQ(layers[l].size(), counts[l]);
+    }
+}
+
+TEST(Test_cslibs_ndt, testWorkerPool)
+{
+    for (const std::size_t threads : {1ul, 2ul, 4ul}) {
+        cslibs_ndt::utility::WorkerPool workers(threads);
+        EXPECT_EQ(threads, workers.size());
+
+        /// every item is visited exactly once per call, calls do not overlap
+        for (const std::size_t count : {0ul, 1ul, 3ul, 1000ul}) {
+            for (std::size_t r=0; r<20; ++r) {
+                std::vector<std::atomic<std::size_t>> visits(count);
+                for (auto &v : visits)
+                    v = 0;
+                workers.parallel_for(count, [&visits](const std::size_t i) {
+                    ++visits[i];
+                });
+                for (const auto &v : visits)
+                    EXPECT_EQ(1ul, v.load());
+            }
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt, testMortonSortFallback)
+{
+    using index_t = std::array<int,3>;
+
+    /// indices beyond the Morton range are sorted lexicographically
+    std::vector<index_t> indices = {{{1, 2, 3}}, {{1 << 25, 0, 0}}, {{-4, 5, 6}}, {{1, 2, 2}}};
+    std::vector<index_t> expected = indices;
+    std::sort(expected.begin(), expected.end());
+    cslibs_ndt::utility::morton_sort<3>(indices, [](const index_t &i) -> const index_t& { return i; });
+    EXPECT_EQ(expected, indices);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
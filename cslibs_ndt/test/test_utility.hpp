@@ -0,0 +1,69 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/map/traits.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+/// points in a flat box, the extent along y and z is a half and a quarter of the one along x
+inline std::vector<cslibs_ndt::map::traits<3,double>::point_t> generatePoints(const std::size_t count,
+                                                                              const double min,
+                                                                              const double max)
+{
+    cslibs_math::random::Uniform<double,1> rng(min, max);
+    std::vector<cslibs_ndt::map::traits<3,double>::point_t> points;
+    for (std::size_t i=0; i<count; ++i)
+        points.emplace_back(rng.get(), 0.5 * rng.get(), 0.25 * rng.get());
+    return points;
+}
+
+/// the populated distributions of both maps are the same, map can be any type which traverses the same distributions
+template <typename expected_t, typename map_t>
+void expectEqual(const expected_t &expected, const map_t &map, const double eps)
+{
+    using index_t        = typename expected_t::index_t;
+    using distribution_t = typename expected_t::distribution_t;
+    using key_t          = std::pair<std::size_t, index_t>;
+
+    std::map<key_t, const distribution_t*> distributions;
+    expected.traverseDistributions([&distributions](const std::size_t layer, const index_t &index, const distribution_t &d) {
+        if (d.data().getN() > 0)
+            distributions[key_t(layer, index)] = &d;
+    });
+
+    std::size_t count = 0;
+    map.traverseDistributions([&distributions, &count, eps](const std::size_t layer, const index_t &index, const distribution_t &d) {
+        if (d.data().getN() == 0)
+            return;
+        const auto it = distributions.find(key_t(layer, index));
+        ASSERT_NE(distributions.end(), it);
+        EXPECT_EQ(it->second->data().getN(), d.data().getN());
+        for (int i=0; i<d.data().getMean().rows(); ++i)
+            EXPECT_NEAR(it->second->data().getMean()(i), d.data().getMean()(i), eps);
+        if (d.data().getN() > 1) {
+            EXPECT_TRUE(it->second->data().getCovariance().isApprox(d.data().getCovariance(), eps));
+        }
+        ++count;
+    });
+    EXPECT_EQ(distributions.size(), count);
+}
+
+/// wall time of f in milliseconds
+template <typename function_t>
+inline double measure(const function_t &f)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// wall time of f in nanoseconds per item
+template <typename function_t>
+inline double measure(const std::size_t count, const function_t &f)
+{
+    return 1e6 * measure(f) / static_cast<double>(count);
+}
@@ -2,6 +2,7 @@
 #define CSLIBS_NDT_2D_CONVERSION_BINARY_GRIDMAP_HPP
 
 #include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt_2d/conversion/rasterize.hpp>
 
 #include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
 #include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
@@ -33,33 +34,19 @@ inline void from(
                             std::ceil(src.getWidth()  / sampling_resolution)));
     std::fill(dst->getData().begin(), dst->getData().end(), dst_map_t::FREE);
 
-    const T bundle_resolution = src.getBundleResolution();
-    const int chunk_step = static_cast<int>(bundle_resolution / sampling_resolution);
-
-    auto sample = [](const cslibs_math_2d::Point2<T> &p, const typename src_map_t::distribution_bundle_t &bundle) {
-        return src_map_t::div_count * (bundle.at(0)->data().sampleNonNormalized(p) +
-                                       bundle.at(1)->data().sampleNonNormalized(p) +
-                                       bundle.at(2)->data().sampleNonNormalized(p) +
-                                       bundle.at(3)->data().sampleNonNormalized(p));
+    auto gather = [](const typename src_map_t::distribution_bundle_t &bundle,
+                     typename src_map_t::bundle_gaussians_t &gaussians) {
+        for (std::size_t i=0; i<src_map_t::bin_count; ++i) {
+            const typename src_map_t::distribution_t *d = bundle.at(i);
+            if (d && d->data().valid() && d->data().getInformationMatrix().allFinite())
+                gaussians.add(d->data().getMean(), d->data().getInformationMatrix(), src_map_t::div_count);
+        }
     };
 
-    using index_t = std::array<int, 2>;
-    const index_t min_bi = src.getMinBundleIndex();
-
-    const auto& origin = src.getInitialOrigin();
-    src.traverse([&dst, &origin, &bundle_resolution, &sampling_resolution, &chunk_step, &min_bi, &sample]
-                  (const index_t &bi, const typename src_map_t::distribution_bundle_t &b){
-        for (int k = 0 ; k < chunk_step ; ++ k) {
-            for (int l = 0 ; l < chunk_step ; ++ l) {
-                const cslibs_math_2d::Point2<T> p(static_cast<T>(bi[0]) * bundle_resolution + static_cast<T>(k) * sampling_resolution,
-                                                  static_cast<T>(bi[1]) * bundle_resolution + static_cast<T>(l) * sampling_resolution);
-                const std::size_t u = (bi[0] - min_bi[0]) * chunk_step + k;
-                const std::size_t v = (bi[1] - min_bi[1]) * chunk_step + l;
-                dst->at(u,v) = sample(p, b) >= threshold ?
-                            cslibs_gridmaps::static_maps::BinaryGridmap::OCCUPIED :
-                            cslibs_gridmaps::static_maps::BinaryGridmap::FREE;
-            }
-        }
+    rasterize(src, sampling_resolution, gather, [&dst, &threshold](const std::size_t u, const std::size_t v, const T value) {
+        dst->at(u,v) = value >= threshold ?
+                    cslibs_gridmaps::static_maps::BinaryGridmap::OCCUPIED :
+                    cslibs_gridmaps::static_maps::BinaryGridmap::FREE;
     });
 }
 
@@ -88,41 +75,20 @@ inline void from(
                             std::ceil(src.getWidth()  / sampling_resolution)));
     std::fill(dst->getData().begin(), dst->getData().end(), dst_map_t::FREE);
 
-    const T bundle_resolution = src.getBundleResolution();
-    const int chunk_step = static_cast<int>(bundle_resolution / sampling_resolution);
-
-    auto sample = [&inverse_model](const cslibs_math_2d::Point2<T> &p, const typename src_map_t::distribution_bundle_t &bundle) {
-        auto sample = [&p, &inverse_model](const typename src_map_t::distribution_t *d) {
-            auto do_sample = [&p, &inverse_model, &d]() {
-                const auto &handle = d;
-                return handle->getDistribution() ?
-                            handle->getDistribution()->sampleNonNormalized(p) * handle->getOccupancy(inverse_model) : T();
-            };
-            return d ? do_sample() : T();
-        };
-        return src_map_t::div_count * (sample(bundle.at(0)) +
-                                       sample(bundle.at(1)) +
-                                       sample(bundle.at(2)) +
-                                       sample(bundle.at(3)));
+    auto gather = [&inverse_model](const typename src_map_t::distribution_bundle_t &bundle,
+                                   typename src_map_t::bundle_gaussians_t &gaussians) {
+        for (std::size_t i=0; i<src_map_t::bin_count; ++i) {
+            const typename src_map_t::distribution_t *d = bundle.at(i);
+            const auto *g = d ? d->getDistribution().get() : nullptr;
+            if (g && g->valid() && g->getInformationMatrix().allFinite())
+                gaussians.add(g->getMean(), g->getInformationMatrix(), src_map_t::div_count * d->getOccupancy(inverse_model));
+        }
     };
 
-    using index_t = std::array<int, 2>;
-    const index_t min_bi = src.getMinBundleIndex();
-
-    const auto& origin = src.getInitialOrigin();
-    src.traverse([&dst, &origin, &bundle_resolution, &sampling_resolution, &chunk_step, &min_bi, &sample]
-                  (const index_t &bi, const typename src_map_t::distribution_bundle_t &b){
-        for (int k = 0 ; k < chunk_step ; ++ k) {
-            for (int l = 0 ; l < chunk_step ; ++ l) {
-                const cslibs_math_2d::Point2<T> p(static_cast<T>(bi[0]) * bundle_resolution + static_cast<T>(k) * sampling_resolution,
-                                                  static_cast<T>(bi[1]) * bundle_resolution + static_cast<T>(l) * sampling_resolution);
-                const std::size_t u = (bi[0] - min_bi[0]) * chunk_step + k;
-                const std::size_t v = (bi[1] - min_bi[1]) * chunk_step + l;
-                dst->at(u,v) = sample(p, b) >= threshold ?
-                            cslibs_gridmaps::static_maps::BinaryGridmap::OCCUPIED :
-                            cslibs_gridmaps::static_maps::BinaryGridmap::FREE;
-            }
-        }
+    rasterize(src, sampling_resolution, gather, [&dst, &threshold](const std::size_t u, const std::size_t v, const T value) {
+        dst->at(u,v) = value >= threshold ?
+                    cslibs_gridmaps::static_maps::BinaryGridmap::OCCUPIED :
+                    cslibs_gridmaps::static_maps::BinaryGridmap::FREE;
     });
 }
 
@@ -0,0 +1,61 @@
+#ifndef CSLIBS_NDT_2D_CONVERSION_RASTERIZE_HPP
+#define CSLIBS_NDT_2D_CONVERSION_RASTERIZE_HPP
+
+#include <cslibs_ndt/map/map.hpp>
+
+namespace cslibs_ndt_2d {
+namespace conversion {
+/**
+ * @brief Evaluate every bundle of a map at its chunk_step x chunk_step raster points.
+ *        The Gaussians of a bundle are packed once and evaluated for all of its
+ *        points together.
+ * @param src                   the map
+ * @param sampling_resolution   the resolution of the raster
+ * @param gather                packs the layers of a bundle into a bundle_gaussians_t
+ * @param write                 receives the raster cell (u,v) and its value
+ */
+template <typename src_map_t, typename T, typename gather_t, typename write_t>
+inline void rasterize(const src_map_t &src,
+                      const T sampling_resolution,
+                      const gather_t &gather,
+                      const write_t &write)
+{
+    using index_t            = typename src_map_t::index_t;
+    using bundle_t           = typename src_map_t::distribution_bundle_t;
+    using bundle_gaussians_t = typename src_map_t::bundle_gaussians_t;
+
+    const T bundle_resolution = src.getBundleResolution();
+    const int chunk_step      = static_cast<int>(bundle_resolution / sampling_resolution);
+    const std::size_t n       = static_cast<std::size_t>(chunk_step * chunk_step);
+    const index_t min_bi      = src.getMinBundleIndex();
+
+    std::vector<T> coordinates(2 * n);
+    std::vector<T> values(n);
+    bundle_gaussians_t gaussians;
+    src.traverseOrdered([&](const index_t &bi, const bundle_t &b) {
+        gaussians.clear();
+        gather(b, gaussians);
+
+        for (int k = 0 ; k < chunk_step ; ++ k) {
+            for (int l = 0 ; l < chunk_step ; ++ l) {
+                const std::size_t j = static_cast<std::size_t>(k * chunk_step + l);
+                coordinates[j]     = static_cast<T>(bi[0]) * bundle_resolution + static_cast<T>(k) * sampling_resolution;
+                coordinates[n + j] = static_cast<T>(bi[1]) * bundle_resolution + static_cast<T>(l) * sampling_resolution;
+            }
+        }
+        std::fill(values.begin(), values.end(), T());
+        gaussians.evaluate(n, coordinates.data(), values.data());
+
+        for (int k = 0 ; k < chunk_step ; ++ k) {
+            for (int l = 0 ; l < chunk_step ; ++ l) {
+                const std::size_t u = (bi[0] - min_bi[0]) * chunk_step + k;
+                const std::size_t v = (bi[1] - min_bi[1]) * chunk_step + l;
+                write(u, v, values[static_cast<std::size_t>(k * chunk_step + l)]);
+            }
+        }
+    });
+}
+}
+}
+
+#endif // CSLIBS_NDT_2D_CONVERSION_RASTERIZE_HPP
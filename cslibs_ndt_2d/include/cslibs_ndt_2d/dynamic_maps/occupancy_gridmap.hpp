@@ -2,6 +2,9 @@
 #define CSLIBS_NDT_2D_DYNAMIC_MAPS_OCCUPANCY_GRIDMAP_HPP
 
 #include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/backend/sharded_unordered_map.hpp>
+#include <cslibs_ndt/backend/flat_hash_map.hpp>
+#include <cslibs_ndt/backend/tiled_map.hpp>
 
 namespace cslibs_ndt_2d {
 namespace dynamic_maps {
@@ -9,6 +12,18 @@ namespace dynamic_maps {
 template <typename T>
 using OccupancyGridmap = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,T>;
 
+/// allows several threads to insert at the same time
+template <typename T>
+using ConcurrentOccupancyGridmap = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,T,cslibs_ndt::backend::ShardedUnorderedMap>;
+
+/// open addressing storage keyed by Morton codes
+template <typename T>
+using FlatOccupancyGridmap = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,T,cslibs_ndt::backend::FlatHashMap,cslibs_ndt::backend::FlatHashMap>;
+
+/// storage growing in dense blocks of 16^Dim cells
+template <typename T>
+using TiledOccupancyGridmap = cslibs_ndt::map::Map<cslibs_ndt::map::tags::dynamic_map,2,cslibs_ndt::OccupancyDistribution,T,cslibs_ndt::backend::TiledMap>;
+
 }
 }
 
@@ -0,0 +1,15 @@
+#ifndef CSLIBS_NDT_2D_FROZEN_MAPS_OCCUPANCY_GRIDMAP_HPP
+#define CSLIBS_NDT_2D_FROZEN_MAPS_OCCUPANCY_GRIDMAP_HPP
+
+#include <cslibs_ndt/map/frozen_map.hpp>
+
+namespace cslibs_ndt_2d {
+namespace frozen_maps {
+
+template <typename T>
+using OccupancyGridmap = cslibs_ndt::map::FrozenMap<2,cslibs_ndt::OccupancyDistribution,T>;
+
+}
+}
+
+#endif // CSLIBS_NDT_2D_FROZEN_MAPS_OCCUPANCY_GRIDMAP_HPP
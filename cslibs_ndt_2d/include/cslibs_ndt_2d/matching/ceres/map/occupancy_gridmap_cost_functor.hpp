@@ -2,6 +2,7 @@
 #define CSLIBS_NDT_2D_MATCHING_CERES_OCCUPANCY_GRIDMAP_COST_FUNCTOR_HPP
 
 #include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/map/frozen_map.hpp>
 #include <cslibs_ndt/matching/ceres/map/scan_match_cost_functor.hpp>
 
 #include <ceres/cubic_interpolation.h>
@@ -65,7 +66,7 @@ protected:
                         const Eigen::Matrix<JetT,2,1> diff =
                                 p_prime - di->getMean().template cast<double>();
                         const Eigen::Matrix<double,2,2> inf =
-                                di->getInformationMatrix().template cast<double>();
+                                bi->getInformationMatrix().template cast<double>();
 
                         const auto& sample = ::ceres::exp((-0.5 * diff.transpose() * inf * diff).value());
                         *value -= static_cast<double>(ndt_t::div_count) * sample * occ;
@@ -147,6 +148,71 @@ private:
     const ::ceres::BiCubicInterpolator<ScanMatchCostFunctor<ndt_t,Flag::INTERPOLATION>> interpolator_;
 };
 
+template <typename _T>
+class ScanMatchCostFunctor<
+        cslibs_ndt::map::FrozenMap<2,cslibs_ndt::OccupancyDistribution,_T>,
+        Flag::DIRECT>
+{
+    using ndt_t = cslibs_ndt::map::FrozenMap<2,cslibs_ndt::OccupancyDistribution,_T>;
+
+    using ivm_t = typename ndt_t::inverse_sensor_model_t;
+    using point_t = typename ndt_t::point_t;
+    using bundle_t = typename ndt_t::bundle_t;
+
+protected:
+    explicit inline ScanMatchCostFunctor(const ndt_t& map,
+                                         const typename ivm_t::Ptr& ivm) :
+        map_(map),
+        ivm_(ivm),
+        resolution_inv_(1.0 / map_.getBundleResolution())
+    {
+        const auto& origin_inv = map_.getInitialOrigin().inverse();
+        rot_ = Eigen::Rotation2D<double>(static_cast<double>(origin_inv.yaw())).toRotationMatrix();
+        trans_ = Eigen::Matrix<double,2,1>(static_cast<double>(origin_inv.tx()),static_cast<double>(origin_inv.ty()));
+    }
+
+    template <int _D>
+    inline void Evaluate(const Eigen::Matrix<double,_D,1>& q, double* const value) const
+    {
+        *value = 1.0 - map_.sampleNonNormalized(point_t(q(0),q(1)), ivm_);
+    }
+
+    template <typename JetT, int _D>
+    inline void Evaluate(const Eigen::Matrix<JetT,_D,1>& q, JetT* const value) const
+    {
+        const Eigen::Matrix<JetT,2,1>& p = q.template topRows<2>();
+
+        const Eigen::Matrix<JetT,2,1>& p_prime = rot_ * p + trans_;
+        const std::array<int,2> bi{{static_cast<int>(std::floor(p_prime(0).a * resolution_inv_)),
+                                    static_cast<int>(std::floor(p_prime(1).a * resolution_inv_))}};
+
+        const bundle_t* bundle = map_.getBundle(bi);
+        *value = JetT(1.0);
+        if (bundle) {
+            for (const auto e : *bundle) {
+                if (e == ndt_t::no_entry || !map_.valid(e))
+                    continue;
+
+                const Eigen::Matrix<JetT,2,1> diff =
+                        p_prime - map_.getMean(e).template cast<double>();
+                const Eigen::Matrix<double,2,2> inf =
+                        map_.getInformationMatrix(e).template cast<double>();
+
+                const auto& sample = ::ceres::exp((-0.5 * diff.transpose() * inf * diff).value());
+                *value -= static_cast<double>(ndt_t::div_count) * sample * static_cast<double>(map_.getOccupancy(e, *ivm_));
+            }
+        }
+    }
+
+private:
+    const ndt_t& map_;
+    const typename ivm_t::Ptr& ivm_;
+
+    const double resolution_inv_;
+    Eigen::Matrix<double,2,2> rot_;
+    Eigen::Matrix<double,2,1> trans_;
+};
+
 }
 }
 }
@@ -0,0 +1,46 @@
+#ifndef CSLIBS_NDT_2D_GRADIENT_HPP
+#define CSLIBS_NDT_2D_GRADIENT_HPP
+
+#include <cslibs_ndt_2d/matching/jacobian.hpp>
+#include <cslibs_ndt_2d/matching/hessian.hpp>
+
+namespace cslibs_ndt_2d {
+namespace matching {
+/**
+ * @brief Add the gradient and Hessian of a single point-to-distribution term,
+ *        following the 3d kernel with the point Jacobian [I | (-r_y, r_x)] where
+ *        r = R p. Only the upper triangle of h is filled.
+ * @param p     the point before the transformation by the state
+ * @param q     the point relative to the distribution mean
+ * @param info  the information matrix of the distribution
+ * @param s     the score of the term
+ */
+template <typename gradient_t, typename hessian_t>
+inline void accumulateGradient(const Eigen::Vector2d &p,
+                               const Eigen::Vector2d &q,
+                               const Eigen::Matrix2d &info,
+                               const double s,
+                               const Jacobian &J,
+                               gradient_t &g,
+                               hessian_t &h)
+{
+    const Eigen::RowVector2d q_info = q.transpose() * info;
+    const Eigen::Vector2d    r = J.rotation() * p;
+    const Eigen::Vector2d    J_yaw(-r(1), r(0));
+    const Eigen::Vector2d    info_J = info * J_yaw;
+    const double             q_info_J = q_info.dot(J_yaw);
+
+    g.template head<2>() += s * q_info.transpose();
+    g(2)                 += s * q_info_J;
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = i; j < 2; ++j)
+            h(i, j) -= s * (info(j, i) + q_info(i) * q_info(j));
+        h(i, 2) -= s * (info.col(i).dot(J_yaw) + q_info(i) * q_info_J);
+    }
+    h(2, 2) -= s * (-q_info.dot(r) + J_yaw.dot(info_J) + q_info_J * q_info_J);
+}
+}
+}
+
+#endif // CSLIBS_NDT_2D_GRADIENT_HPP
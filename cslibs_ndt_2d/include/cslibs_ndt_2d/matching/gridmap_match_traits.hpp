@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cslibs_ndt/matching/match_traits.hpp>
+#include <cslibs_ndt/matching/parameter.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/static_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/matching/jacobian.hpp>
+#include <cslibs_ndt_2d/matching/hessian.hpp>
+#include <cslibs_ndt_2d/matching/gradient.hpp>
+
+namespace cslibs_ndt {
+namespace matching {
+
+template<typename MapT> struct Is2dGridmap : std::false_type {};
+template<> struct Is2dGridmap<cslibs_ndt_2d::dynamic_maps::Gridmap<double>> : std::true_type {};
+template<> struct Is2dGridmap<cslibs_ndt_2d::static_maps::Gridmap<double>> : std::true_type {};
+
+template<typename MapT>
+struct MatchTraits<MapT, typename std::enable_if<Is2dGridmap<MapT>::value>::type>
+{
+    static constexpr int LINEAR_DIMS  = 2;
+    static constexpr int ANGULAR_DIMS = 1;
+    using Jacobian              = cslibs_ndt_2d::matching::Jacobian;
+    using Hessian               = cslibs_ndt_2d::matching::Hessian;
+
+    using gradient_t            = Eigen::Matrix<double, 3, 1>;
+    using hessian_t             = Eigen::Matrix<double, 3, 3>;
+
+    using point_t               = cslibs_math_2d::Point2d;
+    using transform_t           = cslibs_math_2d::Transform2d;
+    using parameter_t           = cslibs_ndt::matching::Parameter;
+
+    static transform_t makeTransform(const Eigen::Vector2d& linear,
+                                     const Eigen::Matrix<double, 1, 1>& angular)
+    {
+        return transform_t{linear.x(), linear.y(), angular(0)};
+    }
+
+    static void computeGradient(const MapT& map,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian&,
+                                const parameter_t&,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        typename MapT::distribution_const_list_t bundle;
+        if (!map.getDistributions(point, bundle))
+            return;
+
+        /// evaluate all layers at once, only significant ones contribute to the gradient
+        typename MapT::bundle_gaussians_t gaussians;
+        std::array<const typename MapT::distribution_t*, MapT::bin_count> layers;
+        for (auto* distribution_wrapper : bundle)
+        {
+            if (!distribution_wrapper)
+                continue;
+
+            auto& d = distribution_wrapper->data();
+            if (d.getN() < 3)
+                continue;
+
+            layers[gaussians.size()] = distribution_wrapper;
+            gaussians.add(d.getMean(), distribution_wrapper->getInformationMatrix(), 1.0);
+        }
+
+        std::array<double, MapT::bin_count> s;
+        gaussians.evaluate(point.data().data(), s.data());
+        for (std::size_t k = 0 ; k < gaussians.size() ; ++k)
+        {
+            if (!std::isnormal(s[k]) || s[k] <= 1e-5)
+                continue;
+
+            const auto q = (point.data() - layers[k]->data().getMean()).eval();
+            cslibs_ndt_2d::matching::accumulateGradient(source.data(), q, layers[k]->getInformationMatrix(), s[k], J, g, h);
+            score += s[k];
+        }
+    }
+};
+
+}
+}
@@ -0,0 +1,46 @@
+#ifndef CSLIBS_NDT_2D_HESSIAN_HPP
+#define CSLIBS_NDT_2D_HESSIAN_HPP
+
+#include <eigen3/Eigen/Eigen>
+
+namespace cslibs_ndt_2d {
+namespace matching {
+/**
+ * @brief Second derivatives of a point moved by the state, see Jacobian. Only
+ *        the one with respect to yaw twice is not zero.
+ */
+class EIGEN_ALIGN16 Hessian {
+public:
+    using point_t  = Eigen::Vector2d;
+    using matrix_t = Eigen::Matrix2d;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    inline Hessian() :
+        rotation_(matrix_t::Identity())
+    {
+    }
+
+    enum Partial{tx = 0, ty = 1, yaw = 2};
+
+    inline const point_t get(const std::size_t pi,
+                             const std::size_t pj,
+                             const point_t &p) const
+    {
+        assert(pi < 3);
+        assert(pj < 3);
+        return (pi == yaw && pj == yaw) ? static_cast<point_t>(-(rotation_ * p)) : point_t::Zero();
+    }
+
+    inline static void get(const Eigen::Matrix<double, 1, 1> &angular,
+                           Hessian &h)
+    {
+        h.rotation_ = Eigen::Rotation2Dd(angular(0)).toRotationMatrix();
+    }
+
+private:
+    matrix_t rotation_;
+};
+}
+}
+#endif // CSLIBS_NDT_2D_HESSIAN_HPP
@@ -0,0 +1,55 @@
+#ifndef CSLIBS_NDT_2D_JACOBIAN_HPP
+#define CSLIBS_NDT_2D_JACOBIAN_HPP
+
+#include <eigen3/Eigen/Eigen>
+
+namespace cslibs_ndt_2d {
+namespace matching {
+/**
+ * @brief Derivatives of a point moved by the state, R(yaw) p + t, with respect
+ *        to x, y and yaw. They are taken at the point before the transformation,
+ *        the one with respect to yaw is the rotated point turned by 90 degrees.
+ */
+class EIGEN_ALIGN16 Jacobian {
+public:
+    using point_t  = Eigen::Vector2d;
+    using matrix_t = Eigen::Matrix2d;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    inline Jacobian() :
+        rotation_(matrix_t::Identity())
+    {
+    }
+
+    enum Partial{tx = 0, ty = 1, yaw = 2};
+
+    inline const point_t get(const std::size_t pi,
+                             const point_t &p) const
+    {
+        assert(pi < 3);
+        if (pi == tx)
+            return point_t(1.0, 0.0);
+        if (pi == ty)
+            return point_t(0.0, 1.0);
+        const point_t r = rotation_ * p;
+        return point_t(-r(1), r(0));
+    }
+
+    inline const matrix_t& rotation() const
+    {
+        return rotation_;
+    }
+
+    inline static void get(const Eigen::Matrix<double, 1, 1> &angular,
+                           Jacobian &j)
+    {
+        j.rotation_ = Eigen::Rotation2Dd(angular(0)).toRotationMatrix();
+    }
+
+private:
+    matrix_t rotation_;
+};
+}
+}
+#endif // CSLIBS_NDT_2D_JACOBIAN_HPP
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <cslibs_ndt_2d/matching/gridmap_match_traits.hpp>
+#include <cslibs_ndt_2d/matching/occupancy_gridmap_match_traits.hpp>
+#include <cslibs_ndt/matching/generic_match.hpp>
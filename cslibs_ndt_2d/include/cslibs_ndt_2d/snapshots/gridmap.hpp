@@ -0,0 +1,15 @@
+#ifndef CSLIBS_NDT_2D_SNAPSHOTS_GRIDMAP_HPP
+#define CSLIBS_NDT_2D_SNAPSHOTS_GRIDMAP_HPP
+
+#include <cslibs_ndt/map/snapshot.hpp>
+
+namespace cslibs_ndt_2d {
+namespace snapshots {
+
+template <typename T>
+using Gridmap = cslibs_ndt::map::Snapshot<2,cslibs_ndt::Distribution,T>;
+
+}
+}
+
+#endif // CSLIBS_NDT_2D_SNAPSHOTS_GRIDMAP_HPP
@@ -0,0 +1,15 @@
+#ifndef CSLIBS_NDT_2D_SNAPSHOTS_OCCUPANCY_GRIDMAP_HPP
+#define CSLIBS_NDT_2D_SNAPSHOTS_OCCUPANCY_GRIDMAP_HPP
+
+#include <cslibs_ndt/map/snapshot.hpp>
+
+namespace cslibs_ndt_2d {
+namespace snapshots {
+
+template <typename T>
+using OccupancyGridmap = cslibs_ndt::map::Snapshot<2,cslibs_ndt::OccupancyDistribution,T>;
+
+}
+}
+
+#endif // CSLIBS_NDT_2D_SNAPSHOTS_OCCUPANCY_GRIDMAP_HPP
@@ -170,7 +170,7 @@ public:
             return;
 
         distribution_t *distribution = getAllocate(i);
-        distribution->data().add(p);
+        distribution->add(p);
     }
 
     inline T sample(const point_t &p) const
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/matching/match.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+using point_t     = cslibs_math_2d::Point2d;
+using transform_t = cslibs_math_2d::Transform2d;
+using points_t    = std::vector<point_t>;
+using gradient_t  = Eigen::Matrix<double, 3, 1>;
+using hessian_t   = Eigen::Matrix<double, 3, 3>;
+
+/// the term evaluated partial by partial
+void accumulateReference(const Eigen::Vector2d &p,
+                         const Eigen::Vector2d &q,
+                         const Eigen::Matrix2d &info,
+                         const double s,
+                         const cslibs_ndt_2d::matching::Jacobian &J,
+                         const cslibs_ndt_2d::matching::Hessian &H,
+                         gradient_t &g,
+                         hessian_t &h)
+{
+    const auto q_info = (q.transpose() * info).eval();
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        const auto J_ip = J.get(i, p);
+        g(i) += s * q_info * J_ip;
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+            const auto J_jp = J.get(j, p);
+            h(i, j) -= s * (q_info * H.get(i, j, p) +
+                            J_jp.transpose() * info * J_ip +
+                            (q_info * J_ip).value() * (q_info * J_jp)).value();
+        }
+    }
+}
+
+/// the score of a single term with the source point p moved by the state
+double score(const Eigen::Vector2d &p,
+             const Eigen::Vector2d &mean,
+             const Eigen::Matrix2d &info,
+             const gradient_t &state)
+{
+    const Eigen::Vector2d q = (transform_t(state(0), state(1), state(2)) * point_t(p)).data() - mean;
+    return std::exp(-0.5 * q.dot(info * q));
+}
+
+TEST(Test_cslibs_ndt_2d, testGradientKernel)
+{
+    cslibs_math::random::Uniform<double,1> u(-1.0, 1.0);
+    for (std::size_t t = 0; t < 100; ++t)
+    {
+        /// a state with a translation far from zero, the distribution sits close to the moved point
+        const gradient_t state(2.0 * u.get(), 2.0 * u.get(), u.get());
+        const Eigen::Matrix<double, 1, 1> angular(state(2));
+        cslibs_ndt_2d::matching::Jacobian J;
+        cslibs_ndt_2d::matching::Jacobian::get(angular, J);
+        cslibs_ndt_2d::matching::Hessian H;
+        cslibs_ndt_2d::matching::Hessian::get(angular, H);
+
+        const Eigen::Vector2d p(5.0 * u.get(), 5.0 * u.get());
+        const Eigen::Vector2d p_moved = (transform_t(state(0), state(1), state(2)) * point_t(p)).data();
+        const Eigen::Vector2d mean(p_moved(0) + 0.5 * u.get(), p_moved(1) + 0.5 * u.get());
+        Eigen::Matrix2d A;
+        for (int i = 0; i < 4; ++i)
+            A(i) = u.get();
+        const Eigen::Matrix2d info = (A * A.transpose() + 0.1 * Eigen::Matrix2d::Identity()).inverse();
+        const double s = score(p, mean, info, state);
+
+        gradient_t g = gradient_t::Zero(), g_reference = gradient_t::Zero();
+        hessian_t  h = hessian_t::Zero(),  h_reference = hessian_t::Zero();
+        cslibs_ndt_2d::matching::accumulateGradient(p, p_moved - mean, info, s, J, g, h);
+        accumulateReference(p, p_moved - mean, info, s, J, H, g_reference, h_reference);
+
+        EXPECT_EQ(0.0, h(1, 0));
+        EXPECT_EQ(0.0, h(2, 0));
+        EXPECT_EQ(0.0, h(2, 1));
+        h.triangularView<Eigen::StrictlyLower>() = h.transpose();
+        EXPECT_TRUE(g.isApprox(g_reference, 1e-12));
+        EXPECT_TRUE(h.isApprox(h_reference, 1e-12));
+
+        /// g is the negative derivative of the score in the three parameters of the state
+        const double eps = 1e-6;
+        for (int i = 0; i < 3; ++i) {
+            const gradient_t delta = eps * gradient_t::Unit(i);
+            const double d = (score(p, mean, info, state + delta) -
+                              score(p, mean, info, state - delta)) / (2.0 * eps);
+            EXPECT_NEAR(-d, g(i), 1e-6);
+        }
+    }
+}
+
+template <typename map_t>
+void testMatch(const map_t &map)
+{
+    const transform_t truth(0.1, -0.06, 0.02);
+    const points_t scan = transformed(generateRoom(4000), truth.inverse());
+
+    cslibs_ndt::matching::Parameter param;
+    param.maxIterations() = 100;
+    const auto result = cslibs_ndt::matching::match(scan.begin(), scan.end(), map, param, transform_t());
+
+    /// every step moves towards the true pose
+    EXPECT_TRUE(std::isfinite(result.score()));
+    EXPECT_GT(result.iterations(), 0ul);
+    EXPECT_GT(result.transform().tx(), 0.0);
+    EXPECT_LT(result.transform().tx(), truth.tx());
+    EXPECT_LT(result.transform().ty(), 0.0);
+    EXPECT_GT(result.transform().ty(), truth.ty());
+    EXPECT_GT(result.transform().yaw(), 0.0);
+    EXPECT_LT(result.transform().yaw(), truth.yaw());
+
+    /// the line search does not stop short of the true pose
+    param.lineSearch() = true;
+    const auto searched = cslibs_ndt::matching::match(scan.begin(), scan.end(), map, param, transform_t());
+    EXPECT_EQ(cslibs_ndt::matching::Termination::DELTA_EPSILON, searched.termination());
+    EXPECT_GT(searched.score(), result.score());
+    EXPECT_LT(searched.iterations(), result.iterations());
+    EXPECT_NEAR(truth.tx(),  searched.transform().tx(),  1e-2);
+    EXPECT_NEAR(truth.ty(),  searched.transform().ty(),  1e-2);
+    EXPECT_NEAR(truth.yaw(), searched.transform().yaw(), 2.5e-3);
+}
+
+TEST(Test_cslibs_ndt_2d, testMatchGridmap)
+{
+    const points_t room = generateRoom(40000);
+
+    cslibs_ndt_2d::dynamic_maps::Gridmap<double> dynamic_map(transform_t(), 1.0);
+    dynamic_map.insert(room.begin(), room.end());
+    testMatch(dynamic_map);
+
+    cslibs_ndt_2d::static_maps::Gridmap<double> static_map(transform_t(), 1.0, {{48, 48}}, {{-24, -24}});
+    static_map.insert(room.begin(), room.end());
+    testMatch(static_map);
+}
+
+TEST(Test_cslibs_ndt_2d, testMatchOccupancyGridmap)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+
+    map_t map(transform_t(), 1.0);
+    const points_t room = generateRoom(40000);
+    for (const point_t &p : room)
+        map.insert(point_t(), p);
+
+    const cslibs_ndt::matching::OccupancyParameter::InverseModel ivm(0.5, 0.45, 0.65);
+    const cslibs_ndt::matching::OccupancyParameter param(cslibs_ndt::matching::Parameter(), ivm);
+    const transform_t truth(0.1, -0.05, 0.02);
+    const points_t scan = transformed(generateRoom(4000), truth.inverse());
+    const auto result = cslibs_ndt::matching::match(scan.begin(), scan.end(), map, param, transform_t());
+
+    EXPECT_TRUE(std::isfinite(result.score()));
+    EXPECT_GT(result.score(), 0.0);
+}
+
+/// the occupancy of a bundle is the mean over its 4 layers, layers which are not allocated count at the prior
+TEST(Test_cslibs_ndt_2d, testOccupancyThreshold)
+{
+    using map_t    = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+    using traits_t = cslibs_ndt::matching::MatchTraits<map_t>;
+
+    map_t map(transform_t(), 1.0);
+    const points_t room = generateRoom(4000);
+    for (const point_t &p : room)
+        map.insert(point_t(), p);
+
+    const cslibs_ndt::matching::OccupancyParameter::InverseModel ivm(0.5, 0.45, 0.65);
+    cslibs_ndt::matching::OccupancyParameter param(cslibs_ndt::matching::Parameter(), ivm);
+
+    const traits_t::Jacobian J;
+    const traits_t::Hessian  H;
+    /// the bundles behind the walls are only partially allocated
+    cslibs_math::random::Uniform<double,1> u(-11.0, 11.0);
+    std::size_t partial = 0;
+    for (std::size_t i = 0 ; i < 20000 ; ++i) {
+        const point_t p(u.get(), u.get());
+        map_t::distribution_const_list_t distributions;
+        if (!map.getDistributions(p, distributions))
+            continue;
+
+        double occupancy = 0.0;
+        bool missing = false;
+        for (const auto *d : distributions) {
+            occupancy += d ? d->computeOccupancy(ivm) : 0.5;
+            missing |= d == nullptr;
+        }
+        occupancy /= static_cast<double>(distributions.size());
+
+        gradient_t g = gradient_t::Zero();
+        hessian_t  h = hessian_t::Zero();
+        double expected = 0.0;
+        param.occupancyThreshold() = 0.0;
+        traits_t::computeGradient(map, p, p, J, H, param, expected, g, h);
+        if (expected <= 0.0)
+            continue;
+        partial += missing;
+
+        for (const double threshold : {occupancy - 1e-9, occupancy + 1e-9}) {
+            param.occupancyThreshold() = threshold;
+            double s = 0.0;
+            traits_t::computeGradient(map, p, p, J, H, param, s, g, h);
+            EXPECT_EQ(threshold < occupancy ? expected : 0.0, s);
+        }
+    }
+    EXPECT_GT(partial, 0ul);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
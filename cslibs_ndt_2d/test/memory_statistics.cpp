@@ -0,0 +1,99 @@
+#include <cslibs_ndt_2d/static_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/static_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/weighted_occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <iostream>
+#include <string>
+
+using pose_t   = cslibs_ndt_2d::dynamic_maps::Gridmap<double>::pose_t;
+using point_t  = cslibs_ndt_2d::dynamic_maps::Gridmap<double>::point_t;
+using points_t = std::vector<point_t>;
+using scans_t  = std::vector<std::pair<pose_t, points_t>>;
+
+/// scans of a 40m x 40m room taken from several poses, in scanner coordinates
+inline scans_t generateScans(const std::size_t scans, const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(-20.0, 20.0);
+    cslibs_math::random::Uniform<double,1> s(0.0, 4.0);
+    scans_t result(scans);
+    for (auto &scan : result) {
+        scan.first = pose_t(0.5 * u.get(), 0.5 * u.get(), 0.0);
+        const pose_t inverse = scan.first.inverse();
+        for (std::size_t i = 0 ; i < count ; ++i) {
+            const double side = s.get();
+            const double t    = u.get();
+            const point_t p = side < 1.0 ? point_t(-20.0, t) :
+                              side < 2.0 ? point_t( 20.0, t) :
+                              side < 3.0 ? point_t(t, -20.0) :
+                                           point_t(t,  20.0);
+            scan.second.emplace_back(inverse * p);
+        }
+    }
+    return result;
+}
+
+template <typename map_t>
+inline void report(const std::string &name,
+                   map_t &map,
+                   const scans_t &scans)
+{
+    for (const auto &scan : scans)
+        map.insert(scan.second.begin(), scan.second.end(), scan.first);
+    map.allocatePartiallyAllocatedBundles();
+
+    std::cout << "== " << name << " | getByteSize: " << map.getByteSize() << "\n"
+              << map.getMemoryStatistics() << "\n";
+}
+
+/// prints the memory statistics of the 2d map types after mapping the same room
+int main(int argc, char *argv[])
+{
+    const std::size_t scans      = argc > 1 ? std::stoul(argv[1]) : 20ul;
+    const std::size_t scan_size  = argc > 2 ? std::stoul(argv[2]) : 5000ul;
+    const double      resolution = argc > 3 ? std::stod(argv[3]) : 0.5;
+
+    const scans_t data = generateScans(scans, scan_size);
+
+    /// static maps cover the room
+    const std::size_t cells = static_cast<std::size_t>(std::ceil(44.0 / resolution));
+    const std::array<std::size_t,2> size = {{cells, cells}};
+    const std::array<int,2> min_bundle_index = {{-static_cast<int>(cells), -static_cast<int>(cells)}};
+
+    {
+        cslibs_ndt_2d::static_maps::Gridmap<double> map(pose_t(), resolution, size, min_bundle_index);
+        report("static Gridmap", map, data);
+    }
+    {
+        cslibs_ndt_2d::static_maps::OccupancyGridmap<double> map(pose_t(), resolution, size, min_bundle_index);
+        report("static OccupancyGridmap", map, data);
+    }
+    {
+        cslibs_ndt_2d::dynamic_maps::Gridmap<double> map(pose_t(), resolution);
+        report("dynamic Gridmap", map, data);
+    }
+    {
+        cslibs_ndt_2d::dynamic_maps::FlatGridmap<double> map(pose_t(), resolution);
+        report("dynamic FlatGridmap", map, data);
+    }
+    {
+        cslibs_ndt_2d::dynamic_maps::TiledGridmap<double> map(pose_t(), resolution);
+        report("dynamic TiledGridmap", map, data);
+    }
+    {
+        cslibs_ndt_2d::dynamic_maps::ConcurrentGridmap<double> map(pose_t(), resolution);
+        report("dynamic ConcurrentGridmap", map, data);
+    }
+    {
+        cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double> map(pose_t(), resolution);
+        report("dynamic OccupancyGridmap", map, data);
+    }
+    {
+        cslibs_ndt_2d::dynamic_maps::WeightedOccupancyGridmap<double> map(pose_t(), resolution);
+        report("dynamic WeightedOccupancyGridmap", map, data);
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cslibs_math_2d/linear/transform.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <vector>
+
+/// a 20m x 20m room with two pillars, surfaces sampled with gaussian noise
+inline std::vector<cslibs_math_2d::Point2d> generateRoom(const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(0.0, 1.0);
+    cslibs_math::random::Normal<double,1>  n(0.0, 0.02);
+
+    std::vector<cslibs_math_2d::Point2d> points;
+    for (std::size_t i = 0 ; i < count ; ++i) {
+        const double a = u.get() * 20.0 - 10.0;
+        switch (i % 5) {
+        case 0: points.emplace_back(a, -10.0 + n.get()); break;
+        case 1: points.emplace_back(a,  10.0 + n.get()); break;
+        case 2: points.emplace_back(-10.0 + n.get(), a); break;
+        case 3: points.emplace_back( 10.0 + n.get(), a); break;
+        default: {
+            const double phi = u.get() * 2.0 * M_PI;
+            const double x   = (i % 10 < 5) ? -4.0 : 3.0;
+            points.emplace_back(x + 0.5 * std::cos(phi) + n.get(), 2.0 + 0.5 * std::sin(phi) + n.get());
+        }
+        }
+    }
+    return points;
+}
+
+inline std::vector<cslibs_math_2d::Point2d> transformed(const std::vector<cslibs_math_2d::Point2d> &points,
+                                                        const cslibs_math_2d::Transform2d &t)
+{
+    std::vector<cslibs_math_2d::Point2d> result;
+    for (const cslibs_math_2d::Point2d &p : points)
+        result.emplace_back(t * p);
+    return result;
+}
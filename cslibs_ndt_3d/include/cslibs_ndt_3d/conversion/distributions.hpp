@@ -10,7 +10,7 @@ namespace cslibs_ndt_3d {
 namespace conversion {
 template <template <typename, std::size_t, std::size_t> typename distribution_t, typename T>
 inline Distribution from(const distribution_t<T, 3, 3> &d,
-                         const int &id,
+                         const std::uint64_t &id,
                          const T &prob)
 {
     Distribution distr;
@@ -27,108 +27,164 @@ inline Distribution from(const distribution_t<T, 3, 3> &d,
     return distr;
 }
 
+/**
+ * @brief Convert a map into a distribution array. By default there is one entry per
+ *        bundle, holding the sum of its 8 layers, the map is expanded beforehand.
+ * @param per_layer     emit every layer distribution once instead, the map is left
+ *                      untouched and the ids are the distribution ids
+ */
 template <typename T>
 inline void from(
         const typename cslibs_ndt_3d::dynamic_maps::Gridmap<T>::Ptr &src,
-        cslibs_ndt_3d::DistributionArray::Ptr &dst)
+        cslibs_ndt_3d::DistributionArray::Ptr &dst,
+        const bool per_layer = false)
 {
     if (!src)
         return;
-    src->allocatePartiallyAllocatedBundles();
 
     using src_map_t = cslibs_ndt_3d::dynamic_maps::Gridmap<T>;
     using dst_map_t = cslibs_ndt_3d::DistributionArray;
     dst.reset(new dst_map_t());
 
-    using point_t               = typename src_map_t::point_t;
-    using distribution_t        = typename src_map_t::distribution_t;
-    using distribution_bundle_t = typename src_map_t::distribution_bundle_t;
+    using index_t                   = typename src_map_t::index_t;
+    using point_t                   = typename src_map_t::point_t;
+    using distribution_t            = typename src_map_t::distribution_t;
+    using distribution_bundle_t     = typename src_map_t::distribution_bundle_t;
+    using distribution_const_list_t = typename src_map_t::distribution_const_list_t;
+
+    if (per_layer) {
+        const typename src_map_t::pose_t w_T_m = src->getInitialOrigin();
+        auto sample = [&src, &w_T_m](const point_t &p) -> T {
+            distribution_const_list_t distributions;
+            if (!src->getDistributions(w_T_m * p, distributions))
+                return 0.0;
+            T s = 0.0;
+            for (const distribution_t *d : distributions)
+                s += d ? d->data().sampleNonNormalized(p) : 0.0;
+            return src_map_t::div_count * s;
+        };
+
+        /// every distribution is converted once, not once per bundle it belongs to
+        auto process_distribution = [&dst, &sample](const std::size_t layer, const index_t &index, const distribution_t &d) {
+            if (!d.data().valid())
+                return;
+
+            dst->data.emplace_back(from(d.data(), src_map_t::getDistributionId(layer, index), sample(point_t(d.data().getMean()))));
+        };
+        src->traverseDistributions(process_distribution);
+        return;
+    }
+
+    src->allocatePartiallyAllocatedBundles();
+
     auto sample = [](const distribution_t *d,
                      const point_t &p) -> T {
         return d ? d->data().sampleNonNormalized(p) : 0.0;
     };
     auto sample_bundle = [&sample](const distribution_bundle_t &b,
                                    const point_t &p) -> T {
-        return 0.125 * (sample(b.at(0), p) +
-                        sample(b.at(1), p) +
-                        sample(b.at(2), p) +
-                        sample(b.at(3), p) +
-                        sample(b.at(4), p) +
-                        sample(b.at(5), p) +
-                        sample(b.at(6), p) +
-                        sample(b.at(7), p));
+        T s = 0.0;
+        for (std::size_t i = 0 ; i < src_map_t::bin_count ; ++i)
+            s += sample(b.at(i), p);
+        return src_map_t::div_count * s;
     };
 
-    using index_t = std::array<int, 3>;
     auto process_bundle = [&dst, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
         typename distribution_t::distribution_t d;
-        for (std::size_t i = 0; i < 8; ++ i)
-            d += b.at(i)->data();
+        for (std::size_t i = 0 ; i < src_map_t::bin_count ; ++i)
+            if (b.at(i))
+                d += b.at(i)->data();
         if (d.getN() == 0)
             return;
 
-        dst->data.emplace_back(from(d, b.id(), sample_bundle(b, point_t(d.getMean()))));
+        dst->data.emplace_back(from(d, src_map_t::getBundleId(bi), sample_bundle(b, point_t(d.getMean()))));
     };
-
-    src->traverse(process_bundle);
+    src->traverseOrdered(process_bundle);
 }
 
+/**
+ * @brief Convert an occupancy map into a distribution array. By default there is one
+ *        entry per bundle whose mean occupancy reaches the threshold, holding the sum
+ *        of its 8 layers, the map is expanded beforehand.
+ * @param per_layer     emit every layer distribution reaching the threshold once
+ *                      instead, the map is left untouched and the ids are the
+ *                      distribution ids
+ */
 template <typename T>
 inline void from(
         const typename cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<T>::Ptr &src,
         cslibs_ndt_3d::DistributionArray::Ptr &dst,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &ivm,
-        const T &threshold = 0.169)
+        const T &threshold = 0.169,
+        const bool per_layer = false)
 {
     if (!src)
         return;
-    src->allocatePartiallyAllocatedBundles();
 
     using src_map_t = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<T>;
     using dst_map_t = cslibs_ndt_3d::DistributionArray;
     dst.reset(new dst_map_t());
 
-    using point_t               = typename src_map_t::point_t;
-    using distribution_t        = typename src_map_t::distribution_t;
-    using distribution_bundle_t = typename src_map_t::distribution_bundle_t;
+    using index_t                   = typename src_map_t::index_t;
+    using point_t                   = typename src_map_t::point_t;
+    using distribution_t            = typename src_map_t::distribution_t;
+    using distribution_bundle_t     = typename src_map_t::distribution_bundle_t;
+    using distribution_const_list_t = typename src_map_t::distribution_const_list_t;
+
+    if (per_layer) {
+        const typename src_map_t::pose_t w_T_m = src->getInitialOrigin();
+        auto sample = [&src, &ivm, &w_T_m](const point_t &p) -> T {
+            distribution_const_list_t distributions;
+            if (!src->getDistributions(w_T_m * p, distributions))
+                return 0.0;
+            T s = 0.0;
+            for (const distribution_t *d : distributions)
+                s += d && d->getDistribution() ? d->getDistribution()->sampleNonNormalized(p) * d->getOccupancy(ivm) : 0.0;
+            return src_map_t::div_count * s;
+        };
+
+        /// every distribution is converted once, not once per bundle it belongs to
+        auto process_distribution = [&dst, &ivm, &threshold, &sample](const std::size_t layer, const index_t &index, const distribution_t &d) {
+            const auto &handle = d.getDistribution();
+            if (!handle || !handle->valid() || d.getOccupancy(ivm) < threshold)
+                return;
+
+            dst->data.emplace_back(from(*handle, src_map_t::getDistributionId(layer, index), sample(point_t(handle->getMean()))));
+        };
+        src->traverseDistributions(process_distribution);
+        return;
+    }
+
+    src->allocatePartiallyAllocatedBundles();
+
     auto sample = [&ivm](const distribution_t *d,
                          const point_t &p) -> T {
-        auto evaluate = [&ivm, d, p] {
-            const auto &handle = d;
-            return d && handle->getDistribution() ?
-                        handle->getDistribution()->sampleNonNormalized(p) * handle->getOccupancy(ivm) : 0.0;
-        };
-        return d ? evaluate() : 0.0;
+        return d && d->getDistribution() ?
+                    d->getDistribution()->sampleNonNormalized(p) * d->getOccupancy(ivm) : 0.0;
     };
     auto sample_bundle = [&sample](const distribution_bundle_t &b,
                                    const point_t &p) -> T {
-        return 0.125 * (sample(b.at(0), p) +
-                        sample(b.at(1), p) +
-                        sample(b.at(2), p) +
-                        sample(b.at(3), p) +
-                        sample(b.at(4), p) +
-                        sample(b.at(5), p) +
-                        sample(b.at(6), p) +
-                        sample(b.at(7), p));
-    };    
-
-    using index_t = std::array<int, 3>;
+        T s = 0.0;
+        for (std::size_t i = 0 ; i < src_map_t::bin_count ; ++i)
+            s += sample(b.at(i), p);
+        return src_map_t::div_count * s;
+    };
+
     auto process_bundle = [&dst, &ivm, &threshold, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
         typename distribution_t::distribution_t d;
         T occupancy = 0.0;
-
-        for (std::size_t i = 0 ; i < 8 ; ++i) {
+        for (std::size_t i = 0 ; i < src_map_t::bin_count ; ++i) {
             const auto &handle = b.at(i);
-            occupancy += 0.125 * handle->getOccupancy(ivm);
-            if (const auto &d_tmp = handle->getDistribution())
-                d += *d_tmp;
+            occupancy += src_map_t::div_count * (handle ? handle->getOccupancy(ivm) : cslibs_math::common::LogOdds<T>::from(0.0));
+            if (handle && handle->getDistribution())
+                d += *handle->getDistribution();
         }
         if (d.getN() == 0 || occupancy < threshold)
             return;
 
-        dst->data.emplace_back(from(d, b.id(), sample_bundle(b, point_t(d.getMean()))));
+        dst->data.emplace_back(from(d, src_map_t::getBundleId(bi), sample_bundle(b, point_t(d.getMean()))));
     };
-    src->traverse(process_bundle);
+    src->traverseOrdered(process_bundle);
 }
 }
 }
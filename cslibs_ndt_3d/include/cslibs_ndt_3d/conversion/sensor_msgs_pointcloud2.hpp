@@ -90,7 +90,7 @@ inline void from(
         tmp.emplace_back(static_cast<float>(p(2)));
         tmp.emplace_back(static_cast<float>(sample_bundle(b, mean)));
     };
-    src.traverse(process_bundle);
+    src.traverseOrdered(process_bundle);
     from(tmp, dst);
 }
 
@@ -171,7 +171,7 @@ inline void from(
         tmp.emplace_back(static_cast<float>(p(2)));
         tmp.emplace_back(static_cast<float>(sample_bundle(b, mean)));
     };
-    src.traverse(process_bundle);
+    src.traverseOrdered(process_bundle);
     from(tmp, dst);
 }
 
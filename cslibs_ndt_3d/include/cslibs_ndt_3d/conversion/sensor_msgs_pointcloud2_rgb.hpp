@@ -77,7 +77,7 @@ inline void rgbFrom(
             }
         }
     };
-    src.traverse(process_bundle);
+    src.traverseOrdered(process_bundle);
 
     const T min_z = cloud->min().getPoint()(2);
     const T max_z = cloud->max().getPoint()(2);
@@ -160,7 +160,7 @@ inline void rgbFrom(
             }
         }
     };
-    src.traverse(process_bundle);
+    src.traverseOrdered(process_bundle);
 
     const T min_z = cloud->min().getPoint()(2);
     const T max_z = cloud->max().getPoint()(2);
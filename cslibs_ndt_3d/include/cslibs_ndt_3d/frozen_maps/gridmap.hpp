@@ -0,0 +1,15 @@
+#ifndef CSLIBS_NDT_3D_FROZEN_MAPS_GRIDMAP_HPP
+#define CSLIBS_NDT_3D_FROZEN_MAPS_GRIDMAP_HPP
+
+#include <cslibs_ndt/map/frozen_map.hpp>
+
+namespace cslibs_ndt_3d {
+namespace frozen_maps {
+
+template <typename T>
+using Gridmap = cslibs_ndt::map::FrozenMap<3,cslibs_ndt::Distribution,T>;
+
+}
+}
+
+#endif // CSLIBS_NDT_3D_FROZEN_MAPS_GRIDMAP_HPP
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cslibs_ndt/matching/match_traits.hpp>
+#include <cslibs_ndt/matching/parameter.hpp>
+#include <cslibs_ndt/matching/occupancy_parameter.hpp>
+#include <cslibs_ndt_3d/frozen_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/frozen_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_3d/matching/jacobian.hpp>
+#include <cslibs_ndt_3d/matching/hessian.hpp>
+#include <cslibs_ndt_3d/matching/gradient.hpp>
+
+namespace cslibs_ndt {
+namespace matching {
+
+template<>
+struct MatchTraits<cslibs_ndt_3d::frozen_maps::Gridmap<double>>
+{
+    static constexpr int LINEAR_DIMS  = 3;
+    static constexpr int ANGULAR_DIMS = 3;
+    using Jacobian              = cslibs_ndt_3d::matching::Jacobian;
+    using Hessian               = cslibs_ndt_3d::matching::Hessian;
+
+    using gradient_t            = Eigen::Matrix<double, 6, 1>;
+    using hessian_t             = Eigen::Matrix<double, 6, 6>;
+
+    using map_t                 = cslibs_ndt_3d::frozen_maps::Gridmap<double>;
+    using point_t               = cslibs_math_3d::Point3d;
+    using transform_t           = cslibs_math_3d::Transform3d;
+    using parameter_t           = cslibs_ndt::matching::Parameter;
+
+    static transform_t makeTransform(const Eigen::Vector3d& linear,
+                                     const Eigen::Vector3d& angular)
+    {
+        return transform_t{
+            linear.x(), linear.y(), linear.z(),
+                    angular.x(), angular.y(), angular.z()};
+    }
+
+    static void computeGradient(const map_t& map,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        computeGradient(map, map.getBundle(point), point, source, J, H, param, score, g, h);
+    }
+
+    static void computeGradient(const map_t& map,
+                                const map_t::bundle_t* bundle,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t&,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        if (!bundle)
+            return;
+
+        for (const map_t::entry_t e : *bundle)
+        {
+            if (e == map_t::no_entry || map.getSampleCount(e) < 4)
+                continue;
+
+            const auto& info    = map.getInformationMatrix(e);
+            const auto q        = (point.data() - map.getMean(e)).eval();
+            const auto q_info   = (q.transpose() * info).eval();
+            const auto exponent = -0.5 * double(q_info * q);
+            const auto s        = std::exp(exponent);
+            if (!std::isnormal(s) || s <= 1e-5)
+                continue;
+
+            cslibs_ndt_3d::matching::accumulateGradient(source.data(), q, info, s, J, H, g, h);
+            score += s;
+        }
+    }
+};
+
+template<>
+struct MatchTraits<cslibs_ndt_3d::frozen_maps::OccupancyGridmap<double>>
+{
+    static constexpr int LINEAR_DIMS  = 3;
+    static constexpr int ANGULAR_DIMS = 3;
+    using Jacobian              = cslibs_ndt_3d::matching::Jacobian;
+    using Hessian               = cslibs_ndt_3d::matching::Hessian;
+
+    using gradient_t            = Eigen::Matrix<double, 6, 1>;
+    using hessian_t             = Eigen::Matrix<double, 6, 6>;
+
+    using map_t                 = cslibs_ndt_3d::frozen_maps::OccupancyGridmap<double>;
+    using point_t               = cslibs_math_3d::Point3d;
+    using transform_t           = cslibs_math_3d::Transform3d;
+    using parameter_t           = cslibs_ndt::matching::OccupancyParameter;
+
+    static transform_t makeTransform(const Eigen::Vector3d& linear,
+                                     const Eigen::Vector3d& angular)
+    {
+        return transform_t{
+                linear.x(), linear.y(), linear.z(),
+                angular.x(), angular.y(), angular.z()};
+    }
+
+    static void computeGradient(const map_t& map,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        computeGradient(map, map.getBundle(point), point, source, J, H, param, score, g, h);
+    }
+
+    static void computeGradient(const map_t& map,
+                                const map_t::bundle_t* bundle,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        static constexpr double d1 = 0.95;
+        static constexpr double d2 = 1 - d1;
+
+        if (!bundle)
+            return;
+
+        // check occupancy value
+        if (param.occupancyThreshold() > 0.0)
+        {
+            double occupancy = 0.0;
+            /// layers which are not allocated count at the prior
+            for (const map_t::entry_t e : *bundle)
+                occupancy += e != map_t::no_entry ?
+                            map.getOccupancy(e, param.inverseModel()) :
+                            cslibs_math::common::LogOdds<double>::from(0.0);
+            occupancy /= 8.0;
+
+            if (occupancy < param.occupancyThreshold())
+                return;
+        }
+
+        for (const map_t::entry_t e : *bundle)
+        {
+            if (e == map_t::no_entry || !map.valid(e) || map.getSampleCount(e) < 4)
+                continue;
+
+            const auto& info    = map.getInformationMatrix(e);
+            const auto q        = (point.data() - map.getMean(e)).eval();
+            const auto q_info   = (q.transpose() * info).eval();
+            const auto p_occ    = map.getOccupancy(e, param.inverseModel());
+            const auto exponent = -0.5 * double(q_info * q) * (d2 * (1 - p_occ));
+            const auto s        = d1 * p_occ * std::exp(exponent);
+            if (!std::isnormal(s) || s <= 1e-5)
+                continue;
+
+            cslibs_ndt_3d::matching::accumulateGradient(source.data(), q, info, s, J, H, g, h);
+            score += s;
+        }
+    }
+};
+
+}
+}
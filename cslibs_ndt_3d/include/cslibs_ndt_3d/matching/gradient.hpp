@@ -0,0 +1,65 @@
+#ifndef CSLIBS_NDT_3D_GRADIENT_HPP
+#define CSLIBS_NDT_3D_GRADIENT_HPP
+
+#include <cslibs_ndt_3d/matching/jacobian.hpp>
+#include <cslibs_ndt_3d/matching/hessian.hpp>
+
+namespace cslibs_ndt_3d {
+namespace matching {
+/**
+ * @brief Add the gradient and Hessian of a single point-to-distribution term.
+ *        The point Jacobian is [I | A_k p], the second derivatives vanish unless
+ *        both parameters are angular (see Magnusson, 2009), so only the angular
+ *        columns and the angular block are computed. Only the upper triangle of
+ *        h is filled, the lower one is left untouched.
+ * @param p     the point before the transformation by the state, the angular
+ *              partials dR/dθ·p are taken at it
+ * @param q     the point relative to the distribution mean
+ * @param info  the information matrix of the distribution
+ * @param s     the score of the term
+ */
+template <typename gradient_t, typename hessian_t>
+inline void accumulateGradient(const Eigen::Vector3d &p,
+                               const Eigen::Vector3d &q,
+                               const Eigen::Matrix3d &info,
+                               const double s,
+                               const Jacobian &J,
+                               const Hessian &H,
+                               gradient_t &g,
+                               hessian_t &h)
+{
+    const Eigen::RowVector3d q_info = q.transpose() * info;
+
+    /// angular columns of the point Jacobian
+    Eigen::Matrix3d J_p;
+    for (int k = 0; k < 3; ++k)
+        J_p.col(k).noalias() = J.angular()[k] * p;
+
+    const Eigen::RowVector3d q_info_J = q_info * J_p;
+    const Eigen::Matrix3d    info_J   = info * J_p;
+
+    g.template head<3>() += s * q_info.transpose();
+    g.template tail<3>() += s * q_info_J.transpose();
+
+    /// linear block, J_i = e_i
+    for (int i = 0; i < 3; ++i)
+        for (int j = i; j < 3; ++j)
+            h(i, j) -= s * (info(j, i) + q_info(i) * q_info(j));
+
+    /// mixed block
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            h(i, 3 + j) -= s * (info.col(i).dot(J_p.col(j)) + q_info(i) * q_info_J(j));
+
+    /// angular block with second derivatives
+    const Hessian::hessian_t &D = H.angular();
+    for (int i = 0; i < 3; ++i)
+        for (int j = i; j < 3; ++j)
+            h(3 + i, 3 + j) -= s * (q_info.dot(D[i][j] * p) +
+                                    J_p.col(j).dot(info_J.col(i)) +
+                                    q_info_J(i) * q_info_J(j));
+}
+}
+}
+
+#endif // CSLIBS_NDT_3D_GRADIENT_HPP
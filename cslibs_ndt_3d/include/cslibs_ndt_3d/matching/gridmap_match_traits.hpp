@@ -7,6 +7,7 @@
 #include <cslibs_ndt_3d/static_maps/gridmap.hpp>
 #include <cslibs_ndt_3d/matching/jacobian.hpp>
 #include <cslibs_ndt_3d/matching/hessian.hpp>
+#include <cslibs_ndt_3d/matching/gradient.hpp>
 
 namespace cslibs_ndt {
 namespace matching {
@@ -30,6 +31,7 @@ struct MatchTraits<MapT, typename std::enable_if<Is3dGridmap<MapT>::value>::type
     using transform_t           = cslibs_math_3d::Transform3d;
     using parameter_t           = cslibs_ndt::matching::Parameter;
     using distribution_bundle_t = typename MapT::distribution_bundle_t;
+    using distribution_t        = typename MapT::distribution_t;
     using index_t               = typename MapT::index_t;
 
     static transform_t makeTransform(const Eigen::Vector3d& linear,
@@ -42,6 +44,7 @@ struct MatchTraits<MapT, typename std::enable_if<Is3dGridmap<MapT>::value>::type
 
     static void computeGradient(const MapT& map,
                                 const point_t& point,
+                                const point_t& source,
                                 const Jacobian& J,
                                 const Hessian& H,
                                 const parameter_t& param,
@@ -49,43 +52,36 @@ struct MatchTraits<MapT, typename std::enable_if<Is3dGridmap<MapT>::value>::type
                                 gradient_t& g,
                                 hessian_t& h)
     {
-        auto* bundle = map.getDistributionBundle(point);
-        if (!bundle)
+        typename MapT::distribution_const_list_t bundle;
+        if (!map.getDistributions(point, bundle))
             return;
 
-        for (auto* distribution_wrapper : *bundle)
+        /// evaluate all layers at once, only significant ones contribute to the gradient
+        typename MapT::bundle_gaussians_t gaussians;
+        std::array<const typename MapT::distribution_t*, MapT::bin_count> layers;
+        for (auto* distribution_wrapper : bundle)
         {
-            auto& d = distribution_wrapper->data();
-            if (d.getN() < 4)
+            if (!distribution_wrapper)
                 continue;
 
-            const auto info   = d.getInformationMatrix();
-            const auto q      = (point.data() - d.getMean()).eval();
-            const auto q_info = (q.transpose() * info).eval();
-            const auto e      = -0.5 * double(q_info * q);
-            const auto s      = std::exp(e);
-            if (!std::isnormal(s) || s <= 1e-5)
+            auto& d = distribution_wrapper->data();
+            if (d.getN() < 4)
                 continue;
 
-            // this part should be vectorized, may also remove common factors...
-            for (std::size_t i = 0; i < LINEAR_DIMS + ANGULAR_DIMS; ++i)
-            {
-                const auto J_iq     = J.get(i, q);
-                const auto J_info   = (info * J_iq).eval();
-
-                g(i) += s * q_info * J_iq;
+            layers[gaussians.size()] = distribution_wrapper;
+            gaussians.add(d.getMean(), distribution_wrapper->getInformationMatrix(), 1.0);
+        }
 
-                for (std::size_t j = 0; j < LINEAR_DIMS + ANGULAR_DIMS; ++j)
-                {
-                    h(i, j) -= s * q_info * H.get(i, j, q) +
-                            s * static_cast<double>((J.get(j, q).transpose()).eval() * J_info) -
-                            s * (q_info * J_iq).eval() * (-q_info * J.get(j, q)).eval();
-                }
-            }
-            std::cout << "hessian  : " << h << "\n";
-            std::cout << "sub score: " << s << "\n";
+        std::array<double, MapT::bin_count> s;
+        gaussians.evaluate(point.data().data(), s.data());
+        for (std::size_t k = 0 ; k < gaussians.size() ; ++k)
+        {
+            if (!std::isnormal(s[k]) || s[k] <= 1e-5)
+                continue;
 
-            score += s;
+            const auto q = (point.data() - layers[k]->data().getMean()).eval();
+            cslibs_ndt_3d::matching::accumulateGradient(source.data(), q, layers[k]->getInformationMatrix(), s[k], J, H, g, h);
+            score += s[k];
         }
     }
 
@@ -176,67 +172,95 @@ struct MatchTraits<MapT, typename std::enable_if<Is3dGridmap<MapT>::value>::type
         const std::size_t size = distribution_bundle_t::size();
 
         /// III.    : calculate the score using both bundles
-        const auto R = J.rotation();
         for(std::size_t i = 0 ; i < size ; ++i) {
             if(!bundle_map[i])
                 continue;
+            computeGradient(*bundle_map[i], *bundle[i], J, H, t, score, g, h);
+        }
+    }
+
+    /**
+     * @brief Match a single distribution, e.g. visited by traverseDistributions. It is
+     *        paired with the distribution of the same layer in the map at its mean moved by t.
+     */
+    static void computeGradient(const MapT& map,
+                                const std::size_t layer,
+                                const distribution_t& distribution,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const transform_t &t,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        const auto &d = distribution.data();
+        if (!d.valid())
+            return;
 
-            auto& d = bundle[i]->data();
-            auto& d_map = bundle_map[i]->data();
+        typename MapT::distribution_const_list_t bundle_map;
+        if (!map.getDistributions(t * point_t(d.getMean()), bundle_map) || !bundle_map[layer])
+            return;
 
-            if (!d.valid() || !d_map.valid())
-                continue;
+        computeGradient(*bundle_map[layer], distribution, J, H, t, score, g, h);
+    }
 
-            const auto mean      = t * d.getMean();
-            const auto mean_map  = d_map.getMean();
-            const auto cov       = d.getCovariance();
-            const auto cov_map   = d_map.getCovariance();
-            const auto cov_rot   = (R.transpose() * cov * R).eval();
-            const auto B_inv     = (cov_rot + cov_map);
+    /**
+     * @brief Match the source distribution moved by t against a map distribution. The
+     *        difference of the means is normal with the covariance R C R^T + C_map, the
+     *        partials are taken with respect to the source mean and covariance.
+     */
+    static void computeGradient(const distribution_t& distribution_map,
+                                const distribution_t& distribution,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const transform_t &t,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        auto& d = distribution.data();
+        auto& d_map = distribution_map.data();
 
-            if(B_inv.determinant() == 0.0)
-                continue;
+        if (!d.valid() || !d_map.valid())
+            return;
 
-            const auto B = B_inv.inverse();
-            const auto q = (mean - mean_map).eval();
-            const auto q_info = (q.transpose() * B).eval();
-            const auto e = static_cast<double>(q_info * q);
-            const auto d2 = 1.0; // 0.05;
-            const auto s = std::exp(-0.5 * d2 * e);
-            const auto Bq = (B * q).eval();
+        const Eigen::Matrix3d &R   = J.rotation();
+        const Eigen::Vector3d mean = d.getMean();
+        const Eigen::Matrix3d cov  = d.getCovariance();
+        const Eigen::Matrix3d B_inv = R * cov * R.transpose() + d_map.getCovariance();
 
-            if (!std::isnormal(s) || s <= 1e-5)
-                continue;
+        if (B_inv.determinant() == 0.0)
+            return;
 
-            // this part should be vectorized, may also remove common factors...
-            for (std::size_t i = 0; i < LINEAR_DIMS + ANGULAR_DIMS; ++i)
-            {
-                const auto J_iq       = J.get(i, q);
-                const auto Z_i        = J.get(i, cov_rot);
-                const auto q_info_Z_i = q_info * Z_i;
-
-                g(i) += s * d2 * 0.5 * ((q_info * J_iq).value() - (q_info_Z_i * Bq).value());
-
-                for (std::size_t j = 0; j < LINEAR_DIMS + ANGULAR_DIMS; ++j)
-                {
-                    const auto H_ij = H.get(i,j,q);
-                    const auto Z_ij = H.get(i,j,cov_rot);
-                    const auto Z_j  = J.get(j,cov_rot);
-
-                    h(i, j) -= s * d2 * ((J_iq.transpose() * B * J_iq).value() -
-                                         (2.0 * q_info_Z_i * J_iq).value() +
-                                         (q_info * H_ij).value() -
-                                         (q_info_Z_i * B * Z_j * Bq).value() -
-                                         (0.5 * q_info * Z_ij * Bq).value() -
-                                         (d2 * 0.25 * e * e));
-                }
-            }
+        const Eigen::Matrix3d B  = B_inv.inverse();
+        const Eigen::Vector3d q  = (t * point_t(mean)).data() - d_map.getMean();
+        const Eigen::Vector3d Bq = B * q;
+        const double s = std::exp(-0.5 * q.dot(Bq));
 
-            std::cout << "hessian  : " << h << "\n";
-            std::cout << "sub score: " << s << "\n";
+        if (!std::isnormal(s) || s <= 1e-5)
+            return;
 
-            score += s;
+        /// partials of the mean, the covariance only changes with the rotation
+        std::array<Eigen::Vector3d, LINEAR_DIMS + ANGULAR_DIMS> J_mean;
+        gradient_t a;
+        for (int i = 0; i < LINEAR_DIMS; ++i) {
+            J_mean[i] = Eigen::Vector3d::Unit(i);
+            a(i) = Bq(i);
+        }
+        for (int k = 0; k < ANGULAR_DIMS; ++k) {
+            const Eigen::Matrix3d &dR = J.angular()[k];
+            const Eigen::Matrix3d dR_cov_R = dR * cov * R.transpose();
+            const Eigen::Matrix3d Z = dR_cov_R + dR_cov_R.transpose();
+            J_mean[LINEAR_DIMS + k] = dR * mean;
+            a(LINEAR_DIMS + k) = Bq.dot(J_mean[LINEAR_DIMS + k]) - 0.5 * Bq.dot(Z * Bq);
         }
+
+        g += s * a;
+        for (int i = 0; i < LINEAR_DIMS + ANGULAR_DIMS; ++i)
+            for (int j = 0; j < LINEAR_DIMS + ANGULAR_DIMS; ++j)
+                h(i, j) -= s * (J_mean[i].dot(B * J_mean[j]) + a(i) * a(j));
+
+        score += s;
     }
 };
 
@@ -6,6 +6,7 @@
 #include <cslibs_ndt_3d/static_maps/occupancy_gridmap.hpp>
 #include <cslibs_ndt_3d/matching/jacobian.hpp>
 #include <cslibs_ndt_3d/matching/hessian.hpp>
+#include <cslibs_ndt_3d/matching/gradient.hpp>
 
 namespace cslibs_ndt {
 namespace matching {
@@ -40,6 +41,7 @@ struct MatchTraits<MapT, typename std::enable_if<Is3dOccupancyGridmap<MapT>::val
     // todo: deduplicate code, make model configureable...
     static void computeGradient(const MapT& map,
                                 const point_t& point,
+                                const point_t& source,
                                 const Jacobian& J,
                                 const Hessian& H,
                                 const parameter_t& param,
@@ -50,54 +52,52 @@ struct MatchTraits<MapT, typename std::enable_if<Is3dOccupancyGridmap<MapT>::val
         static constexpr double d1 = 0.95;
         static constexpr double d2 = 1 - d1;
 
-        auto* bundle = map.getDistributionBundle(point);
-        if (!bundle)
+        typename MapT::distribution_const_list_t bundle;
+        if (!map.getDistributions(point, bundle))
             return;
 
         // check occupancy value
         if (param.occupancyThreshold() > 0.0)
         {
+            /// layers which are not allocated yet count at the prior
             double occupancy = 0.0;
-            for (auto* distribution_wrapper : *bundle)
-                occupancy += distribution_wrapper->getOccupancy(param.inverseModel());
+            for (auto* distribution_wrapper : bundle)
+                occupancy += distribution_wrapper ?
+                            distribution_wrapper->computeOccupancy(param.inverseModel()) :
+                            cslibs_math::common::LogOdds<double>::from(0.0);
             occupancy /= 8.0;
 
             if (occupancy < param.occupancyThreshold())
                 return;
         }
 
-        for (auto* distribution_wrapper : *bundle)
+        /// evaluate all layers at once, only significant ones contribute to the gradient
+        typename MapT::bundle_gaussians_t gaussians;
+        std::array<const typename MapT::distribution_t*, MapT::bin_count> layers;
+        for (auto* distribution_wrapper : bundle)
         {
-            auto& d = distribution_wrapper->getDistribution();
-            if (!d || d->getN() < 4)
+            if (!distribution_wrapper)
                 continue;
 
-            const auto info   = d->getInformationMatrix();
-            const auto q      = (point.data() - d->getMean()).eval();
-            const auto q_info = (q.transpose() * info).eval();
-            const auto p_occ  = distribution_wrapper->getOccupancy(param.inverseModel()); // no recompute: this uses a cached value
-            const auto e      = -0.5 * double(q_info * q) * (d2 * (1 - p_occ));
-            const auto s      = d1 * p_occ * std::exp(e);
-            if (!std::isnormal(s) || s <= 1e-5)
+            auto& d = distribution_wrapper->getDistribution();
+            if (!d || d->getN() < 4)
                 continue;
 
-            // this part should be vectorized, may also remove common factors...
-            for (std::size_t i = 0; i < LINEAR_DIMS + ANGULAR_DIMS; ++i)
-            {
-                const auto J_iq = J.get(i, q);
-                const auto J_info = (info * J_iq).eval();
-
-                g(i) += s * q_info * J_iq;
+            const auto p_occ = distribution_wrapper->computeOccupancy(param.inverseModel()); // the cache is not thread safe
+            layers[gaussians.size()] = distribution_wrapper;
+            gaussians.add(d->getMean(), distribution_wrapper->getInformationMatrix() * (d2 * (1 - p_occ)), d1 * p_occ);
+        }
 
-                for (std::size_t j = 0; j < LINEAR_DIMS + ANGULAR_DIMS; ++j)
-                {
-                    h(i, j) -= s * q_info * H.get(i, j, q) +
-                               s * static_cast<double>((J.get(j, q).transpose()).eval() * J_info) -
-                               s * (q_info * J_iq).value() * (-q_info * J.get(j, q)).value();
-                }
-            }
+        std::array<double, MapT::bin_count> s;
+        gaussians.evaluate(point.data().data(), s.data());
+        for (std::size_t k = 0 ; k < gaussians.size() ; ++k)
+        {
+            if (!std::isnormal(s[k]) || s[k] <= 1e-5)
+                continue;
 
-            score += s;
+            const auto q = (point.data() - layers[k]->getDistribution()->getMean()).eval();
+            cslibs_ndt_3d::matching::accumulateGradient(source.data(), q, layers[k]->getInformationMatrix(), s[k], J, H, g, h);
+            score += s[k];
         }
     }
 };
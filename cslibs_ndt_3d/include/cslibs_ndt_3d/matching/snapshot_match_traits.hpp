@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cslibs_ndt_3d/matching/frozen_map_match_traits.hpp>
+#include <cslibs_ndt_3d/snapshots/gridmap.hpp>
+#include <cslibs_ndt_3d/snapshots/occupancy_gridmap.hpp>
+
+namespace cslibs_ndt {
+namespace matching {
+
+template<>
+struct MatchTraits<cslibs_ndt_3d::snapshots::Gridmap<double>> :
+        public MatchTraits<cslibs_ndt_3d::frozen_maps::Gridmap<double>>
+{
+    using base_t                = MatchTraits<cslibs_ndt_3d::frozen_maps::Gridmap<double>>;
+    using map_t                 = cslibs_ndt_3d::snapshots::Gridmap<double>;
+
+    static void computeGradient(const map_t& map,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        const map_t::tile_t* tile = nullptr;
+        const map_t::bundle_t* bundle = map.getBundle(point, tile);
+        if (bundle)
+            base_t::computeGradient(*tile, bundle, point, source, J, H, param, score, g, h);
+    }
+};
+
+template<>
+struct MatchTraits<cslibs_ndt_3d::snapshots::OccupancyGridmap<double>> :
+        public MatchTraits<cslibs_ndt_3d::frozen_maps::OccupancyGridmap<double>>
+{
+    using base_t                = MatchTraits<cslibs_ndt_3d::frozen_maps::OccupancyGridmap<double>>;
+    using map_t                 = cslibs_ndt_3d::snapshots::OccupancyGridmap<double>;
+
+    static void computeGradient(const map_t& map,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        const map_t::tile_t* tile = nullptr;
+        const map_t::bundle_t* bundle = map.getBundle(point, tile);
+        if (bundle)
+            base_t::computeGradient(*tile, bundle, point, source, J, H, param, score, g, h);
+    }
+};
+
+}
+}
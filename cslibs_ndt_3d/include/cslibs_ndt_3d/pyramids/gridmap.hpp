@@ -0,0 +1,15 @@
+#ifndef CSLIBS_NDT_3D_PYRAMIDS_GRIDMAP_HPP
+#define CSLIBS_NDT_3D_PYRAMIDS_GRIDMAP_HPP
+
+#include <cslibs_ndt/map/pyramid.hpp>
+
+namespace cslibs_ndt_3d {
+namespace pyramids {
+
+template <typename T>
+using Gridmap = cslibs_ndt::map::Pyramid<cslibs_ndt::map::tags::dynamic_map,3,cslibs_ndt::Distribution,T>;
+
+}
+}
+
+#endif // CSLIBS_NDT_3D_PYRAMIDS_GRIDMAP_HPP
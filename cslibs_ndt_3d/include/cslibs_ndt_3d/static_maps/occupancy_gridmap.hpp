@@ -2,6 +2,7 @@
 #define CSLIBS_NDT_3D_STATIC_MAPS_OCCUPANCY_GRIDMAP_HPP
 
 #include <cslibs_ndt/map/map.hpp>
+#include <cslibs_ndt/map/rolling_map.hpp>
 
 namespace cslibs_ndt_3d {
 namespace static_maps {
@@ -9,6 +10,10 @@ namespace static_maps {
 template <typename T>
 using OccupancyGridmap = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::OccupancyDistribution,T>;
 
+/// constant size window following the robot, see cslibs_ndt::map::RollingMap
+template <typename T>
+using RollingOccupancyGridmap = cslibs_ndt::map::RollingMap<3,cslibs_ndt::OccupancyDistribution,T>;
+
 }
 }
 
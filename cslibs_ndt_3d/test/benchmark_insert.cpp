@@ -0,0 +1,122 @@
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using map_t            = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using concurrent_map_t = cslibs_ndt_3d::dynamic_maps::ConcurrentGridmap<double>;
+using point_t          = cslibs_math_3d::Point3d;
+using transform_t      = cslibs_math_3d::Transform3d;
+using points_t         = std::vector<point_t>;
+
+/// one scan per sensor, the sensors look at overlapping parts of the same area
+inline std::vector<points_t> generateScans(const std::size_t sensors, const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(-15.0, 15.0);
+    std::vector<points_t> scans(sensors);
+    for (points_t &scan : scans) {
+        scan.reserve(count);
+        for (std::size_t i = 0 ; i < count ; ++i)
+            scan.emplace_back(u.get(), u.get(), 0.1 * u.get());
+    }
+    return scans;
+}
+
+template <typename fn_t>
+double run(const std::vector<points_t> &scans, const std::size_t repetitions, const fn_t &insert)
+{
+    return 1e-3 * measure([&scans, repetitions, &insert]() {
+        std::vector<std::thread> threads;
+        for (const points_t &scan : scans)
+            threads.emplace_back([&scan, repetitions, &insert]() {
+                for (std::size_t r = 0 ; r < repetitions ; ++r)
+                    insert(scan);
+            });
+        for (std::thread &t : threads)
+            t.join();
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t max_threads = argc > 1 ? std::stoul(argv[1]) : cslibs_ndt::utility::hardware_threads();
+    const std::size_t scan_size   = argc > 2 ? std::stoul(argv[2]) : 30000ul;
+    const std::size_t repetitions = 10;
+
+    for (std::size_t threads = 1 ; threads <= max_threads ; ++threads) {
+        const std::vector<points_t> scans = generateScans(threads, scan_size);
+        const double points = static_cast<double>(threads * scan_size * repetitions);
+
+        /// regular map, writers are serialized by a global mutex
+        map_t map(1.0);
+        std::mutex mutex;
+        const double t_mutex = run(scans, repetitions, [&map, &mutex](const points_t &scan) {
+            std::unique_lock<std::mutex> l(mutex);
+            map.insert(scan.begin(), scan.end());
+        });
+
+        /// sharded backend, writers only synchronize per distribution
+        concurrent_map_t concurrent_map(1.0);
+        const double t_concurrent = run(scans, repetitions, [&concurrent_map](const points_t &scan) {
+            concurrent_map.insert(scan.begin(), scan.end());
+        });
+
+        std::cout << "threads: "               << threads
+                  << " | points: "             << static_cast<std::size_t>(points)
+                  << " | mutex points/s: "     << points / t_mutex
+                  << " | concurrent points/s: " << points / t_concurrent
+                  << " | speedup: "            << t_mutex / t_concurrent << "\n";
+    }
+
+    /// once the map was expanded, the writers also record the bundles they modify
+    for (std::size_t threads = 1 ; threads <= max_threads ; ++threads) {
+        const std::vector<points_t> scans = generateScans(threads, scan_size);
+        const double points = static_cast<double>(threads * scan_size * repetitions);
+
+        concurrent_map_t fresh_map(1.0);
+        fresh_map.insert(scans.front().begin(), scans.front().end());
+        const double t_fresh = run(scans, repetitions, [&fresh_map](const points_t &scan) {
+            fresh_map.insert(scan.begin(), scan.end());
+        });
+
+        concurrent_map_t expanded_map(1.0);
+        expanded_map.insert(scans.front().begin(), scans.front().end());
+        expanded_map.allocatePartiallyAllocatedBundles();
+        const double t_expanded = run(scans, repetitions, [&expanded_map](const points_t &scan) {
+            expanded_map.insert(scan.begin(), scan.end());
+        });
+
+        std::cout << "after expansion | threads: " << threads
+                  << " | points: "                  << static_cast<std::size_t>(points)
+                  << " | untracked points/s: "      << points / t_fresh
+                  << " | tracked points/s: "        << points / t_expanded
+                  << " | ratio: "                   << t_fresh / t_expanded << "\n";
+    }
+
+    /// a single dense scan, e.g. 128 beams with 1024 points each
+    const points_t scan = generateScans(1, 128 * 1024).front();
+    double reference_ms = 0.0;
+    for (std::size_t threads = 1 ; threads <= max_threads ; ++threads) {
+        double ms = 0.0;
+        for (std::size_t r = 0 ; r < repetitions ; ++r) {
+            map_t map(1.0);
+            ms += measure([&]() {
+                map.insertParallel(scan.begin(), scan.end(), transform_t(), threads);
+            });
+        }
+        ms /= static_cast<double>(repetitions);
+        if (threads == 1)
+            reference_ms = ms;
+
+        std::cout << "single scan | threads: " << threads
+                  << " | points: "             << scan.size()
+                  << " | ms: "                 << ms
+                  << " | speedup: "            << reference_ms / ms << "\n";
+    }
+    return 0;
+}
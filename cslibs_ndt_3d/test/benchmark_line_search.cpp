@@ -0,0 +1,92 @@
+#include <cslibs_ndt/matching/match.hpp>
+#include <cslibs_ndt/matching/match_pyramid.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include "test_utility.hpp"
+
+#include <atomic>
+#include <iostream>
+
+using map_t       = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using point_t     = cslibs_math_3d::Point3d;
+using transform_t = cslibs_math_3d::Transform3d;
+using points_t    = std::vector<point_t>;
+using traits_t    = cslibs_ndt::matching::MatchTraits<map_t>;
+
+/// counts the point terms to report the passes over the scan
+struct CountingTraits : public traits_t
+{
+    static std::atomic<std::size_t> terms;
+
+    template<typename... Args>
+    static void computeGradient(Args&&... args)
+    {
+        ++terms;
+        traits_t::computeGradient(std::forward<Args>(args)...);
+    }
+};
+std::atomic<std::size_t> CountingTraits::terms(0);
+
+struct Frame
+{
+    points_t    scan;
+    transform_t truth;
+    transform_t initial;
+};
+
+int main(int argc, char *argv[])
+{
+    const std::size_t frames    = argc > 1 ? std::stoul(argv[1]) : 50ul;
+    const std::size_t scan_size = argc > 2 ? std::stoul(argv[2]) : 20000ul;
+
+    map_t map(transform_t(), 1.0);
+    const points_t room = generateRoom(500000);
+    map.insert(room.begin(), room.end());
+
+    /// a drive through the room, every scan is matched from its odometry estimate
+    cslibs_math::random::Normal<double,1> odometry(0.0, 1.0);
+    std::vector<Frame> replay(frames);
+    for (std::size_t i = 0 ; i < frames ; ++i) {
+        const double s = static_cast<double>(i) / static_cast<double>(frames);
+        Frame &f = replay[i];
+        f.truth   = transform_t(-5.0 + 10.0 * s, 2.0 * std::sin(2.0 * M_PI * s), 0.0,
+                                0.0, 0.0, 0.5 * std::cos(2.0 * M_PI * s));
+        f.initial = f.truth * transform_t(0.15 * odometry.get(), 0.15 * odometry.get(), 0.0,
+                                          0.0, 0.0, 0.05 * odometry.get());
+        f.scan = transformed(generateRoom(scan_size), f.truth.inverse());
+    }
+
+    cslibs_ndt::matching::Parameter param;
+    for (const bool line_search : {false, true}) {
+        param.lineSearch() = line_search;
+
+        double ms = 0.0, iterations = 0.0, translation = 0.0, rotation = 0.0;
+        CountingTraits::terms = 0;
+        for (const Frame &f : replay) {
+            cslibs_ndt::matching::Result<transform_t> result;
+            ms += measure([&]() {
+                result = cslibs_ndt::matching::match<points_t::const_iterator, map_t, CountingTraits>(
+                            f.scan.begin(), f.scan.end(), map, param, f.initial);
+            });
+
+            double dt, dr;
+            cslibs_ndt::matching::detail::difference<point_t>(f.truth, result.transform(), dt, dr);
+            iterations  += static_cast<double>(result.iterations());
+            translation += dt;
+            rotation    += dr;
+        }
+
+        const double n = static_cast<double>(frames);
+        std::cout << (line_search ? "line search" : "step control")
+                  << " | frames: "      << frames
+                  << " | points: "      << scan_size
+                  << " | iterations: "  << iterations / n
+                  << " | passes: "      << static_cast<double>(CountingTraits::terms) / (n * static_cast<double>(scan_size))
+                  << " | ms: "          << ms / n
+                  << " | translation error: " << translation / n
+                  << " | rotation error: "    << rotation / n << "\n";
+    }
+    return 0;
+}
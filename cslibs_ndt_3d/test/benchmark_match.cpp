@@ -0,0 +1,63 @@
+#include <cslibs_ndt/matching/match.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+
+#include "test_utility.hpp"
+
+#include <iostream>
+
+using map_t       = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using point_t     = cslibs_math_3d::Point3d;
+using transform_t = cslibs_math_3d::Transform3d;
+using points_t    = std::vector<point_t>;
+
+int main(int argc, char *argv[])
+{
+    const std::size_t max_threads = argc > 1 ? std::stoul(argv[1]) : cslibs_ndt::utility::hardware_threads();
+    const std::size_t scan_size   = argc > 2 ? std::stoul(argv[2]) : 60000ul;
+    const std::size_t repetitions = 10;
+
+    map_t map(transform_t(), 1.0);
+    const points_t room = generateRoom(500000);
+    map.insert(room.begin(), room.end());
+
+    const points_t scan = generateRoom(scan_size);
+    const transform_t initial(0.2, -0.1, 0.05, 0.0, 0.0, 0.05);
+
+    cslibs_ndt::matching::Parameter param;
+    param.maxIterations() = 20;
+
+    transform_t reference;
+    double reference_time = 0.0;
+    for (std::size_t threads = 1 ; threads <= max_threads ; ++threads) {
+        param.numThreads() = threads;
+
+        double ms = 0.0;
+        cslibs_ndt::matching::Result<transform_t> result;
+        for (std::size_t r = 0 ; r < repetitions ; ++r) {
+            ms += measure([&]() {
+                result = cslibs_ndt::matching::match(scan.begin(), scan.end(), map, param, initial);
+            });
+        }
+        ms /= static_cast<double>(repetitions);
+
+        if (threads == 1) {
+            reference      = result.transform();
+            reference_time = ms;
+        }
+        const transform_t &t = result.transform();
+        const bool identical = reference.tx()    == t.tx()    &&
+                               reference.ty()    == t.ty()    &&
+                               reference.tz()    == t.tz()    &&
+                               reference.roll()  == t.roll()  &&
+                               reference.pitch() == t.pitch() &&
+                               reference.yaw()   == t.yaw();
+
+        std::cout << "threads: "       << threads
+                  << " | points: "     << scan.size()
+                  << " | iterations: " << result.iterations()
+                  << " | ms: "         << ms
+                  << " | speedup: "    << reference_time / ms
+                  << " | identical: "  << std::boolalpha << identical << "\n";
+    }
+    return 0;
+}
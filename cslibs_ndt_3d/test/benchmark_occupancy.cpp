@@ -0,0 +1,87 @@
+#include <cslibs_ndt_3d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using map_t       = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+using point_t     = cslibs_math_3d::Point3d;
+using transform_t = cslibs_math_3d::Transform3d;
+using points_t    = std::vector<point_t>;
+
+/// resident memory of the process in kB
+inline std::size_t residentMemory()
+{
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        if (key == "VmRSS:") {
+            std::size_t kb = 0;
+            status >> kb;
+            return kb;
+        }
+    }
+    return 0;
+}
+
+/// scans of a 40m x 40m room with walls and floor, taken from several poses
+inline std::vector<points_t> generateScans(const std::size_t scans, const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(-20.0, 20.0);
+    cslibs_math::random::Uniform<double,1> h(0.0, 3.0);
+    cslibs_math::random::Uniform<double,1> s(0.0, 4.0);
+    std::vector<points_t> result(scans);
+    for (points_t &scan : result) {
+        scan.reserve(count);
+        for (std::size_t i = 0 ; i < count ; ++i) {
+            const double side = s.get();
+            if (side < 1.0)
+                scan.emplace_back(-20.0, u.get(), h.get());
+            else if (side < 2.0)
+                scan.emplace_back(+20.0, u.get(), h.get());
+            else if (side < 3.0)
+                scan.emplace_back(u.get(), 20.0, h.get());
+            else
+                scan.emplace_back(u.get(), u.get(), 0.0);
+        }
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t scans      = argc > 1 ? std::stoul(argv[1]) : 50ul;
+    const std::size_t scan_size  = argc > 2 ? std::stoul(argv[2]) : 20000ul;
+    const double      resolution = argc > 3 ? std::stod(argv[3]) : 0.5;
+
+    const std::vector<points_t> data = generateScans(scans, scan_size);
+    cslibs_math::random::Uniform<double,1> u(-5.0, 5.0);
+
+    const std::size_t memory_start = residentMemory();
+    const auto start = std::chrono::steady_clock::now();
+    map_t map(resolution);
+    for (const points_t &scan : data) {
+        const transform_t origin(u.get(), u.get(), 1.0, 0.0, 0.0, 0.0);
+        map.insert(scan.begin(), scan.end(), origin);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const std::size_t memory_end = residentMemory();
+
+    std::size_t cells = 0, occupied = 0;
+    for (const auto &storage : map.getStorages()) {
+        storage->traverse([&cells, &occupied](const map_t::index_t &, const map_t::distribution_t &d) {
+            ++cells;
+            occupied += d.getDistribution() ? 1 : 0;
+        });
+    }
+
+    std::cout << "cells: "                   << cells
+              << " | with gaussian: "        << occupied
+              << " | points/s: "             << static_cast<double>(scans * scan_size) / seconds
+              << " | map bytes: "            << map.getByteSize()
+              << " | resident kB: "          << memory_end - memory_start << "\n";
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <thread>
+
+const std::size_t NUM_SENSORS = 3;
+const std::size_t NUM_SCANS   = 20;
+const std::size_t SCAN_SIZE   = 2000;
+
+using rng_t       = cslibs_math::random::Uniform<double,1>;
+using point_t     = cslibs_math_3d::Point3d;
+using transform_t = cslibs_math_3d::Transform3d;
+using scan_t      = std::vector<point_t>;
+
+struct Sensor
+{
+    transform_t         origin;
+    std::vector<scan_t> scans;
+};
+
+/// overlapping scans of several sensors, every sensor is fed by its own thread
+inline std::vector<Sensor> generateSensors(const std::size_t scan_size)
+{
+    rng_t rng_coord(-8.0, 8.0);
+    std::vector<Sensor> sensors(NUM_SENSORS);
+    for (std::size_t s = 0 ; s < NUM_SENSORS ; ++s) {
+        sensors[s].origin = transform_t(static_cast<double>(s) - 1.0, 0.5 * static_cast<double>(s), 1.0,
+                                        0.0, 0.0, 0.5 * static_cast<double>(s));
+        sensors[s].scans.resize(NUM_SCANS);
+        for (scan_t &scan : sensors[s].scans)
+            for (std::size_t i = 0 ; i < scan_size ; ++i)
+                scan.emplace_back(rng_coord.get(), rng_coord.get(), 0.25 * rng_coord.get());
+    }
+    return sensors;
+}
+
+template <typename map_t, typename fn_t>
+void insertConcurrently(const std::vector<Sensor> &sensors, const fn_t &insert)
+{
+    std::vector<std::thread> threads;
+    for (const Sensor &sensor : sensors)
+        threads.emplace_back([&sensor, &insert]() {
+            for (const scan_t &scan : sensor.scans)
+                insert(scan, sensor.origin);
+        });
+    for (std::thread &t : threads)
+        t.join();
+}
+
+template <typename map_a_t, typename map_b_t, typename compare_t>
+void compareMaps(const map_a_t &expected, const map_b_t &map, const compare_t &compare)
+{
+    for (std::size_t i = 0 ; i < 3 ; ++i) {
+        EXPECT_EQ(expected.getMinBundleIndex()[i], map.getMinBundleIndex()[i]);
+        EXPECT_EQ(expected.getMaxBundleIndex()[i], map.getMaxBundleIndex()[i]);
+    }
+
+    std::vector<typename map_a_t::index_t> expected_indices, indices;
+    expected.getBundleIndices(expected_indices);
+    map.getBundleIndices(indices);
+    EXPECT_EQ(expected_indices.size(), indices.size());
+
+    for (const auto &bi : expected_indices) {
+        const auto *expected_bundle = expected.get(bi);
+        const auto *bundle          = map.get(bi);
+        ASSERT_NE(bundle, nullptr);
+        for (std::size_t i = 0 ; i < map_a_t::bin_count ; ++i)
+            compare(*expected_bundle->at(i), *bundle->at(i));
+    }
+
+    for (std::size_t i = 0 ; i < map_a_t::bin_count ; ++i)
+        EXPECT_EQ(expected.getStorages()[i]->size(), map.getStorages()[i]->size());
+}
+
+TEST(Test_cslibs_ndt_3d, testConcurrentGridmapInsertion)
+{
+    using map_t            = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using concurrent_map_t = cslibs_ndt_3d::dynamic_maps::ConcurrentGridmap<double>;
+
+    const std::vector<Sensor> sensors = generateSensors(SCAN_SIZE);
+
+    map_t expected(1.0);
+    for (const Sensor &sensor : sensors)
+        for (const scan_t &scan : sensor.scans)
+            expected.insert(scan.begin(), scan.end(), sensor.origin);
+
+    concurrent_map_t map(1.0);
+    insertConcurrently<concurrent_map_t>(sensors, [&map](const scan_t &scan, const transform_t &origin) {
+        map.insert(scan.begin(), scan.end(), origin);
+    });
+
+    compareMaps(expected, map, [](const map_t::distribution_t &a, const concurrent_map_t::distribution_t &b) {
+        EXPECT_EQ(a.data().getN(), b.data().getN());
+        for (std::size_t j = 0 ; j < 3 ; ++j)
+            EXPECT_NEAR(a.data().getMean()(j), b.data().getMean()(j), 1e-9);
+    });
+}
+
+TEST(Test_cslibs_ndt_3d, testConcurrentGridmapPointInsertion)
+{
+    using map_t            = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using concurrent_map_t = cslibs_ndt_3d::dynamic_maps::ConcurrentGridmap<double>;
+
+    const std::vector<Sensor> sensors = generateSensors(SCAN_SIZE / 10);
+
+    map_t expected(1.0);
+    for (const Sensor &sensor : sensors)
+        for (const scan_t &scan : sensor.scans)
+            for (const point_t &p : scan)
+                expected.insert(sensor.origin * p);
+
+    concurrent_map_t map(1.0);
+    insertConcurrently<concurrent_map_t>(sensors, [&map](const scan_t &scan, const transform_t &origin) {
+        for (const point_t &p : scan)
+            map.insert(origin * p);
+    });
+
+    compareMaps(expected, map, [](const map_t::distribution_t &a, const concurrent_map_t::distribution_t &b) {
+        EXPECT_EQ(a.data().getN(), b.data().getN());
+        for (std::size_t j = 0 ; j < 3 ; ++j)
+            EXPECT_NEAR(a.data().getMean()(j), b.data().getMean()(j), 1e-9);
+    });
+}
+
+TEST(Test_cslibs_ndt_3d, testParallelScanInsertion)
+{
+    using map_t = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+
+    const std::vector<Sensor> sensors = generateSensors(10 * SCAN_SIZE);
+    const Sensor &sensor = sensors.back();
+
+    for (const std::size_t threads : {2ul, 3ul, 8ul}) {
+        map_t expected(1.0);
+        map_t map(1.0);
+        for (std::size_t s = 0 ; s < 2 ; ++s) {
+            expected.insert(sensor.scans[s].begin(), sensor.scans[s].end(), sensor.origin);
+            map.insertParallel(sensor.scans[s].begin(), sensor.scans[s].end(), sensor.origin, threads);
+        }
+
+        compareMaps(expected, map, [](const map_t::distribution_t &a, const map_t::distribution_t &b) {
+            EXPECT_EQ(a.data().getN(), b.data().getN());
+            for (std::size_t j = 0 ; j < 3 ; ++j)
+                EXPECT_NEAR(a.data().getMean()(j), b.data().getMean()(j), 1e-9);
+            if (a.data().getN() >= 3) {
+                EXPECT_TRUE(a.data().getCovariance().isApprox(b.data().getCovariance(), 1e-6));
+            }
+        });
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testConcurrentOccupancyGridmapInsertion)
+{
+    using map_t            = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+    using concurrent_map_t = cslibs_ndt_3d::dynamic_maps::ConcurrentOccupancyGridmap<double>;
+
+    const std::vector<Sensor> sensors = generateSensors(SCAN_SIZE / 10);
+
+    map_t expected(1.0);
+    for (const Sensor &sensor : sensors)
+        for (const scan_t &scan : sensor.scans)
+            expected.insert(scan.begin(), scan.end(), sensor.origin);
+
+    concurrent_map_t map(1.0);
+    insertConcurrently<concurrent_map_t>(sensors, [&map](const scan_t &scan, const transform_t &origin) {
+        map.insert(scan.begin(), scan.end(), origin);
+    });
+
+    compareMaps(expected, map, [](const map_t::distribution_t &a, const concurrent_map_t::distribution_t &b) {
+        EXPECT_EQ(a.numFree(),     b.numFree());
+        EXPECT_EQ(a.numOccupied(), b.numOccupied());
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
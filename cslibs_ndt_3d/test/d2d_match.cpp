@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/matching/match.hpp>
+#include <cslibs_ndt/matching/match_pyramid.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+
+#include "test_utility.hpp"
+
+using rng_t          = cslibs_math::random::Uniform<double,1>;
+using point_t        = cslibs_math_3d::Point3d;
+using transform_t    = cslibs_math_3d::Transform3d;
+using map_t          = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using traits_t       = cslibs_ndt::matching::MatchTraits<map_t>;
+using distribution_t = map_t::distribution_t;
+using state_t        = Eigen::Matrix<double, 6, 1>;
+
+/// score, gradient and Hessian of one pair of distributions at the state
+double evaluate(const distribution_t &map_distribution,
+                const distribution_t &distribution,
+                const state_t &state,
+                traits_t::gradient_t &g,
+                traits_t::hessian_t &h)
+{
+    const Eigen::Vector3d linear  = state.head<3>();
+    const Eigen::Vector3d angular = state.tail<3>();
+    traits_t::Jacobian J;
+    traits_t::Jacobian::get(angular, J);
+    traits_t::Hessian H;
+    traits_t::Hessian::get(angular, H);
+
+    double score = 0.0;
+    g.setZero();
+    h.setZero();
+    traits_t::computeGradient(map_distribution, distribution, J, H,
+                              traits_t::makeTransform(linear, angular),
+                              score, g, h);
+    return score;
+}
+
+TEST(Test_cslibs_ndt_3d, testDistributionGradientFiniteDifferences)
+{
+    rng_t rng(-1.0, 1.0);
+    for (std::size_t t = 0; t < 100; ++t)
+    {
+        /// two flat distributions, the source one is moved close to the map one by the state
+        distribution_t map_distribution, distribution;
+        const Eigen::Vector3d center(2.0 * rng.get(), 2.0 * rng.get(), rng.get());
+        for (std::size_t n = 0; n < 50; ++n) {
+            map_distribution.data().add(Eigen::Vector3d(center(0) + 0.5 * rng.get(), center(1) + 0.5 * rng.get(), center(2) + 0.05 * rng.get()));
+            distribution.data().add(Eigen::Vector3d(center(0) + 0.4 * rng.get(), center(1) + 0.1 * rng.get(), center(2) + 0.3 * rng.get()));
+        }
+
+        state_t state;
+        for (int i = 0; i < 6; ++i)
+            state(i) = 0.05 * rng.get();
+
+        traits_t::gradient_t g, g_eps;
+        traits_t::hessian_t  h, h_eps;
+        if (evaluate(map_distribution, distribution, state, g, h) <= 1e-5)
+            continue;
+
+        /// g is the negative derivative of the score, h is symmetric and negative semi-definite
+        const double eps = 1e-6;
+        for (int i = 0; i < 6; ++i) {
+            const state_t delta = eps * state_t::Unit(i);
+            const double d = (evaluate(map_distribution, distribution, state + delta, g_eps, h_eps) -
+                              evaluate(map_distribution, distribution, state - delta, g_eps, h_eps)) / (2.0 * eps);
+            EXPECT_NEAR(-d, g(i), 1e-6);
+        }
+        EXPECT_TRUE(h.isApprox(h.transpose(), 1e-12));
+        EXPECT_LE(Eigen::SelfAdjointEigenSolver<traits_t::hessian_t>(h).eigenvalues().maxCoeff(), 1e-12);
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testD2DMatch)
+{
+    map_t dst(transform_t(), 1.0);
+    const std::vector<point_t> room = generateRoom(200000);
+    dst.insert(room.begin(), room.end());
+
+    const transform_t truth(0.1, -0.075, 0.025, 0.0, 0.0, 0.025);
+    map_t src(transform_t(), 1.0);
+    const std::vector<point_t> scan = transformed(generateRoom(100000), truth.inverse());
+    src.insert(scan.begin(), scan.end());
+
+    cslibs_ndt::matching::Parameter param;
+    param.maxIterations() = 100;
+    for (const std::size_t threads : {1ul, 4ul}) {
+        param.numThreads() = threads;
+        const auto result = cslibs_ndt::matching::match(src, dst, param, transform_t());
+
+        double translation, rotation;
+        cslibs_ndt::matching::detail::difference<point_t>(truth, result.transform(), translation, rotation);
+        EXPECT_LT(translation, 0.03);
+        EXPECT_LT(rotation, 0.005);
+        EXPECT_EQ(cslibs_ndt::matching::Termination::DELTA_EPSILON, result.termination());
+    }
+
+    /// started at the solution it stays there
+    const auto result = cslibs_ndt::matching::match(src, dst, param, truth);
+    double translation, rotation;
+    cslibs_ndt::matching::detail::difference<point_t>(truth, result.transform(), translation, rotation);
+    EXPECT_LT(translation, 0.03);
+    EXPECT_LT(rotation, 0.005);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/matching/match.hpp>
+#include <cslibs_ndt_3d/matching/occupancy_gridmap_match_traits.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/frozen_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/frozen_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+const std::size_t NUM_POINTS  = 20000;
+const std::size_t NUM_QUERIES = 5000;
+
+using rng_t   = cslibs_math::random::Uniform<double,1>;
+using point_t = cslibs_math_3d::Point3d;
+
+inline std::vector<point_t> generatePoints(const std::size_t count)
+{
+    rng_t rng_coord(-5.0, 5.0);
+    std::vector<point_t> points;
+    for (std::size_t i = 0 ; i < count ; ++i)
+        points.emplace_back(rng_coord.get(), rng_coord.get(), 0.25 * rng_coord.get());
+    return points;
+}
+
+template <typename map_t, typename frozen_t>
+void testLookup(const map_t &map, const frozen_t &frozen)
+{
+    rng_t rng_coord(-6.0, 6.0);
+    for (std::size_t i = 0 ; i < NUM_QUERIES ; ++i) {
+        const point_t p(rng_coord.get(), rng_coord.get(), rng_coord.get());
+
+        typename map_t::distribution_const_list_t distributions;
+        const bool found = map.getDistributions(p, distributions);
+        const typename frozen_t::bundle_t *bundle = frozen.getBundle(p);
+
+        bool expected = false;
+        for (std::size_t l = 0 ; l < map_t::bin_count ; ++l)
+            expected |= distributions[l] && distributions[l]->data().valid();
+        EXPECT_EQ(found && expected, bundle != nullptr);
+        if (!bundle)
+            continue;
+
+        for (std::size_t l = 0 ; l < map_t::bin_count ; ++l) {
+            const typename frozen_t::entry_t e = bundle->at(l);
+            const bool valid = distributions[l] && distributions[l]->data().valid();
+            EXPECT_EQ(valid, e != frozen_t::no_entry);
+            if (!valid)
+                continue;
+
+            const auto &d = distributions[l]->data();
+            EXPECT_EQ(d.getN(), frozen.getSampleCount(e));
+            for (std::size_t j = 0 ; j < 3 ; ++j)
+                EXPECT_EQ(d.getMean()(j), frozen.getMean(e)(j));
+            EXPECT_TRUE(d.getInformationMatrix().isApprox(frozen.getInformationMatrix(e)));
+        }
+
+        if (map.get(p)) {
+            EXPECT_NEAR(map.sampleNonNormalized(p), frozen.sampleNonNormalized(p), 1e-9);
+            EXPECT_NEAR(map.sample(p), frozen.sample(p), 1e-9);
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testFrozenDynamicGridmap)
+{
+    using map_t    = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using frozen_t = cslibs_ndt_3d::frozen_maps::Gridmap<double>;
+
+    map_t map(cslibs_math_3d::Transform3d(0.5, -0.25, 0.1, 0.0, 0.0, 0.3), 1.0);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS);
+    map.insert(points.begin(), points.end());
+
+    const frozen_t frozen(map);
+    EXPECT_GT(frozen.size(), 0ul);
+    EXPECT_GT(frozen.bundleCount(), 0ul);
+    testLookup(map, frozen);
+}
+
+TEST(Test_cslibs_ndt_3d, testFrozenStaticGridmap)
+{
+    using map_t    = cslibs_ndt_3d::static_maps::Gridmap<double>;
+    using frozen_t = cslibs_ndt::map::FrozenMap<3,cslibs_ndt::Distribution,double>;
+
+    map_t map(cslibs_math_3d::Transform3d(-6.0, -6.0, -6.0, 0.0, 0.0, 0.0), 1.0, {{12, 12, 12}}, {{0, 0, 0}});
+    const std::vector<point_t> points = generatePoints(NUM_POINTS);
+    map.insert(points.begin(), points.end());
+
+    const frozen_t frozen(map);
+    testLookup(map, frozen);
+}
+
+TEST(Test_cslibs_ndt_3d, testFrozenOccupancyGridmap)
+{
+    using map_t    = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+    using frozen_t = cslibs_ndt_3d::frozen_maps::OccupancyGridmap<double>;
+    using ivm_t    = map_t::inverse_sensor_model_t;
+
+    map_t map(1.0);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS / 10);
+    map.insert(points.begin(), points.end(), cslibs_math_3d::Transform3d(0.0, 0.0, 3.0, 0.0, 0.0, 0.0));
+
+    const frozen_t frozen(map);
+    const ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+
+    rng_t rng_coord(-6.0, 6.0);
+    for (std::size_t i = 0 ; i < NUM_QUERIES ; ++i) {
+        const point_t p(rng_coord.get(), rng_coord.get(), rng_coord.get());
+
+        typename map_t::distribution_const_list_t distributions;
+        const typename frozen_t::bundle_t *bundle = frozen.getBundle(p);
+        EXPECT_EQ(map.getDistributions(p, distributions), bundle != nullptr);
+        if (!bundle)
+            continue;
+
+        for (std::size_t l = 0 ; l < map_t::bin_count ; ++l) {
+            const frozen_t::entry_t e = bundle->at(l);
+            ASSERT_EQ(distributions[l] != nullptr, e != frozen_t::no_entry);
+            if (distributions[l]) {
+                EXPECT_NEAR(distributions[l]->computeOccupancy(*ivm), frozen.getOccupancy(e, *ivm), 1e-9);
+            }
+        }
+
+        if (map.get(p)) {
+            EXPECT_NEAR(map.sampleNonNormalized(p, ivm), frozen.sampleNonNormalized(p, ivm), 1e-9);
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testFrozenGridmapMatch)
+{
+    using map_t    = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using frozen_t = cslibs_ndt_3d::frozen_maps::Gridmap<double>;
+
+    map_t map(1.0);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS);
+    map.insert(points.begin(), points.end());
+    const frozen_t frozen(map);
+
+    const std::vector<point_t> scan = generatePoints(NUM_POINTS / 10);
+    const cslibs_math_3d::Transform3d initial(0.1, -0.1, 0.0, 0.0, 0.0, 0.02);
+
+    cslibs_ndt::matching::Parameter param;
+    param.numThreads() = 2;
+    const auto result        = cslibs_ndt::matching::match(scan.begin(), scan.end(), map, param, initial);
+    const auto result_frozen = cslibs_ndt::matching::match(scan.begin(), scan.end(), frozen, param, initial);
+
+    EXPECT_EQ(result.iterations(), result_frozen.iterations());
+    EXPECT_NEAR(result.score(), result_frozen.score(), 1e-6);
+    EXPECT_NEAR(result.transform().tx(),  result_frozen.transform().tx(),  1e-9);
+    EXPECT_NEAR(result.transform().ty(),  result_frozen.transform().ty(),  1e-9);
+    EXPECT_NEAR(result.transform().tz(),  result_frozen.transform().tz(),  1e-9);
+    EXPECT_NEAR(result.transform().yaw(), result_frozen.transform().yaw(), 1e-9);
+}
+
+/// the occupancy of a bundle is the mean over its 8 layers, layers which are not allocated count at the prior
+TEST(Test_cslibs_ndt_3d, testOccupancyThreshold)
+{
+    using map_t    = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+    using frozen_t = cslibs_ndt_3d::frozen_maps::OccupancyGridmap<double>;
+    using traits_t        = cslibs_ndt::matching::MatchTraits<map_t>;
+    using frozen_traits_t = cslibs_ndt::matching::MatchTraits<frozen_t>;
+
+    map_t map(1.0);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS / 10);
+    map.insert(points.begin(), points.end(), cslibs_math_3d::Transform3d(0.0, 0.0, 3.0, 0.0, 0.0, 0.0));
+    const frozen_t frozen(map);
+
+    const cslibs_ndt::matching::OccupancyParameter::InverseModel ivm(0.5, 0.45, 0.65);
+    cslibs_ndt::matching::OccupancyParameter param(cslibs_ndt::matching::Parameter(), ivm);
+
+    const traits_t::Jacobian J;
+    const traits_t::Hessian  H;
+    std::size_t partial = 0;
+    for (const point_t &p : points) {
+        map_t::distribution_const_list_t distributions;
+        if (!map.getDistributions(p, distributions))
+            continue;
+
+        double occupancy = 0.0;
+        bool missing = false;
+        for (const auto *d : distributions) {
+            occupancy += d ? d->computeOccupancy(ivm) : 0.5;
+            missing |= d == nullptr;
+        }
+        occupancy /= 8.0;
+
+        traits_t::gradient_t g = traits_t::gradient_t::Zero();
+        traits_t::hessian_t  h = traits_t::hessian_t::Zero();
+        double expected = 0.0;
+        param.occupancyThreshold() = 0.0;
+        traits_t::computeGradient(map, p, p, J, H, param, expected, g, h);
+        if (expected <= 0.0)
+            continue;
+        partial += missing;
+
+        for (const double threshold : {occupancy - 1e-9, occupancy + 1e-9}) {
+            param.occupancyThreshold() = threshold;
+            double s = 0.0, s_frozen = 0.0;
+            traits_t::computeGradient(map, p, p, J, H, param, s, g, h);
+            frozen_traits_t::computeGradient(frozen, p, p, J, H, param, s_frozen, g, h);
+            EXPECT_EQ(threshold < occupancy ? expected : 0.0, s);
+            EXPECT_NEAR(s, s_frozen, 1e-9);
+        }
+    }
+    EXPECT_GT(partial, 0ul);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
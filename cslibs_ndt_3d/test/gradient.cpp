@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/matching/generic_match.hpp>
+#include <cslibs_ndt_3d/matching/gradient.hpp>
+
+#include <cslibs_math/random/random.hpp>
+#include <cslibs_math_3d/linear/transform.hpp>
+
+using rng_t      = cslibs_math::random::Uniform<double,1>;
+using gradient_t = Eigen::Matrix<double, 6, 1>;
+using hessian_t  = Eigen::Matrix<double, 6, 6>;
+using states_t   = std::vector<gradient_t, Eigen::aligned_allocator<gradient_t>>;
+
+using cslibs_ndt_3d::matching::Jacobian;
+using cslibs_ndt_3d::matching::Hessian;
+
+/// the term evaluated partial by partial
+void accumulateReference(const Eigen::Vector3d &p,
+                         const Eigen::Vector3d &q,
+                         const Eigen::Matrix3d &info,
+                         const double s,
+                         const Jacobian &J,
+                         const Hessian &H,
+                         gradient_t &g,
+                         hessian_t &h)
+{
+    const auto q_info = (q.transpose() * info).eval();
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        const auto J_ip     = J.get(i, p);
+        const auto J_info   = (info * J_ip).eval();
+
+        g(i) += s * q_info * J_ip;
+
+        for (std::size_t j = 0; j < 6; ++j)
+        {
+            h(i, j) -= s * q_info * H.get(i, j, p) +
+                    s * static_cast<double>((J.get(j, p).transpose()).eval() * J_info) -
+                    s * (q_info * J_ip).eval() * (-q_info * J.get(j, p)).eval();
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testGradientKernel)
+{
+    rng_t rng(-1.0, 1.0);
+    for (std::size_t t = 0; t < 100; ++t)
+    {
+        const Eigen::Vector3d angular(rng.get(), rng.get(), 3.0 * rng.get());
+        Jacobian J;
+        Jacobian::get(angular, J);
+        Hessian H;
+        Hessian::get(angular, H);
+
+        gradient_t g = gradient_t::Zero(), g_reference = gradient_t::Zero();
+        hessian_t  h = hessian_t::Zero(),  h_reference = hessian_t::Zero();
+        for (std::size_t n = 0; n < 50; ++n)
+        {
+            Eigen::Matrix3d A;
+            for (int i = 0; i < 9; ++i)
+                A(i) = rng.get();
+            const Eigen::Matrix3d info = (A * A.transpose() + 0.1 * Eigen::Matrix3d::Identity()).inverse();
+            const Eigen::Vector3d p(5.0 * rng.get(), 5.0 * rng.get(), rng.get());
+            const Eigen::Vector3d q(rng.get(), rng.get(), rng.get());
+            const double s = 0.5 * (rng.get() + 1.0);
+
+            cslibs_ndt_3d::matching::accumulateGradient(p, q, info, s, J, H, g, h);
+            accumulateReference(p, q, info, s, J, H, g_reference, h_reference);
+        }
+
+        /// the lower triangle is left untouched
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < i; ++j)
+                EXPECT_EQ(0.0, h(i, j));
+
+        h.triangularView<Eigen::StrictlyLower>() = h.transpose();
+        EXPECT_TRUE(g.isApprox(g_reference, 1e-12));
+        EXPECT_TRUE(h.isApprox(h_reference, 1e-12));
+    }
+}
+
+/// the score of a single term with the source point p moved by the state
+double score(const Eigen::Vector3d &p,
+             const Eigen::Vector3d &mean,
+             const Eigen::Matrix3d &info,
+             const gradient_t &state)
+{
+    const cslibs_math_3d::Transform3d t(state(0), state(1), state(2), state(3), state(4), state(5));
+    const Eigen::Vector3d q = (t * cslibs_math_3d::Point3d(p)).data() - mean;
+    return std::exp(-0.5 * q.dot(info * q));
+}
+
+TEST(Test_cslibs_ndt_3d, testGradientFiniteDifferences)
+{
+    rng_t rng(-1.0, 1.0);
+    for (std::size_t t = 0; t < 100; ++t)
+    {
+        gradient_t state;
+        for (int i = 0; i < 6; ++i)
+            state(i) = 0.5 * rng.get();
+        const Eigen::Vector3d angular = state.tail<3>();
+        Jacobian J;
+        Jacobian::get(angular, J);
+        Hessian H;
+        Hessian::get(angular, H);
+
+        /// the distribution sits close to the moved point
+        const cslibs_math_3d::Transform3d transform(state(0), state(1), state(2), state(3), state(4), state(5));
+        const Eigen::Vector3d p(5.0 * rng.get(), 5.0 * rng.get(), rng.get());
+        const Eigen::Vector3d p_moved = (transform * cslibs_math_3d::Point3d(p)).data();
+        const Eigen::Vector3d mean(p_moved(0) + 0.5 * rng.get(), p_moved(1) + 0.5 * rng.get(), p_moved(2) + 0.5 * rng.get());
+        Eigen::Matrix3d A;
+        for (int i = 0; i < 9; ++i)
+            A(i) = rng.get();
+        const Eigen::Matrix3d info = (A * A.transpose() + 0.1 * Eigen::Matrix3d::Identity()).inverse();
+
+        gradient_t g = gradient_t::Zero();
+        hessian_t  h = hessian_t::Zero();
+        cslibs_ndt_3d::matching::accumulateGradient(p, p_moved - mean, info, score(p, mean, info, state), J, H, g, h);
+
+        /// g is the negative derivative of the score in the six parameters of the state
+        const double eps = 1e-6;
+        for (int i = 0; i < 6; ++i) {
+            const gradient_t delta = eps * gradient_t::Unit(i);
+            const double d = (score(p, mean, info, state + delta) -
+                              score(p, mean, info, state - delta)) / (2.0 * eps);
+            EXPECT_NEAR(-d, g(i), 1e-6);
+        }
+    }
+}
+
+/// a map without cells, its score is a sum of Gaussians and has no jumps at cell borders
+struct Mixture
+{
+    using point_t     = cslibs_math_3d::Point3d;
+    using transform_t = cslibs_math_3d::Transform3d;
+
+    std::vector<Eigen::Vector3d> means;
+    Eigen::Matrix3d              info;
+};
+
+/// the states of all evaluations of the matcher, in order
+struct MixtureTraits
+{
+    static constexpr int LINEAR_DIMS  = 3;
+    static constexpr int ANGULAR_DIMS = 3;
+    using Jacobian    = cslibs_ndt_3d::matching::Jacobian;
+    using Hessian     = cslibs_ndt_3d::matching::Hessian;
+    using gradient_t  = ::gradient_t;
+    using hessian_t   = ::hessian_t;
+    using point_t     = Mixture::point_t;
+    using transform_t = Mixture::transform_t;
+    using parameter_t = cslibs_ndt::matching::Parameter;
+
+    static states_t states;
+
+    static transform_t makeTransform(const Eigen::Vector3d& linear,
+                                     const Eigen::Vector3d& angular)
+    {
+        gradient_t state;
+        state << linear, angular;
+        states.push_back(state);
+        return transform_t{linear.x(), linear.y(), linear.z(),
+                           angular.x(), angular.y(), angular.z()};
+    }
+
+    static void computeGradient(const Mixture& map,
+                                const point_t& point,
+                                const point_t& source,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t&,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        for (const Eigen::Vector3d &mean : map.means) {
+            const Eigen::Vector3d q = point.data() - mean;
+            const double s = std::exp(-0.5 * q.dot(map.info * q));
+            cslibs_ndt_3d::matching::accumulateGradient(source.data(), q, map.info, s, J, H, g, h);
+            score += s;
+        }
+    }
+};
+states_t MixtureTraits::states;
+
+/// score and gradient of all points at the state, as one pass of the matcher computes them
+double evaluate(const Mixture &map,
+                const std::vector<cslibs_math_3d::Point3d> &points,
+                const gradient_t &state,
+                gradient_t &g)
+{
+    const Eigen::Vector3d angular = state.tail<3>();
+    Jacobian J;
+    Jacobian::get(angular, J);
+    Hessian H;
+    Hessian::get(angular, H);
+    const cslibs_math_3d::Transform3d t(state(0), state(1), state(2), state(3), state(4), state(5));
+
+    double score = 0.0;
+    hessian_t h = hessian_t::Zero();
+    g.setZero();
+    for (const cslibs_math_3d::Point3d &p : points)
+        MixtureTraits::computeGradient(map, t * p, p, J, H, MixtureTraits::parameter_t(), score, g, h);
+    return score;
+}
+
+TEST(Test_cslibs_ndt_3d, testLineSearchSlope)
+{
+    rng_t rng(-1.0, 1.0);
+
+    Mixture map;
+    for (std::size_t i = 0; i < 30; ++i)
+        map.means.emplace_back(5.0 * rng.get(), 5.0 * rng.get(), rng.get());
+    map.info = Eigen::Vector3d(4.0, 2.0, 8.0).asDiagonal();
+
+    /// the points are drawn around the means and moved away from them
+    const cslibs_math_3d::Transform3d truth(0.2, -0.15, 0.05, 0.02, -0.03, 0.1);
+    std::vector<cslibs_math_3d::Point3d> points;
+    for (std::size_t i = 0; i < 300; ++i) {
+        const Eigen::Vector3d &mean = map.means[i % map.means.size()];
+        const cslibs_math_3d::Point3d p(mean(0) + 0.2 * rng.get(), mean(1) + 0.2 * rng.get(), mean(2) + 0.1 * rng.get());
+        points.emplace_back(truth.inverse() * p);
+    }
+
+    cslibs_ndt::matching::Parameter param;
+    param.lineSearch() = true;
+    param.maxIterations() = 100;
+    MixtureTraits::states.clear();
+    const auto result = cslibs_ndt::matching::match<std::vector<cslibs_math_3d::Point3d>::const_iterator, Mixture, MixtureTraits>(
+                points.begin(), points.end(), map, param, cslibs_math_3d::Transform3d());
+    EXPECT_EQ(cslibs_ndt::matching::Termination::DELTA_EPSILON, result.termination());
+    EXPECT_GT(MixtureTraits::states.size(), result.iterations() + 1);
+
+    /// every trial lies on the search line of the one before, phi'(a) = g dp is the slope of -score along it
+    std::size_t checked = 0;
+    const double eps = 1e-6;
+    for (std::size_t k = 1; k < MixtureTraits::states.size(); ++k) {
+        const gradient_t &state = MixtureTraits::states[k];
+        const gradient_t  step  = state - MixtureTraits::states[k - 1];
+        if (step.norm() < 1e-9)
+            continue;
+        const gradient_t dp = step.normalized();
+
+        gradient_t g, g_eps;
+        evaluate(map, points, state, g);
+        const double d = -(evaluate(map, points, state + eps * dp, g_eps) -
+                           evaluate(map, points, state - eps * dp, g_eps)) / (2.0 * eps);
+        EXPECT_NEAR(d, g.dot(dp), 1e-6 * std::max(1.0, std::abs(d)));
+        ++checked;
+    }
+    EXPECT_GT(checked, 2ul);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/matching/match.hpp>
+#include <cslibs_ndt/matching/match_pyramid.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/pyramids/gridmap.hpp>
+
+#include "test_utility.hpp"
+
+const std::size_t NUM_POINTS = 40000;
+
+using point_t     = cslibs_math_3d::Point3d;
+using transform_t = cslibs_math_3d::Transform3d;
+using map_t       = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using pyramid_t   = cslibs_ndt_3d::pyramids::Gridmap<double>;
+using parameter_t = cslibs_ndt::matching::PyramidParameter<cslibs_ndt::matching::Parameter>;
+
+TEST(Test_cslibs_ndt_3d, testDownsample)
+{
+    const std::vector<point_t> points = generateRoom(NUM_POINTS);
+
+    std::vector<point_t> all, downsampled;
+    cslibs_ndt::matching::detail::downsample(points.begin(), points.end(), 0.0, all);
+    EXPECT_EQ(points.size(), all.size());
+
+    cslibs_ndt::matching::detail::downsample(points.begin(), points.end(), 1.0, downsampled);
+    EXPECT_LT(downsampled.size(), points.size() / 10);
+    EXPECT_GT(downsampled.size(), 0ul);
+
+    /// centroids stay within the voxels, up to the noise of the surfaces
+    for (const point_t &p : downsampled) {
+        EXPECT_LE(std::abs(p(0)), 10.1);
+        EXPECT_LE(std::abs(p(1)), 10.1);
+        EXPECT_LE(p(2), 3.0);
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testDifference)
+{
+    const transform_t a(1.0, 2.0, 0.5, 0.1, -0.2, 0.3);
+    const transform_t b = a * transform_t(0.3, 0.0, -0.4, 0.0, 0.0, 0.25);
+
+    double translation, rotation;
+    cslibs_ndt::matching::detail::difference<point_t>(a, b, translation, rotation);
+    EXPECT_NEAR(0.5,  translation, 1e-9);
+    EXPECT_NEAR(0.25, rotation,    1e-9);
+
+    cslibs_ndt::matching::detail::difference<point_t>(a, a, translation, rotation);
+    EXPECT_NEAR(0.0, translation, 1e-9);
+    EXPECT_NEAR(0.0, rotation,    1e-6);
+}
+
+TEST(Test_cslibs_ndt_3d, testPyramidMatch)
+{
+    map_t::Ptr map(new map_t(0.5));
+    const std::vector<point_t> room = generateRoom(NUM_POINTS);
+    map->insert(room.begin(), room.end());
+    const pyramid_t pyramid(map, 3);
+
+    const transform_t truth(0.3, -0.2, 0.0, 0.0, 0.0, 0.05);
+    const std::vector<point_t> scan = transformed(generateRoom(NUM_POINTS / 4), truth.inverse());
+
+    cslibs_ndt::matching::Parameter level_param;
+    level_param.numThreads() = 2;
+    const parameter_t param(level_param, 0.25, 0.0, 0.0);
+    const auto result = cslibs_ndt::matching::match(scan.begin(), scan.end(), pyramid, param, transform_t());
+
+    ASSERT_EQ(pyramid.getLevelCount(), result.levelIterations().size());
+    EXPECT_EQ(0ul, result.level());
+
+    /// every level starts where the coarser one stopped
+    transform_t expected;
+    std::size_t iterations = 0;
+    for (std::size_t level = pyramid.getLevelCount(); level-- > 0;) {
+        std::vector<point_t> points;
+        cslibs_ndt::matching::detail::downsample(scan.begin(), scan.end(), 0.25 * pyramid.getResolution(level), points);
+        const auto r = level == 0 ?
+                    cslibs_ndt::matching::match(points.begin(), points.end(), *map, level_param, expected) :
+                    cslibs_ndt::matching::match(points.begin(), points.end(), pyramid.getLevel(level), level_param, expected);
+        EXPECT_EQ(r.iterations(), result.levelIterations()[level]);
+        iterations += r.iterations();
+        expected = r.transform();
+    }
+    EXPECT_EQ(iterations, result.iterations());
+    EXPECT_NEAR(expected.tx(), result.transform().tx(), 1e-9);
+    EXPECT_NEAR(expected.ty(), result.transform().ty(), 1e-9);
+    EXPECT_NEAR(expected.tz(), result.transform().tz(), 1e-9);
+}
+
+TEST(Test_cslibs_ndt_3d, testPyramidMatchAgreement)
+{
+    map_t::Ptr map(new map_t(0.5));
+    const std::vector<point_t> room = generateRoom(NUM_POINTS);
+    map->insert(room.begin(), room.end());
+    const pyramid_t pyramid(map, 4);
+
+    const std::vector<point_t> scan = generateRoom(NUM_POINTS / 4);
+    cslibs_ndt::matching::Parameter level_param;
+
+    /// starting at the solution, the second level agrees with the coarsest one and
+    /// the intermediate levels are skipped, level 0 is matched nevertheless
+    parameter_t param(level_param, 0.25, 0.1, 0.1);
+    const auto agreed = cslibs_ndt::matching::match(scan.begin(), scan.end(), pyramid, param, transform_t());
+    const std::size_t level = pyramid.getLevelCount() - 2;
+    ASSERT_EQ(level, agreed.level());
+    for (std::size_t l = 1; l < level; ++l)
+        EXPECT_EQ(0ul, agreed.levelIterations()[l]);
+
+    /// the result and the score are those of level 0 started where the agreeing level stopped
+    transform_t expected;
+    for (std::size_t l = pyramid.getLevelCount(); l-- > level;) {
+        std::vector<point_t> points;
+        cslibs_ndt::matching::detail::downsample(scan.begin(), scan.end(), 0.25 * pyramid.getResolution(l), points);
+        expected = cslibs_ndt::matching::match(points.begin(), points.end(), pyramid.getLevel(l), level_param, expected).transform();
+    }
+    std::vector<point_t> points;
+    cslibs_ndt::matching::detail::downsample(scan.begin(), scan.end(), 0.25 * pyramid.getResolution(0), points);
+    const auto finest = cslibs_ndt::matching::match(points.begin(), points.end(), *map, level_param, expected);
+    EXPECT_NEAR(finest.score(), agreed.score(), 1e-9);
+    double translation, rotation;
+    cslibs_ndt::matching::detail::difference<point_t>(finest.transform(), agreed.transform(), translation, rotation);
+    EXPECT_NEAR(0.0, translation, 1e-9);
+    EXPECT_NEAR(0.0, rotation,    1e-6);
+
+    /// without agreement every level is matched, started off the solution so that each one has to move
+    param.agreementTranslation() = 0.0;
+    const transform_t initial(0.1, -0.1, 0.0, 0.0, 0.0, 0.02);
+    const auto full = cslibs_ndt::matching::match(scan.begin(), scan.end(), pyramid, param, initial);
+    EXPECT_EQ(0ul, full.level());
+    EXPECT_GT(full.levelIterations().front(), 0ul);
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
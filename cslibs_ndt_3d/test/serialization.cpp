@@ -195,8 +195,8 @@ void testDynamicOccMap(const typename cslibs_ndt_3d::dynamic_maps::OccupancyGrid
                 EXPECT_EQ(b.at(i)->numFree(), bb->at(i)->numFree());
                 EXPECT_EQ(b.at(i)->numOccupied(), bb->at(i)->numOccupied());
 
-                const std::shared_ptr<cslibs_math::statistics::Distribution<double, 3, 3>> d  = b.at(i)->getDistribution();
-                const std::shared_ptr<cslibs_math::statistics::Distribution<double, 3, 3>> dd = bb->at(i)->getDistribution();
+                const auto *d  = b.at(i)->getDistribution().get();
+                const auto *dd = bb->at(i)->getDistribution().get();
                 if (d) {
                     EXPECT_NE(dd, nullptr);
                     EXPECT_EQ(d->getN(), dd->getN());
@@ -260,8 +260,8 @@ void testStaticOccMap(const typename cslibs_ndt_3d::static_maps::OccupancyGridma
                 EXPECT_EQ(b.at(i)->numFree(),     bb->at(i)->numFree());
                 EXPECT_EQ(b.at(i)->numOccupied(), bb->at(i)->numOccupied());
 
-                const std::shared_ptr<cslibs_math::statistics::Distribution<double, 3, 3>> d  = b.at(i)->getDistribution();
-                const std::shared_ptr<cslibs_math::statistics::Distribution<double, 3, 3>> dd = bb->at(i)->getDistribution();
+                const auto *d  = b.at(i)->getDistribution().get();
+                const auto *dd = bb->at(i)->getDistribution().get();
                 if (d) {
                     EXPECT_NE(dd, nullptr);
                     EXPECT_EQ(d->getN(), dd->getN());
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/matching/match.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/frozen_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/snapshots/gridmap.hpp>
+#include <cslibs_ndt_3d/snapshots/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+const std::size_t NUM_POINTS  = 20000;
+const std::size_t NUM_QUERIES = 5000;
+const std::size_t TILE_SIZE   = 8;
+
+using rng_t   = cslibs_math::random::Uniform<double,1>;
+using point_t = cslibs_math_3d::Point3d;
+
+inline std::vector<point_t> generatePoints(const std::size_t count,
+                                           const double min,
+                                           const double max)
+{
+    rng_t rng_coord(min, max);
+    std::vector<point_t> points;
+    for (std::size_t i = 0 ; i < count ; ++i)
+        points.emplace_back(rng_coord.get(), rng_coord.get(), 0.25 * rng_coord.get());
+    return points;
+}
+
+/// a snapshot has to answer every query exactly like a full freeze of the map
+template <typename frozen_t, typename snapshot_t>
+void testEqual(const frozen_t &frozen, const snapshot_t &snapshot)
+{
+    rng_t rng_coord(-12.0, 12.0);
+    for (std::size_t i = 0 ; i < NUM_QUERIES ; ++i) {
+        const point_t p(rng_coord.get(), rng_coord.get(), rng_coord.get());
+
+        const typename snapshot_t::tile_t *tile = nullptr;
+        const typename frozen_t::bundle_t *expected = frozen.getBundle(p);
+        const typename snapshot_t::bundle_t *bundle = snapshot.getBundle(p, tile);
+        ASSERT_EQ(expected != nullptr, bundle != nullptr);
+        if (!bundle)
+            continue;
+
+        for (std::size_t l = 0 ; l < snapshot_t::bin_count ; ++l) {
+            ASSERT_EQ(expected->at(l) != frozen_t::no_entry, bundle->at(l) != frozen_t::no_entry);
+            if (bundle->at(l) == frozen_t::no_entry)
+                continue;
+            EXPECT_EQ(frozen.getSampleCount(expected->at(l)), tile->getSampleCount(bundle->at(l)));
+            EXPECT_TRUE(frozen.getMean(expected->at(l)).isApprox(tile->getMean(bundle->at(l))));
+        }
+        EXPECT_NEAR(frozen.sampleNonNormalized(p), snapshot.sampleNonNormalized(p), 1e-9);
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testSnapshotVersions)
+{
+    using map_t      = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using frozen_t   = cslibs_ndt_3d::frozen_maps::Gridmap<double>;
+    using snapshot_t = cslibs_ndt_3d::snapshots::Gridmap<double>;
+
+    map_t map(1.0);
+    map.trackChanges(TILE_SIZE);
+
+    const std::vector<point_t> points = generatePoints(NUM_POINTS, -10.0, 10.0);
+    map.insert(points.begin(), points.end());
+    const snapshot_t::ConstPtr first(new snapshot_t(map));
+    const map_t copy(map);
+    EXPECT_EQ(0ul, first->version());
+    testEqual(frozen_t(map), *first);
+
+    /// only a corner of the map changes
+    const std::vector<point_t> update = generatePoints(NUM_POINTS / 10, 5.0, 10.0);
+    map.insert(update.begin(), update.end());
+    const snapshot_t::ConstPtr second(new snapshot_t(map, first));
+    EXPECT_EQ(1ul, second->version());
+    testEqual(frozen_t(map), *second);
+
+    /// the first version is not affected by the update, unchanged tiles are shared
+    testEqual(frozen_t(copy), *first);
+    EXPECT_GT(second->sharedTileCount(*first), 0ul);
+    EXPECT_LT(second->sharedTileCount(*first), second->tileCount());
+
+    /// the chunks away from the corner are shared by pointer, those with changed tiles are copied
+    EXPECT_GT(second->sharedChunkCount(*first), 0ul);
+    EXPECT_LT(second->sharedChunkCount(*first), second->chunkCount());
+
+    /// nothing changed, everything is shared
+    const snapshot_t third(map, second);
+    EXPECT_EQ(second->tileCount(), third.sharedTileCount(*second));
+    EXPECT_EQ(second->chunkCount(), third.sharedChunkCount(*second));
+}
+
+TEST(Test_cslibs_ndt_3d, testSnapshotChunks)
+{
+    using map_t      = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using frozen_t   = cslibs_ndt_3d::frozen_maps::Gridmap<double>;
+    using snapshot_t = cslibs_ndt_3d::snapshots::Gridmap<double>;
+
+    /// small tiles, the map spans chunks on both sides of the origin
+    map_t map(1.0);
+    map.trackChanges(2);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS, -10.0, 10.0);
+    map.insert(points.begin(), points.end());
+    snapshot_t::ConstPtr previous(new snapshot_t(map));
+    EXPECT_GT(previous->chunkCount(), 1ul);
+    EXPECT_LE(previous->tileCount(), previous->chunkCount() * snapshot_t::chunk_tiles);
+    testEqual(frozen_t(map), *previous);
+
+    /// local updates copy few chunks, the versions keep answering like a full freeze
+    rng_t rng_coord(-10.0, 10.0);
+    for (std::size_t v = 0 ; v < 5 ; ++v) {
+        const double x = rng_coord.get(), y = rng_coord.get();
+        const std::vector<point_t> update = generatePoints(NUM_POINTS / 100, -1.0, 1.0);
+        std::vector<point_t> moved;
+        for (const point_t &p : update)
+            moved.emplace_back(p(0) + x, p(1) + y, p(2));
+        map.insert(moved.begin(), moved.end());
+
+        const snapshot_t::ConstPtr next(new snapshot_t(map, previous));
+        testEqual(frozen_t(map), *next);
+        EXPECT_GT(next->sharedChunkCount(*previous), next->chunkCount() / 2);
+        previous = next;
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testSnapshotStaticGridmap)
+{
+    using map_t      = cslibs_ndt_3d::static_maps::Gridmap<double>;
+    using frozen_t   = cslibs_ndt::map::FrozenMap<3,cslibs_ndt::Distribution,double>;
+    using snapshot_t = cslibs_ndt::map::Snapshot<3,cslibs_ndt::Distribution,double>;
+
+    map_t map(cslibs_math_3d::Transform3d(-6.0, -6.0, -6.0, 0.0, 0.0, 0.0), 1.0, {{12, 12, 12}}, {{0, 0, 0}});
+    map.trackChanges(TILE_SIZE);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS, -5.0, 5.0);
+    map.insert(points.begin(), points.end());
+
+    const snapshot_t::ConstPtr first(new snapshot_t(map));
+    testEqual(frozen_t(map), *first);
+
+    map.insert(points.begin(), points.begin() + NUM_POINTS / 10);
+    testEqual(frozen_t(map), snapshot_t(map, first));
+}
+
+TEST(Test_cslibs_ndt_3d, testSnapshotOccupancyGridmap)
+{
+    using map_t      = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+    using snapshot_t = cslibs_ndt_3d::snapshots::OccupancyGridmap<double>;
+    using ivm_t      = map_t::inverse_sensor_model_t;
+
+    map_t map(1.0);
+    map.trackChanges(TILE_SIZE);
+    const cslibs_math_3d::Transform3d origin(0.0, 0.0, 3.0, 0.0, 0.0, 0.0);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS / 10, -5.0, 5.0);
+    map.insert(points.begin(), points.end(), origin);
+    const snapshot_t::ConstPtr first(new snapshot_t(map));
+
+    const std::vector<point_t> update = generatePoints(NUM_POINTS / 100, 0.0, 5.0);
+    map.insert(update.begin(), update.end(), origin);
+    const snapshot_t second(map, first);
+
+    const ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    rng_t rng_coord(-6.0, 6.0);
+    for (std::size_t i = 0 ; i < NUM_QUERIES ; ++i) {
+        const point_t p(rng_coord.get(), rng_coord.get(), rng_coord.get());
+        if (map.get(p)) {
+            EXPECT_NEAR(map.sampleNonNormalized(p, ivm), second.sampleNonNormalized(p, ivm), 1e-9);
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt_3d, testSnapshotConcurrentMapping)
+{
+    using map_t      = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using snapshot_t = cslibs_ndt_3d::snapshots::Gridmap<double>;
+
+    map_t map(1.0);
+    map.trackChanges(TILE_SIZE);
+    const std::vector<point_t> points = generatePoints(NUM_POINTS, -10.0, 10.0);
+    map.insert(points.begin(), points.end());
+
+    snapshot_t::ConstPtr published(new snapshot_t(map));
+    std::atomic<bool> done(false);
+
+    /// the writer keeps on mapping and publishes a version after every scan
+    std::thread writer([&]() {
+        for (std::size_t s = 0 ; s < 10 ; ++s) {
+            const std::vector<point_t> scan = generatePoints(NUM_POINTS / 10, -10.0, 10.0);
+            map.insert(scan.begin(), scan.end());
+            std::atomic_store(&published, snapshot_t::ConstPtr(new snapshot_t(map, std::atomic_load(&published))));
+        }
+        done = true;
+    });
+
+    /// the reader localizes against whatever version is the latest
+    const std::vector<point_t> scan = generatePoints(NUM_POINTS / 20, -10.0, 10.0);
+    const cslibs_math_3d::Transform3d initial(0.1, -0.1, 0.0, 0.0, 0.0, 0.02);
+    cslibs_ndt::matching::Parameter param;
+    param.maxIterations() = 5;
+    std::size_t matches = 0;
+    while (!done || matches == 0) {
+        const snapshot_t::ConstPtr snapshot = std::atomic_load(&published);
+        const auto result = cslibs_ndt::matching::match(scan.begin(), scan.end(), *snapshot, param, initial);
+        EXPECT_TRUE(std::isfinite(result.score()));
+        ++matches;
+    }
+    writer.join();
+
+    EXPECT_EQ(10ul, std::atomic_load(&published)->version());
+}
+
+TEST(Test_cslibs_ndt_3d, testConcurrentChangeTracking)
+{
+    using map_t            = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    using concurrent_map_t = cslibs_ndt_3d::dynamic_maps::ConcurrentGridmap<double>;
+    using index_t          = map_t::index_t;
+
+    std::vector<std::vector<point_t>> scans;
+    for (std::size_t s = 0 ; s < 4 ; ++s)
+        scans.emplace_back(generatePoints(NUM_POINTS / 4, -10.0 + 2.0 * s, 2.0 * s));
+
+    map_t expected(1.0);
+    expected.trackChanges(TILE_SIZE);
+    for (const std::vector<point_t> &scan : scans)
+        expected.insert(scan.begin(), scan.end());
+
+    /// every writer marks tiles of its own and tiles shared with the others
+    concurrent_map_t map(1.0);
+    map.trackChanges(TILE_SIZE);
+    std::vector<std::thread> writers;
+    for (const std::vector<point_t> &scan : scans)
+        writers.emplace_back([&map, &scan]() {
+            map.insert(scan.begin(), scan.end());
+        });
+    for (std::thread &w : writers)
+        w.join();
+
+    std::vector<index_t> expected_tiles, tiles;
+    expected.takeChangedTiles(expected_tiles);
+    map.takeChangedTiles(tiles);
+    EXPECT_FALSE(tiles.empty());
+    EXPECT_EQ(expected_tiles.size(), tiles.size());
+    EXPECT_TRUE(std::set<index_t>(expected_tiles.begin(), expected_tiles.end()) ==
+                std::set<index_t>(tiles.begin(), tiles.end()));
+
+    map.takeChangedTiles(tiles);
+    EXPECT_TRUE(tiles.empty());
+}
+
+int main(int argc, char *argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cslibs_math_3d/linear/transform.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <vector>
+
+/// box shaped room with two pillars, surfaces sampled with gaussian noise
+inline std::vector<cslibs_math_3d::Point3d> generateRoom(const std::size_t count)
+{
+    cslibs_math::random::Uniform<double,1> u(0.0, 1.0);
+    cslibs_math::random::Normal<double,1>  n(0.0, 0.02);
+
+    std::vector<cslibs_math_3d::Point3d> points;
+    points.reserve(count);
+    for (std::size_t i = 0 ; i < count ; ++i) {
+        const double a = u.get() * 20.0 - 10.0;
+        const double b = u.get() * 20.0 - 10.0;
+        const double c = u.get() * 3.0;
+        switch (i % 6) {
+        case 0: points.emplace_back(a, b, n.get()); break;
+        case 1: points.emplace_back(a, -10.0 + n.get(), c); break;
+        case 2: points.emplace_back(a,  10.0 + n.get(), c); break;
+        case 3: points.emplace_back(-10.0 + n.get(), b, c); break;
+        case 4: points.emplace_back( 10.0 + n.get(), b, c); break;
+        default: {
+            const double phi = u.get() * 2.0 * M_PI;
+            const double x   = (i % 12 < 6) ? -4.0 : 4.0;
+            points.emplace_back(x + 0.5 * std::cos(phi), 0.5 * std::sin(phi), c);
+        }
+        }
+    }
+    return points;
+}
+
+inline std::vector<cslibs_math_3d::Point3d> transformed(const std::vector<cslibs_math_3d::Point3d> &points,
+                                                        const cslibs_math_3d::Transform3d &t)
+{
+    std::vector<cslibs_math_3d::Point3d> result;
+    result.reserve(points.size());
+    for (const cslibs_math_3d::Point3d &p : points)
+        result.emplace_back(t * p);
+    return result;
+}
+
+/// wall time of f in milliseconds
+template <typename function_t>
+inline double measure(const function_t &f)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}